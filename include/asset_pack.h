@@ -0,0 +1,91 @@
+#pragma once
+#include <Arduino.h>
+
+// Packed UI assets (icons, fonts) built from PixelArt/ by scripts/pack_assets.py
+// and flashed to the "assets" partition. The layout must match the packer.
+#define ASSET_PACK_MAGIC       0x50414345 // "ECAP"
+#define ASSET_PACK_VERSION     1
+#define ASSET_NAME_LEN         28
+#define ASSET_PARTITION_NAME   "assets"
+#define ASSET_PARTITION_TYPE   0x40       // Custom data subtype, see partitions.csv
+#define ASSET_CACHE_SLOTS      8
+#define ASSET_CACHE_SLOT_BYTES 256        // Largest bitmap (SD question mark) is 215
+
+#ifndef ASSET_PACK_HOST_FILE
+#define ASSET_PACK_HOST_FILE ".pio/assets/assets.bin" // Simulator only
+#endif
+
+enum AssetType : uint8_t {
+    ASSET_BITMAP = 0, // 1-bit, drawBitmap layout
+    ASSET_BLOB = 1    // Raw bytes, e.g. a .vlw smooth font
+};
+
+enum AssetCodec : uint8_t {
+    ASSET_STORED = 0,
+    ASSET_LZ4 = 1     // LZ4 block format
+};
+
+struct AssetPackHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t totalSize;
+    uint32_t reserved;
+};
+
+struct AssetEntry {
+    char name[ASSET_NAME_LEN];
+    uint16_t width;
+    uint16_t height;
+    uint8_t type;
+    uint8_t codec;
+    uint16_t reserved;
+    uint32_t offset;     // From the start of the pack
+    uint32_t packedSize;
+    uint32_t rawSize;
+};
+
+// Stored assets are returned straight from the memory mapped partition.
+// Compressed ones are decoded into a small LRU cache, so a returned pointer
+// stays valid until ASSET_CACHE_SLOTS other compressed assets are fetched.
+class AssetPack {
+public:
+    static AssetPack& getInstance() {
+        static AssetPack instance;
+        return instance;
+    }
+
+    bool begin();                                 // Map the assets partition
+    bool begin(const uint8_t* data, size_t size); // Use a pack that is already in memory
+    bool isReady() { return pack != nullptr; }
+
+    const AssetEntry* find(const char* name);
+    const uint8_t* get(const char* name);         // nullptr if missing or corrupt
+    const unsigned char* getBitmap(const char* name); // Never null, missing icons draw blank
+    void clearCache();
+
+    uint16_t getCount() { return count; }
+    uint32_t getHits() { return hits; }
+    uint32_t getMisses() { return misses; }
+
+    // Returns the decoded size, or -1 on malformed input / overflow
+    static int lz4Decode(const uint8_t* src, size_t srcLen, uint8_t* dst, size_t dstCap);
+
+private:
+    struct CacheSlot {
+        const AssetEntry* entry;
+        uint32_t lastUse;
+        uint8_t data[ASSET_CACHE_SLOT_BYTES];
+    };
+
+    const uint8_t* pack = nullptr;
+    const AssetEntry* entries = nullptr;
+    uint16_t count = 0;
+    CacheSlot cache[ASSET_CACHE_SLOTS];
+    uint32_t useCounter = 0;
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+
+    AssetPack() { clearCache(); }
+    const uint8_t* decode(const AssetEntry* entry);
+};
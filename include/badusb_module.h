@@ -1,6 +1,7 @@
 #pragma once
 #include "module_base.h"
 #include "sd_manager.h"
+#include "list_view.h"
 #include <vector>
 
 class BadUSBModule : public Module {
@@ -19,7 +20,7 @@ public:
 
 private:
     std::vector<FileEntry> scriptFiles;
-    int selectedIndex = 0;
+    ListView fileList;
     bool filesLoaded = false;
     String statusMessage = "";
     String currentPath = "/payloads";
@@ -0,0 +1,101 @@
+#pragma once
+#include <Arduino.h>
+
+#define BATTERY_SAMPLE_MS    1000  // One oversampled reading per second
+#define BATTERY_OVERSAMPLE   16    // ADC reads per reading, the lowest and highest dropped
+#define BATTERY_FILTER_SHIFT 3     // Exponential filter weight 1/8, settles in ~20 readings
+#define BATTERY_TREND_MS     60000 // One point a minute for the estimate
+#define BATTERY_TREND_POINTS 16    // Slope over the last quarter hour
+#define BATTERY_TREND_MIN    4     // Points before there is a state and an estimate
+#define BATTERY_USB_MV       4250  // Above a full cell, only the charger holds it there
+#define BATTERY_JUMP_MV      80    // Between two points: plugged or unplugged, start over
+#define BATTERY_RISE_PCT_H   2.0f  // Rising faster than this is charging
+#define BATTERY_FALL_PCT_H   0.1f  // Falling slower than this gives no time to empty
+
+#define BATTERY_LOG_DIR      "/battery"
+#define BATTERY_LOG_FILE     "/battery/discharge.csv"
+#define BATTERY_LOG_HEADER   "unixtime,uptime_s,mv,percent,minutes_left\n"
+#define BATTERY_LOG_LINE_MAX 48
+#define BATTERY_LOG_BUFFER   512   // ~12 rows, an SD write every ~12 minutes while discharging
+
+enum BatteryState : uint8_t {
+    BATTERY_UNKNOWN,      // Not enough points yet
+    BATTERY_DISCHARGING,
+    BATTERY_CHARGING      // On USB, or rising
+};
+
+// Charge left in a resting LiPo cell, 0 to 100, from a typical discharge curve
+float batteryPercent(uint16_t mv);
+
+// Smooths one oversampled reading per add(). A median of the last three
+// drops single dips, e.g. the rail sagging under a WiFi transmit, and an
+// exponential filter in fixed point settles the rest. The first reading
+// after reset() seeds it.
+class BatteryFilter {
+public:
+    void reset();
+    uint16_t add(uint16_t mv);
+    uint16_t get() const { return (value + 8) >> 4; }
+
+private:
+    int32_t value = 0;  // mV with 4 fraction bits
+    uint16_t last[3] = {};
+    uint8_t count = 0;
+};
+
+// Charge state and time to empty from one filtered point a minute: a least
+// squares slope of the charge over the last BATTERY_TREND_POINTS points.
+// Points taken on USB, or across a jump, are not part of any curve.
+class BatteryTrend {
+public:
+    void reset();
+    void add(uint32_t ms, uint16_t mv);
+
+    BatteryState getState() const { return state; }
+    float getRate() const { return rate; }            // Percent per hour, negative while discharging
+    int32_t getMinutesLeft() const;                   // -1 without an estimate
+    uint8_t getCount() const { return count; }
+
+private:
+    uint32_t times[BATTERY_TREND_POINTS];
+    uint16_t levels[BATTERY_TREND_POINTS];            // mV
+    uint8_t head = 0;                                 // Next slot
+    uint8_t count = 0;
+    float rate = 0;
+    BatteryState state = BATTERY_UNKNOWN;
+
+    void fit();
+};
+
+// Battery voltage read off the draw path. poll() takes one reading a second
+// of BATTERY_OVERSAMPLE calibrated ADC reads, so the status bar only ever
+// reads the cached, filtered value. Points taken while discharging are kept
+// in RAM and appended to BATTERY_LOG_FILE a buffer at a time.
+class BatteryMonitor {
+public:
+    void begin(uint8_t pin);     // Takes the first reading right away
+    bool poll();                 // From the main loop; true when a trend point was added
+
+    uint16_t getMillivolts() const { return filter.get(); }
+    float getVoltage() const { return filter.get() / 1000.0f; }
+    uint8_t getPercent() const { return (uint8_t)(batteryPercent(filter.get()) + 0.5f); }
+    BatteryState getState() const;
+    int32_t getMinutesLeft() const { return trend.getMinutesLeft(); }
+    uint32_t getReads() const { return reads; } // ADC conversions so far
+
+    // One row for the discharge log; the time comes from the RTC, 0 without one
+    void logPoint(uint32_t unixTime);
+    void flushLog();
+
+private:
+    uint8_t pin = 0;
+    BatteryFilter filter;
+    BatteryTrend trend;
+    uint32_t lastSampleMs = 0;
+    uint32_t lastTrendMs = 0;
+    uint32_t reads = 0;
+    char logBuffer[BATTERY_LOG_BUFFER];
+    size_t logLen = 0;
+
+    uint16_t sample();
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <TFT_eSPI.h>
+
+#define BLIT_BUFFER_PIXELS 1024 // 2KB, a 24x16 icon or a 320px wide line of 3 rows per push
+
+// Draws 1-bit images (drawBitmap layout: rows padded to a byte, msb first)
+// opaque in fg and bg. Every 4 bits are expanded with one lookup into a
+// table of 16 four-pixel spans, already in the panel's byte order, and
+// whole rows go out in one window per push instead of one pixel write per
+// set bit. The table is only rebuilt when the colors change.
+class BitmapBlitter {
+public:
+    void setColors(uint16_t fg, uint16_t bg);
+
+    // One row of w pixels into out, in panel byte order
+    void expandRow(const uint8_t* bits, uint16_t w, uint16_t* out);
+
+    void draw(TFT_eSPI* tft, int32_t x, int32_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t fg,
+              uint16_t bg);
+
+    uint32_t getPushes() { return pushes; }
+
+private:
+    uint16_t lut[16][4];
+    uint16_t lutFg = 0;
+    uint16_t lutBg = 0;
+    bool lutValid = false;
+    uint16_t buffer[BLIT_BUFFER_PIXELS];
+    uint32_t pushes = 0;
+
+    void push(TFT_eSPI* tft, int32_t x, int32_t y, int16_t w, int16_t rows);
+};
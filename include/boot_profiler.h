@@ -0,0 +1,35 @@
+#pragma once
+#include <Arduino.h>
+
+#define BOOT_MAX_PHASES 12
+#define BOOT_TARGET_MS  1500 // Boot-to-menu goal shown on the About screen
+
+struct BootPhase {
+    const char* name;
+    uint32_t startUs; // micros() since power-on
+    uint32_t endUs;
+};
+
+// Timestamps each setup() phase. Sequential phases use mark(), phases that
+// run on another task report their own window through record().
+class BootProfiler {
+public:
+    void begin();
+    void mark(const char* name);                               // Ends a phase started at the previous mark
+    void record(const char* name, uint32_t startUs, uint32_t endUs);
+    void finish();                                             // Menu is on screen
+    uint32_t now();
+
+    uint32_t getTotalMs() { return totalUs / 1000; }
+    bool metTarget() { return getTotalMs() <= BOOT_TARGET_MS; }
+    int getPhaseCount() { return phaseCount; }
+    const BootPhase& getPhase(int index) { return phases[index]; }
+    void printReport();
+
+private:
+    BootPhase phases[BOOT_MAX_PHASES];
+    int phaseCount = 0;
+    uint32_t lastMarkUs = 0;
+    uint32_t totalUs = 0;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
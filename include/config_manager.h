@@ -20,6 +20,13 @@ struct ConfigData {
     int badusbDelay = 100;
     int badusbStartupDelay = 2000; // Delay before running payload after arming/plugin
     bool badusbAutoExec = false;
+
+    // LoRa
+    long loraFrequency = 915000000; // Hz
+    int loraSpreadingFactor = 7;
+    long loraBandwidth = 125000;    // Hz
+    int loraCodingRate = 5;         // 4/5 .. 4/8
+    int loraTxPower = 17;           // dBm
 };
 
 class ConfigManager {
@@ -1,36 +1,65 @@
 #pragma once
 #include <TFT_eSPI.h>
 #include <RTClib.h>
+#include <atomic>
+#include "bitmap_blit.h"
+#include "list_view.h"
+#include "battery_monitor.h"
+#include "ui/themes.h"
 
-// Dark Purple Theme Colors
-#define THEME_BG        TFT_BLACK
-#define THEME_PRIMARY   0x780F // Purple
-#define THEME_SECONDARY 0x4010 // Dark Purple
-#define THEME_TEXT      TFT_WHITE
-#define THEME_ACCENT    0x911F // Light Purple
+// Colors of the active theme, see src/ui/themes.h
+#define THEME_BG        activeTheme.colors[COLOR_BG]
+#define THEME_PRIMARY   activeTheme.colors[COLOR_PRIMARY]
+#define THEME_SECONDARY activeTheme.colors[COLOR_SECONDARY]
+#define THEME_TEXT      activeTheme.colors[COLOR_TEXT]
+#define THEME_ACCENT    activeTheme.colors[COLOR_ACCENT]
+#define THEME_BORDER    activeTheme.colors[COLOR_BORDER]
+#define THEME_OK        activeTheme.colors[COLOR_OK]
+#define THEME_WARN      activeTheme.colors[COLOR_WARN]
+#define THEME_ERROR     activeTheme.colors[COLOR_ERROR]
 
 class DisplayManager {
 public:
     DisplayManager();
     void init();
     void setBrightness(int brightness);
-    void initRTC();
+    // Switches palettes; when it changed, the next takeRepaint() asks for one full redraw
+    bool setTheme(const String& name);
+    bool takeRepaint();
+    bool initRTC(uint32_t timeoutMs = 500);
+    // While another user holds the I2C bus at a speed the DS3231 can't take,
+    // the clock is left alone: not drawn, not logged, getTime() returns 0
+    void setRTCBusy(bool busy) { rtcBusy = busy; }
     void turnOff();
     void clear();
     void clearContent();
     void drawStatusBar(String status, float voltage, bool sdStatus, bool wifiStatus, bool showClock = true, String replacement = "", bool forceRedraw = true);
     void drawMenuTitle(String title);
     void drawMenuItem(String text, int index, bool selected, const unsigned char* icon = nullptr, int iconWidth = 16, int iconHeight = 16, int iconSpacing = 8, int iconOffsetY = 0);
+    // The same row at any y, for lists that slide
+    void drawMenuItemAt(const String& text, int yPos, bool selected, const unsigned char* icon = nullptr, int iconWidth = 16, int iconHeight = 16, int iconSpacing = 8, int iconOffsetY = 0);
     void updateClock();
     void drawScrollBar(int totalItems, int scrollOffset, int itemsPerPage);
-    float getBatteryVoltage();
+    float getBatteryVoltage();      // Cached, see BatteryMonitor
     bool isOnBattery();
+    // Battery reading and discharge log, call from the main loop
+    void pollBattery();
+    BatteryMonitor& getBattery() { return battery; }
     void setTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second);
     DateTime getTime();
     TFT_eSPI* getTFT(); // Return pointer to allow null check if needed
+    // 1-bit image on a known background, drawn in whole rows
+    void drawIcon(int32_t x, int32_t y, const unsigned char* bitmap, int16_t w, int16_t h, uint16_t fg, uint16_t bg);
+    BitmapBlitter& getBlitter() { return blitter; }
 
 private:
     TFT_eSPI* tft;
     RTC_DS3231 rtc;
-    bool rtcInitialized;
+    std::atomic<bool> rtcInitialized;
+    volatile bool rtcBusy = false;
+    BitmapBlitter blitter;
+    BatteryMonitor battery;
+    bool repaintPending = false;
+
+    bool rtcReadable() const { return rtcInitialized && !rtcBusy; }
 };
@@ -0,0 +1,80 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+
+class DisplayManager;
+
+#define LIST_ROWS         5   // Rows on screen, 25px apart from y = 25
+#define LIST_ROW_PITCH    25
+#define LIST_SCROLL_ROWS  3   // Rows the window moves when the cursor walks off it
+#ifndef LIST_SLIDE
+#define LIST_SLIDE        0   // -D LIST_SLIDE=1 animates window moves, at several times the pixels
+#endif
+#define LIST_SCROLL_PX    20  // Most a slide moves per frame
+#define LIST_FRAME_MS     8   // Between those frames
+
+// What one row shows, filled in by the list's source
+struct ListRow {
+    String text;
+    const unsigned char* icon = nullptr;
+    int iconWidth = 16;
+    int iconHeight = 16;
+    int iconSpacing = 8;
+    int iconOffsetY = 0;
+};
+
+// Called for each row about to be drawn, never for rows that stay as they are
+typedef std::function<void(int index, ListRow& row)> ListSource;
+
+// A scrolling list of count items drawn with drawMenuItem. It owns the
+// cursor and the window; the window only moves when the cursor leaves it,
+// and then by LIST_SCROLL_ROWS so the next clicks stay inside it again.
+// Moving the cursor inside the window redraws the two rows involved, and
+// a window move redraws the five rows in place, once. With LIST_SLIDE a
+// short move slides the rows instead, up to LIST_SCROLL_PX per frame.
+// Content comes from the source, one row at a time and only when that row
+// is drawn.
+//
+// Changes are recorded, and only reach the screen through draw() or
+// update(), so a list that is not on screen can be moved freely.
+class ListView {
+public:
+    void begin(DisplayManager* display, ListSource source);
+
+    void reset(int count);          // Cursor and window back to the top
+    void setCount(int count);       // Keeps the cursor where it is when it can
+    void select(int index);
+    void next();                    // Wraps to the top after the last item
+    void invalidate(int index);     // Its content changed, draw it again
+
+    int getSelected() const { return selected; }
+    int getOffset() const { return offset; }
+    int getCount() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // All rows and the scroll bar, on a cleared content area
+    void draw();
+    // Only what changed since the last draw() or update()
+    void update();
+    // Pixels the last draw() or update() covered, to compare redraw costs
+    uint32_t getLastPixels() const { return lastPixels; }
+
+private:
+    DisplayManager* display = nullptr;
+    ListSource source;
+    ListRow row;                    // Reused, so its String keeps its buffer
+    int count = 0;
+    int selected = 0;
+    int offset = 0;
+    int drawnOffset = 0;            // Window the screen shows
+    uint8_t staleRows = 0;          // Bit per screen row
+    bool scrollBarStale = false;
+    uint32_t lastPixels = 0;
+
+    void follow();                  // Moves the window so the cursor is in it
+    void drawRow(int index, int y, bool clean);
+    void drawScrollBar();
+#if LIST_SLIDE
+    void slide();
+#endif
+};
@@ -1,13 +1,15 @@
 #pragma once
-#include <vector>
 #include "module_base.h"
+#include "module_registry.h"
 #include "display_manager.h"
 #include "sd_manager.h"
 
 class MenuSystem {
 public:
     MenuSystem(DisplayManager* display, SDManager* sd);
-    void registerModule(Module* module);
+    void registerModule(Module* module);                 // Always loaded
+    void registerModule(const ModuleDescriptor& module); // Loaded while open or busy
+    ModuleRegistry& getRegistry() { return registry; }
     void draw();
     void handleInput(uint8_t input); // 0=Up, 1=Down, 2=Select, 3=Back
     void update();
@@ -17,12 +19,11 @@ private:
 
     DisplayManager* displayManager;
     SDManager* sdManager;
-    std::vector<Module*> modules;
-    int selectedIndex;
-    int scrollOffset;
-    const int itemsPerPage = 5;
+    ModuleRegistry registry;
+    ListView moduleList;
     bool inModule;
     Module* activeModule;
+    int activeIndex;
 
     bool isDeepSleepPending;
     unsigned long deepSleepStartTime;
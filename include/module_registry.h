@@ -0,0 +1,74 @@
+#pragma once
+#include <Arduino.h>
+#include <new>
+#include <vector>
+#include "module_base.h"
+
+typedef Module* (*ModuleFactory)();
+
+// Factory for a module with a default constructor, nullptr when the heap is short
+template <typename T> Module* makeModule() { return new (std::nothrow) T(); }
+
+// What the menu shows for a module that has not been constructed
+struct ModuleDescriptor {
+    const char* name;
+    const char* icon;       // Asset pack name, nullptr for none
+    int iconWidth;
+    int iconHeight;
+    int iconSpacing;
+    int iconOffsetY;
+    ModuleFactory create;
+};
+
+// Heap a module was seen to hold, in bytes. Measured as the drop in free
+// heap (internal and PSRAM) across its construction and init() and again
+// when it is left, so allocations made meanwhile by anything else count too.
+struct ModuleFootprint {
+    int32_t atEntry = 0;    // Constructor and init()
+    int32_t peak = 0;       // Most held at entry or exit
+    int32_t reclaimed = 0;  // Freed by the last teardown
+    uint32_t loads = 0;     // Constructions
+};
+
+// The modules in menu order. A resident module is a global that lives as
+// long as the firmware; a lazy one is constructed by its factory when it is
+// entered and deleted when it is left, unless it is still running in the
+// background, in which case it is deleted once that work ends.
+class ModuleRegistry {
+public:
+    int add(Module* module);                      // Resident
+    int add(const ModuleDescriptor& descriptor);  // Lazy
+
+    int count() const { return entries.size(); }
+    bool isResident(int i) const { return entries[i].resident; }
+    const ModuleDescriptor& getDescriptor(int i) const { return entries[i].descriptor; }
+    Module* get(int i) const { return entries[i].instance; } // nullptr while unloaded
+    String getName(int i) const;
+
+    // Constructs the module if needed and runs its init(), nullptr when it could not be constructed
+    Module* acquire(int i);
+    // Left by the user; tears it down unless it is resident or busy in the background
+    void release(int i);
+    // Tears down lazy modules whose background work has ended since they were left
+    void reap();
+
+    bool anyBackground() const;
+    void backgroundLoop();
+
+    const ModuleFootprint& getFootprint(int i) const { return entries[i].footprint; }
+    void printReport(int only = -1) const; // Every module, or just one
+
+private:
+    struct Entry {
+        ModuleDescriptor descriptor = {};
+        Module* instance = nullptr;
+        bool resident = false;
+        bool inUse = false;
+        uint32_t freeBefore = 0;    // Free heap before it was constructed
+        ModuleFootprint footprint;
+    };
+    std::vector<Entry> entries;
+
+    void measure(Entry& e);
+    void unload(Entry& e);
+};
@@ -13,6 +13,7 @@ struct FileEntry {
 class SDManager {
 public:
     bool init();
+    bool waitForCard(uint32_t timeoutMs);
     void end();
     bool isMounted();
     String readFile(String path);
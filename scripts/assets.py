@@ -0,0 +1,38 @@
+# PlatformIO extra script: packs PixelArt/ before every build and adds an
+# "uploadassets" target that writes the pack to the assets partition.
+#
+#   pio run -t uploadassets
+Import("env")
+
+import csv
+import os
+
+PROJECT_DIR = env.subst("$PROJECT_DIR")
+PACKER = os.path.join(PROJECT_DIR, "scripts", "pack_assets.py")
+PACK = os.path.join(PROJECT_DIR, ".pio", "assets", "assets.bin")
+
+env.Execute('"$PYTHONEXE" "%s" --quiet --out "%s"' % (PACKER, PACK))
+
+
+def assets_offset():
+    table = env.GetProjectOption("board_build.partitions", "")
+    with open(os.path.join(PROJECT_DIR, table)) as f:
+        for row in csv.reader(line for line in f if not line.lstrip().startswith("#")):
+            if row and row[0].strip() == "assets":
+                return row[3].strip()
+    raise ValueError("no 'assets' partition in %s" % table)
+
+
+if env.get("PIOPLATFORM") == "espressif32":
+    env.AddCustomTarget(
+        name="uploadassets",
+        dependencies=None,
+        actions=[
+            '"$PYTHONEXE" "%s" --verify --out "%s"' % (PACKER, PACK),
+            env.VerboseAction(env.AutodetectUploadPort, "Looking for upload port..."),
+            '"$PYTHONEXE" "$UPLOADER" --chip $BOARD_MCU --port "$UPLOAD_PORT" --baud $UPLOAD_SPEED write_flash %s "%s"'
+            % (assets_offset(), PACK),
+        ],
+        title="Upload assets",
+        description="Pack PixelArt/ and write it to the assets partition",
+    )
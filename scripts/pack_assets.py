@@ -0,0 +1,280 @@
+#!/usr/bin/env python3
+"""Pack PixelArt/ into the asset blob that lives in the "assets" partition.
+
+    python3 scripts/pack_assets.py [--src PixelArt] [--out .pio/assets/assets.bin] [--verify]
+
+*.png  -> 1-bit bitmaps in TFT_eSPI drawBitmap layout (MSB first, rows
+          padded to a byte). With an alpha channel, opaque pixels are set;
+          without one, light pixels are set.
+*.vlw  -> smooth fonts, stored as-is so they can be used straight from flash.
+
+Small assets are LZ4 (block format) compressed and decoded on demand into
+the firmware's LRU cache. Anything that doesn't shrink, or doesn't fit a
+cache slot, is stored and served zero-copy from the mapped partition.
+The layout must match include/asset_pack.h.
+"""
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = 0x50414345  # "ECAP"
+VERSION = 1
+NAME_LEN = 28
+CACHE_SLOT_BYTES = 256  # ASSET_CACHE_SLOT_BYTES
+
+TYPE_BITMAP = 0
+TYPE_BLOB = 1
+CODEC_STORED = 0
+CODEC_LZ4 = 1
+
+HEADER = struct.Struct("<IHHII")             # magic, version, count, total size, reserved
+ENTRY = struct.Struct("<%dsHHBBHIII" % NAME_LEN)  # name, w, h, type, codec, reserved, offset, packed, raw
+
+
+# --- PNG ---
+
+def read_png(path):
+    data = open(path, "rb").read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("not a PNG")
+    pos, idat, palette, trns = 8, b"", None, None
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            width, height, depth, color, _, _, interlace = struct.unpack(">IIBBBBB", chunk)
+        elif kind == b"PLTE":
+            palette = chunk
+        elif kind == b"tRNS":
+            trns = chunk
+        elif kind == b"IDAT":
+            idat += chunk
+    if depth != 8 or interlace:
+        raise ValueError("only 8-bit, non-interlaced PNGs are supported")
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color]
+
+    raw = zlib.decompress(idat)
+    stride = width * channels
+    prev = bytearray(stride)
+    pixels = []
+    i = 0
+    for _ in range(height):
+        filt = raw[i]
+        line = bytearray(raw[i + 1:i + 1 + stride])
+        i += 1 + stride
+        for x in range(stride):
+            a = line[x - channels] if x >= channels else 0
+            b = prev[x]
+            c = prev[x - channels] if x >= channels else 0
+            if filt == 1:
+                line[x] = (line[x] + a) & 0xFF
+            elif filt == 2:
+                line[x] = (line[x] + b) & 0xFF
+            elif filt == 3:
+                line[x] = (line[x] + (a + b) // 2) & 0xFF
+            elif filt == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                line[x] = (line[x] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xFF
+        prev = line
+
+        row = []
+        for x in range(width):
+            px = line[x * channels:(x + 1) * channels]
+            if color == 6:
+                on = px[3] >= 128
+            elif color == 4:
+                on = px[1] >= 128
+            elif color == 3:
+                alpha = trns[px[0]] if trns and px[0] < len(trns) else 255
+                r, g, b = palette[px[0] * 3:px[0] * 3 + 3]
+                on = alpha >= 128 if trns else (r + g + b) >= 384
+            elif color == 2:
+                on = sum(px) >= 384
+            else:
+                on = px[0] >= 128
+            row.append(on)
+        pixels.append(row)
+    return width, height, pixels
+
+
+def to_bitmap(width, height, pixels):
+    stride = (width + 7) // 8
+    out = bytearray(stride * height)
+    for y in range(height):
+        for x in range(width):
+            if pixels[y][x]:
+                out[y * stride + x // 8] |= 0x80 >> (x % 8)
+    return bytes(out)
+
+
+# --- LZ4 block format ---
+
+MIN_MATCH = 4
+LAST_LITERALS = 5
+MF_LIMIT = 12
+
+
+def _length(out, n):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+
+def _sequence(out, literals, offset=0, match_len=0):
+    lit = len(literals)
+    ml = match_len - MIN_MATCH if match_len else 0
+    out.append((min(lit, 15) << 4) | (min(ml, 15) if match_len else 0))
+    if lit >= 15:
+        _length(out, lit - 15)
+    out += literals
+    if match_len:
+        out += struct.pack("<H", offset)
+        if ml >= 15:
+            _length(out, ml - 15)
+
+
+def lz4_compress(data):
+    n = len(data)
+    out = bytearray()
+    table = {}
+    anchor = i = 0
+    while i < n - MF_LIMIT:
+        key = data[i:i + 4]
+        cand = table.get(key)
+        table[key] = i
+        if cand is not None and i - cand <= 0xFFFF:
+            length = MIN_MATCH
+            while i + length < n - LAST_LITERALS and data[cand + length] == data[i + length]:
+                length += 1
+            _sequence(out, data[anchor:i], i - cand, length)
+            i += length
+            anchor = i
+        else:
+            i += 1
+    _sequence(out, data[anchor:])
+    return bytes(out)
+
+
+def lz4_decompress(src, size):
+    out = bytearray()
+    i = 0
+    while i < len(src):
+        token = src[i]
+        i += 1
+        lit = token >> 4
+        if lit == 15:
+            while True:
+                b = src[i]
+                i += 1
+                lit += b
+                if b != 255:
+                    break
+        out += src[i:i + lit]
+        i += lit
+        if i >= len(src):
+            break
+        offset = src[i] | (src[i + 1] << 8)
+        i += 2
+        length = (token & 15) + MIN_MATCH
+        if token & 15 == 15:
+            while True:
+                b = src[i]
+                i += 1
+                length += b
+                if b != 255:
+                    break
+        for _ in range(length):
+            out.append(out[-offset])
+    if len(out) != size:
+        raise ValueError("decoded %d bytes, expected %d" % (len(out), size))
+    return bytes(out)
+
+
+# --- Pack ---
+
+def collect(src):
+    assets = []
+    for fname in sorted(os.listdir(src)):
+        path = os.path.join(src, fname)
+        name, ext = os.path.splitext(fname)
+        ext = ext.lower()
+        if ext not in (".png", ".vlw"):
+            continue
+        if len(name.encode()) >= NAME_LEN:
+            sys.exit("%s: name longer than %d characters" % (fname, NAME_LEN - 1))
+        if ext == ".png":
+            width, height, pixels = read_png(path)
+            data = to_bitmap(width, height, pixels)
+            if len(data) > CACHE_SLOT_BYTES:
+                sys.exit("%s: %d bytes, bitmaps must fit a %d byte cache slot" % (fname, len(data), CACHE_SLOT_BYTES))
+            assets.append((name, TYPE_BITMAP, width, height, data))
+        else:
+            assets.append((name, TYPE_BLOB, 0, 0, open(path, "rb").read()))
+    # The firmware binary searches the index
+    assets.sort(key=lambda a: a[0].encode())
+    return assets
+
+
+def pack(assets):
+    data_start = HEADER.size + ENTRY.size * len(assets)
+    index, blob = bytearray(), bytearray()
+    for name, kind, width, height, raw in assets:
+        codec, payload = CODEC_STORED, raw
+        if len(raw) <= CACHE_SLOT_BYTES:
+            packed = lz4_compress(raw)
+            if len(packed) < len(raw):
+                codec, payload = CODEC_LZ4, packed
+        while (data_start + len(blob)) % 4:
+            blob.append(0)  # Keep stored assets word aligned in the mapping
+        offset = data_start + len(blob)
+        blob += payload
+        index += ENTRY.pack(name.encode(), width, height, kind, codec, 0, offset, len(payload), len(raw))
+    total = data_start + len(blob)
+    return HEADER.pack(MAGIC, VERSION, len(assets), total, 0) + bytes(index) + bytes(blob)
+
+
+def verify(blob, assets):
+    magic, version, count, total, _ = HEADER.unpack_from(blob)
+    assert magic == MAGIC and version == VERSION and count == len(assets) and total == len(blob)
+    for i, (name, kind, width, height, raw) in enumerate(assets):
+        fields = ENTRY.unpack_from(blob, HEADER.size + i * ENTRY.size)
+        ename, ew, eh, ekind, codec, _, offset, packed, size = fields
+        assert ename.rstrip(b"\0").decode() == name and (ew, eh, ekind, size) == (width, height, kind, len(raw))
+        payload = blob[offset:offset + packed]
+        decoded = lz4_decompress(payload, size) if codec == CODEC_LZ4 else payload
+        assert decoded == raw, name
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--src", default=os.path.join(root, "PixelArt"))
+    parser.add_argument("--out", default=os.path.join(root, ".pio", "assets", "assets.bin"))
+    parser.add_argument("--verify", action="store_true", help="decode the pack again and compare")
+    parser.add_argument("-q", "--quiet", action="store_true")
+    args = parser.parse_args()
+
+    assets = collect(args.src)
+    blob = pack(assets)
+    if args.verify:
+        verify(blob, assets)
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.out)), exist_ok=True)
+    if os.path.exists(args.out) and open(args.out, "rb").read() == blob:
+        return 0  # Unchanged, keep the timestamp
+    with open(args.out, "wb") as f:
+        f.write(blob)
+
+    if not args.quiet:
+        raw = sum(len(a[4]) for a in assets)
+        print("Packed %d assets, %d bytes raw -> %d bytes (%s)" % (len(assets), raw, len(blob), args.out))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
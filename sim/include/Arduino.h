@@ -0,0 +1,144 @@
+#pragma once
+// Host shim for the parts of the Arduino/ESP32 core used by ESP-Chain.
+// Time is virtual: delay() advances the clock instead of sleeping.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include "WString.h"
+
+#define SIMULATOR 1
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define IRAM_ATTR
+
+#define HIGH 1
+#define LOW  0
+#define INPUT          0x01
+#define OUTPUT         0x03
+#define INPUT_PULLUP   0x05
+#define INPUT_PULLDOWN 0x09
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::min;
+using std::max;
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+
+// --- Virtual clock ---
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void simAdvanceMicros(uint64_t us);
+
+// --- GPIO ---
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+uint32_t analogReadMilliVolts(uint8_t pin);
+void simSetPinInput(uint8_t pin, int level);     // Drive an input (e.g. a button), fires attached ISRs
+void simSetAnalogInput(uint8_t pin, uint16_t raw);
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+#define digitalPinToInterrupt(p) (p)
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t bits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+uint32_t simGetLedcDuty(uint8_t channel);
+
+typedef int gpio_num_t;
+#define GPIO_NUM_14 14
+int gpio_hold_en(gpio_num_t pin);
+int gpio_hold_dis(gpio_num_t pin);
+
+// --- Sleep ---
+#define ESP_EXT1_WAKEUP_ANY_LOW 0
+int esp_sleep_enable_ext1_wakeup(uint64_t mask, int mode);
+void esp_deep_sleep_start();
+
+// --- Logging ---
+typedef enum { ESP_LOG_NONE, ESP_LOG_ERROR, ESP_LOG_WARN, ESP_LOG_INFO, ESP_LOG_DEBUG, ESP_LOG_VERBOSE } esp_log_level_t;
+inline void esp_log_level_set(const char* tag, esp_log_level_t level) {}
+
+// --- Serial ---
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) {}
+    size_t print(const String& s) { return fputs(s.c_str(), stdout) >= 0 ? s.length() : 0; }
+    size_t print(const char* s) { return fputs(s, stdout) >= 0 ? strlen(s) : 0; }
+    size_t println(const String& s) { print(s); return print("\n"); }
+    size_t println(const char* s = "") { print(s); return print("\n"); }
+    template <typename T> size_t print(T v) { return print(String(v)); }
+    template <typename T> size_t println(T v) { return println(String(v)); }
+    int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    int available() { return 0; }
+    int read() { return -1; }
+};
+extern HardwareSerial Serial;
+
+// Heap accounting (counts every global operator new)
+uint64_t simAllocCount();
+uint64_t simAllocBytes();
+
+class EspClass {
+public:
+    uint32_t getFlashChipSize() { return 16 * 1024 * 1024; }
+    uint32_t getFreeHeap();
+    uint32_t getHeapSize() { return 320 * 1024; }
+    uint32_t getCycleCount() { return micros() * 240; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    void restart() {}
+};
+extern EspClass ESP;
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// --- FreeRTOS ---
+// Tasks are not simulated: xTaskCreate fails so callers use their inline fallback.
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef void* QueueHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void (*TaskFunction_t)(void*);
+#define pdPASS  1
+#define pdFAIL  0
+#define pdTRUE  1
+#define pdFALSE 0
+#define portMAX_DELAY 0xFFFFFFFF
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portTICK_PERIOD_MS 1
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* param, UBaseType_t prio, TaskHandle_t* handle);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* param, UBaseType_t prio, TaskHandle_t* handle, BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelete(TaskHandle_t handle);
+BaseType_t xPortGetCoreID();
+
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+
+typedef struct { int owner; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
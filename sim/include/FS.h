@@ -0,0 +1,67 @@
+#pragma once
+// Host File/FS backed by a directory on disk (see SD.h)
+#include <Arduino.h>
+#include <memory>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct SimFileImpl;
+
+class File {
+public:
+    File() {}
+    explicit File(std::shared_ptr<SimFileImpl> impl) : _impl(impl) {}
+
+    operator bool() const;
+    size_t write(uint8_t b);
+    size_t write(const uint8_t* buf, size_t len);
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t println(const String& s = "") { return print(s) + print("\n"); }
+    int available();
+    int read();
+    size_t read(uint8_t* buf, size_t len);
+    int peek();
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position();
+    size_t size();
+    void flush();
+    void close();
+    const char* name();
+    const char* path();
+    bool isDirectory();
+    File openNextFile(const char* mode = FILE_READ);
+    void rewindDirectory();
+    String readString();
+    String readStringUntil(char terminator);
+
+private:
+    std::shared_ptr<SimFileImpl> _impl;
+};
+
+namespace fs {
+class FS {
+public:
+    File open(const char* path, const char* mode = FILE_READ, bool create = false);
+    File open(const String& path, const char* mode = FILE_READ, bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+    bool mkdir(const char* path);
+    bool mkdir(const String& path) { return mkdir(path.c_str()); }
+    bool rmdir(const char* path);
+    bool rmdir(const String& path) { return rmdir(path.c_str()); }
+};
+}
+using fs::FS;
+
+// Host directory that stands in for the card root
+void simSetFsRoot(const char* dir);
+const char* simGetFsRoot();
@@ -0,0 +1,19 @@
+#pragma once
+#include "FS.h"
+#include "SPI.h"
+
+typedef enum { CARD_NONE, CARD_MMC, CARD_SD, CARD_SDHC, CARD_UNKNOWN } sdcard_type_t;
+
+class SDFS : public fs::FS {
+public:
+    bool begin(uint8_t ssPin = 10, SPIClass& spi = SPI, uint32_t frequency = 4000000, const char* mountpoint = "/sd", uint8_t maxFiles = 5, bool formatOnFail = false);
+    void end() { _mounted = false; }
+    sdcard_type_t cardType() { return _mounted ? CARD_SDHC : CARD_NONE; }
+    uint64_t cardSize() { return 8ULL * 1024 * 1024 * 1024; }
+    uint64_t totalBytes() { return cardSize(); }
+    uint64_t usedBytes() { return 0; }
+
+private:
+    bool _mounted = false;
+};
+extern SDFS SD;
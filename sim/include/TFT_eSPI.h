@@ -0,0 +1,126 @@
+#pragma once
+// Host TFT_eSPI: draws into an RGB565 framebuffer that can be dumped as PNG.
+// Text uses a 5x7 glyph set scaled per font number, so layout is
+// approximate but sizes and positions follow the real fonts closely enough
+// for screenshots and pixel accounting.
+#include <Arduino.h>
+
+#define TFT_BLACK       0x0000
+#define TFT_NAVY        0x000F
+#define TFT_DARKGREEN   0x03E0
+#define TFT_MAROON      0x7800
+#define TFT_PURPLE      0x780F
+#define TFT_DARKGREY    0x7BEF
+#define TFT_LIGHTGREY   0xD69A
+#define TFT_BLUE        0x001F
+#define TFT_GREEN       0x07E0
+#define TFT_CYAN        0x07FF
+#define TFT_RED         0xF800
+#define TFT_MAGENTA     0xF81F
+#define TFT_YELLOW      0xFFE0
+#define TFT_WHITE       0xFFFF
+#define TFT_ORANGE      0xFDA0
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+#define TFT_DISPOFF 0x28
+#define TFT_SLPIN   0x10
+
+#ifndef TFT_WIDTH
+#define TFT_WIDTH  170
+#endif
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 320
+#endif
+
+class TFT_eSPI {
+public:
+    TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
+    ~TFT_eSPI();
+
+    void init();
+    void setRotation(uint8_t r);
+    int16_t width() { return _width; }
+    int16_t height() { return _height; }
+    void writecommand(uint8_t c);
+
+    void fillScreen(uint32_t color);
+    void drawPixel(int32_t x, int32_t y, uint32_t color);
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color);
+    void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color);
+    void fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+    void drawCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color);
+    void drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t fg, uint16_t bg);
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data); // Panel byte order unless swapped
+    void setSwapBytes(bool swap) { _swapBytes = swap; }
+    bool getSwapBytes() { return _swapBytes; }
+    void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h);
+    // Clips every draw to the rectangle, offsets coordinates by it when vpDatum
+    void setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum = true);
+    void resetViewport();
+    void pushColors(const uint16_t* data, uint32_t len, bool swap = true);
+    void pushColor(uint16_t color, uint32_t len);
+    void startWrite() {}
+    void endWrite() {}
+
+    void setTextColor(uint16_t fg) { _textFg = fg; _textBg = fg; }
+    void setTextColor(uint16_t fg, uint16_t bg, bool fill = false) { _textFg = fg; _textBg = bg; }
+    void setTextSize(uint8_t s) { _textSize = s ? s : 1; }
+    void setTextDatum(uint8_t d) { _datum = d; }
+    uint8_t getTextDatum() { return _datum; }
+    void setTextPadding(uint16_t px) { _padding = px; }
+    void setTextFont(uint8_t f) { _font = f; }
+    void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+    int16_t drawString(const char* s, int32_t x, int32_t y, uint8_t font);
+    int16_t drawString(const char* s, int32_t x, int32_t y) { return drawString(s, x, y, _font); }
+    int16_t drawString(const String& s, int32_t x, int32_t y, uint8_t font) { return drawString(s.c_str(), x, y, font); }
+    int16_t drawString(const String& s, int32_t x, int32_t y) { return drawString(s.c_str(), x, y, _font); }
+    int16_t drawCentreString(const String& s, int32_t x, int32_t y, uint8_t font);
+    int16_t textWidth(const char* s, uint8_t font);
+    int16_t textWidth(const String& s, uint8_t font) { return textWidth(s.c_str(), font); }
+    int16_t textWidth(const String& s) { return textWidth(s.c_str(), _font); }
+    int16_t fontHeight(uint8_t font);
+    void print(const String& s);
+    void println(const String& s = "") { print(s); _cursorX = 0; _cursorY += fontHeight(_font); }
+
+    // --- Simulator hooks ---
+    uint16_t getPixel(int32_t x, int32_t y);
+    const uint16_t* framebuffer() { return _fb; }
+    bool writePNG(const char* path);
+    uint64_t pixelsWritten() { return _pixelsWritten; } // Every pixel store since reset
+    void resetPixelCounter() { _pixelsWritten = 0; }
+    bool isDisplayOn() { return _displayOn; }
+
+private:
+    uint16_t* _fb;
+    int16_t _width, _height;
+    uint8_t _rotation = 0;
+    bool _displayOn = true;
+    bool _swapBytes = false;
+    uint64_t _pixelsWritten = 0;
+
+    uint16_t _textFg = TFT_WHITE, _textBg = TFT_BLACK;
+    uint8_t _textSize = 1, _datum = TL_DATUM, _font = 1;
+    uint16_t _padding = 0;
+    int16_t _cursorX = 0, _cursorY = 0;
+    int32_t _winX = 0, _winY = 0, _winW = 0, _winH = 0, _winPos = 0;
+    int32_t _vpX = 0, _vpY = 0, _vpW = 0, _vpH = 0; // 0 wide when there is no viewport
+    bool _vpDatum = false;
+
+    void glyphMetrics(uint8_t font, int* scale, int* advance, int* height);
+    void drawChar(char c, int32_t x, int32_t y, int scale, uint16_t color);
+};
@@ -0,0 +1,12 @@
+#pragma once
+#include <Arduino.h>
+
+class ESPUSB {
+public:
+    bool begin() { _started = true; return true; }
+    operator bool() const { return _started; }
+
+private:
+    bool _started = false;
+};
+extern ESPUSB USB;
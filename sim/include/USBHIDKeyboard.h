@@ -0,0 +1,47 @@
+#pragma once
+// Host keyboard: counts reports instead of sending them
+#include <Arduino.h>
+
+#define KEY_LEFT_CTRL   0x80
+#define KEY_LEFT_SHIFT  0x81
+#define KEY_LEFT_ALT    0x82
+#define KEY_LEFT_GUI    0x83
+#define KEY_RIGHT_CTRL  0x84
+#define KEY_RIGHT_SHIFT 0x85
+#define KEY_RIGHT_ALT   0x86
+#define KEY_RIGHT_GUI   0x87
+
+#define KEY_UP_ARROW    0xDA
+#define KEY_DOWN_ARROW  0xD9
+#define KEY_LEFT_ARROW  0xD8
+#define KEY_RIGHT_ARROW 0xD7
+#define KEY_BACKSPACE   0xB2
+#define KEY_TAB         0xB3
+#define KEY_RETURN      0xB0
+#define KEY_ESC         0xB1
+#define KEY_INSERT      0xD1
+#define KEY_DELETE      0xD4
+#define KEY_PAGE_UP     0xD3
+#define KEY_PAGE_DOWN   0xD6
+#define KEY_HOME        0xD2
+#define KEY_END         0xD5
+#define KEY_CAPS_LOCK   0xC1
+#define KEY_F1          0xC2
+
+class USBHIDKeyboard {
+public:
+    void begin() {}
+    void end() {}
+    size_t press(uint8_t k) { _reports++; return 1; }
+    size_t release(uint8_t k) { _reports++; return 1; }
+    void releaseAll() { _reports++; }
+    size_t write(uint8_t c) { press(c); release(c); return 1; }
+    size_t write(const uint8_t* buf, size_t len) { for (size_t i = 0; i < len; i++) write(buf[i]); return len; }
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+    uint32_t simReportCount() { return _reports; }
+
+private:
+    uint32_t _reports = 0;
+};
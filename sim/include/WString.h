@@ -0,0 +1,137 @@
+#pragma once
+// Host stand-in for the Arduino String class, backed by std::string
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class String {
+public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(unsigned char v, unsigned char base = DEC) { fromUnsigned(v, base); }
+    String(int v, unsigned char base = DEC) { fromSigned(v, base); }
+    String(unsigned int v, unsigned char base = DEC) { fromUnsigned(v, base); }
+    String(long v, unsigned char base = DEC) { fromSigned(v, base); }
+    String(unsigned long v, unsigned char base = DEC) { fromUnsigned(v, base); }
+    String(long long v, unsigned char base = DEC) { fromSigned(v, base); }
+    String(unsigned long long v, unsigned char base = DEC) { fromUnsigned(v, base); }
+    String(float v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+    String(double v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+    bool isEmpty() const { return _s.empty(); }
+    char charAt(unsigned int i) const { return i < _s.length() ? _s[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    char& operator[](unsigned int i) { return _s[i]; }
+    void reserve(unsigned int n) { _s.reserve(n); }
+
+    bool concat(const String& s) { _s += s._s; return true; }
+    bool concat(const char* s) { if (s) _s += s; return true; }
+    bool concat(const char* s, unsigned int n) { if (s) _s.append(s, n); return true; }
+    bool concat(char c) { _s += c; return true; }
+    String& operator+=(const String& s) { _s += s._s; return *this; }
+    String& operator+=(const char* s) { if (s) _s += s; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    String& operator+=(int v) { _s += String(v)._s; return *this; }
+    String& operator+=(unsigned int v) { _s += String(v)._s; return *this; }
+    String& operator+=(long v) { _s += String(v)._s; return *this; }
+    String& operator+=(unsigned long v) { _s += String(v)._s; return *this; }
+
+    bool operator==(const String& o) const { return _s == o._s; }
+    bool operator==(const char* o) const { return _s == (o ? o : ""); }
+    bool operator!=(const String& o) const { return _s != o._s; }
+    bool operator!=(const char* o) const { return !(*this == o); }
+    bool operator<(const String& o) const { return _s < o._s; }
+    bool equals(const String& o) const { return _s == o._s; }
+    bool equalsIgnoreCase(const String& o) const {
+        if (_s.size() != o._s.size()) return false;
+        for (size_t i = 0; i < _s.size(); i++) {
+            if (tolower((unsigned char)_s[i]) != tolower((unsigned char)o._s[i])) return false;
+        }
+        return true;
+    }
+
+    bool startsWith(const String& p) const { return _s.compare(0, p._s.size(), p._s) == 0; }
+    bool endsWith(const String& p) const {
+        return _s.size() >= p._s.size() && _s.compare(_s.size() - p._s.size(), p._s.size(), p._s) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return npos(_s.find(c, from)); }
+    int indexOf(const String& s, unsigned int from = 0) const { return npos(_s.find(s._s, from)); }
+    int lastIndexOf(char c) const { return npos(_s.rfind(c)); }
+    int lastIndexOf(char c, unsigned int from) const { return npos(_s.rfind(c, from)); }
+    int lastIndexOf(const String& s) const { return npos(_s.rfind(s._s)); }
+
+    String substring(unsigned int from) const { return from >= _s.size() ? String() : String(_s.substr(from)); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) { unsigned int t = from; from = to; to = t; }
+        if (from >= _s.size()) return String();
+        return String(_s.substr(from, to - from));
+    }
+
+    void trim() {
+        size_t b = 0, e = _s.size();
+        while (b < e && isspace((unsigned char)_s[b])) b++;
+        while (e > b && isspace((unsigned char)_s[e - 1])) e--;
+        _s = _s.substr(b, e - b);
+    }
+    void toUpperCase() { for (auto& c : _s) c = toupper((unsigned char)c); }
+    void toLowerCase() { for (auto& c : _s) c = tolower((unsigned char)c); }
+    void replace(const String& from, const String& to) {
+        if (from._s.empty()) return;
+        size_t pos = 0;
+        while ((pos = _s.find(from._s, pos)) != std::string::npos) {
+            _s.replace(pos, from._s.size(), to._s);
+            pos += to._s.size();
+        }
+    }
+    void replace(char from, char to) { for (auto& c : _s) if (c == from) c = to; }
+    void remove(unsigned int index) { if (index < _s.size()) _s.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < _s.size()) _s.erase(index, count); }
+
+    long toInt() const { return strtol(_s.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(_s.c_str(), nullptr); }
+
+private:
+    std::string _s;
+
+    static int npos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+
+    void fromUnsigned(unsigned long long v, unsigned char base) {
+        if (v == 0) { _s = "0"; return; }
+        char buf[65];
+        int i = 64;
+        buf[i] = 0;
+        while (v) { int d = v % base; buf[--i] = d < 10 ? '0' + d : 'a' + d - 10; v /= base; }
+        _s = &buf[i];
+    }
+    void fromSigned(long long v, unsigned char base) {
+        if (base == DEC && v < 0) { fromUnsigned((unsigned long long)(-v), base); _s = "-" + _s; }
+        else fromUnsigned((unsigned long long)v, base);
+    }
+    void fromDouble(double v, unsigned char decimals) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+        _s = buf;
+    }
+};
+
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, int b) { String r(a); r += String(b); return r; }
+inline String operator+(const String& a, unsigned int b) { String r(a); r += String(b); return r; }
+inline String operator+(const String& a, long b) { String r(a); r += String(b); return r; }
+inline String operator+(const String& a, unsigned long b) { String r(a); r += String(b); return r; }
+inline bool operator==(const char* a, const String& b) { return b == a; }
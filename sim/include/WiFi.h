@@ -0,0 +1,33 @@
+#pragma once
+// Host WiFi: scans return whatever was registered with simAddAccessPoint()
+#include <Arduino.h>
+#include "esp_wifi.h"
+
+typedef enum { WIFI_OFF = 0, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED  (-2)
+
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t m) { _mode = m; return true; }
+    bool disconnect(bool wifiOff = false, bool eraseAp = false) { return true; }
+    int16_t scanNetworks(bool async = false, bool showHidden = false, bool passive = false, uint32_t maxMsPerChan = 300, uint8_t channel = 0);
+    int16_t scanComplete() { return _scanState; }
+    void scanDelete() { _scanState = WIFI_SCAN_FAILED; }
+    String SSID(uint8_t i);
+    int32_t RSSI(uint8_t i);
+    int32_t channel(uint8_t i);
+    String BSSIDstr(uint8_t i);
+    uint8_t* BSSID(uint8_t i);
+    wifi_auth_mode_t encryptionType(uint8_t i);
+    static void* getScanInfoByIndex(int i); // wifi_ap_record_t*, nullptr past the end
+
+private:
+    wifi_mode_t _mode = WIFI_OFF;
+    int16_t _scanState = WIFI_SCAN_FAILED;
+};
+extern WiFiClass WiFi;
+
+// --- Simulator hooks ---
+void simAddAccessPoint(const char* ssid, int32_t rssi, uint8_t channel, const char* bssid, wifi_auth_mode_t auth);
@@ -0,0 +1,37 @@
+#pragma once
+// Host I2C bus. Devices are register maps registered by the simulator;
+// anything else NACKs.
+#include <Arduino.h>
+
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { return true; }
+    bool end() { return true; }
+    bool setClock(uint32_t hz) { _clock = hz; return true; }
+    uint32_t getClock() { return _clock; }
+    void setTimeOut(uint16_t ms) { _timeout = ms; }
+    uint16_t getTimeOut() { return _timeout; }
+
+    void beginTransmission(uint16_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    size_t write(uint8_t b);
+    size_t write(const uint8_t* buf, size_t len);
+    uint8_t requestFrom(uint16_t address, uint8_t len, bool sendStop = true);
+    int available();
+    int read();
+
+    // --- Simulator hooks ---
+    void simAddDevice(uint8_t address);
+    void simSetRegister(uint8_t address, uint8_t reg, uint8_t value);
+
+private:
+    uint32_t _clock = 100000;
+    uint16_t _timeout = 50;
+    uint8_t _txAddress = 0;
+    uint8_t _txBuf[32];
+    size_t _txLen = 0;
+    uint8_t _regPointer[128] = {0};
+    uint8_t _rxBuf[32];
+    size_t _rxLen = 0, _rxPos = 0;
+};
+extern TwoWire Wire;
@@ -0,0 +1,5 @@
+#pragma once
+#include <Arduino.h>
+
+int rtc_gpio_pullup_en(gpio_num_t pin);
+int rtc_gpio_pulldown_dis(gpio_num_t pin);
@@ -0,0 +1,85 @@
+#pragma once
+// Host stand-in for the esp_wifi types and calls used by the WiFi module.
+// Nothing is transmitted; promiscuous frames are injected with simWifiInjectFrame().
+#include <Arduino.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+
+typedef enum {
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WEP,
+    WIFI_AUTH_WPA_PSK,
+    WIFI_AUTH_WPA2_PSK,
+    WIFI_AUTH_WPA_WPA2_PSK,
+    WIFI_AUTH_WPA2_ENTERPRISE,
+    WIFI_AUTH_WPA3_PSK,
+    WIFI_AUTH_WPA2_WPA3_PSK,
+    WIFI_AUTH_WAPI_PSK,
+    WIFI_AUTH_MAX
+} wifi_auth_mode_t;
+
+typedef enum { WIFI_IF_STA = 0, WIFI_IF_AP } wifi_interface_t;
+typedef enum { WIFI_SECOND_CHAN_NONE = 0, WIFI_SECOND_CHAN_ABOVE, WIFI_SECOND_CHAN_BELOW } wifi_second_chan_t;
+typedef enum { WIFI_PKT_MGMT, WIFI_PKT_CTRL, WIFI_PKT_DATA, WIFI_PKT_MISC } wifi_promiscuous_pkt_type_t;
+
+// Subset of the rx_ctrl fields the firmware reads
+typedef struct {
+    signed rssi : 8;
+    unsigned rate : 5;        // wifi_phy_rate_t of a non-HT frame
+    unsigned sig_mode : 2;    // 0 non-HT, 1 HT
+    unsigned mcs : 7;
+    unsigned cwb : 1;         // 40MHz
+    unsigned sgi : 1;
+    signed noise_floor : 8;
+    unsigned channel : 4;
+    unsigned secondary_channel : 4;
+    unsigned timestamp : 32;
+    unsigned sig_len : 12;
+    unsigned rx_state : 8;
+} wifi_pkt_rx_ctrl_t;
+
+typedef struct {
+    wifi_pkt_rx_ctrl_t rx_ctrl;
+    uint8_t payload[0];
+} wifi_promiscuous_pkt_t;
+
+// Subset of a scan record, as returned by WiFi.getScanInfoByIndex()
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t ssid[33];
+    uint8_t primary;
+    wifi_second_chan_t second;
+    int8_t rssi;
+    wifi_auth_mode_t authmode;
+} wifi_ap_record_t;
+
+typedef void (*wifi_promiscuous_cb_t)(void* buf, wifi_promiscuous_pkt_type_t type);
+
+typedef struct {
+    uint32_t filter_mask;
+} wifi_promiscuous_filter_t;
+
+#define WIFI_PROMIS_FILTER_MASK_ALL         0xFFFFFFFF
+#define WIFI_PROMIS_FILTER_MASK_MGMT        (1 << 0)
+#define WIFI_PROMIS_FILTER_MASK_CTRL        (1 << 1)
+#define WIFI_PROMIS_FILTER_MASK_DATA        (1 << 2)
+#define WIFI_PROMIS_FILTER_MASK_MISC        (1 << 3)
+#define WIFI_PROMIS_CTRL_FILTER_MASK_ALL    0xFF800000 // Bit 16 + subtype, wrapper (7) to CF-End+Ack (15)
+#define WIFI_PROMIS_CTRL_FILTER_MASK_ACK    (1 << 29)
+
+esp_err_t esp_wifi_set_channel(uint8_t primary, wifi_second_chan_t second);
+esp_err_t esp_wifi_set_promiscuous(bool enable);
+esp_err_t esp_wifi_set_promiscuous_rx_cb(wifi_promiscuous_cb_t cb);
+esp_err_t esp_wifi_set_promiscuous_filter(const wifi_promiscuous_filter_t* filter);
+esp_err_t esp_wifi_set_promiscuous_ctrl_filter(const wifi_promiscuous_filter_t* filter);
+esp_err_t esp_wifi_80211_tx(wifi_interface_t ifx, const void* buffer, int len, bool en_sys_seq);
+
+// --- Simulator hooks ---
+// Builds a wifi_promiscuous_pkt_t around the frame and hands it to the callback.
+// Like the hardware, the payload ends with the FCS and sig_len counts it.
+// Frames the promiscuous filters exclude never reach the callback.
+void simWifiInjectFrame(const uint8_t* frame, int len, wifi_promiscuous_pkt_type_t type, int8_t rssi = -50);
+uint32_t simWifiTxCount();
+uint32_t simWifiRxCount(); // Callback invocations
+uint8_t simWifiChannel();
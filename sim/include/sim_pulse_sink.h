@@ -0,0 +1,77 @@
+#pragma once
+// Host stand-in for the RMT TX channel. Items are "sent" against the
+// virtual clock and the resulting waveform is recorded, with every
+// hand-over costing restartUs of extra low time like the real driver.
+#include <Arduino.h>
+#include <vector>
+#include "modules/subghz/pulse_sink.h"
+
+struct SimPulse {
+    bool level;
+    uint32_t us;
+};
+
+class SimPulseSink : public PulseSink {
+public:
+    explicit SimPulseSink(uint32_t restartUs = 12) : restartUs(restartUs) {}
+
+    bool begin() override {
+        waveform.clear();
+        sending = false;
+        started = false;
+        gapUs = 0;
+        return true;
+    }
+
+    bool send(const PulseItem* items, size_t count) override {
+        uint64_t now = micros();
+        uint64_t start = now;
+        if (started) {
+            // Restart latency counts from when the previous chunk finished
+            start = std::max<uint64_t>(now, endUs) + restartUs;
+            gapUs = (uint32_t)(start - endUs);
+            append(false, gapUs);
+        }
+        started = true;
+
+        uint64_t air = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (items[i].duration0 == 0) break;
+            append(items[i].level0, items[i].duration0);
+            air += items[i].duration0;
+            if (items[i].duration1 == 0) break;
+            append(items[i].level1, items[i].duration1);
+            air += items[i].duration1;
+        }
+        endUs = start + air;
+        sending = true;
+        return true;
+    }
+
+    bool waitDone(uint32_t timeoutMs) override {
+        uint64_t now = micros();
+        if (sending && endUs > now) simAdvanceMicros(endUs - now);
+        sending = false;
+        return true;
+    }
+
+    uint32_t lastGapUs() override { return gapUs; }
+    void end() override { sending = false; }
+
+    // Adjacent pulses of the same level are merged, like they look on air
+    const std::vector<SimPulse>& getWaveform() { return waveform; }
+
+private:
+    uint32_t restartUs;
+    std::vector<SimPulse> waveform;
+    bool sending = false;
+    bool started = false;
+    uint64_t endUs = 0;
+    uint32_t gapUs = 0;
+
+    void append(bool level, uint32_t us) {
+        if (us == 0) return;
+        if (!waveform.empty() && waveform.back().level == level) waveform.back().us += us;
+        else waveform.push_back({level, us});
+    }
+};
@@ -0,0 +1,157 @@
+#include <Arduino.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <new>
+#include "driver/rtc_io.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// --- Virtual clock ---
+
+static uint64_t nowUs = 0;
+
+unsigned long millis() { return (unsigned long)(nowUs / 1000); }
+unsigned long micros() { return (unsigned long)nowUs; }
+void delay(uint32_t ms) { nowUs += (uint64_t)ms * 1000; }
+void delayMicroseconds(uint32_t us) { nowUs += us; }
+void simAdvanceMicros(uint64_t us) { nowUs += us; }
+
+// --- GPIO ---
+
+static uint8_t pinLevel[64];
+static uint8_t pinModes[64];
+static uint16_t analogLevel[64];
+static uint32_t ledcDuty[16];
+
+struct SimIsr {
+    void (*fn)();
+    void (*fnArg)(void*);
+    void* arg;
+    int mode;
+};
+static SimIsr isrs[64];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin >= 64) return;
+    pinModes[pin] = mode;
+    if (mode == INPUT_PULLUP) pinLevel[pin] = HIGH;
+    else if (mode == INPUT_PULLDOWN) pinLevel[pin] = LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) { if (pin < 64) pinLevel[pin] = value ? HIGH : LOW; }
+int digitalRead(uint8_t pin) { return pin < 64 ? pinLevel[pin] : LOW; }
+uint16_t analogRead(uint8_t pin) { return pin < 64 ? analogLevel[pin] : 0; }
+uint32_t analogReadMilliVolts(uint8_t pin) { return analogRead(pin) * 3300UL / 4095; }
+void simSetPinInput(uint8_t pin, int level) {
+    if (pin >= 64) return;
+    uint8_t old = pinLevel[pin];
+    pinLevel[pin] = level ? HIGH : LOW;
+    if (old == pinLevel[pin]) return;
+
+    // Run the ISR synchronously, like an edge interrupt with no latency
+    const SimIsr& isr = isrs[pin];
+    bool rising = pinLevel[pin] == HIGH;
+    if (isr.mode == CHANGE || (isr.mode == RISING && rising) || (isr.mode == FALLING && !rising)) {
+        if (isr.fnArg) isr.fnArg(isr.arg);
+        else if (isr.fn) isr.fn();
+    }
+}
+void simSetAnalogInput(uint8_t pin, uint16_t raw) { if (pin < 64) analogLevel[pin] = raw; }
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {
+    if (pin < 64) isrs[pin] = {isr, nullptr, nullptr, mode};
+}
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode) {
+    if (pin < 64) isrs[pin] = {nullptr, isr, arg, mode};
+}
+void detachInterrupt(uint8_t pin) { if (pin < 64) isrs[pin] = {nullptr, nullptr, nullptr, 0}; }
+
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t bits) { return freq; }
+void ledcAttachPin(uint8_t pin, uint8_t channel) {}
+void ledcWrite(uint8_t channel, uint32_t duty) { if (channel < 16) ledcDuty[channel] = duty; }
+uint32_t simGetLedcDuty(uint8_t channel) { return channel < 16 ? ledcDuty[channel] : 0; }
+
+int gpio_hold_en(gpio_num_t pin) { return 0; }
+int gpio_hold_dis(gpio_num_t pin) { return 0; }
+int rtc_gpio_pullup_en(gpio_num_t pin) { return 0; }
+int rtc_gpio_pulldown_dis(gpio_num_t pin) { return 0; }
+
+int esp_sleep_enable_ext1_wakeup(uint64_t mask, int mode) { return 0; }
+void esp_deep_sleep_start() {
+    printf("[sim] deep sleep requested, exiting\n");
+    exit(0);
+}
+
+// --- Serial ---
+
+int HardwareSerial::printf(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vprintf(fmt, args);
+    va_end(args);
+    return n;
+}
+
+// --- Random ---
+
+long random(long max) { return max > 0 ? rand() % max : 0; }
+long random(long min, long max) { return max > min ? min + rand() % (max - min) : min; }
+void randomSeed(unsigned long seed) { srand(seed); }
+
+// --- FreeRTOS ---
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* param, UBaseType_t prio, TaskHandle_t* handle) {
+    return pdFAIL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* param, UBaseType_t prio, TaskHandle_t* handle, BaseType_t core) {
+    return pdFAIL;
+}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+void vTaskDelete(TaskHandle_t handle) {}
+BaseType_t xPortGetCoreID() { return 1; }
+
+// Binary semaphores are single threaded here, a counter is enough
+SemaphoreHandle_t xSemaphoreCreateBinary() { return new int(0); }
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new int(1); }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) { *(int*)sem = 1; return pdTRUE; }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    if (*(int*)sem) { *(int*)sem = 0; return pdTRUE; }
+    if (ticks != portMAX_DELAY) delay(ticks);
+    return pdFALSE;
+}
+
+// --- Heap accounting ---
+
+static uint64_t allocCount = 0;
+static uint64_t allocBytes = 0;
+static int64_t liveBytes = 0;
+
+uint64_t simAllocCount() { return allocCount; }
+uint64_t simAllocBytes() { return allocBytes; }
+uint32_t EspClass::getFreeHeap() { return (uint32_t)(getHeapSize() - (liveBytes > 0 ? liveBytes : 0)); }
+
+// Size header in front of each block so frees can be accounted too
+void* operator new(size_t size) {
+    allocCount++;
+    allocBytes += size;
+    liveBytes += size;
+    size_t* p = (size_t*)malloc(size + sizeof(size_t) * 2);
+    if (!p) throw std::bad_alloc();
+    p[0] = size;
+    return p + 2;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    size_t* p = (size_t*)ptr - 2;
+    liveBytes -= p[0];
+    free(p);
+}
+
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { operator delete(ptr); }
@@ -0,0 +1,161 @@
+#include <SD.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+
+SDFS SD;
+SPIClass SPI;
+
+static std::string fsRoot = "sd_card_root";
+
+void simSetFsRoot(const char* dir) { fsRoot = dir; }
+const char* simGetFsRoot() { return fsRoot.c_str(); }
+
+static std::string hostPath(const char* path) {
+    std::string p = path ? path : "/";
+    if (p.empty() || p[0] != '/') p = "/" + p;
+    return fsRoot + p;
+}
+
+struct SimFileImpl {
+    std::string path;     // Card path, e.g. /payloads/a.txt
+    std::string name;     // Basename, like arduino-esp32 2.x
+    FILE* fp = nullptr;
+    DIR* dir = nullptr;
+    bool isDir = false;
+
+    ~SimFileImpl() {
+        if (fp) fclose(fp);
+        if (dir) closedir(dir);
+    }
+};
+
+static std::shared_ptr<SimFileImpl> openImpl(const char* path, const char* mode) {
+    std::string host = hostPath(path);
+    struct stat st;
+    bool exists = stat(host.c_str(), &st) == 0;
+
+    auto impl = std::make_shared<SimFileImpl>();
+    impl->path = path;
+    size_t slash = impl->path.find_last_of('/');
+    impl->name = slash == std::string::npos ? impl->path : impl->path.substr(slash + 1);
+    if (impl->name.empty()) impl->name = "/";
+
+    if (exists && S_ISDIR(st.st_mode)) {
+        impl->isDir = true;
+        impl->dir = opendir(host.c_str());
+        return impl->dir ? impl : nullptr;
+    }
+
+    const char* m = "rb";
+    if (strcmp(mode, FILE_WRITE) == 0) m = "wb";
+    else if (strcmp(mode, FILE_APPEND) == 0) m = "ab";
+    else if (!exists) return nullptr;
+    else if (strcmp(mode, "r+") == 0) m = "r+b";
+    impl->fp = fopen(host.c_str(), m);
+    return impl->fp ? impl : nullptr;
+}
+
+File::operator bool() const { return _impl != nullptr; }
+
+size_t File::write(uint8_t b) { return write(&b, 1); }
+
+size_t File::write(const uint8_t* buf, size_t len) {
+    if (!_impl || !_impl->fp) return 0;
+    return fwrite(buf, 1, len, _impl->fp);
+}
+
+int File::available() {
+    if (!_impl || !_impl->fp) return 0;
+    long pos = ftell(_impl->fp);
+    fseek(_impl->fp, 0, SEEK_END);
+    long end = ftell(_impl->fp);
+    fseek(_impl->fp, pos, SEEK_SET);
+    return (int)(end - pos);
+}
+
+int File::read() {
+    if (!_impl || !_impl->fp) return -1;
+    return fgetc(_impl->fp);
+}
+
+size_t File::read(uint8_t* buf, size_t len) {
+    if (!_impl || !_impl->fp) return 0;
+    return fread(buf, 1, len, _impl->fp);
+}
+
+int File::peek() {
+    if (!_impl || !_impl->fp) return -1;
+    int c = fgetc(_impl->fp);
+    if (c != EOF) ungetc(c, _impl->fp);
+    return c;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!_impl || !_impl->fp) return false;
+    int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+    return fseek(_impl->fp, pos, whence) == 0;
+}
+
+size_t File::position() { return (_impl && _impl->fp) ? ftell(_impl->fp) : 0; }
+
+size_t File::size() {
+    if (!_impl) return 0;
+    struct stat st;
+    if (_impl->fp) fflush(_impl->fp);
+    return stat(hostPath(_impl->path.c_str()).c_str(), &st) == 0 ? st.st_size : 0;
+}
+
+void File::flush() { if (_impl && _impl->fp) fflush(_impl->fp); }
+void File::close() { _impl.reset(); }
+const char* File::name() { return _impl ? _impl->name.c_str() : ""; }
+const char* File::path() { return _impl ? _impl->path.c_str() : ""; }
+bool File::isDirectory() { return _impl && _impl->isDir; }
+
+File File::openNextFile(const char* mode) {
+    if (!_impl || !_impl->dir) return File();
+    struct dirent* e;
+    while ((e = readdir(_impl->dir)) != nullptr) {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+        std::string child = _impl->path;
+        if (child.empty() || child.back() != '/') child += "/";
+        child += e->d_name;
+        return File(openImpl(child.c_str(), mode));
+    }
+    return File();
+}
+
+void File::rewindDirectory() { if (_impl && _impl->dir) rewinddir(_impl->dir); }
+
+String File::readString() {
+    std::string s;
+    int c;
+    while ((c = read()) >= 0) s += (char)c;
+    return String(s);
+}
+
+String File::readStringUntil(char terminator) {
+    std::string s;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) s += (char)c;
+    return String(s);
+}
+
+File fs::FS::open(const char* path, const char* mode, bool create) { return File(openImpl(path, mode)); }
+
+bool fs::FS::exists(const char* path) {
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool fs::FS::remove(const char* path) { return unlink(hostPath(path).c_str()) == 0; }
+bool fs::FS::rename(const char* from, const char* to) { return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0; }
+bool fs::FS::mkdir(const char* path) { return ::mkdir(hostPath(path).c_str(), 0755) == 0; }
+bool fs::FS::rmdir(const char* path) { return ::rmdir(hostPath(path).c_str()) == 0; }
+
+bool SDFS::begin(uint8_t ssPin, SPIClass& spi, uint32_t frequency, const char* mountpoint, uint8_t maxFiles, bool formatOnFail) {
+    struct stat st;
+    _mounted = stat(fsRoot.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    return _mounted;
+}
@@ -0,0 +1,166 @@
+// Headless ESP-Chain: runs MenuSystem, DisplayManager and the portable
+// modules against the host shims, drives Btn 14 from a script and reports
+// per-interaction render cost.
+//
+//   esp_chain_sim [--sd DIR] [--out DIR] [--no-png] [--script "c c d l w500"]
+//
+// Script actions: c = click, d = double click, l = long press, wN = wait N ms
+#include <Arduino.h>
+#include <SD.h>
+#include <Wire.h>
+#include <WiFi.h>
+#include <chrono>
+#include <string>
+#include <sys/stat.h>
+#include "display_manager.h"
+#include "sd_manager.h"
+#include "menu_system.h"
+#include "input_manager.h"
+#include "config_manager.h"
+#include "asset_pack.h"
+#include "ui/icons.h"
+#include "modules/counter_module.h"
+#include "modules/file_explorer_module.h"
+#include "modules/settings_module.h"
+#include "modules/i2c/i2c_scanner_module.h"
+#include "modules/nrf24/nrf24_module.h"
+#include "modules/wifi/wifi_module.h"
+#include "badusb_module.h"
+
+DisplayManager displayManager;
+SDManager sdManager;
+MenuSystem menuSystem(&displayManager, &sdManager);
+InputManager inputManager(&menuSystem);
+
+// Loaded on entry like on the device, so the heap report is real
+static const ModuleDescriptor MODULES[] = {
+    {"WiFi Tools",    "wifi",                  19, 16, 13, 0, makeModule<WiFiModule>},
+    {"BadUSB",        "monitor",               16, 16, 16, 0, makeModule<BadUSBModule>},
+    {"NRF24 Tools",   "music_radio_streaming", 17, 16, 14, 1, makeModule<NRF24Module>},
+    {"File Explorer", "folder_explorer",       24, 16, 6,  0, makeModule<FileExplorerModule>},
+    {"Settings",      "menu_options",          14, 16, 8,  1, makeModule<SettingsModule>},
+    {"I2C Scanner",   nullptr,                 16, 16, 8,  0, makeModule<I2CScannerModule>},
+    {"Counter Demo",  nullptr,                 16, 16, 8,  0, makeModule<CounterModule>},
+};
+
+#define SIM_BATTERY_RAW 2420 // ~3.9V through the 1:2 divider
+
+static std::string outDir = "sim_out";
+static bool writePngs = true;
+static int frameIndex = 0;
+
+static void loopOnce() {
+    inputManager.update();
+    menuSystem.update();
+    delay(10);
+}
+
+static void runFor(uint32_t ms) {
+    unsigned long end = millis() + ms;
+    while (millis() < end) loopOnce();
+}
+
+static void pressFor(uint32_t downMs, uint32_t upMs) {
+    simSetPinInput(BTN_14, LOW);
+    runFor(downMs);
+    simSetPinInput(BTN_14, HIGH);
+    runFor(upMs);
+}
+
+static void snapshot(const char* action, double cpuUs, uint64_t allocs, uint64_t allocBytes, uint64_t pixels) {
+    char png[64] = "";
+    if (writePngs) {
+        snprintf(png, sizeof(png), "frame_%03d.png", frameIndex);
+        displayManager.getTFT()->writePNG((outDir + "/" + png).c_str());
+    }
+    printf("{\"step\":%d,\"action\":\"%s\",\"screen\":\"%s\",\"cpu_us\":%.1f,\"allocs\":%llu,\"alloc_bytes\":%llu,\"pixels\":%llu,\"virtual_ms\":%lu}\n",
+           frameIndex, action, png, cpuUs, (unsigned long long)allocs, (unsigned long long)allocBytes,
+           (unsigned long long)pixels, millis());
+    frameIndex++;
+}
+
+// Measure one interaction: host CPU time, heap allocations and pixels pushed
+template <typename F>
+static void measure(const char* action, F fn) {
+    TFT_eSPI* tft = displayManager.getTFT();
+    uint64_t allocs = simAllocCount();
+    uint64_t bytes = simAllocBytes();
+    tft->resetPixelCounter();
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    double us = std::chrono::duration<double, std::micro>(end - start).count();
+    snapshot(action, us, simAllocCount() - allocs, simAllocBytes() - bytes, tft->pixelsWritten());
+}
+
+static void addSimulatedAccessPoints() {
+    simAddAccessPoint("HomeNet", -48, 6, "a4:2b:b0:11:22:33", WIFI_AUTH_WPA2_PSK);
+    simAddAccessPoint("Cafe Guest", -71, 1, "c0:ff:ee:00:00:01", WIFI_AUTH_OPEN);
+    simAddAccessPoint("", -80, 11, "de:ad:be:ef:00:02", WIFI_AUTH_WPA2_WPA3_PSK);
+}
+
+static void addSimulatedI2CDevices() {
+    Wire.simSetRegister(0x68, 0x0F, 0x00); // DS3231
+    Wire.simSetRegister(0x0D, 0x0D, 0xFF); // QMC5883L
+    Wire.simAddDevice(0x57);               // RTC board EEPROM
+}
+
+int main(int argc, char** argv) {
+    std::string script = "c c c d l";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--sd" && i + 1 < argc) simSetFsRoot(argv[++i]);
+        else if (arg == "--out" && i + 1 < argc) outDir = argv[++i];
+        else if (arg == "--script" && i + 1 < argc) script = argv[++i];
+        else if (arg == "--no-png") writePngs = false;
+        else {
+            fprintf(stderr, "usage: %s [--sd DIR] [--out DIR] [--no-png] [--script \"c d l w500\"]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (writePngs) mkdir(outDir.c_str(), 0755);
+
+    simSetAnalogInput(4, SIM_BATTERY_RAW);
+    addSimulatedI2CDevices();
+    addSimulatedAccessPoints();
+
+    // Same bring-up order as setup(), minus the hardware-only modules
+    measure("boot", [] {
+        AssetPack::getInstance().begin();
+        displayManager.init();
+        displayManager.initRTC();
+        if (sdManager.init()) {
+            if (!ConfigManager::getInstance().load()) ConfigManager::getInstance().save();
+            displayManager.setBrightness(ConfigManager::getInstance().data.displayBrightness);
+            displayManager.setTheme(ConfigManager::getInstance().data.displayTheme);
+        }
+        inputManager.begin();
+
+        for (const ModuleDescriptor& module : MODULES) menuSystem.registerModule(module);
+        menuSystem.draw();
+    });
+
+    size_t pos = 0;
+    while (pos < script.size()) {
+        size_t end = script.find_first_of(" ,", pos);
+        if (end == std::string::npos) end = script.size();
+        std::string token = script.substr(pos, end - pos);
+        pos = end + 1;
+        if (token.empty()) continue;
+
+        switch (token[0]) {
+            case 'c': measure("click", [] { pressFor(100, 400); }); break;
+            case 'd': measure("double", [] { pressFor(80, 80); pressFor(80, 400); }); break;
+            case 'l': measure("long", [] { pressFor(700, 100); }); break;
+            case 'w': {
+                uint32_t ms = strtoul(token.c_str() + 1, nullptr, 10);
+                measure("wait", [ms] { runFor(ms); });
+                break;
+            }
+            default:
+                fprintf(stderr, "unknown action '%s'\n", token.c_str());
+                return 1;
+        }
+    }
+    return 0;
+}
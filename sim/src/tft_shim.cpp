@@ -0,0 +1,399 @@
+#include <TFT_eSPI.h>
+#include <stdlib.h>
+
+// Classic 5x7 column-major glyphs for ASCII 0x20..0x7E, LSB at the top
+static const uint8_t glyphs[95][5] = {
+    {0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x5F,0x00,0x00},{0x00,0x07,0x00,0x07,0x00},{0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12},{0x23,0x13,0x08,0x64,0x62},{0x36,0x49,0x55,0x22,0x50},{0x00,0x05,0x03,0x00,0x00},
+    {0x00,0x1C,0x22,0x41,0x00},{0x00,0x41,0x22,0x1C,0x00},{0x14,0x08,0x3E,0x08,0x14},{0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x50,0x30,0x00,0x00},{0x08,0x08,0x08,0x08,0x08},{0x00,0x60,0x60,0x00,0x00},{0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E},{0x00,0x42,0x7F,0x40,0x00},{0x42,0x61,0x51,0x49,0x46},{0x21,0x41,0x45,0x4B,0x31},
+    {0x18,0x14,0x12,0x7F,0x10},{0x27,0x45,0x45,0x45,0x39},{0x3C,0x4A,0x49,0x49,0x30},{0x01,0x71,0x09,0x05,0x03},
+    {0x36,0x49,0x49,0x49,0x36},{0x06,0x49,0x49,0x29,0x1E},{0x00,0x36,0x36,0x00,0x00},{0x00,0x56,0x36,0x00,0x00},
+    {0x08,0x14,0x22,0x41,0x00},{0x14,0x14,0x14,0x14,0x14},{0x00,0x41,0x22,0x14,0x08},{0x02,0x01,0x51,0x09,0x06},
+    {0x32,0x49,0x79,0x41,0x3E},{0x7E,0x11,0x11,0x11,0x7E},{0x7F,0x49,0x49,0x49,0x36},{0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x22,0x1C},{0x7F,0x49,0x49,0x49,0x41},{0x7F,0x09,0x09,0x01,0x01},{0x3E,0x41,0x41,0x51,0x32},
+    {0x7F,0x08,0x08,0x08,0x7F},{0x00,0x41,0x7F,0x41,0x00},{0x20,0x40,0x41,0x3F,0x01},{0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40},{0x7F,0x02,0x04,0x02,0x7F},{0x7F,0x04,0x08,0x10,0x7F},{0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06},{0x3E,0x41,0x51,0x21,0x5E},{0x7F,0x09,0x19,0x29,0x46},{0x46,0x49,0x49,0x49,0x31},
+    {0x01,0x01,0x7F,0x01,0x01},{0x3F,0x40,0x40,0x40,0x3F},{0x1F,0x20,0x40,0x20,0x1F},{0x7F,0x20,0x18,0x20,0x7F},
+    {0x63,0x14,0x08,0x14,0x63},{0x03,0x04,0x78,0x04,0x03},{0x61,0x51,0x49,0x45,0x43},{0x00,0x7F,0x41,0x41,0x00},
+    {0x02,0x04,0x08,0x10,0x20},{0x00,0x41,0x41,0x7F,0x00},{0x04,0x02,0x01,0x02,0x04},{0x40,0x40,0x40,0x40,0x40},
+    {0x00,0x01,0x02,0x04,0x00},{0x20,0x54,0x54,0x54,0x78},{0x7F,0x48,0x44,0x44,0x38},{0x38,0x44,0x44,0x44,0x20},
+    {0x38,0x44,0x44,0x48,0x7F},{0x38,0x54,0x54,0x54,0x18},{0x08,0x7E,0x09,0x01,0x02},{0x08,0x14,0x54,0x54,0x3C},
+    {0x7F,0x08,0x04,0x04,0x78},{0x00,0x44,0x7D,0x40,0x00},{0x20,0x40,0x44,0x3D,0x00},{0x00,0x7F,0x10,0x28,0x44},
+    {0x00,0x41,0x7F,0x40,0x00},{0x7C,0x04,0x18,0x04,0x78},{0x7C,0x08,0x04,0x04,0x78},{0x38,0x44,0x44,0x44,0x38},
+    {0x7C,0x14,0x14,0x14,0x08},{0x08,0x14,0x14,0x18,0x7C},{0x7C,0x08,0x04,0x04,0x08},{0x48,0x54,0x54,0x54,0x20},
+    {0x04,0x3F,0x44,0x40,0x20},{0x3C,0x40,0x40,0x20,0x7C},{0x1C,0x20,0x40,0x20,0x1C},{0x3C,0x40,0x30,0x40,0x3C},
+    {0x44,0x28,0x10,0x28,0x44},{0x0C,0x50,0x50,0x50,0x3C},{0x44,0x64,0x54,0x4C,0x44},{0x00,0x08,0x36,0x41,0x00},
+    {0x00,0x00,0x7F,0x00,0x00},{0x00,0x41,0x36,0x08,0x00},{0x02,0x01,0x02,0x04,0x02},
+};
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h) : _width(w), _height(h) {
+    // Allocate for the larger orientation so rotation never reallocates
+    int n = (w > h ? w : h);
+    _fb = (uint16_t*)calloc(n * n, sizeof(uint16_t));
+}
+
+TFT_eSPI::~TFT_eSPI() {
+    free(_fb);
+}
+
+void TFT_eSPI::init() {
+    _displayOn = true;
+}
+
+void TFT_eSPI::setRotation(uint8_t r) {
+    _rotation = r & 3;
+    int16_t shortSide = TFT_WIDTH < TFT_HEIGHT ? TFT_WIDTH : TFT_HEIGHT;
+    int16_t longSide = TFT_WIDTH < TFT_HEIGHT ? TFT_HEIGHT : TFT_WIDTH;
+    _width = (_rotation & 1) ? longSide : shortSide;
+    _height = (_rotation & 1) ? shortSide : longSide;
+}
+
+void TFT_eSPI::writecommand(uint8_t c) {
+    if (c == TFT_DISPOFF) _displayOn = false;
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+    if (_vpW > 0) {
+        if (_vpDatum) {
+            x += _vpX;
+            y += _vpY;
+        }
+        if (x < _vpX || y < _vpY || x >= _vpX + _vpW || y >= _vpY + _vpH) return;
+    }
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    _fb[y * _width + x] = color;
+    _pixelsWritten++;
+}
+
+uint16_t TFT_eSPI::getPixel(int32_t x, int32_t y) {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+    return _fb[y * _width + x];
+}
+
+void TFT_eSPI::fillScreen(uint32_t color) {
+    fillRect(0, 0, _width, _height, color);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    for (int32_t j = y; j < y + h; j++) {
+        for (int32_t i = x; i < x + w; i++) drawPixel(i, j, color);
+    }
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+    fillRect(x, y, w, 1, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+    fillRect(x, y, 1, h, color);
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+    int32_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int32_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy;
+    while (true) {
+        drawPixel(x0, y0, color);
+        if (x0 == x1 && y0 == y1) break;
+        int32_t e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+// Rounded rects: corners are approximated by skipping pixels outside the radius
+static bool outsideCorner(int32_t i, int32_t j, int32_t w, int32_t h, int32_t r) {
+    int32_t cx = i < r ? r - i : (i >= w - r ? i - (w - r - 1) : 0);
+    int32_t cy = j < r ? r - j : (j >= h - r ? j - (h - r - 1) : 0);
+    return cx > 0 && cy > 0 && cx * cx + cy * cy > r * r;
+}
+
+void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) {
+    for (int32_t j = 0; j < h; j++) {
+        for (int32_t i = 0; i < w; i++) {
+            if (!outsideCorner(i, j, w, h, r)) drawPixel(x + i, y + j, color);
+        }
+    }
+}
+
+void TFT_eSPI::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) {
+    for (int32_t j = 0; j < h; j++) {
+        for (int32_t i = 0; i < w; i++) {
+            if (outsideCorner(i, j, w, h, r)) continue;
+            bool edge = i == 0 || j == 0 || i == w - 1 || j == h - 1 ||
+                        outsideCorner(i - 1, j, w, h, r) || outsideCorner(i + 1, j, w, h, r) ||
+                        outsideCorner(i, j - 1, w, h, r) || outsideCorner(i, j + 1, w, h, r);
+            if (edge) drawPixel(x + i, y + j, color);
+        }
+    }
+}
+
+void TFT_eSPI::fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color) {
+    for (int32_t j = -r; j <= r; j++) {
+        for (int32_t i = -r; i <= r; i++) {
+            if (i * i + j * j <= r * r) drawPixel(x + i, y + j, color);
+        }
+    }
+}
+
+void TFT_eSPI::drawCircle(int32_t x, int32_t y, int32_t r, uint32_t color) {
+    for (int32_t j = -r; j <= r; j++) {
+        for (int32_t i = -r; i <= r; i++) {
+            int32_t d = i * i + j * j;
+            if (d <= r * r && d > (r - 1) * (r - 1)) drawPixel(x + i, y + j, color);
+        }
+    }
+}
+
+void TFT_eSPI::drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t color) {
+    int16_t byteWidth = (w + 7) / 8;
+    for (int16_t j = 0; j < h; j++) {
+        for (int16_t i = 0; i < w; i++) {
+            if (bitmap[j * byteWidth + i / 8] & (0x80 >> (i & 7))) drawPixel(x + i, y + j, color);
+        }
+    }
+}
+
+void TFT_eSPI::drawBitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t fg, uint16_t bg) {
+    int16_t byteWidth = (w + 7) / 8;
+    for (int16_t j = 0; j < h; j++) {
+        for (int16_t i = 0; i < w; i++) {
+            drawPixel(x + i, y + j, (bitmap[j * byteWidth + i / 8] & (0x80 >> (i & 7))) ? fg : bg);
+        }
+    }
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+    for (int32_t j = 0; j < h; j++) {
+        for (int32_t i = 0; i < w; i++) {
+            // Like the library: unswapped bytes go out in memory order and the panel takes the first as high
+            uint16_t c = data[j * w + i];
+            drawPixel(x + i, y + j, _swapBytes ? c : (uint16_t)(c >> 8 | c << 8));
+        }
+    }
+}
+
+void TFT_eSPI::setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h) {
+    _winX = x; _winY = y; _winW = w; _winH = h; _winPos = 0;
+}
+
+void TFT_eSPI::setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum) {
+    _vpX = x; _vpY = y; _vpW = w; _vpH = h; _vpDatum = vpDatum;
+}
+
+void TFT_eSPI::resetViewport() {
+    _vpW = 0;
+    _vpDatum = false;
+}
+
+void TFT_eSPI::pushColors(const uint16_t* data, uint32_t len, bool swap) {
+    for (uint32_t n = 0; n < len && _winW > 0; n++, _winPos++) {
+        uint16_t c = data[n];
+        if (swap) c = (c >> 8) | (c << 8);
+        drawPixel(_winX + _winPos % _winW, _winY + _winPos / _winW, c);
+    }
+}
+
+void TFT_eSPI::pushColor(uint16_t color, uint32_t len) {
+    for (uint32_t n = 0; n < len && _winW > 0; n++, _winPos++) {
+        drawPixel(_winX + _winPos % _winW, _winY + _winPos / _winW, color);
+    }
+}
+
+// Font 1 is 8px, font 2 16px, font 4 26px, 6/7/8 are large digit fonts
+void TFT_eSPI::glyphMetrics(uint8_t font, int* scale, int* advance, int* height) {
+    int s = 1;
+    switch (font) {
+        case 2: s = 2; break;
+        case 4: s = 3; break;
+        case 6: s = 5; break;
+        case 7: s = 6; break;
+        case 8: s = 9; break;
+        default: s = 1; break;
+    }
+    s *= _textSize;
+    *scale = s;
+    *advance = (font == 2) ? 7 * _textSize : 6 * s; // Font 2 is narrow and proportional on device
+    *height = (font == 2) ? 16 * _textSize : 8 * s;
+}
+
+int16_t TFT_eSPI::textWidth(const char* s, uint8_t font) {
+    int scale, advance, height;
+    glyphMetrics(font, &scale, &advance, &height);
+    return strlen(s) * advance;
+}
+
+int16_t TFT_eSPI::fontHeight(uint8_t font) {
+    int scale, advance, height;
+    glyphMetrics(font, &scale, &advance, &height);
+    return height;
+}
+
+void TFT_eSPI::drawChar(char c, int32_t x, int32_t y, int scale, uint16_t color) {
+    if (c < 0x20 || c > 0x7E) c = '?';
+    const uint8_t* g = glyphs[c - 0x20];
+    int sx = scale, sy = scale;
+    for (int col = 0; col < 5; col++) {
+        for (int row = 0; row < 7; row++) {
+            if (g[col] & (1 << row)) fillRect(x + col * sx, y + row * sy, sx, sy, color);
+        }
+    }
+}
+
+int16_t TFT_eSPI::drawString(const char* s, int32_t x, int32_t y, uint8_t font) {
+    int scale, advance, height;
+    glyphMetrics(font, &scale, &advance, &height);
+    int32_t w = strlen(s) * advance;
+
+    // Apply datum
+    if (_datum == TC_DATUM || _datum == MC_DATUM || _datum == BC_DATUM) x -= w / 2;
+    else if (_datum == TR_DATUM || _datum == MR_DATUM || _datum == BR_DATUM) x -= w;
+    if (_datum == ML_DATUM || _datum == MC_DATUM || _datum == MR_DATUM) y -= height / 2;
+    else if (_datum >= BL_DATUM) y -= height;
+
+    if (_textBg != _textFg) {
+        int32_t padW = w < _padding ? _padding : w;
+        int32_t padX = x;
+        if (_datum == TC_DATUM || _datum == MC_DATUM || _datum == BC_DATUM) padX = x + w / 2 - padW / 2;
+        else if (_datum == TR_DATUM || _datum == MR_DATUM || _datum == BR_DATUM) padX = x + w - padW;
+        fillRect(padX, y, padW, height, _textBg);
+    }
+
+    int glyphScaleY = (font == 2) ? 2 : scale;
+    int32_t glyphY = y + (height - 7 * glyphScaleY) / 2;
+    for (const char* p = s; *p; p++, x += advance) {
+        if (font == 2) {
+            // Narrow font: 1px wide columns, 2px tall rows
+            const uint8_t* g = glyphs[(*p < 0x20 || *p > 0x7E ? '?' : *p) - 0x20];
+            for (int col = 0; col < 5; col++) {
+                for (int row = 0; row < 7; row++) {
+                    if (g[col] & (1 << row)) fillRect(x + col * _textSize, glyphY + row * 2 * _textSize, _textSize, 2 * _textSize, _textFg);
+                }
+            }
+        } else {
+            drawChar(*p, x, glyphY, scale, _textFg);
+        }
+    }
+    return w;
+}
+
+int16_t TFT_eSPI::drawCentreString(const String& s, int32_t x, int32_t y, uint8_t font) {
+    uint8_t d = _datum;
+    _datum = TC_DATUM;
+    int16_t w = drawString(s.c_str(), x, y, font);
+    _datum = d;
+    return w;
+}
+
+void TFT_eSPI::print(const String& s) {
+    uint8_t d = _datum;
+    _datum = TL_DATUM;
+    _cursorX += drawString(s.c_str(), _cursorX, _cursorY, _font);
+    _datum = d;
+}
+
+// --- PNG output ---
+// Uses stored (uncompressed) deflate blocks so no zlib dependency is needed.
+
+static uint32_t crcTable[256];
+
+static void initCrc() {
+    if (crcTable[1]) return;
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+        crcTable[n] = c;
+    }
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t len) {
+    crc ^= 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFF;
+}
+
+static void putBE32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+static void writeChunk(FILE* f, const char* type, const uint8_t* data, uint32_t len) {
+    uint8_t hdr[8];
+    putBE32(hdr, len);
+    memcpy(hdr + 4, type, 4);
+    fwrite(hdr, 1, 8, f);
+    if (len) fwrite(data, 1, len, f);
+    uint32_t crc = crc32(0, hdr + 4, 4);
+    crc = crc32(crc, data, len);
+    uint8_t c[4];
+    putBE32(c, crc);
+    fwrite(c, 1, 4, f);
+}
+
+bool TFT_eSPI::writePNG(const char* path) {
+    initCrc();
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+
+    static const uint8_t sig[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(sig, 1, 8, f);
+
+    uint8_t ihdr[13];
+    putBE32(ihdr, _width);
+    putBE32(ihdr + 4, _height);
+    ihdr[8] = 8;  // Bit depth
+    ihdr[9] = 2;  // RGB
+    ihdr[10] = 0; ihdr[11] = 0; ihdr[12] = 0;
+    writeChunk(f, "IHDR", ihdr, 13);
+
+    // Raw scanlines: filter byte + RGB888
+    size_t rowLen = 1 + _width * 3;
+    size_t rawLen = rowLen * _height;
+    uint8_t* raw = (uint8_t*)malloc(rawLen);
+    for (int y = 0; y < _height; y++) {
+        uint8_t* row = raw + y * rowLen;
+        row[0] = 0;
+        for (int x = 0; x < _width; x++) {
+            uint16_t c = _fb[y * _width + x];
+            row[1 + x * 3] = ((c >> 11) & 0x1F) * 255 / 31;
+            row[2 + x * 3] = ((c >> 5) & 0x3F) * 255 / 63;
+            row[3 + x * 3] = (c & 0x1F) * 255 / 31;
+        }
+    }
+
+    // zlib stream of stored blocks
+    size_t blocks = (rawLen + 65534) / 65535;
+    size_t zLen = 2 + rawLen + blocks * 5 + 4;
+    uint8_t* z = (uint8_t*)malloc(zLen);
+    size_t o = 0;
+    z[o++] = 0x78; z[o++] = 0x01;
+    uint32_t a = 1, b = 0;
+    for (size_t pos = 0; pos < rawLen; ) {
+        size_t n = rawLen - pos > 65535 ? 65535 : rawLen - pos;
+        z[o++] = (pos + n == rawLen) ? 1 : 0;
+        z[o++] = n & 0xFF; z[o++] = n >> 8;
+        z[o++] = ~n & 0xFF; z[o++] = (~n >> 8) & 0xFF;
+        memcpy(z + o, raw + pos, n);
+        for (size_t i = 0; i < n; i++) { a = (a + raw[pos + i]) % 65521; b = (b + a) % 65521; }
+        o += n;
+        pos += n;
+    }
+    putBE32(z + o, (b << 16) | a);
+    o += 4;
+    writeChunk(f, "IDAT", z, o);
+    writeChunk(f, "IEND", nullptr, 0);
+
+    free(raw);
+    free(z);
+    fclose(f);
+    return true;
+}
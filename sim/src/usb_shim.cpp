@@ -0,0 +1,3 @@
+#include <USB.h>
+
+ESPUSB USB;
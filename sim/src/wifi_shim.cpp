@@ -0,0 +1,97 @@
+#include <WiFi.h>
+#include <vector>
+#include <string>
+
+WiFiClass WiFi;
+
+struct SimAccessPoint {
+    std::string ssid;
+    int32_t rssi;
+    uint8_t channel;
+    std::string bssid;
+    wifi_auth_mode_t auth;
+};
+
+static std::vector<SimAccessPoint> accessPoints;
+static std::vector<wifi_ap_record_t> scanRecords; // What the last scan found, like the driver's copy
+static wifi_promiscuous_cb_t promiscuousCb = nullptr;
+static bool promiscuous = false;
+static uint8_t currentChannel = 1;
+static uint32_t txCount = 0;
+static uint32_t rxCount = 0;
+// Driver defaults: everything but MISC, every control subtype
+static uint32_t filterMask = WIFI_PROMIS_FILTER_MASK_MGMT | WIFI_PROMIS_FILTER_MASK_CTRL | WIFI_PROMIS_FILTER_MASK_DATA;
+static uint32_t ctrlFilterMask = WIFI_PROMIS_CTRL_FILTER_MASK_ALL;
+
+void simAddAccessPoint(const char* ssid, int32_t rssi, uint8_t channel, const char* bssid, wifi_auth_mode_t auth) {
+    accessPoints.push_back({ssid, rssi, channel, bssid, auth});
+}
+
+// Scans finish instantly, the caller sees the results on its next scanComplete()
+int16_t WiFiClass::scanNetworks(bool async, bool showHidden, bool passive, uint32_t maxMsPerChan, uint8_t channel) {
+    scanRecords.resize(accessPoints.size());
+    for (size_t i = 0; i < accessPoints.size(); i++) {
+        wifi_ap_record_t& r = scanRecords[i];
+        memset(&r, 0, sizeof(r));
+        memcpy(r.bssid, BSSID(i), 6);
+        strncpy((char*)r.ssid, accessPoints[i].ssid.c_str(), 32);
+        r.primary = accessPoints[i].channel;
+        r.rssi = accessPoints[i].rssi;
+        r.authmode = accessPoints[i].auth;
+    }
+    _scanState = (int16_t)accessPoints.size();
+    return async ? WIFI_SCAN_RUNNING : _scanState;
+}
+
+String WiFiClass::SSID(uint8_t i) { return i < accessPoints.size() ? String(accessPoints[i].ssid) : String(); }
+int32_t WiFiClass::RSSI(uint8_t i) { return i < accessPoints.size() ? accessPoints[i].rssi : 0; }
+int32_t WiFiClass::channel(uint8_t i) { return i < accessPoints.size() ? accessPoints[i].channel : 0; }
+String WiFiClass::BSSIDstr(uint8_t i) { return i < accessPoints.size() ? String(accessPoints[i].bssid) : String(); }
+uint8_t* WiFiClass::BSSID(uint8_t i) {
+    static uint8_t bssid[6];
+    memset(bssid, 0, sizeof(bssid));
+    if (i < accessPoints.size()) {
+        sscanf(accessPoints[i].bssid.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
+               &bssid[0], &bssid[1], &bssid[2], &bssid[3], &bssid[4], &bssid[5]);
+    }
+    return bssid;
+}
+void* WiFiClass::getScanInfoByIndex(int i) {
+    return i >= 0 && i < (int)scanRecords.size() ? &scanRecords[i] : nullptr;
+}
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t i) { return i < accessPoints.size() ? accessPoints[i].auth : WIFI_AUTH_OPEN; }
+
+esp_err_t esp_wifi_set_channel(uint8_t primary, wifi_second_chan_t second) { currentChannel = primary; return ESP_OK; }
+esp_err_t esp_wifi_set_promiscuous(bool enable) { promiscuous = enable; return ESP_OK; }
+esp_err_t esp_wifi_set_promiscuous_rx_cb(wifi_promiscuous_cb_t cb) { promiscuousCb = cb; return ESP_OK; }
+esp_err_t esp_wifi_set_promiscuous_filter(const wifi_promiscuous_filter_t* filter) { filterMask = filter->filter_mask; return ESP_OK; }
+esp_err_t esp_wifi_set_promiscuous_ctrl_filter(const wifi_promiscuous_filter_t* filter) { ctrlFilterMask = filter->filter_mask; return ESP_OK; }
+esp_err_t esp_wifi_80211_tx(wifi_interface_t ifx, const void* buffer, int len, bool en_sys_seq) { txCount++; return ESP_OK; }
+
+void simWifiInjectFrame(const uint8_t* frame, int len, wifi_promiscuous_pkt_type_t type, int8_t rssi) {
+    if (!promiscuous || !promiscuousCb || !(filterMask & (1u << type))) return;
+    if (type == WIFI_PKT_CTRL && len > 0 && !(ctrlFilterMask & (1u << (16 + (frame[0] >> 4))))) return;
+    std::vector<uint8_t> buf(sizeof(wifi_promiscuous_pkt_t) + len + 4);
+    wifi_promiscuous_pkt_t* pkt = (wifi_promiscuous_pkt_t*)buf.data();
+    pkt->rx_ctrl.rssi = rssi;
+    pkt->rx_ctrl.rate = 0x0B; // 6 Mbps
+    pkt->rx_ctrl.noise_floor = -95;
+    pkt->rx_ctrl.channel = currentChannel;
+    pkt->rx_ctrl.timestamp = micros();
+    pkt->rx_ctrl.sig_len = len + 4;
+    memcpy(pkt->payload, frame, len);
+
+    uint32_t crc = 0xFFFFFFFF; // CRC-32 as 802.11 sends it, little endian
+    for (int i = 0; i < len; i++) {
+        crc ^= frame[i];
+        for (int b = 0; b < 8; b++) crc = crc >> 1 ^ (0xEDB88320 & -(crc & 1));
+    }
+    crc = ~crc;
+    for (int i = 0; i < 4; i++) pkt->payload[len + i] = crc >> (8 * i);
+    rxCount++;
+    promiscuousCb(pkt, type);
+}
+
+uint32_t simWifiTxCount() { return txCount; }
+uint32_t simWifiRxCount() { return rxCount; }
+uint8_t simWifiChannel() { return currentChannel; }
@@ -0,0 +1,105 @@
+#include <Wire.h>
+#include <RTClib.h>
+#include <time.h>
+
+TwoWire Wire;
+
+// Simulated devices: presence bit plus a 256 byte register file each
+static bool present[128];
+static uint8_t registers[128][256];
+
+void TwoWire::simAddDevice(uint8_t address) {
+    if (address < 128) present[address] = true;
+}
+
+void TwoWire::simSetRegister(uint8_t address, uint8_t reg, uint8_t value) {
+    simAddDevice(address);
+    registers[address][reg] = value;
+}
+
+void TwoWire::beginTransmission(uint16_t address) {
+    _txAddress = address & 0x7F;
+    _txLen = 0;
+}
+
+size_t TwoWire::write(uint8_t b) {
+    if (_txLen >= sizeof(_txBuf)) return 0;
+    _txBuf[_txLen++] = b;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* buf, size_t len) {
+    size_t n = 0;
+    while (n < len && write(buf[n])) n++;
+    return n;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    // Roughly one address byte plus data at the configured clock
+    delayMicroseconds((uint32_t)((_txLen + 1) * 9 * 1000000ULL / _clock) + 1);
+    if (!present[_txAddress]) return 2;
+    if (_txLen > 0) {
+        uint8_t reg = _txBuf[0];
+        for (size_t i = 1; i < _txLen; i++) registers[_txAddress][(uint8_t)(reg + i - 1)] = _txBuf[i];
+        _regPointer[_txAddress] = reg + (_txLen > 1 ? _txLen - 1 : 0);
+    }
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint16_t address, uint8_t len, bool sendStop) {
+    address &= 0x7F;
+    _rxLen = _rxPos = 0;
+    if (!present[address]) return 0;
+    if (len > sizeof(_rxBuf)) len = sizeof(_rxBuf);
+    for (uint8_t i = 0; i < len; i++) _rxBuf[i] = registers[address][_regPointer[address]++];
+    _rxLen = len;
+    delayMicroseconds((uint32_t)((len + 1) * 9 * 1000000ULL / _clock) + 1);
+    return len;
+}
+
+int TwoWire::available() { return (int)(_rxLen - _rxPos); }
+int TwoWire::read() { return _rxPos < _rxLen ? _rxBuf[_rxPos++] : -1; }
+
+// --- RTClib ---
+
+DateTime::DateTime(uint32_t t) {
+    time_t tt = t;
+    struct tm tmv;
+    gmtime_r(&tt, &tmv);
+    yOff = tmv.tm_year + 1900 - 2000;
+    m = tmv.tm_mon + 1;
+    d = tmv.tm_mday;
+    hh = tmv.tm_hour;
+    mm = tmv.tm_min;
+    ss = tmv.tm_sec;
+}
+
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t min, uint8_t sec)
+    : yOff(year - 2000), m(month), d(day), hh(hour), mm(min), ss(sec) {}
+
+uint32_t DateTime::unixtime() const {
+    struct tm tmv = {};
+    tmv.tm_year = yOff + 2000 - 1900;
+    tmv.tm_mon = m - 1;
+    tmv.tm_mday = d;
+    tmv.tm_hour = hh;
+    tmv.tm_min = mm;
+    tmv.tm_sec = ss;
+    return (uint32_t)timegm(&tmv);
+}
+
+static int64_t rtcOffset = 0;
+static bool rtcOffsetSet = false;
+
+DateTime RTC_DS3231::now() {
+    if (!rtcOffsetSet) {
+        rtcOffset = (int64_t)time(nullptr);
+        rtcOffsetSet = true;
+    }
+    return DateTime((uint32_t)(rtcOffset + millis() / 1000));
+}
+
+void RTC_DS3231::adjust(const DateTime& dt) {
+    rtcOffset = (int64_t)dt.unixtime() - millis() / 1000;
+    rtcOffsetSet = true;
+}
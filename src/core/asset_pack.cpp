@@ -0,0 +1,191 @@
+#include "asset_pack.h"
+#ifdef SIMULATOR
+#include <vector>
+#else
+#include <esp_partition.h>
+#include <esp_idf_version.h>
+#endif
+
+// Must match the struct formats in scripts/pack_assets.py
+static_assert(sizeof(AssetPackHeader) == 16, "asset pack header layout");
+static_assert(sizeof(AssetEntry) == 48, "asset entry layout");
+
+// Handed out for missing icons, drawBitmap() skips clear bits
+static const uint8_t blankBitmap[ASSET_CACHE_SLOT_BYTES] = {0};
+
+bool AssetPack::begin() {
+#ifdef SIMULATOR
+    // No partitions on the host, read the packer's output instead
+    static std::vector<uint8_t> hostPack;
+    FILE* f = fopen(ASSET_PACK_HOST_FILE, "rb");
+    if (!f) {
+        Serial.println("Asset pack not found: " ASSET_PACK_HOST_FILE);
+        return false;
+    }
+    uint8_t buf[1024];
+    size_t n;
+    hostPack.clear();
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) hostPack.insert(hostPack.end(), buf, buf + n);
+    fclose(f);
+    return begin(hostPack.data(), hostPack.size());
+#else
+    const esp_partition_t* part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+        (esp_partition_subtype_t)ASSET_PARTITION_TYPE, ASSET_PARTITION_NAME);
+    if (!part) {
+        Serial.println("Asset partition missing, flash partitions.csv");
+        return false;
+    }
+
+    const void* mapped = nullptr;
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_partition_mmap_handle_t handle;
+    esp_err_t err = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &mapped, &handle);
+#else
+    spi_flash_mmap_handle_t handle;
+    esp_err_t err = esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &mapped, &handle);
+#endif
+    if (err != ESP_OK) {
+        Serial.println("Asset partition mmap failed");
+        return false;
+    }
+    // Mapping stays for the lifetime of the firmware
+    return begin((const uint8_t*)mapped, part->size);
+#endif
+}
+
+bool AssetPack::begin(const uint8_t* data, size_t size) {
+    pack = nullptr;
+    entries = nullptr;
+    count = 0;
+    clearCache();
+
+    if (size < sizeof(AssetPackHeader)) return false;
+    AssetPackHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != ASSET_PACK_MAGIC || header.version != ASSET_PACK_VERSION) {
+        Serial.println("Asset pack missing or wrong version, run 'pio run -t uploadassets'");
+        return false;
+    }
+    if (header.totalSize > size || sizeof(header) + header.count * sizeof(AssetEntry) > header.totalSize) {
+        Serial.println("Asset pack truncated");
+        return false;
+    }
+
+    const AssetEntry* table = (const AssetEntry*)(data + sizeof(header));
+    for (int i = 0; i < header.count; i++) {
+        const AssetEntry& e = table[i];
+        if (e.offset + e.packedSize > header.totalSize || e.name[ASSET_NAME_LEN - 1] != 0) {
+            Serial.println("Asset pack index corrupt");
+            return false;
+        }
+    }
+
+    pack = data;
+    entries = table;
+    count = header.count;
+    Serial.println("Asset pack: " + String(count) + " assets, " + String(header.totalSize) + " bytes");
+    return true;
+}
+
+// The packer sorts the index by name
+const AssetEntry* AssetPack::find(const char* name) {
+    int lo = 0, hi = (int)count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int cmp = strncmp(name, entries[mid].name, ASSET_NAME_LEN);
+        if (cmp == 0) return &entries[mid];
+        if (cmp < 0) hi = mid - 1;
+        else lo = mid + 1;
+    }
+    return nullptr;
+}
+
+const uint8_t* AssetPack::get(const char* name) {
+    const AssetEntry* entry = find(name);
+    if (!entry) return nullptr;
+    if (entry->codec == ASSET_STORED) return pack + entry->offset;
+    return decode(entry);
+}
+
+const unsigned char* AssetPack::getBitmap(const char* name) {
+    const uint8_t* data = get(name);
+    return data ? data : blankBitmap;
+}
+
+void AssetPack::clearCache() {
+    for (int i = 0; i < ASSET_CACHE_SLOTS; i++) {
+        cache[i].entry = nullptr;
+        cache[i].lastUse = 0;
+    }
+}
+
+const uint8_t* AssetPack::decode(const AssetEntry* entry) {
+    if (entry->codec != ASSET_LZ4 || entry->rawSize > ASSET_CACHE_SLOT_BYTES) return nullptr;
+
+    CacheSlot* victim = &cache[0];
+    for (int i = 0; i < ASSET_CACHE_SLOTS; i++) {
+        if (cache[i].entry == entry) {
+            cache[i].lastUse = ++useCounter;
+            hits++;
+            return cache[i].data;
+        }
+        if (cache[i].lastUse < victim->lastUse) victim = &cache[i];
+    }
+
+    misses++;
+    int len = lz4Decode(pack + entry->offset, entry->packedSize, victim->data, ASSET_CACHE_SLOT_BYTES);
+    if (len != (int)entry->rawSize) {
+        victim->entry = nullptr;
+        victim->lastUse = 0;
+        return nullptr;
+    }
+    victim->entry = entry;
+    victim->lastUse = ++useCounter;
+    return victim->data;
+}
+
+int AssetPack::lz4Decode(const uint8_t* src, size_t srcLen, uint8_t* dst, size_t dstCap) {
+    const uint8_t* ip = src;
+    const uint8_t* end = src + srcLen;
+    uint8_t* op = dst;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15) {
+            uint8_t b;
+            do {
+                if (ip >= end) return -1;
+                b = *ip++;
+                literals += b;
+            } while (b == 255);
+        }
+        if (literals > (size_t)(end - ip) || literals > dstCap - (op - dst)) return -1;
+        memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+        if (ip >= end) break; // Last sequence is literals only
+
+        if (end - ip < 2) return -1;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) return -1;
+
+        size_t matchLen = (token & 0x0F) + 4;
+        if ((token & 0x0F) == 15) {
+            uint8_t b;
+            do {
+                if (ip >= end) return -1;
+                b = *ip++;
+                matchLen += b;
+            } while (b == 255);
+        }
+        if (matchLen > dstCap - (op - dst)) return -1;
+
+        // Byte by byte, matches may overlap their own output
+        const uint8_t* match = op - offset;
+        while (matchLen--) *op++ = *match++;
+    }
+    return op - dst;
+}
@@ -0,0 +1,168 @@
+#include "battery_monitor.h"
+#include "sd_manager.h"
+#include <SD.h>
+#include <algorithm>
+
+// Resting voltage against charge left, a typical 1S LiPo under light load
+static const uint16_t CURVE_MV[] = {3300, 3500, 3600, 3700, 3750, 3790, 3830, 3870, 3920, 3980, 4060, 4130, 4200};
+static const uint8_t CURVE_PCT[] = {0, 3, 6, 12, 20, 30, 40, 50, 60, 70, 80, 90, 100};
+#define CURVE_POINTS (sizeof(CURVE_MV) / sizeof(CURVE_MV[0]))
+
+float batteryPercent(uint16_t mv) {
+    if (mv <= CURVE_MV[0]) return 0;
+    for (uint8_t i = 1; i < CURVE_POINTS; i++) {
+        if (mv < CURVE_MV[i]) {
+            return CURVE_PCT[i - 1] + (float)(CURVE_PCT[i] - CURVE_PCT[i - 1]) * (mv - CURVE_MV[i - 1]) /
+                                          (CURVE_MV[i] - CURVE_MV[i - 1]);
+        }
+    }
+    return 100;
+}
+
+// --- Filter ---
+
+void BatteryFilter::reset() {
+    value = 0;
+    count = 0;
+}
+
+uint16_t BatteryFilter::add(uint16_t mv) {
+    last[0] = last[1];
+    last[1] = last[2];
+    last[2] = mv;
+    if (count < 3) count++;
+
+    uint16_t m = mv;
+    if (count == 3) {
+        uint16_t a = last[0], b = last[1], c = last[2];
+        m = std::max(std::min(a, b), std::min(std::max(a, b), c));
+    }
+    if (count == 1) value = (int32_t)m << 4;
+    else value += (((int32_t)m << 4) - value) >> BATTERY_FILTER_SHIFT;
+    return get();
+}
+
+// --- Trend ---
+
+void BatteryTrend::reset() {
+    head = count = 0;
+    rate = 0;
+    state = BATTERY_UNKNOWN;
+}
+
+void BatteryTrend::add(uint32_t ms, uint16_t mv) {
+    // The charger holds the cell up, nothing to learn about the charge from it
+    if (mv >= BATTERY_USB_MV) {
+        reset();
+        state = BATTERY_CHARGING;
+        return;
+    }
+    if (count > 0) {
+        uint16_t previous = levels[(head + BATTERY_TREND_POINTS - 1) % BATTERY_TREND_POINTS];
+        if (abs((int)mv - (int)previous) > BATTERY_JUMP_MV) reset();
+    }
+    times[head] = ms;
+    levels[head] = mv;
+    head = (head + 1) % BATTERY_TREND_POINTS;
+    if (count < BATTERY_TREND_POINTS) count++;
+    fit();
+}
+
+void BatteryTrend::fit() {
+    if (count < BATTERY_TREND_MIN) {
+        rate = 0;
+        state = BATTERY_UNKNOWN;
+        return;
+    }
+    // Minutes since the oldest point, so the sums stay small in a float
+    uint8_t oldest = (head + BATTERY_TREND_POINTS - count) % BATTERY_TREND_POINTS;
+    float sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t slot = (oldest + i) % BATTERY_TREND_POINTS;
+        float x = (times[slot] - times[oldest]) / 60000.0f;
+        float y = batteryPercent(levels[slot]);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    float d = count * sxx - sx * sx;
+    rate = d > 0 ? (count * sxy - sx * sy) / d * 60 : 0;
+    state = rate > BATTERY_RISE_PCT_H ? BATTERY_CHARGING : BATTERY_DISCHARGING;
+}
+
+int32_t BatteryTrend::getMinutesLeft() const {
+    if (state != BATTERY_DISCHARGING || rate > -BATTERY_FALL_PCT_H) return -1;
+    uint16_t newest = levels[(head + BATTERY_TREND_POINTS - 1) % BATTERY_TREND_POINTS];
+    return (int32_t)(batteryPercent(newest) / -rate * 60);
+}
+
+// --- Monitor ---
+
+void BatteryMonitor::begin(uint8_t batteryPin) {
+    pin = batteryPin;
+    filter.reset();
+    trend.reset();
+    filter.add(sample());
+    lastSampleMs = lastTrendMs = millis();
+    trend.add(lastTrendMs, filter.get());
+}
+
+// analogReadMilliVolts() applies the eFuse calibration (two point or Vref)
+// the factory burned into this chip, a plain analogRead() is off by up to ~100mV
+uint16_t BatteryMonitor::sample() {
+    uint32_t sum = 0, lowest = UINT32_MAX, highest = 0;
+    for (uint8_t i = 0; i < BATTERY_OVERSAMPLE; i++) {
+        uint32_t mv = analogReadMilliVolts(pin);
+        sum += mv;
+        lowest = std::min(lowest, mv);
+        highest = std::max(highest, mv);
+    }
+    reads += BATTERY_OVERSAMPLE;
+    return (sum - lowest - highest) * 2 / (BATTERY_OVERSAMPLE - 2); // 1:2 divider
+}
+
+bool BatteryMonitor::poll() {
+    uint32_t now = millis();
+    if (now - lastSampleMs < BATTERY_SAMPLE_MS) return false;
+    lastSampleMs = now;
+    filter.add(sample());
+    if (now - lastTrendMs < BATTERY_TREND_MS) return false;
+    lastTrendMs = now;
+
+    bool wasDischarging = trend.getState() == BATTERY_DISCHARGING;
+    trend.add(now, filter.get());
+    if (wasDischarging && trend.getState() != BATTERY_DISCHARGING) flushLog(); // That curve ended
+    return true;
+}
+
+BatteryState BatteryMonitor::getState() const {
+    if (filter.get() >= BATTERY_USB_MV) return BATTERY_CHARGING; // Known before the first trend point
+    return trend.getState();
+}
+
+void BatteryMonitor::logPoint(uint32_t unixTime) {
+    if (logLen + BATTERY_LOG_LINE_MAX > sizeof(logBuffer)) flushLog();
+    int n = snprintf(logBuffer + logLen, sizeof(logBuffer) - logLen, "%lu,%lu,%u,%u,%ld\n", (unsigned long)unixTime,
+                     (unsigned long)(millis() / 1000), filter.get(), getPercent(), (long)getMinutesLeft());
+    if (n > 0 && logLen + n < sizeof(logBuffer)) logLen += n;
+}
+
+void BatteryMonitor::flushLog() {
+    extern SDManager sdManager;
+    if (logLen == 0) return;
+    // The file is only open for the write, USB Storage may take the card away in between
+    if (sdManager.isMounted()) {
+        if (!SD.exists(BATTERY_LOG_DIR)) SD.mkdir(BATTERY_LOG_DIR);
+        bool isNew = !SD.exists(BATTERY_LOG_FILE);
+        File file = SD.open(BATTERY_LOG_FILE, FILE_APPEND);
+        if (file) {
+            if (isNew) file.print(BATTERY_LOG_HEADER);
+            file.write((const uint8_t*)logBuffer, logLen);
+            file.close();
+        } else {
+            Serial.println("Battery: failed to open " BATTERY_LOG_FILE);
+        }
+    }
+    logLen = 0; // Without a card the rows are dropped, the buffer is not a backlog
+}
@@ -0,0 +1,52 @@
+#include "bitmap_blit.h"
+#include <algorithm>
+
+// The ESP32-S3's PIE vector unit could expand 16 bits per instruction, but
+// the table lookup already runs faster than the SPI bus drains, so the
+// portable path is the only one.
+void BitmapBlitter::setColors(uint16_t fg, uint16_t bg) {
+    if (lutValid && fg == lutFg && bg == lutBg) return;
+    uint16_t f = fg >> 8 | fg << 8; // The panel takes the high byte first
+    uint16_t b = bg >> 8 | bg << 8;
+    for (int n = 0; n < 16; n++) {
+        for (int i = 0; i < 4; i++) lut[n][i] = n & (8 >> i) ? f : b;
+    }
+    lutFg = fg;
+    lutBg = bg;
+    lutValid = true;
+}
+
+void BitmapBlitter::expandRow(const uint8_t* bits, uint16_t w, uint16_t* out) {
+    uint16_t x = 0;
+    for (; x + 8 <= w; x += 8, bits++) {
+        memcpy(out + x, lut[*bits >> 4], 8);
+        memcpy(out + x + 4, lut[*bits & 0x0F], 8);
+    }
+    if (x == w) return;
+    // Last byte of the row, only its leading bits are pixels
+    uint16_t rest = w - x;
+    memcpy(out + x, lut[*bits >> 4], std::min<uint16_t>(rest, 4) * 2);
+    if (rest > 4) memcpy(out + x + 4, lut[*bits & 0x0F], (rest - 4) * 2);
+}
+
+void BitmapBlitter::push(TFT_eSPI* tft, int32_t x, int32_t y, int16_t w, int16_t rows) {
+    tft->pushImage(x, y, w, rows, buffer);
+    pushes++;
+}
+
+void BitmapBlitter::draw(TFT_eSPI* tft, int32_t x, int32_t y, const uint8_t* bitmap, int16_t w, int16_t h, uint16_t fg,
+                         uint16_t bg) {
+    if (w <= 0 || h <= 0) return;
+    if (w > BLIT_BUFFER_PIXELS) {
+        tft->drawBitmap(x, y, bitmap, w, h, fg, bg);
+        return;
+    }
+    setColors(fg, bg);
+    int16_t stride = (w + 7) / 8;
+    int16_t band = BLIT_BUFFER_PIXELS / w; // Rows per push
+    for (int16_t row = 0; row < h; row += band) {
+        int16_t rows = std::min<int16_t>(band, h - row);
+        for (int16_t r = 0; r < rows; r++) expandRow(bitmap + (row + r) * stride, w, buffer + r * w);
+        push(tft, x, y + row, w, rows);
+    }
+}
@@ -0,0 +1,47 @@
+#include "boot_profiler.h"
+
+void BootProfiler::begin() {
+    phaseCount = 0;
+    totalUs = 0;
+    // Time before setup() (bootloader, static init) counts as its own phase
+    lastMarkUs = 0;
+    mark("Startup");
+}
+
+uint32_t BootProfiler::now() {
+    return micros();
+}
+
+void BootProfiler::mark(const char* name) {
+    uint32_t t = now();
+    record(name, lastMarkUs, t);
+    lastMarkUs = t;
+}
+
+void BootProfiler::record(const char* name, uint32_t startUs, uint32_t endUs) {
+    // RTC init reports from its own task, so guard the table
+    portENTER_CRITICAL(&lock);
+    if (phaseCount < BOOT_MAX_PHASES) {
+        phases[phaseCount].name = name;
+        phases[phaseCount].startUs = startUs;
+        phases[phaseCount].endUs = endUs;
+        phaseCount++;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void BootProfiler::finish() {
+    mark("Menu");
+    totalUs = lastMarkUs;
+}
+
+void BootProfiler::printReport() {
+    Serial.println("--- Boot Profile ---");
+    for (int i = 0; i < phaseCount; i++) {
+        Serial.printf("%-10s %6lu -> %6lu ms (%lu ms)\n", phases[i].name,
+                      (unsigned long)(phases[i].startUs / 1000),
+                      (unsigned long)(phases[i].endUs / 1000),
+                      (unsigned long)((phases[i].endUs - phases[i].startUs) / 1000));
+    }
+    Serial.printf("Boot to menu: %lu ms (target %d ms) %s\n", (unsigned long)getTotalMs(), BOOT_TARGET_MS, metTarget() ? "OK" : "SLOW");
+}
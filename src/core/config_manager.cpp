@@ -38,6 +38,16 @@ bool ConfigManager::load(String path) {
         data.badusbAutoExec = badusb["auto_execute"] | false;
     }
 
+    // LoRa
+    if (doc.containsKey("lora")) {
+        JsonObject lora = doc["lora"];
+        data.loraFrequency = lora["frequency"] | 915000000L;
+        data.loraSpreadingFactor = lora["spreading_factor"] | 7;
+        data.loraBandwidth = lora["bandwidth"] | 125000L;
+        data.loraCodingRate = lora["coding_rate"] | 5;
+        data.loraTxPower = lora["tx_power"] | 17;
+    }
+
     return true;
 }
 
@@ -74,6 +84,14 @@ bool ConfigManager::save(String path) {
     badusb["startup_delay_ms"] = data.badusbStartupDelay;
     badusb["auto_execute"] = data.badusbAutoExec;
 
+    JsonObject lora = doc["lora"];
+    if (lora.isNull()) lora = doc.createNestedObject("lora");
+    lora["frequency"] = data.loraFrequency;
+    lora["spreading_factor"] = data.loraSpreadingFactor;
+    lora["bandwidth"] = data.loraBandwidth;
+    lora["coding_rate"] = data.loraCodingRate;
+    lora["tx_power"] = data.loraTxPower;
+
     String output;
     serializeJsonPretty(doc, output);
     return sdManager.writeFile(path, output);
@@ -4,6 +4,8 @@
 
 #define PIN_BAT_VOLT 4
 
+ThemePalette activeTheme = THEMES[0];
+
 DisplayManager::DisplayManager() {
     tft = new TFT_eSPI();
     rtcInitialized = false;
@@ -16,6 +18,7 @@ void DisplayManager::init() {
 
     // Battery Pin
     pinMode(PIN_BAT_VOLT, INPUT);
+    battery.begin(PIN_BAT_VOLT);
 
     tft->init();
     tft->setRotation(3); // Landscape
@@ -33,19 +36,43 @@ void DisplayManager::setBrightness(int brightness) {
     ledcWrite(0, brightness);
 }
 
-void DisplayManager::initRTC() {
+bool DisplayManager::setTheme(const String& name) {
+    int index = themeIndex(name.c_str());
+    if (index < 0) {
+        Serial.println("Unknown theme " + name + ", using " + String(THEMES[0].name));
+        index = 0;
+    }
+    if (activeTheme.name == THEMES[index].name) return false;
+    activeTheme = THEMES[index];
+    repaintPending = true;
+    return true;
+}
+
+bool DisplayManager::takeRepaint() {
+    bool pending = repaintPending;
+    repaintPending = false;
+    return pending;
+}
+
+bool DisplayManager::initRTC(uint32_t timeoutMs) {
     // Enable external power (Pin 17) for I2C devices
     pinMode(17, OUTPUT);
     digitalWrite(17, HIGH);
-    delay(100);
 
     Wire.begin(43, 44);
-    if (!rtc.begin()) {
+    // Poll until the DS3231 answers instead of waiting a fixed settle time
+    unsigned long start = millis();
+    bool found = rtc.begin();
+    while (!found && millis() - start < timeoutMs) {
+        delay(10);
+        found = rtc.begin();
+    }
+    if (!found) {
         Serial.println("Couldn't find RTC");
-        rtcInitialized = false;
-    } else {
-        rtcInitialized = true;
     }
+    // Published once the RTC is set up, this may run on a boot task
+    rtcInitialized = found;
+    return found;
 }
 
 void DisplayManager::turnOff() {
@@ -77,7 +104,7 @@ void DisplayManager::drawStatusBar(String status, float voltage, bool sdStatus,
     tft->setTextDatum(MC_DATUM);
     tft->setTextPadding(100);
     if (showClock) {
-        if (rtcInitialized) {
+        if (rtcReadable()) {
             DateTime now = rtc.now();
             char timeStr[10];
             sprintf(timeStr, "%02d:%02d:%02d", now.hour(), now.minute(), now.second());
@@ -95,28 +122,27 @@ void DisplayManager::drawStatusBar(String status, float voltage, bool sdStatus,
     tft->drawString((String(voltage, 2) + "V").c_str(), 320, 10, 2);
     tft->setTextPadding(0);
 
-    // Draw WiFi Icon
-    tft->fillRect(215, 2, 18, 16, THEME_SECONDARY);
+    // Draw WiFi Icon, the icons are opaque so only the columns next to them need clearing
     if (wifiStatus) {
-        tft->setTextColor(TFT_CYAN, THEME_SECONDARY);
-        tft->drawBitmap(215, 2, image_cloud_sync_bits, 17, 16, TFT_CYAN);
+        drawIcon(215, 2, image_cloud_sync_bits, 17, 16, THEME_OK, THEME_SECONDARY);
+        tft->fillRect(232, 2, 1, 16, THEME_SECONDARY);
+    } else {
+        tft->fillRect(215, 2, 18, 16, THEME_SECONDARY);
     }
 
     // Draw SD Icon
-    tft->fillRect(235, 2, 15, 16, THEME_SECONDARY);
-    uint16_t color = sdStatus ? TFT_CYAN : TFT_RED; // White
-    tft->drawBitmap(235, 2, sdStatus ? image_micro_sd_bits : image_micro_sd_no_card_bits, 14, 16, color);
+    uint16_t color = sdStatus ? THEME_OK : THEME_ERROR;
+    drawIcon(235, 2, sdStatus ? image_micro_sd_bits : image_micro_sd_no_card_bits, 14, 16, color, THEME_SECONDARY);
+    tft->fillRect(249, 2, 1, 16, THEME_SECONDARY);
     
     // Draw Battery Icon
-    tft->fillRect(255, 2, 25, 16, THEME_SECONDARY);
+    tft->fillRect(279, 2, 1, 16, THEME_SECONDARY);
     const unsigned char* batIcon = image_battery_full_bits;
     
-    if (voltage >= 4.25) {
+    if (voltage >= BATTERY_USB_MV / 1000.0 || battery.getState() == BATTERY_CHARGING) {
         batIcon = image_battery_charging_bits;
     } else {
-        float percentage = (voltage - 3.3) / (4.2 - 3.3);
-        if (percentage < 0) percentage = 0;
-        if (percentage > 1) percentage = 1;
+        float percentage = batteryPercent(voltage * 1000) / 100;
         
         if (percentage < 0.10) batIcon = image_battery_0_bits;
         else if (percentage < 0.25) batIcon = image_battery_17_bits;
@@ -127,19 +153,24 @@ void DisplayManager::drawStatusBar(String status, float voltage, bool sdStatus,
         else batIcon = image_battery_full_bits;
     }
     
-    tft->drawBitmap(255, 2, batIcon, 24, 16, THEME_TEXT);
+    drawIcon(255, 2, batIcon, 24, 16, THEME_TEXT, THEME_SECONDARY);
     
     tft->setTextColor(THEME_TEXT, THEME_BG); // Reset
 }
 
 float DisplayManager::getBatteryVoltage() {
-    uint32_t raw = analogRead(PIN_BAT_VOLT);
-    return (raw * 2.0 * 3.3) / 4096.0;
+    return battery.getVoltage();
 }
 
 bool DisplayManager::isOnBattery() {
-    float voltage = getBatteryVoltage();
-    return voltage < 4.0;  // Adjust threshold if needed (e.g., < 4.5 for USB detection)
+    return battery.getState() != BATTERY_CHARGING;
+}
+
+void DisplayManager::pollBattery() {
+    // The RTC is only read for the log rows, one a minute while discharging
+    if (battery.poll() && battery.getState() == BATTERY_DISCHARGING) {
+        battery.logPoint(rtcReadable() ? rtc.now().unixtime() : 0);
+    }
 }
 
 void DisplayManager::drawMenuTitle(String title) {
@@ -147,7 +178,10 @@ void DisplayManager::drawMenuTitle(String title) {
 }
 
 void DisplayManager::drawMenuItem(String text, int index, bool selected, const unsigned char* icon, int iconWidth, int iconHeight, int iconSpacing, int iconOffsetY) {
-    int yPos = 25 + (index * 25); 
+    drawMenuItemAt(text, 25 + (index * 25), selected, icon, iconWidth, iconHeight, iconSpacing, iconOffsetY);
+}
+
+void DisplayManager::drawMenuItemAt(const String& text, int yPos, bool selected, const unsigned char* icon, int iconWidth, int iconHeight, int iconSpacing, int iconOffsetY) {
     int radius = 4;
     int width = 290;
     
@@ -158,12 +192,12 @@ void DisplayManager::drawMenuItem(String text, int index, bool selected, const u
         tft->fillRoundRect(10, yPos, width, 22, radius, THEME_BG);
         tft->setTextColor(THEME_TEXT, THEME_BG);
     }
-    tft->drawRoundRect(10, yPos, width, 22, radius, TFT_WHITE);
+    tft->drawRoundRect(10, yPos, width, 22, radius, THEME_BORDER);
     
     int textX = 20;
     if (icon) {
         int iconY = yPos + (22 - iconHeight) / 2 + iconOffsetY;
-        tft->drawBitmap(textX, iconY, icon, iconWidth, iconHeight, THEME_TEXT);
+        drawIcon(textX, iconY, icon, iconWidth, iconHeight, THEME_TEXT, selected ? THEME_PRIMARY : THEME_BG);
         textX += iconWidth + iconSpacing;
     }
     
@@ -171,6 +205,11 @@ void DisplayManager::drawMenuItem(String text, int index, bool selected, const u
     tft->drawString(text.c_str(), textX, yPos + 11, 2);
 }
 
+void DisplayManager::drawIcon(int32_t x, int32_t y, const unsigned char* bitmap, int16_t w, int16_t h, uint16_t fg,
+                              uint16_t bg) {
+    blitter.draw(tft, x, y, bitmap, w, h, fg, bg);
+}
+
 void DisplayManager::drawScrollBar(int totalItems, int currentItem, int visibleItems) {
     if (totalItems <= visibleItems) return;
     
@@ -189,11 +228,11 @@ void DisplayManager::drawScrollBar(int totalItems, int currentItem, int visibleI
     float scrollRatio = (float)currentItem / maxScroll;
     int maxThumbY = scrollBarHeight - thumbHeight;
     int thumbY = scrollBarY + (scrollRatio * maxThumbY);
-    tft->fillRoundRect(scrollBarX + 1, thumbY + 1, scrollBarWidth - 2, thumbHeight - 2, 2, TFT_WHITE);
+    tft->fillRoundRect(scrollBarX + 1, thumbY + 1, scrollBarWidth - 2, thumbHeight - 2, 2, THEME_BORDER);
 }
 
 void DisplayManager::updateClock() {
-    if (rtcInitialized) {
+    if (rtcReadable()) {
         DateTime now = rtc.now();
         char timeStr[10];
         sprintf(timeStr, "%02d:%02d:%02d", now.hour(), now.minute(), now.second());
@@ -219,13 +258,13 @@ void DisplayManager::updateClock() {
 }
 
 void DisplayManager::setTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
-    if (rtcInitialized) {
+    if (rtcReadable()) {
         rtc.adjust(DateTime(year, month, day, hour, minute, second));
     }
 }
 
 DateTime DisplayManager::getTime() {
-    if (rtcInitialized) {
+    if (rtcReadable()) {
         return rtc.now();
     }
     return DateTime((uint32_t)0);
@@ -0,0 +1,167 @@
+#include "list_view.h"
+#include "display_manager.h"
+#include <algorithm>
+
+// Where drawMenuItem puts its rows
+#define LIST_X      10
+#define LIST_Y      25
+#define LIST_W      290
+#define LIST_ROW_H  22
+#define LIST_RADIUS 4    // Corner columns a moved row has to clear itself
+#define LIST_H      (LIST_ROWS * LIST_ROW_PITCH)
+#define LIST_BAR_X  308
+#define LIST_BAR_W  6
+#define LIST_ALL_ROWS ((1 << LIST_ROWS) - 1)
+
+void ListView::begin(DisplayManager* displayManager, ListSource rowSource) {
+    display = displayManager;
+    source = rowSource;
+}
+
+void ListView::reset(int n) {
+    count = n > 0 ? n : 0;
+    selected = offset = drawnOffset = 0;
+    staleRows = LIST_ALL_ROWS;
+    scrollBarStale = true;
+}
+
+void ListView::setCount(int n) {
+    n = n > 0 ? n : 0;
+    if (n == count) return;
+    // Rows between the old and the new end appear or go blank
+    for (int i = 0; i < LIST_ROWS; i++) {
+        int index = drawnOffset + i;
+        if (index >= std::min(n, count) && index < std::max(n, count)) staleRows |= 1 << i;
+    }
+    count = n;
+    scrollBarStale = true;
+    select(selected);
+}
+
+void ListView::select(int index) {
+    if (count == 0) {
+        selected = offset = 0;
+        return;
+    }
+    index = constrain(index, 0, count - 1);
+    if (index != selected) {
+        invalidate(selected);
+        invalidate(index);
+        selected = index;
+    }
+    follow();
+}
+
+void ListView::next() {
+    if (count > 0) select(selected + 1 < count ? selected + 1 : 0);
+}
+
+void ListView::invalidate(int index) {
+    int row = index - drawnOffset;
+    if (row >= 0 && row < LIST_ROWS) staleRows |= 1 << row;
+}
+
+void ListView::follow() {
+    if (selected < offset) offset = selected - (LIST_SCROLL_ROWS - 1);
+    else if (selected >= offset + LIST_ROWS) offset = selected - (LIST_ROWS - LIST_SCROLL_ROWS);
+    // No blank rows at the bottom while items are hidden above
+    offset = constrain(offset, 0, std::max(count - LIST_ROWS, 0));
+}
+
+void ListView::draw() {
+    lastPixels = 0;
+    drawnOffset = offset;
+    for (int i = 0; i < LIST_ROWS && offset + i < count; i++) drawRow(offset + i, LIST_Y + i * LIST_ROW_PITCH, false);
+    staleRows = 0;
+    scrollBarStale = true;
+    drawScrollBar();
+}
+
+void ListView::update() {
+    lastPixels = 0;
+    if (offset != drawnOffset) {
+        bool slid = false;
+#if LIST_SLIDE
+        if (abs(offset - drawnOffset) <= LIST_SCROLL_ROWS) {
+            slide();
+            slid = true;
+        }
+#endif
+        staleRows = slid ? 0 : LIST_ALL_ROWS;
+        drawnOffset = offset;
+        scrollBarStale = true;
+    }
+    for (int i = 0; i < LIST_ROWS && staleRows; i++) {
+        if (!(staleRows & (1 << i))) continue;
+        int y = LIST_Y + i * LIST_ROW_PITCH;
+        if (offset + i < count) {
+            drawRow(offset + i, y, false);
+        } else {
+            display->getTFT()->fillRect(LIST_X, y, LIST_W, LIST_ROW_H, THEME_BG);
+            lastPixels += LIST_W * LIST_ROW_H;
+        }
+    }
+    staleRows = 0;
+    if (scrollBarStale) {
+        display->getTFT()->fillRect(LIST_BAR_X, LIST_Y, LIST_BAR_W, LIST_H, THEME_BG);
+        lastPixels += LIST_BAR_W * LIST_H;
+        drawScrollBar();
+    }
+}
+
+// A clean row also clears its corners and the gap below it, which a row
+// that is not in its usual place cannot count on being background
+void ListView::drawRow(int index, int y, bool clean) {
+    TFT_eSPI* tft = display->getTFT();
+    int h = clean ? LIST_ROW_PITCH : LIST_ROW_H;
+    if (clean) {
+        tft->fillRect(LIST_X, y, LIST_RADIUS, LIST_ROW_H, THEME_BG);
+        tft->fillRect(LIST_X + LIST_W - LIST_RADIUS, y, LIST_RADIUS, LIST_ROW_H, THEME_BG);
+        tft->fillRect(LIST_X, y + LIST_ROW_H, LIST_W, LIST_ROW_PITCH - LIST_ROW_H, THEME_BG);
+    }
+    // Only what is inside the list counts, a sliding row is partly outside
+    int top = std::max(y, LIST_Y);
+    int bottom = std::min(y + h, LIST_Y + LIST_H);
+    if (bottom > top) lastPixels += LIST_W * (bottom - top);
+    if (index >= count) {
+        tft->fillRect(LIST_X, y, LIST_W, h, THEME_BG);
+        return;
+    }
+    row.text = "";
+    row.icon = nullptr;
+    row.iconWidth = row.iconHeight = 16;
+    row.iconSpacing = 8;
+    row.iconOffsetY = 0;
+    source(index, row);
+    display->drawMenuItemAt(row.text, y, index == selected, row.icon, row.iconWidth, row.iconHeight, row.iconSpacing,
+                            row.iconOffsetY);
+}
+
+void ListView::drawScrollBar() {
+    if (scrollBarStale && count > LIST_ROWS) {
+        display->drawScrollBar(count, offset, LIST_ROWS);
+        lastPixels += LIST_BAR_W * LIST_H;
+    }
+    scrollBarStale = false;
+}
+
+#if LIST_SLIDE
+// Every frame draws the rows a little further along, clipped to the list,
+// so the old rows slide out as the new ones slide in. The last frame leaves
+// the rows where draw() would put them.
+void ListView::slide() {
+    TFT_eSPI* tft = display->getTFT();
+    tft->setViewport(LIST_X, LIST_Y, LIST_W, LIST_H, false);
+    int from = drawnOffset * LIST_ROW_PITCH;
+    int to = offset * LIST_ROW_PITCH;
+    int steps = (abs(to - from) + LIST_SCROLL_PX - 1) / LIST_SCROLL_PX;
+    for (int step = 1; step <= steps; step++) {
+        int pos = from + (to - from) * step / steps;
+        int first = pos / LIST_ROW_PITCH;
+        int last = (pos + LIST_H - 1) / LIST_ROW_PITCH;
+        for (int index = first; index <= last; index++) drawRow(index, LIST_Y + index * LIST_ROW_PITCH - pos, true);
+        if (step < steps) delay(LIST_FRAME_MS);
+    }
+    tft->resetViewport();
+}
+#endif
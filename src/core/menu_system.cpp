@@ -1,23 +1,46 @@
 #include "menu_system.h"
 #include "driver/rtc_io.h"
+#include "../ui/icons.h"
 
 #define PIN_EXT_POWER 17
 
-MenuSystem::MenuSystem(DisplayManager* display, SDManager* sd) : displayManager(display), sdManager(sd), selectedIndex(0), scrollOffset(0), inModule(false), activeModule(nullptr), isDeepSleepPending(false), deepSleepStartTime(0) {}
+MenuSystem::MenuSystem(DisplayManager* display, SDManager* sd) : displayManager(display), sdManager(sd), inModule(false), activeModule(nullptr), activeIndex(-1), isDeepSleepPending(false), deepSleepStartTime(0) {
+    moduleList.begin(display, [this](int index, ListRow& row) {
+        if (registry.isResident(index)) {
+            Module* mod = registry.get(index);
+            row.text = mod->getName();
+            row.icon = mod->getIcon();
+            row.iconWidth = mod->getIconWidth();
+            row.iconHeight = mod->getIconHeight();
+            row.iconSpacing = mod->getIconSpacing();
+            row.iconOffsetY = mod->getIconOffsetY();
+            return;
+        }
+        // Lazy modules are listed from their descriptor, loaded or not
+        const ModuleDescriptor& d = registry.getDescriptor(index);
+        row.text = d.name;
+        row.icon = d.icon ? ICON(d.icon) : nullptr;
+        row.iconWidth = d.iconWidth;
+        row.iconHeight = d.iconHeight;
+        row.iconSpacing = d.iconSpacing;
+        row.iconOffsetY = d.iconOffsetY;
+    });
+}
 
 void MenuSystem::registerModule(Module* module) {
-    modules.push_back(module);
+    registry.add(module);
+    moduleList.setCount(registry.count());
+}
+
+void MenuSystem::registerModule(const ModuleDescriptor& module) {
+    registry.add(module);
+    moduleList.setCount(registry.count());
 }
 
 void MenuSystem::draw() {
+    displayManager->takeRepaint(); // This is the full redraw a theme change asks for
     // Check for background modules
-    bool wifiActive = false;
-    for (auto* mod : modules) {
-        if (mod->isBackgroundRunning()) {
-            wifiActive = true;
-            break;
-        }
-    }
+    bool wifiActive = registry.anyBackground();
 
     // Always draw status bar
     String statusText = inModule && activeModule ? activeModule->getName() : "Main Menu";
@@ -28,15 +51,7 @@ void MenuSystem::draw() {
     } else {
         displayManager->clearContent();
         // displayManager->drawMenuTitle("ESP-Chain"); // Removed title
-        
-        int start = scrollOffset;
-        int end = start + itemsPerPage;
-        if (end > modules.size()) end = modules.size();
-
-        for (int i = start; i < end; i++) {
-            displayManager->drawMenuItem(modules[i]->getName(), i - scrollOffset, i == selectedIndex, modules[i]->getIcon(), modules[i]->getIconWidth(), modules[i]->getIconHeight(), modules[i]->getIconSpacing(), modules[i]->getIconOffsetY());
-        }
-        displayManager->drawScrollBar(modules.size(), scrollOffset, itemsPerPage);
+        moduleList.draw();
     }
 }
 
@@ -52,6 +67,11 @@ void MenuSystem::handleInput(uint8_t input) {
         if (!activeModule->handleInput(input)) {
             inModule = false;
             activeModule = nullptr;
+            registry.release(activeIndex); // Its heap is back before the menu draws
+            registry.printReport(activeIndex);
+            activeIndex = -1;
+            draw();
+        } else if (displayManager->takeRepaint()) {
             draw();
         }
         return;
@@ -62,33 +82,25 @@ void MenuSystem::handleInput(uint8_t input) {
         case 0: // Up (Not used)
             break;
         case 1: // Down (Single Click)
-            if (selectedIndex < modules.size() - 1) {
-                selectedIndex++;
-            } else {
-                selectedIndex = 0;
-            }
-
-            // Center selection
-            {
-                int halfPage = itemsPerPage / 2;
-                if (selectedIndex <= halfPage) {
-                    scrollOffset = 0;
-                } else if (selectedIndex >= (int)modules.size() - halfPage) {
-                    scrollOffset = (int)modules.size() - itemsPerPage;
-                } else {
-                    scrollOffset = selectedIndex - halfPage;
-                }
-                if (scrollOffset < 0) scrollOffset = 0;
-            }
-
-            draw();
+            // Only the rows that change are drawn, the status bar keeps its once a second refresh
+            moduleList.next();
+            moduleList.update();
             break;
         case 2: // Select (Double Click)
-            if (modules.size() > 0) {
-                activeModule = modules[selectedIndex];
-                inModule = true;
+            if (registry.count() > 0) {
                 displayManager->clearContent(); // Clear only content area
-                activeModule->init();
+                activeIndex = moduleList.getSelected();
+                activeModule = registry.acquire(activeIndex); // Constructs and inits it
+                if (!activeModule) {
+                    activeIndex = -1;
+                    displayManager->getTFT()->setTextDatum(MC_DATUM);
+                    displayManager->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
+                    displayManager->getTFT()->drawString("Not enough memory", 160, 80, 4);
+                    delay(1500);
+                    draw();
+                    break;
+                }
+                inModule = true;
                 // activeModule->drawMenu(displayManager); // Let the loop handle drawing or call it here
                 draw();
             }
@@ -99,7 +111,7 @@ void MenuSystem::handleInput(uint8_t input) {
                 deepSleepStartTime = millis();
                 displayManager->clearContent();
                 displayManager->getTFT()->setTextDatum(MC_DATUM);
-                displayManager->getTFT()->setTextColor(TFT_WHITE, TFT_BLACK);
+                displayManager->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
                 displayManager->getTFT()->drawString("Sleeping in 5s...", 160, 80, 4);
                 displayManager->getTFT()->drawString("Press any key", 160, 120, 2);
                 displayManager->getTFT()->drawString("to cancel", 160, 140, 2);
@@ -109,18 +121,15 @@ void MenuSystem::handleInput(uint8_t input) {
 }
 
 void MenuSystem::update() {
+    if (displayManager->takeRepaint()) draw();
+    displayManager->pollBattery();
+
     // Update status bar (clock, battery, etc) every second
     static unsigned long lastUpdate = 0;
     if (millis() - lastUpdate > 1000) { 
         lastUpdate = millis();
         if (!isDeepSleepPending) {
-            bool wifiActive = false;
-            for (auto* mod : modules) {
-                if (mod->isBackgroundRunning()) {
-                    wifiActive = true;
-                    break;
-                }
-            }
+            bool wifiActive = registry.anyBackground();
             String statusText = inModule && activeModule ? activeModule->getName() : "Main Menu";
             // Update status bar without full redraw
             displayManager->drawStatusBar(statusText, displayManager->getBatteryVoltage(), sdManager->isMounted(), wifiActive, true, "", false);
@@ -138,9 +147,9 @@ void MenuSystem::update() {
             if (remaining != lastRemaining) {
                 lastRemaining = remaining;
                 displayManager->getTFT()->setTextDatum(MC_DATUM);
-                displayManager->getTFT()->setTextColor(TFT_WHITE, TFT_BLACK);
+                displayManager->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
                 String msg = "Sleeping in " + String(remaining) + "s...";
-                displayManager->getTFT()->fillRect(0, 60, 320, 40, TFT_BLACK);
+                displayManager->getTFT()->fillRect(0, 60, 320, 40, THEME_BG);
                 displayManager->getTFT()->drawString(msg, 160, 80, 4);
             }
         }
@@ -151,13 +160,14 @@ void MenuSystem::update() {
         activeModule->loop();
     }
     
-    // Run background loops
-    for (auto* mod : modules) {
-        mod->backgroundLoop();
-    }
+    // Run background loops, then let go of lazy modules that went idle in the background
+    registry.backgroundLoop();
+    registry.reap();
 }
 
 void MenuSystem::enterDeepSleep() {
+    displayManager->getBattery().flushLog();
+
     // Turn off display
     displayManager->turnOff();
 
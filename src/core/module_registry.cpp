@@ -0,0 +1,103 @@
+#include "module_registry.h"
+
+// Both heaps, large buffers go to PSRAM when there is some
+static uint32_t freeBytes() {
+#ifdef SIMULATOR
+    return ESP.getFreeHeap();
+#else
+    return ESP.getFreeHeap() + ESP.getFreePsram();
+#endif
+}
+
+int ModuleRegistry::add(Module* module) {
+    Entry e;
+    e.instance = module;
+    e.resident = true;
+    entries.push_back(e);
+    return entries.size() - 1;
+}
+
+int ModuleRegistry::add(const ModuleDescriptor& descriptor) {
+    Entry e;
+    e.descriptor = descriptor;
+    entries.push_back(e);
+    return entries.size() - 1;
+}
+
+String ModuleRegistry::getName(int i) const {
+    const Entry& e = entries[i];
+    if (e.resident) return e.instance->getName();
+    return e.descriptor.name;
+}
+
+Module* ModuleRegistry::acquire(int i) {
+    Entry& e = entries[i];
+    if (!e.instance) {
+        e.freeBefore = freeBytes();
+        e.instance = e.descriptor.create ? e.descriptor.create() : nullptr;
+        if (!e.instance) {
+            Serial.println("Registry: not enough heap for " + getName(i));
+            return nullptr;
+        }
+        e.footprint.loads++;
+    } else if (e.resident) {
+        e.freeBefore = freeBytes();
+    }
+    e.inUse = true;
+    e.instance->init();
+    e.footprint.atEntry = (int32_t)(e.freeBefore - freeBytes());
+    measure(e);
+    return e.instance;
+}
+
+void ModuleRegistry::release(int i) {
+    Entry& e = entries[i];
+    e.inUse = false;
+    if (!e.instance) return;
+    measure(e);
+    if (!e.resident && !e.instance->isBackgroundRunning()) unload(e);
+}
+
+void ModuleRegistry::reap() {
+    for (auto& e : entries) {
+        if (e.instance && !e.resident && !e.inUse && !e.instance->isBackgroundRunning()) unload(e);
+    }
+}
+
+bool ModuleRegistry::anyBackground() const {
+    for (auto& e : entries) {
+        if (e.instance && e.instance->isBackgroundRunning()) return true;
+    }
+    return false;
+}
+
+void ModuleRegistry::backgroundLoop() {
+    for (auto& e : entries) {
+        if (e.instance) e.instance->backgroundLoop();
+    }
+}
+
+void ModuleRegistry::measure(Entry& e) {
+    int32_t held = (int32_t)(e.freeBefore - freeBytes());
+    if (held > e.footprint.peak) e.footprint.peak = held;
+}
+
+void ModuleRegistry::unload(Entry& e) {
+    uint32_t before = freeBytes();
+    delete e.instance;
+    e.instance = nullptr;
+    e.footprint.reclaimed = (int32_t)(freeBytes() - before);
+}
+
+void ModuleRegistry::printReport(int only) const {
+    if (only < 0) Serial.println("Module heap (bytes):");
+    for (int i = 0; i < count(); i++) {
+        if (only >= 0 && i != only) continue;
+        const Entry& e = entries[i];
+        const ModuleFootprint& f = e.footprint;
+        String line = "  " + getName(i) + ": entry " + String(f.atEntry) + ", peak " + String(f.peak);
+        if (e.resident) line += ", resident";
+        else line += ", reclaimed " + String(f.reclaimed) + ", loads " + String(f.loads) + (e.instance ? ", loaded" : "");
+        Serial.println(line);
+    }
+}
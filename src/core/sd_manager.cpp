@@ -26,6 +26,16 @@ bool SDManager::init() {
     return true;
 }
 
+bool SDManager::waitForCard(uint32_t timeoutMs) {
+    // Retry until the card finishes powering up rather than sleeping a fixed time
+    unsigned long start = millis();
+    while (!init()) {
+        if (millis() - start >= timeoutMs) return false;
+        delay(20);
+    }
+    return true;
+}
+
 void SDManager::end() {
     SD.end();
     isSDMounted = false;
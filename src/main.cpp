@@ -1,6 +1,7 @@
 #include <Arduino.h>
 #include "display_manager.h"
 #include "menu_system.h"
+#include "module_registry.h"
 #include "input_manager.h"
 #include "module_base.h"
 #include "driver/rtc_io.h"
@@ -8,13 +9,17 @@
 #include "modules/counter_module.h" // 1. Include your new module header
 #include "modules/file_explorer_module.h"
 #include "modules/settings_module.h"
-#include "modules/i2c_scanner_module.h"
+#include "modules/i2c/i2c_scanner_module.h"
 #include "modules/nrf24/nrf24_module.h"
+#include "modules/subghz/subghz_module.h"
+#include "modules/lora/lora_module.h"
 #include "modules/usb_storage_module.h"
 #include "modules/wifi_storage_module.h"
 #include "badusb_module.h"
 #include "sd_manager.h"
 #include "config_manager.h"
+#include "boot_profiler.h"
+#include "asset_pack.h"
 #include "ui/icons.h"
 
 // --- Sleep Module ---
@@ -24,8 +29,10 @@ public:
     void init() override {
         // Configure Wakeup on Button 14 (Low)
         // Ensure pullup is enabled for the button during sleep
-        // Formally stop SD card operations
+        // Formally stop SD card operations, the battery log goes first
         extern SDManager sdManager;
+        extern DisplayManager displayManager;
+        displayManager.getBattery().flushLog();
         sdManager.end();
 
         // Prevent phantom power to SD card by grounding SPI pins
@@ -73,7 +80,7 @@ public:
         display->drawMenuTitle("Deep Sleep");
         
         display->getTFT()->setTextDatum(MC_DATUM);
-        display->getTFT()->setTextColor(TFT_WHITE, TFT_BLACK); 
+        display->getTFT()->setTextColor(THEME_TEXT, THEME_BG); 
         display->getTFT()->drawString("Going to sleep...", 160, 80, 4);
         display->getTFT()->drawString("Press Btn 14", 160, 120, 2);
         display->getTFT()->drawString("to wake up", 160, 140, 2);
@@ -110,7 +117,7 @@ public:
         display->clearContent();
         
         display->getTFT()->setTextDatum(ML_DATUM);
-        display->getTFT()->setTextColor(TFT_WHITE, TFT_BLACK);
+        display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
         
         display->getTFT()->drawString("ESP-Chain Matt3r FW beta v0", 20, 60, 2);
         display->getTFT()->drawString("LilyGo T-Display S3", 20, 85, 2);
@@ -118,6 +125,12 @@ public:
         
         String flashSize = "Flash: " + String(ESP.getFlashChipSize() / (1024 * 1024)) + "MB";
         display->getTFT()->drawString(flashSize, 20, 135, 2);
+
+        extern BootProfiler bootProfiler;
+        String bootTime = "Boot: " + String(bootProfiler.getTotalMs()) + "ms (target " + String(BOOT_TARGET_MS) + "ms)";
+        display->getTFT()->setTextColor(bootProfiler.metTarget() ? THEME_OK : THEME_WARN, THEME_BG);
+        display->getTFT()->drawString(bootTime, 20, 160, 2);
+        display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
         
         display->getTFT()->drawString("Long Press Btn 14", 20, 180, 2);
         display->getTFT()->drawString("to exit", 20, 205, 2);
@@ -135,50 +148,93 @@ SDManager sdManager;
 MenuSystem menuSystem(&displayManager, &sdManager);
 InputManager inputManager(&menuSystem);
 
-// 2. Instantiate your modules
-AboutModule aboutModule;
-SleepModule sleepModule;
-WiFiModule wifiModule;
-CounterModule counterModule;
-FileExplorerModule fileExplorerModule;
-SettingsModule settingsModule;
-BadUSBModule badusbModule;
-I2CScannerModule i2cScannerModule;
-NRF24Module nrf24Module;
-USBStorageModule usbStorageModule;
-WiFiStorageModule wifiStorageModule;
+// 2. Describe your modules: menu name, icon from the asset pack (width,
+// height, spacing, y offset) and a factory. Each one is constructed when it
+// is opened and deleted when it is left, unless it keeps running in the
+// background; until then the menu only needs this table.
+static const ModuleDescriptor MODULES[] = {
+    {"WiFi Tools",    "wifi",                        19, 16, 13, 0, makeModule<WiFiModule>},
+    {"BadUSB",        "monitor",                     16, 16, 16, 0, makeModule<BadUSBModule>},
+    {"NRF24 Tools",   "music_radio_streaming",       17, 16, 14, 1, makeModule<NRF24Module>},
+    {"SubGHz",        "music_radio_streaming",       17, 16, 14, 1, makeModule<SubGHzModule>},
+    {"LoRa",          "music_radio_streaming",       17, 16, 14, 1, makeModule<LoRaModule>},
+    {"File Explorer", "folder_explorer",             24, 16, 6,  0, makeModule<FileExplorerModule>},
+    {"USB Storage",   nullptr,                       16, 16, 8,  0, makeModule<USBStorageModule>},
+    {"WiFi Storage",  nullptr,                       16, 16, 8,  0, makeModule<WiFiStorageModule>},
+    {"Deep Sleep",    "device_sleep_mode_white",     15, 16, 8,  1, makeModule<SleepModule>},
+    {"Settings",      "menu_options",                14, 16, 8,  1, makeModule<SettingsModule>},
+    {"I2C Scanner",   nullptr,                       16, 16, 8,  0, makeModule<I2CScannerModule>},
+    {"About",         "menu_information_sign_white", 15, 16, 8,  0, makeModule<AboutModule>},
+};
 
 int PIN_EXT_POWER = 17;
 
+BootProfiler bootProfiler;
+
+// Boot timeouts: readiness is polled, these are only upper bounds
+#define EXT_POWER_OFF_MS   250  // SD card needs this long unpowered to reset
+#define SD_READY_TIMEOUT   1000
+#define RTC_READY_TIMEOUT  500
+#define SD_FAIL_NOTICE_MS  2000 // Skippable with Btn 14
+
+static SemaphoreHandle_t rtcReady = nullptr;
+
+// RTC lives on I2C and the SD card on SPI, so they can come up in parallel
+static void rtcInitTask(void* param) {
+    uint32_t start = bootProfiler.now();
+    displayManager.initRTC(RTC_READY_TIMEOUT);
+    bootProfiler.record("RTC", start, bootProfiler.now());
+    xSemaphoreGive(rtcReady);
+    vTaskDelete(nullptr);
+}
+
 void setup() {
+    bootProfiler.begin();
     Serial.begin(115200);
     Serial.println("Starting ESP-Chain...");
 
+    // Start the SD power cycle first so the off time overlaps display init
+    pinMode(PIN_EXT_POWER, OUTPUT);
+    gpio_hold_dis((gpio_num_t)PIN_EXT_POWER); // Disable hold before writing
+    digitalWrite(PIN_EXT_POWER, LOW);
+    unsigned long powerOffStart = millis();
+
+    // Icons come from the asset partition, map it before the first draw
+    AssetPack::getInstance().begin();
+
     // Initialize Display
     displayManager.init();
-    displayManager.initRTC();
     displayManager.getTFT()->setTextDatum(MC_DATUM);
-    displayManager.getTFT()->setTextColor(TFT_WHITE, TFT_BLACK);
+    displayManager.getTFT()->setTextColor(THEME_TEXT, THEME_BG);
     displayManager.drawStatusBar("Booting...", displayManager.getBatteryVoltage(), false, false, false, "ESP-Chain");
-    pinMode(PIN_EXT_POWER, OUTPUT);
-    gpio_hold_dis((gpio_num_t)PIN_EXT_POWER); // Disable hold before writing
-    
-    // Cycle power to ensure SD card reset
-    digitalWrite(PIN_EXT_POWER, LOW);
-    delay(250);
+    inputManager.begin();
+    bootProfiler.mark("Display");
+
+    // Only wait for whatever is left of the power-off window
+    while (millis() - powerOffStart < EXT_POWER_OFF_MS) {
+        delay(1);
+    }
     digitalWrite(PIN_EXT_POWER, HIGH); // Turn ON NPN
+    bootProfiler.mark("Power");
+
+    rtcReady = xSemaphoreCreateBinary();
+    if (xTaskCreate(rtcInitTask, "rtc_init", 4096, nullptr, 1, nullptr) != pdPASS) {
+        // No task available, fall back to initializing inline
+        displayManager.initRTC(RTC_READY_TIMEOUT);
+        bootProfiler.mark("RTC");
+        xSemaphoreGive(rtcReady);
+    }
 
-    displayManager.getTFT()->drawString("Wait for External Power", 160, 40, 2);
-    delay(700); // Wait for SPI devices to power up
     //Write initial status to tft
     displayManager.clearContent();
-    displayManager.drawStatusBar("Initializing...", displayManager.getBatteryVoltage(), false, false, true);
+    // No clock yet, rtcInitTask may still be talking to the RTC until rtcReady is taken
+    displayManager.drawStatusBar("Initializing...", displayManager.getBatteryVoltage(), false, false, false);
     displayManager.getTFT()->drawString("Initializing SD Card...", 160, 40, 2);
-    
 
     // Initialize SD Card
-    if (sdManager.init()) {
+    if (sdManager.waitForCard(SD_READY_TIMEOUT)) {
         Serial.println("SD Card Initialized");
+        bootProfiler.mark("SD");
         if (ConfigManager::getInstance().load()) {
              Serial.println("Config Loaded");
              displayManager.setBrightness(ConfigManager::getInstance().data.displayBrightness);
@@ -187,35 +243,33 @@ void setup() {
              ConfigManager::getInstance().save();
              displayManager.setBrightness(ConfigManager::getInstance().data.displayBrightness);
         }
+        displayManager.setTheme(ConfigManager::getInstance().data.displayTheme);
+        bootProfiler.mark("Config");
     } else {
         Serial.println("SD Card Failed");
+        bootProfiler.mark("SD");
         displayManager.getTFT()->drawString("SD Card Failed", 160, 40, 2);
-        displayManager.getTFT()->drawBitmap(160 - 8, 80, image_SDQuestion_bits, 35, 43, TFT_YELLOW);
-        delay(2000);
+        displayManager.getTFT()->drawBitmap(160 - 8, 80, image_SDQuestion_bits, 35, 43, THEME_WARN);
+        unsigned long noticeStart = millis();
+        while (millis() - noticeStart < SD_FAIL_NOTICE_MS && digitalRead(BTN_14) == HIGH) {
+            delay(10);
+        }
+        bootProfiler.mark("SD notice");
     }
 
-    delay(1000);
-
-    // Initialize Input
-    inputManager.begin();
+    // The clock in the status bar needs the RTC, wait for it (bounded)
+    xSemaphoreTake(rtcReady, pdMS_TO_TICKS(RTC_READY_TIMEOUT + 100));
 
     // 3. Register Modules
-    // The order here determines the order in the menu!
-    // To move items, just cut and paste these lines.
-    
-    menuSystem.registerModule(&wifiModule);
-    menuSystem.registerModule(&badusbModule);
-    menuSystem.registerModule(&nrf24Module);
-    menuSystem.registerModule(&fileExplorerModule);
-    menuSystem.registerModule(&usbStorageModule);
-    menuSystem.registerModule(&wifiStorageModule);
-    menuSystem.registerModule(&sleepModule);
-    menuSystem.registerModule(&settingsModule);
-    menuSystem.registerModule(&i2cScannerModule);
-    menuSystem.registerModule(&aboutModule);
+    // The order of MODULES determines the order in the menu!
+    for (const ModuleDescriptor& module : MODULES) {
+        menuSystem.registerModule(module);
+    }
 
     // Initial Draw
     menuSystem.draw();
+    bootProfiler.finish();
+    bootProfiler.printReport();
 }
 
 void loop() {
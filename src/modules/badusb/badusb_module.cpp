@@ -14,6 +14,11 @@ USBHIDKeyboard Keyboard;
 DuckyParser parser(&Keyboard);
 
 void BadUSBModule::init() {
+    fileList.begin(&displayManager, [this](int index, ListRow& row) {
+        const FileEntry& entry = scriptFiles[index];
+        row.text = entry.name.startsWith("/") ? entry.name.substring(entry.name.lastIndexOf('/') + 1) : entry.name;
+        if (entry.isDirectory) row.text += "/";
+    });
     Keyboard.begin();
     USB.begin();
     state = STATE_BROWSING;
@@ -80,18 +85,18 @@ void BadUSBModule::drawMenu(DisplayManager* display) {
     if (state == STATE_ARMED) {
         display->drawMenuTitle("ARMED");
         display->getTFT()->setTextDatum(MC_DATUM);
-        display->getTFT()->setTextColor(TFT_RED, TFT_BLACK);
+        display->getTFT()->setTextColor(THEME_ERROR, THEME_BG);
         display->getTFT()->drawString("WAITING USB...", 160, 80, 4);
-        display->getTFT()->setTextColor(TFT_WHITE, TFT_BLACK);
+        display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
         display->getTFT()->drawString("Plug in USB now", 160, 120, 2);
         display->getTFT()->drawString("Long Press to Cancel", 160, 200, 2);
         return;
     } else if (state == STATE_WAITING_DELAY) {
         display->drawMenuTitle("ARMED");
         display->getTFT()->setTextDatum(MC_DATUM);
-        display->getTFT()->setTextColor(TFT_ORANGE, TFT_BLACK);
+        display->getTFT()->setTextColor(THEME_WARN, THEME_BG);
         display->getTFT()->drawString("STARTING...", 160, 80, 4);
-        display->getTFT()->setTextColor(TFT_WHITE, TFT_BLACK);
+        display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
         
         long remaining = (long)ConfigManager::getInstance().data.badusbStartupDelay - (long)(millis() - armedTime);
         if (remaining < 0) remaining = 0;
@@ -103,15 +108,15 @@ void BadUSBModule::drawMenu(DisplayManager* display) {
     } else if (state == STATE_RUNNING) {
         display->drawMenuTitle("RUNNING");
         display->getTFT()->setTextDatum(MC_DATUM);
-        display->getTFT()->setTextColor(TFT_YELLOW, TFT_BLACK);
+        display->getTFT()->setTextColor(THEME_WARN, THEME_BG);
         display->getTFT()->drawString("EXECUTING...", 160, 100, 4);
         return;
     } else if (state == STATE_DONE) {
         display->drawMenuTitle("DONE");
         display->getTFT()->setTextDatum(MC_DATUM);
-        display->getTFT()->setTextColor(TFT_GREEN, TFT_BLACK);
+        display->getTFT()->setTextColor(THEME_OK, THEME_BG);
         display->getTFT()->drawString("FINISHED", 160, 100, 4);
-        display->getTFT()->setTextColor(TFT_WHITE, TFT_BLACK);
+        display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
         display->getTFT()->drawString("Press Back", 160, 140, 2);
         return;
     }
@@ -124,6 +129,7 @@ void BadUSBModule::drawMenu(DisplayManager* display) {
     
     if (!filesLoaded) {
         scriptFiles = sdManager.listDir(currentPath);
+        fileList.reset(scriptFiles.size());
         filesLoaded = true;
     }
     
@@ -132,28 +138,10 @@ void BadUSBModule::drawMenu(DisplayManager* display) {
         return;
     }
 
-    int maxItems = 5; 
-    int startIdx = 0;
-    if (selectedIndex >= maxItems) {
-        startIdx = selectedIndex - maxItems + 1;
-    }
-    
-    // Ensure startIdx is valid
-    if (startIdx < 0) startIdx = 0;
-    if (startIdx > (int)scriptFiles.size() - maxItems && (int)scriptFiles.size() > maxItems) {
-        startIdx = scriptFiles.size() - maxItems;
-    }
-
-    for (int i = startIdx; i < (int)scriptFiles.size() && i < startIdx + maxItems; i++) {
-        String name = scriptFiles[i].name;
-        if (name.startsWith("/")) name = name.substring(name.lastIndexOf('/') + 1);
-        if (scriptFiles[i].isDirectory) name += "/";
-        
-        display->drawMenuItem(name, i - startIdx, i == selectedIndex);
-    }
+    fileList.draw();
     
     if (statusMessage != "") {
-        display->getTFT()->setTextColor(TFT_GREEN, TFT_BLACK);
+        display->getTFT()->setTextColor(THEME_OK, THEME_BG);
         display->getTFT()->drawString(statusMessage, 20, 180, 2);
     }
 }
@@ -183,22 +171,18 @@ bool BadUSBModule::handleInput(uint8_t button) {
 
     if (button == 1) { // Down / Next
         if (!scriptFiles.empty()) {
-            selectedIndex++;
-            if (selectedIndex >= (int)scriptFiles.size()) {
-                selectedIndex = 0;
-            }
-            drawMenu(&displayManager);
+            fileList.next();
+            fileList.update();
         }
     } else if (button == 2) { // Select
-        if (selectedIndex >= 0 && selectedIndex < (int)scriptFiles.size()) {
-            FileEntry& entry = scriptFiles[selectedIndex];
+        if (!scriptFiles.empty()) {
+            FileEntry& entry = scriptFiles[fileList.getSelected()];
             String fullPath = entry.name;
             if (!fullPath.startsWith("/")) fullPath = currentPath + "/" + fullPath;
             
             if (entry.isDirectory) {
                 currentPath = fullPath;
                 filesLoaded = false;
-                selectedIndex = 0;
                 statusMessage = "";
                 drawMenu(&displayManager);
             } else {
@@ -221,7 +205,6 @@ bool BadUSBModule::handleInput(uint8_t button) {
                 currentPath = "/payloads";
             }
             filesLoaded = false;
-            selectedIndex = 0;
             statusMessage = "";
             drawMenu(&displayManager);
         }
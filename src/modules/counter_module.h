@@ -30,7 +30,7 @@ public:
         display->drawMenuTitle("Counter");
         
         display->getTFT()->setTextDatum(MC_DATUM);
-        display->getTFT()->setTextColor(TFT_WHITE, TFT_BLACK);
+        display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
         
         // Draw the big number
         display->getTFT()->setTextSize(2); // Double current size
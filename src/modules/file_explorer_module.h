@@ -13,8 +13,7 @@ private:
     // Browser State
     String currentPath;
     std::vector<FileEntry> currentFiles;
-    int selectedIndex;
-    int scrollOffset;
+    ListView fileList;
 
     // Viewer State
     std::vector<String> viewerLines;
@@ -24,8 +23,7 @@ private:
         extern SDManager sdManager;
         currentPath = path;
         currentFiles = sdManager.listDir(currentPath);
-        selectedIndex = 0;
-        scrollOffset = 0;
+        fileList.reset(currentFiles.size());
         currentState = BROWSER;
     }
 
@@ -56,6 +54,17 @@ private:
 
 public:
     void init() override {
+        extern DisplayManager displayManager;
+        fileList.begin(&displayManager, [this](int index, ListRow& row) {
+            const FileEntry& entry = currentFiles[index];
+            if (entry.isDirectory) {
+                row.text = entry.name;
+                row.text += "/";
+            } else {
+                row.text = " ";
+                row.text += entry.name;
+            }
+        });
         loadPath("/");
     }
 
@@ -78,7 +87,7 @@ public:
         display->clearContent();
         
         if (currentState == VIEWER) {
-            display->getTFT()->setTextColor(TFT_WHITE, TFT_BLACK);
+            display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
             display->getTFT()->setTextDatum(TL_DATUM);
             
             int linesPerPage = 6; // Fits in 150px height (20px per line)
@@ -100,22 +109,12 @@ public:
         // BROWSER MODE
         if (currentFiles.empty()) {
              display->getTFT()->setTextDatum(MC_DATUM);
-             display->getTFT()->setTextColor(TFT_WHITE, TFT_BLACK);
+             display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
              display->getTFT()->drawString("Empty Folder", 160, 100, 2);
              return;
         }
 
-        for (int i = 0; i < 5; i++) {
-            int idx = scrollOffset + i;
-            if (idx >= currentFiles.size()) break;
-            
-            String label = currentFiles[idx].name;
-            if (currentFiles[idx].isDirectory) label += "/";
-            else label = " " + label; 
-
-            display->drawMenuItem(label, i, idx == selectedIndex);
-        }
-        display->drawScrollBar(currentFiles.size(), scrollOffset, 5);
+        fileList.draw();
     }
 
     bool handleInput(uint8_t button) override {
@@ -145,21 +144,15 @@ public:
         // BROWSER INPUT
         if (button == 1) { // Scroll
             if (currentFiles.empty()) return true;
-            selectedIndex++;
-            if (selectedIndex >= currentFiles.size()) {
-                selectedIndex = 0;
-                scrollOffset = 0;
-            } else if (selectedIndex >= scrollOffset + 5) {
-                scrollOffset++;
-            }
-            drawMenu(&displayManager);
+            fileList.next();
+            fileList.update();
             return true;
         }
 
         if (button == 2) { // Select
             if (currentFiles.empty()) return true;
             
-            FileEntry& entry = currentFiles[selectedIndex];
+            FileEntry& entry = currentFiles[fileList.getSelected()];
             String newPath = currentPath;
             if (!newPath.endsWith("/")) newPath += "/";
             newPath += entry.name;
@@ -0,0 +1,188 @@
+#include "gps_reader.h"
+#ifndef SIMULATOR
+#include <TinyGPSPlus.h>
+
+static TinyGPSPlus nmea;
+#define GPS_SERIAL Serial1
+#endif
+
+#define UBX_SYNC1        0xB5
+#define UBX_SYNC2        0x62
+#define UBX_CLASS_NAV    0x01
+#define UBX_ID_NAV_PVT   0x07
+#define UBX_NAV_PVT_LEN  92
+
+uint32_t makeUnixTime(int year, int month, int day, int hour, int minute, int second) {
+    // Days from 1970-01-01, counting years from March so the leap day is last
+    year -= month <= 2;
+    int era = year / 400;
+    int yoe = year - era * 400;
+    int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int32_t days = era * 146097 + doe - 719468;
+    return (uint32_t)days * 86400 + hour * 3600 + minute * 60 + second;
+}
+
+static inline uint32_t readU32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool UbxParser::feed(uint8_t b, GeoFix& out) {
+    switch (state) {
+        case SYNC1:
+            if (b == UBX_SYNC1) state = SYNC2;
+            return false;
+        case SYNC2:
+            state = b == UBX_SYNC2 ? CLASS : SYNC1;
+            return false;
+        case CLASS:
+            ckA = ckB = 0;
+            checksum(b);
+            msgClass = b;
+            state = ID;
+            return false;
+        case ID:
+            checksum(b);
+            msgId = b;
+            state = LEN1;
+            return false;
+        case LEN1:
+            checksum(b);
+            length = b;
+            state = LEN2;
+            return false;
+        case LEN2:
+            checksum(b);
+            length |= b << 8;
+            index = 0;
+            state = length ? PAYLOAD : CK_A;
+            return false;
+        case PAYLOAD:
+            checksum(b);
+            if (index < UBX_MAX_PAYLOAD) payload[index] = b; // Longer messages are checked but not kept
+            if (++index == length) state = CK_A;
+            return false;
+        case CK_A:
+            if (b != ckA) {
+                checksumErrors++;
+                state = SYNC1;
+                return false;
+            }
+            state = CK_B;
+            return false;
+        case CK_B:
+            state = SYNC1;
+            if (b != ckB) {
+                checksumErrors++;
+                return false;
+            }
+            frames++;
+            if (msgClass == UBX_CLASS_NAV && msgId == UBX_ID_NAV_PVT && length == UBX_NAV_PVT_LEN) {
+                return decodeNavPvt(out);
+            }
+            return false;
+    }
+    return false;
+}
+
+bool UbxParser::decodeNavPvt(GeoFix& out) {
+    const uint8_t* p = payload;
+    uint8_t fixType = p[20];
+    bool fixOk = p[21] & 0x01;
+    if (fixType < 2 || fixType > 4 || !fixOk) return false; // 2D, 3D or GNSS + dead reckoning
+
+    out.lonE7 = (int32_t)readU32(p + 24);
+    out.latE7 = (int32_t)readU32(p + 28);
+    out.altitudeM = (int32_t)readU32(p + 36) / 1000; // hMSL, mm
+    uint32_t hAccMm = readU32(p + 40);
+    out.accuracyDm = hAccMm / 100 > 0xFFFF ? 0xFFFF : hAccMm / 100;
+    out.satellites = p[23];
+    bool dateValid = (p[11] & 0x03) == 0x03; // validDate and validTime
+    out.unixTime = dateValid ? makeUnixTime(p[4] | (p[5] << 8), p[6], p[7], p[8], p[9], p[10]) : 0;
+    out.timestampMs = millis();
+    out.valid = true;
+    return true;
+}
+
+bool GpsReader::begin() {
+    if (running) return true;
+#ifndef SIMULATOR
+    GPS_SERIAL.setRxBufferSize(1024); // ~1s of NMEA at 9600 baud, covers slow loop iterations
+    GPS_SERIAL.begin(GPS_BAUD, SERIAL_8N1, GPS_RX, GPS_TX);
+#endif
+    fix = {};
+    bytes = 0;
+    running = true;
+    return true;
+}
+
+void GpsReader::end() {
+    if (!running) return;
+#ifndef SIMULATOR
+    GPS_SERIAL.end();
+#endif
+    running = false;
+}
+
+void GpsReader::poll() {
+    if (!running) return;
+#ifndef SIMULATOR
+    uint8_t buf[GPS_UART_CHUNK];
+    size_t n;
+    while ((n = GPS_SERIAL.available()) > 0) {
+        n = GPS_SERIAL.read(buf, std::min(n, sizeof(buf)));
+        feed(buf, n);
+    }
+#endif
+}
+
+void GpsReader::feed(const uint8_t* data, size_t len) {
+    bytes += len;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = data[i];
+        // A UBX frame can contain '$', so it owns the bytes until it ends
+        if (ubx.inFrame() || b == UBX_SYNC1) {
+            GeoFix decoded = fix;
+            if (ubx.feed(b, decoded)) fix = decoded;
+            continue;
+        }
+#ifndef SIMULATOR
+        if (nmea.encode(b)) updateFromNmea();
+#endif
+    }
+}
+
+void GpsReader::updateFromNmea() {
+#ifndef SIMULATOR
+    if (!nmea.location.isUpdated() || !nmea.location.isValid()) return;
+    // Raw degrees keep full precision without going through double, and clear the updated flag
+    const RawDegrees& lat = nmea.location.rawLat();
+    const RawDegrees& lng = nmea.location.rawLng();
+    fix.latE7 = (int32_t)(lat.deg * 10000000L + lat.billionths / 100) * (lat.negative ? -1 : 1);
+    fix.lonE7 = (int32_t)(lng.deg * 10000000L + lng.billionths / 100) * (lng.negative ? -1 : 1);
+    if (nmea.altitude.isValid()) fix.altitudeM = (int16_t)nmea.altitude.meters();
+    // NMEA has no accuracy estimate, HDOP times a typical 5m UERE is the usual stand-in
+    fix.accuracyDm = nmea.hdop.isValid() ? nmea.hdop.value() / 2 : 0;
+    fix.satellites = nmea.satellites.isValid() ? nmea.satellites.value() : 0;
+    if (nmea.date.isValid() && nmea.time.isValid() && nmea.date.year() >= 2020) {
+        fix.unixTime = makeUnixTime(nmea.date.year(), nmea.date.month(), nmea.date.day(),
+                                    nmea.time.hour(), nmea.time.minute(), nmea.time.second());
+    }
+    fix.timestampMs = millis();
+    fix.valid = true;
+#endif
+}
+
+bool GpsReader::getFix(GeoFix& out) {
+    if (!fix.valid || millis() - fix.timestampMs > GPS_FIX_MAX_AGE_MS) return false;
+    out = fix;
+    return true;
+}
+
+uint32_t GpsReader::getSentences() {
+#ifndef SIMULATOR
+    return nmea.passedChecksum();
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <Arduino.h>
+
+// GPS UART. GPIO 3 is the only free header pin left once the SPI radios are
+// fitted; TX is only needed to configure the receiver, so it is not wired.
+#ifndef GPS_RX
+#define GPS_RX 3
+#endif
+#ifndef GPS_TX
+#define GPS_TX -1
+#endif
+#ifndef GPS_BAUD
+#define GPS_BAUD 9600 // u-blox NEO-6M/M8N default
+#endif
+
+#define GPS_FIX_MAX_AGE_MS 2000 // Older fixes are not used to tag observations
+#define GPS_UART_CHUNK     128  // Bytes read from the UART per call
+#define UBX_MAX_PAYLOAD    100  // NAV-PVT is 92, longer messages are skipped
+
+struct GeoFix {
+    int32_t latE7;        // Degrees * 1e7
+    int32_t lonE7;
+    int16_t altitudeM;
+    uint16_t accuracyDm;  // Horizontal, decimetres
+    uint32_t unixTime;    // UTC, 0 if the receiver has no date yet
+    uint32_t timestampMs; // millis() when it was decoded
+    uint8_t satellites;
+    bool valid;
+};
+
+// Seconds since 1970 from a UTC calendar date, without the C library's time zone handling
+uint32_t makeUnixTime(int year, int month, int day, int hour, int minute, int second);
+
+// Incremental UBX decoder for NAV-PVT, fed byte by byte, no allocation
+class UbxParser {
+public:
+    // True when the byte completed a valid NAV-PVT with a position
+    bool feed(uint8_t b, GeoFix& out);
+    bool inFrame() { return state != SYNC1; }
+
+    uint32_t getFrames() { return frames; }
+    uint32_t getChecksumErrors() { return checksumErrors; }
+
+private:
+    enum State : uint8_t { SYNC1, SYNC2, CLASS, ID, LEN1, LEN2, PAYLOAD, CK_A, CK_B };
+    State state = SYNC1;
+    uint8_t msgClass = 0, msgId = 0;
+    uint16_t length = 0, index = 0;
+    uint8_t ckA = 0, ckB = 0;
+    uint8_t payload[UBX_MAX_PAYLOAD];
+    uint32_t frames = 0;
+    uint32_t checksumErrors = 0;
+
+    void checksum(uint8_t b) {
+        ckA += b;
+        ckB += ckA;
+    }
+    bool decodeNavPvt(GeoFix& out);
+};
+
+// Reads the GPS UART in chunks from the module loop. UBX frames go to
+// UbxParser and everything else to TinyGPSPlus, so either protocol (or a
+// receiver sending both) works without configuring it. Neither parser
+// builds Strings, and the fix is only copied out when a sentence or frame
+// with a position completes.
+class GpsReader {
+public:
+    bool begin();
+    void end();
+    bool isRunning() { return running; }
+
+    void poll();
+    // Raw receiver bytes, poll() feeds the UART through here
+    void feed(const uint8_t* data, size_t len);
+
+    // Latest fix, false if there is none newer than GPS_FIX_MAX_AGE_MS
+    bool getFix(GeoFix& out);
+    const GeoFix& getLastFix() { return fix; }
+
+    uint32_t getBytes() { return bytes; }
+    uint32_t getSentences();
+    uint32_t getUbxFrames() { return ubx.getFrames(); }
+
+private:
+    bool running = false;
+    GeoFix fix = {};
+    UbxParser ubx;
+    uint32_t bytes = 0;
+
+    void updateFromNmea();
+};
@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Minimal bus interface so chip identification can run against Wire on the
+// device or a fake bus on the host.
+class I2CBus {
+public:
+    // Returns a Wire style status: 0 = ACK, 2/3 = NACK, 4 = other error, 5 = timeout
+    virtual uint8_t probe(uint8_t address) = 0;
+    virtual bool readRegister(uint8_t address, uint8_t reg, uint8_t* out, size_t len) = 0;
+    virtual ~I2CBus() {}
+};
@@ -0,0 +1,83 @@
+#include "i2c_fingerprint.h"
+
+static bool bcdIn(uint8_t v, uint8_t lo, uint8_t hi) {
+    if ((v & 0x0F) > 9) return false;
+    uint8_t n = (v >> 4) * 10 + (v & 0x0F);
+    return n >= lo && n <= hi;
+}
+
+// The DS3231 has no ID register, its time registers must hold a valid time
+static bool ds3231Time(I2CBus& bus, uint8_t address) {
+    uint8_t t[7];
+    if (!bus.readRegister(address, 0x00, t, sizeof(t))) return false;
+    bool hoursOk = t[2] & 0x40 ? bcdIn(t[2] & 0x1F, 1, 12) : bcdIn(t[2] & 0x3F, 0, 23); // 12 or 24 hour mode
+    return bcdIn(t[0], 0, 59) && bcdIn(t[1], 0, 59) && hoursOk && bcdIn(t[3], 1, 7) && bcdIn(t[4], 1, 31) &&
+           bcdIn(t[5] & 0x1F, 1, 12) && bcdIn(t[6], 0, 99);
+}
+
+static const I2CFingerprint fingerprints[] = {
+    // Magnetometers
+    { 0x0D, 0x0D, true,  0x0D, 0xFF, 0xFF, "QMC5883L Compass" },
+    { 0x1E, 0x1E, true,  0x0A, 0xFF, 0x48, "HMC5883L Compass" },  // 'H'
+    // IMUs with WHO_AM_I at 0x75
+    { 0x68, 0x69, true,  0x75, 0xFF, 0x68, "MPU6050 IMU" },
+    { 0x68, 0x69, true,  0x75, 0xFF, 0x70, "MPU6500 IMU" },
+    { 0x68, 0x69, true,  0x75, 0xFF, 0x71, "MPU9250 IMU" },
+    { 0x68, 0x69, true,  0x75, 0xFF, 0x73, "MPU9255 IMU" },
+    { 0x68, 0x69, true,  0x75, 0xFF, 0x47, "ICM42688 IMU" },
+    // RTC: status bits 6..4 always read 0 and a valid time. Ahead of the IMUs
+    // with their ID at 0x00, which is the DS3231's seconds counter
+    { 0x68, 0x68, true,  0x0F, 0x70, 0x00, "DS3231 RTC", ds3231Time },
+    { 0x68, 0x69, true,  0x00, 0xFF, 0xEA, "ICM20948 IMU" },
+    { 0x68, 0x69, true,  0x00, 0xFF, 0xD1, "BMI160 IMU" },
+    { 0x68, 0x69, true,  0x00, 0xFF, 0x24, "BMI270 IMU" },
+    { 0x6A, 0x6B, true,  0x0F, 0xFF, 0x69, "LSM6DS3 IMU" },
+    { 0x6A, 0x6B, true,  0x0F, 0xFF, 0x6A, "LSM6DSL IMU" },
+    { 0x6A, 0x6B, true,  0x0F, 0xFF, 0x6C, "LSM6DSO IMU" },
+    { 0x6A, 0x6B, true,  0x00, 0xFF, 0x05, "QMI8658 IMU" },
+    { 0x1D, 0x1D, true,  0x00, 0xFF, 0xE5, "ADXL345 Accel" },
+    { 0x53, 0x53, true,  0x00, 0xFF, 0xE5, "ADXL345 Accel" },
+    // Pressure
+    { 0x76, 0x77, true,  0xD0, 0xFF, 0x58, "BMP280 Baro" },
+    { 0x76, 0x77, true,  0xD0, 0xFF, 0x60, "BME280 Baro" },
+    { 0x77, 0x77, true,  0xD0, 0xFF, 0x55, "BMP180 Baro" },
+    // Address-only matches
+    { 0x42, 0x42, false, 0x00, 0x00, 0x00, "u-blox GNSS" },
+    { 0x57, 0x57, false, 0x00, 0x00, 0x00, "AT24C32 EEPROM" },
+    { 0x3C, 0x3D, false, 0x00, 0x00, 0x00, "SSD1306 OLED" },
+};
+
+const I2CFingerprint* getI2CFingerprints(int* count) {
+    *count = sizeof(fingerprints) / sizeof(fingerprints[0]);
+    return fingerprints;
+}
+
+const I2CFingerprint* identifyI2CDevice(I2CBus& bus, uint8_t address) {
+    // Several rows probe the same ID register, only read each one once
+    uint8_t cachedReg[4];
+    uint8_t cachedValue[4];
+    bool cachedOk[4];
+    int cached = 0;
+
+    int count = 0;
+    const I2CFingerprint* table = getI2CFingerprints(&count);
+    for (int i = 0; i < count; i++) {
+        const I2CFingerprint& fp = table[i];
+        if (address < fp.addrMin || address > fp.addrMax) continue;
+        if (!fp.checkId) return &fp;
+
+        int slot = -1;
+        for (int c = 0; c < cached; c++) {
+            if (cachedReg[c] == fp.idReg) { slot = c; break; }
+        }
+        if (slot < 0) {
+            slot = cached < 4 ? cached++ : 3;
+            cachedReg[slot] = fp.idReg;
+            cachedOk[slot] = bus.readRegister(address, fp.idReg, &cachedValue[slot], 1);
+        }
+        if (!cachedOk[slot] || (cachedValue[slot] & fp.idMask) != fp.idValue) continue;
+        if (fp.confirm && !fp.confirm(bus, address)) continue;
+        return &fp;
+    }
+    return nullptr;
+}
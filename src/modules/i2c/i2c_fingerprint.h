@@ -0,0 +1,22 @@
+#pragma once
+#include <stdint.h>
+#include "i2c_bus.h"
+
+// One row per chip. A chip matches when the address is in range and, if
+// checkId is set, (register & idMask) == idValue, and then confirm(), when
+// set, agrees. Rows sharing an address are ordered most specific first.
+struct I2CFingerprint {
+    uint8_t addrMin;
+    uint8_t addrMax;
+    bool checkId;
+    uint8_t idReg;
+    uint8_t idMask;
+    uint8_t idValue;
+    const char* name;
+    bool (*confirm)(I2CBus& bus, uint8_t address); // For chips without an ID register
+};
+
+const I2CFingerprint* getI2CFingerprints(int* count);
+
+// Returns nullptr when nothing in the table matches
+const I2CFingerprint* identifyI2CDevice(I2CBus& bus, uint8_t address);
@@ -0,0 +1,282 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#include <vector>
+#include "module_base.h"
+#include "display_manager.h"
+#include "i2c_fingerprint.h"
+#include "wire_i2c_bus.h"
+
+// Default I2C pins for LilyGo T-Display S3
+#ifndef SDA_PIN
+#define SDA_PIN 43
+#endif
+#ifndef SCL_PIN
+#define SCL_PIN 44
+#endif
+
+#define EXT_POWER_PIN 17
+#define I2C_FIRST_ADDR 0x01
+#define I2C_LAST_ADDR  0x7E
+
+struct I2CDevice {
+    enum Change : uint8_t { SAME, NEW, GONE };
+
+    uint8_t address;
+    uint8_t error;               // Wire status, 0 = ACK
+    const I2CFingerprint* chip;  // nullptr if not in the table
+    Change change;               // Compared to the previous scan
+};
+
+class I2CScannerModule : public Module {
+private:
+    enum State {
+        SCANNING,
+        RESULTS,
+        OPTIONS
+    };
+
+    State currentState = RESULTS;
+    std::vector<I2CDevice> devices;   // Current scan merged with the one before
+    std::vector<I2CDevice> lastScan;  // Cache for diffing
+    ListView deviceList;
+    int optionIndex = 0;
+    bool hasScanned = false;
+
+    // Selectable bus speeds and per-address timeouts
+    const uint32_t speeds[3] = {100000, 400000, 1000000};
+    const uint16_t timeouts[3] = {2, 10, 50};
+    int speedIndex = 1;
+    int timeoutIndex = 1;
+
+    // Written by the scan task, read by the UI
+    I2CDevice found[I2C_LAST_ADDR + 1];
+    volatile int foundCount = 0;
+    volatile int currentScanAddress = 0;
+    volatile bool scanRunning = false;
+    volatile bool scanDone = false;
+    unsigned long scanStartTime = 0;
+    unsigned long scanDuration = 0;
+    unsigned long lastDraw = 0;
+
+    static void scanTask(void* param) {
+        static_cast<I2CScannerModule*>(param)->runScan();
+        vTaskDelete(nullptr);
+    }
+
+    void runScan() {
+        extern DisplayManager displayManager;
+        // The DS3231 shares the bus and is rated for 400kHz, the status bar
+        // stops reading it until the sweep has put the bus back to 100kHz
+        displayManager.setRTCBusy(true);
+
+        // Power Cycle
+        pinMode(EXT_POWER_PIN, OUTPUT);
+        digitalWrite(EXT_POWER_PIN, LOW);
+        vTaskDelay(pdMS_TO_TICKS(50));
+        digitalWrite(EXT_POWER_PIN, HIGH);
+        vTaskDelay(pdMS_TO_TICKS(100));
+
+        Wire.begin(SDA_PIN, SCL_PIN);
+        Wire.setClock(speeds[speedIndex]);
+        Wire.setTimeOut(timeouts[timeoutIndex]);
+
+        WireI2CBus bus(Wire);
+        for (int addr = I2C_FIRST_ADDR; addr <= I2C_LAST_ADDR; addr++) {
+            currentScanAddress = addr;
+            uint8_t error = bus.probe(addr);
+            if (error == 0 || error == 4) {
+                I2CDevice& dev = found[foundCount];
+                dev.address = addr;
+                dev.error = error;
+                dev.chip = (error == 0) ? identifyI2CDevice(bus, addr) : nullptr;
+                dev.change = I2CDevice::SAME;
+                foundCount = foundCount + 1;
+            }
+        }
+
+        // The RTC shares the bus, leave it at a speed it supports
+        Wire.setClock(100000);
+        displayManager.setRTCBusy(false);
+        scanDuration = millis() - scanStartTime;
+        scanDone = true;
+    }
+
+    void startScan() {
+        if (scanRunning) return;
+        currentState = SCANNING;
+        currentScanAddress = I2C_FIRST_ADDR;
+        foundCount = 0;
+        scanDone = false;
+        scanRunning = true;
+        scanStartTime = millis();
+
+        if (xTaskCreate(scanTask, "i2c_scan", 4096, this, 1, nullptr) != pdPASS) {
+            runScan(); // No task available, scan inline
+        }
+    }
+
+    // Merge the finished sweep with the cached one and flag what changed
+    void finishScan() {
+        std::vector<I2CDevice> current(found, found + foundCount);
+
+        devices.clear();
+        for (auto dev : current) {
+            dev.change = I2CDevice::NEW;
+            if (!hasScanned) dev.change = I2CDevice::SAME;
+            for (const auto& prev : lastScan) {
+                if (prev.address == dev.address) {
+                    dev.change = (prev.chip == dev.chip && prev.error == dev.error) ? I2CDevice::SAME : I2CDevice::NEW;
+                    break;
+                }
+            }
+            devices.push_back(dev);
+        }
+        for (auto prev : lastScan) {
+            bool stillThere = false;
+            for (const auto& dev : current) {
+                if (dev.address == prev.address) { stillThere = true; break; }
+            }
+            if (!stillThere) {
+                prev.change = I2CDevice::GONE;
+                devices.push_back(prev);
+            }
+        }
+
+        lastScan = current;
+        hasScanned = true;
+        deviceList.reset(devices.size());
+        scanRunning = false;
+        currentState = RESULTS;
+    }
+
+    String formatDevice(const I2CDevice& dev) {
+        char hex[5];
+        sprintf(hex, "0x%02X", dev.address);
+        String label = hex;
+        if (dev.change == I2CDevice::NEW) label = "+" + label;
+        else if (dev.change == I2CDevice::GONE) label = "-" + label;
+        label += " ";
+        if (dev.error != 0) label += "Error";
+        else if (dev.chip) label += dev.chip->name;
+        else label += "Unknown";
+        return label;
+    }
+
+    String getOptionLabel(int index) {
+        switch (index) {
+            case 0: return "Rescan";
+            case 1: return "Speed: " + String(speeds[speedIndex] / 1000) + "kHz";
+            case 2: return "Timeout: " + String(timeouts[timeoutIndex]) + "ms";
+            default: return "Back";
+        }
+    }
+
+public:
+    void init() override {
+        extern DisplayManager displayManager;
+        deviceList.begin(&displayManager, [this](int index, ListRow& row) { row.text = formatDevice(devices[index]); });
+        startScan();
+    }
+
+    void loop() override {
+        extern DisplayManager displayManager;
+
+        if (currentState != SCANNING) return;
+
+        if (scanDone) {
+            finishScan();
+            drawMenu(&displayManager);
+        } else if (millis() - lastDraw > 100) {
+            // Progress only, the sweep itself runs on its own task
+            lastDraw = millis();
+            drawMenu(&displayManager);
+        }
+    }
+
+    // A sweep left behind keeps writing found[] until its task ends, the
+    // registry must not delete the module before then
+    bool isBackgroundRunning() override {
+        return scanRunning && !scanDone;
+    }
+
+    String getName() override {
+        return "I2C Scanner";
+    }
+
+    String getDescription() override {
+        return "List I2C Devices";
+    }
+
+    void drawMenu(DisplayManager* display) override {
+        if (!display || !display->getTFT()) return;
+
+        display->clearContent();
+
+        if (currentState == SCANNING) {
+            display->drawMenuTitle("Scanning...");
+            display->getTFT()->setTextDatum(MC_DATUM);
+            display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
+
+            int percent = (int)((currentScanAddress / (float)I2C_LAST_ADDR) * 100);
+            display->getTFT()->drawString(String(percent) + "%", 160, 90, 4);
+            display->getTFT()->drawString("Found: " + String(foundCount) + " @ " + String(speeds[speedIndex] / 1000) + "kHz", 160, 130, 2);
+        }
+        else if (currentState == OPTIONS) {
+            display->drawMenuTitle("Scan Options");
+            for (int i = 0; i < 4; i++) {
+                display->drawMenuItem(getOptionLabel(i), i, i == optionIndex);
+            }
+        }
+        else if (currentState == RESULTS) {
+            display->drawMenuTitle("I2C Devices");
+
+            if (devices.empty()) {
+                display->getTFT()->setTextDatum(MC_DATUM);
+                display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
+                display->getTFT()->drawString("No Devices Found", 160, 90, 2);
+                display->getTFT()->drawString("Scan took " + String(scanDuration) + "ms", 160, 115, 2);
+                display->getTFT()->drawString("Double Click: Options", 160, 140, 2);
+            } else {
+                deviceList.draw();
+            }
+        }
+    }
+
+    bool handleInput(uint8_t button) override {
+        extern DisplayManager displayManager;
+
+        if (currentState == OPTIONS) {
+            if (button == 1) {
+                optionIndex = (optionIndex + 1) % 4;
+            } else if (button == 2) {
+                if (optionIndex == 0) { startScan(); }
+                else if (optionIndex == 1) { speedIndex = (speedIndex + 1) % 3; }
+                else if (optionIndex == 2) { timeoutIndex = (timeoutIndex + 1) % 3; }
+                else { currentState = RESULTS; }
+            } else if (button == 3) {
+                currentState = RESULTS;
+            }
+            drawMenu(&displayManager);
+            return true;
+        }
+
+        if (button == 3) { // Long Press -> Exit
+            return false;
+        }
+
+        if (currentState == RESULTS) {
+            if (button == 1 && !devices.empty()) { // Down / Next
+                deviceList.next();
+                deviceList.update();
+            }
+            else if (button == 2) { // Double Click -> Scan options
+                currentState = OPTIONS;
+                optionIndex = 0;
+                drawMenu(&displayManager);
+            }
+        }
+
+        return true;
+    }
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#include "i2c_bus.h"
+
+class WireI2CBus : public I2CBus {
+public:
+    WireI2CBus(TwoWire& wire = Wire) : _wire(wire) {}
+
+    uint8_t probe(uint8_t address) override {
+        _wire.beginTransmission(address);
+        return _wire.endTransmission();
+    }
+
+    bool readRegister(uint8_t address, uint8_t reg, uint8_t* out, size_t len) override {
+        _wire.beginTransmission(address);
+        _wire.write(reg);
+        if (_wire.endTransmission(false) != 0) return false; // Repeated start
+        if (_wire.requestFrom(address, (uint8_t)len) != len) return false;
+        for (size_t i = 0; i < len; i++) out[i] = _wire.read();
+        return true;
+    }
+
+private:
+    TwoWire& _wire;
+};
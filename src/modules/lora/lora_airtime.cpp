@@ -0,0 +1,85 @@
+#include "lora_airtime.h"
+
+#define LORA_LDRO_SYMBOL_US 16000 // Longer symbols need low data rate optimisation
+
+uint32_t loraSymbolUs(const LoRaModemParams& params) {
+    return (uint32_t)(((uint64_t)1000000 << params.spreadingFactor) / params.bandwidthHz);
+}
+
+uint32_t loraTimeOnAirUs(const LoRaModemParams& params, uint8_t payloadLen) {
+    int sf = params.spreadingFactor;
+    int de = loraSymbolUs(params) > LORA_LDRO_SYMBOL_US ? 1 : 0;
+    int ih = params.explicitHeader ? 0 : 1;
+    int crc = params.crc ? 1 : 0;
+
+    // Symbols after the 8 that always go at the lowest rate
+    int num = 8 * payloadLen - 4 * sf + 28 + 16 * crc - 20 * ih;
+    int den = 4 * (sf - 2 * de);
+    int extra = num > 0 ? (num + den - 1) / den * params.codingRate : 0;
+    uint32_t payloadSymbols = 8 + extra;
+
+    // (preamble + 4.25 + payload) symbols, in quarter symbols to stay integer
+    uint64_t quarters = 4 * (uint64_t)params.preambleSymbols + 17 + 4 * (uint64_t)payloadSymbols;
+    uint64_t den4 = 4 * (uint64_t)params.bandwidthHz;
+    return (uint32_t)(((quarters * 1000000 << sf) + den4 / 2) / den4);
+}
+
+DutyCycleBudget::DutyCycleBudget(uint16_t permille, uint32_t windowMs) {
+    bucketMs = windowMs / LORA_DUTY_BUCKETS;
+    budgetUs = windowMs * permille; // ms * permille / 1000, in us
+    reset();
+}
+
+void DutyCycleBudget::reset() {
+    memset(buckets, 0, sizeof(buckets));
+    started = false;
+}
+
+void DutyCycleBudget::advance(uint32_t nowMs) {
+    uint32_t slot = nowMs / bucketMs;
+    if (!started || slot < currentSlot) { // First use, or millis() wrapped
+        memset(buckets, 0, sizeof(buckets));
+        currentSlot = slot;
+        started = true;
+        return;
+    }
+    uint32_t steps = std::min<uint32_t>(slot - currentSlot, LORA_DUTY_BUCKETS + 1);
+    for (uint32_t i = 1; i <= steps; i++) {
+        buckets[(currentSlot + i) % (LORA_DUTY_BUCKETS + 1)] = 0;
+    }
+    currentSlot = slot;
+}
+
+uint32_t DutyCycleBudget::getUsedUs(uint32_t nowMs) {
+    advance(nowMs);
+    uint32_t used = 0;
+    for (int i = 0; i <= LORA_DUTY_BUCKETS; i++) used += buckets[i];
+    return used;
+}
+
+uint32_t DutyCycleBudget::getRemainingUs(uint32_t nowMs) {
+    uint32_t used = getUsedUs(nowMs);
+    return used >= budgetUs ? 0 : budgetUs - used;
+}
+
+void DutyCycleBudget::record(uint32_t airtimeUs, uint32_t nowMs) {
+    advance(nowMs);
+    buckets[currentSlot % (LORA_DUTY_BUCKETS + 1)] += airtimeUs;
+}
+
+uint32_t DutyCycleBudget::getWaitMs(uint32_t airtimeUs, uint32_t nowMs) {
+    uint32_t remaining = getRemainingUs(nowMs);
+    if (airtimeUs <= remaining) return 0;
+    if (airtimeUs > budgetUs) return UINT32_MAX; // Never fits
+
+    // Oldest slice first: slot s counts until currentSlot reaches s + LORA_DUTY_BUCKETS + 1
+    uint32_t need = airtimeUs - remaining;
+    uint32_t freed = 0;
+    for (int age = LORA_DUTY_BUCKETS; age >= 0; age--) {
+        if ((uint32_t)age > currentSlot) continue; // Before the first use
+        uint32_t slot = currentSlot - age;
+        freed += buckets[slot % (LORA_DUTY_BUCKETS + 1)];
+        if (freed >= need) return (slot + LORA_DUTY_BUCKETS + 1) * bucketMs - nowMs;
+    }
+    return UINT32_MAX;
+}
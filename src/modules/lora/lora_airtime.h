@@ -0,0 +1,52 @@
+#pragma once
+#include <Arduino.h>
+
+#ifndef LORA_DUTY_CYCLE_PERMILLE
+#define LORA_DUTY_CYCLE_PERMILLE 10     // 1%, the EU868 g1 sub-band limit
+#endif
+#define LORA_DUTY_WINDOW_MS  3600000UL  // Duty cycle is averaged over an hour
+#define LORA_DUTY_BUCKETS    60
+
+struct LoRaModemParams {
+    uint8_t spreadingFactor = 7;  // 6..12
+    uint32_t bandwidthHz = 125000;
+    uint8_t codingRate = 5;       // Denominator of 4/5 .. 4/8
+    uint16_t preambleSymbols = 8;
+    bool explicitHeader = true;
+    bool crc = true;
+};
+
+// Time on air in us, from the Semtech SX127x datasheet (section 4.1.1.7).
+// Low data rate optimisation is assumed on when a symbol is longer than
+// 16ms, which is what the LoRa library configures.
+uint32_t loraTimeOnAirUs(const LoRaModemParams& params, uint8_t payloadLen);
+uint32_t loraSymbolUs(const LoRaModemParams& params);
+
+// Sliding window of transmit airtime, in LORA_DUTY_BUCKETS slices so the
+// memory is fixed and old airtime expires a slice at a time. A slice is kept
+// one extra slice long, so airtime never leaves the window early.
+class DutyCycleBudget {
+public:
+    explicit DutyCycleBudget(uint16_t permille = LORA_DUTY_CYCLE_PERMILLE, uint32_t windowMs = LORA_DUTY_WINDOW_MS);
+
+    uint32_t getBudgetUs() { return budgetUs; }
+    uint32_t getUsedUs(uint32_t nowMs);
+    uint32_t getRemainingUs(uint32_t nowMs);
+
+    bool canTransmit(uint32_t airtimeUs, uint32_t nowMs) { return airtimeUs <= getRemainingUs(nowMs); }
+    void record(uint32_t airtimeUs, uint32_t nowMs);
+
+    // How long until enough airtime has expired to send airtimeUs, 0 if it fits now
+    uint32_t getWaitMs(uint32_t airtimeUs, uint32_t nowMs);
+
+    void reset();
+
+private:
+    uint32_t buckets[LORA_DUTY_BUCKETS + 1];
+    uint32_t bucketMs;
+    uint32_t budgetUs;
+    uint32_t currentSlot = 0;  // nowMs / bucketMs of the newest bucket
+    bool started = false;
+
+    void advance(uint32_t nowMs);
+};
@@ -0,0 +1,73 @@
+#include "lora_log.h"
+
+size_t formatLoRaLogLine(const LoRaPacket& packet, char* out, size_t max) {
+    static const char hexDigits[] = "0123456789ABCDEF";
+    int n = snprintf(out, max, "%lu,%lu,%u,%lu,%d,%.2f,%u,",
+                     (unsigned long)packet.timestampMs, (unsigned long)packet.frequencyHz,
+                     packet.spreadingFactor, (unsigned long)packet.bandwidthHz,
+                     packet.rssi, packet.snr, packet.length);
+    if (n < 0 || (size_t)n + packet.length * 2 + 2 > max) return 0;
+
+    char* p = out + n;
+    for (uint8_t i = 0; i < packet.length; i++) {
+        *p++ = hexDigits[packet.data[i] >> 4];
+        *p++ = hexDigits[packet.data[i] & 0x0F];
+    }
+    *p++ = '\n';
+    *p = '\0';
+    return p - out;
+}
+
+bool LoRaLogWriter::begin(const String& path) {
+    if (open) return true;
+    if (!SD.exists(LORA_LOG_DIR)) SD.mkdir(LORA_LOG_DIR);
+    bool isNew = !SD.exists(path);
+    file = SD.open(path, FILE_APPEND);
+    if (!file) {
+        Serial.println("LoRa: failed to open " + path);
+        return false;
+    }
+    if (isNew) file.print(LORA_LOG_HEADER);
+    open = true;
+    bufferLen = 0;
+    lines = writes = errors = 0;
+    return true;
+}
+
+bool LoRaLogWriter::append(const LoRaPacket& packet) {
+    if (!open) return false;
+    if (bufferLen + LORA_LOG_LINE_MAX > sizeof(buffer)) flush();
+
+    size_t len = formatLoRaLogLine(packet, buffer + bufferLen, sizeof(buffer) - bufferLen);
+    if (len == 0) {
+        errors++;
+        return false;
+    }
+    if (bufferLen == 0) oldestMs = millis();
+    bufferLen += len;
+    lines++;
+    return true;
+}
+
+void LoRaLogWriter::poll() {
+    if (open && bufferLen > 0 && millis() - oldestMs >= LORA_LOG_FLUSH_MS) flush();
+}
+
+void LoRaLogWriter::flush() {
+    if (!open || bufferLen == 0) return;
+    size_t written = file.write((const uint8_t*)buffer, bufferLen);
+    if (written != bufferLen) {
+        Serial.println("LoRa: SD write failed");
+        errors++;
+    }
+    file.flush();
+    writes++;
+    bufferLen = 0;
+}
+
+void LoRaLogWriter::end() {
+    if (!open) return;
+    flush();
+    file.close();
+    open = false;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <Arduino.h>
+#include <SD.h>
+
+#define LORA_LOG_DIR        "/lora"
+#define LORA_LOG_FILE       "/lora/packets.csv"
+#define LORA_LOG_HEADER     "uptime_ms,freq_hz,sf,bw_hz,rssi_dbm,snr_db,len,payload_hex\n"
+#define LORA_MAX_PAYLOAD    255
+#define LORA_LOG_LINE_MAX   (64 + LORA_MAX_PAYLOAD * 2)
+#define LORA_LOG_BUFFER     2048 // Bytes held before an SD write
+#define LORA_LOG_FLUSH_MS   5000 // Quiet channels still reach the card this often
+
+struct LoRaPacket {
+    uint32_t timestampMs;  // millis() at the RxDone interrupt
+    uint32_t frequencyHz;
+    uint8_t spreadingFactor;
+    uint32_t bandwidthHz;
+    int16_t rssi;          // dBm
+    float snr;             // dB
+    uint8_t length;
+    uint8_t data[LORA_MAX_PAYLOAD];
+};
+
+// One CSV line, newline terminated. Returns its length, 0 if out is too small.
+size_t formatLoRaLogLine(const LoRaPacket& packet, char* out, size_t max);
+
+// Appends formatted packets to a single CSV on SD. Lines are collected in
+// RAM and written in LORA_LOG_BUFFER blocks, or when the oldest pending line
+// is LORA_LOG_FLUSH_MS old, so a busy channel costs one SD write per few
+// dozen packets instead of an open/write/close each.
+class LoRaLogWriter {
+public:
+    bool begin(const String& path = LORA_LOG_FILE);
+    void end();
+    bool isOpen() { return open; }
+
+    bool append(const LoRaPacket& packet);
+    void poll();   // Time based flush, call from the module loop
+    void flush();
+
+    uint32_t getLines() { return lines; }
+    uint32_t getWrites() { return writes; }
+    uint32_t getErrors() { return errors; }
+
+private:
+    File file;
+    bool open = false;
+    char buffer[LORA_LOG_BUFFER];
+    size_t bufferLen = 0;
+    uint32_t oldestMs = 0;
+    uint32_t lines = 0;
+    uint32_t writes = 0;
+    uint32_t errors = 0;
+};
@@ -0,0 +1,243 @@
+#pragma once
+#include <Arduino.h>
+#include "module_base.h"
+#include "display_manager.h"
+#include "sd_manager.h"
+#include "config_manager.h"
+#include "../../ui/icons.h"
+#include "lora_airtime.h"
+#include "lora_log.h"
+#include "lora_receiver.h"
+
+#define LORA_PING_LEN 16
+
+class LoRaModule : public Module {
+private:
+    enum State {
+        MENU,
+        PACKETS
+    };
+
+    State currentState = MENU;
+    int menuIndex = 0;
+    unsigned long lastDraw = 0;
+    uint32_t lastPackets = 0;
+    uint32_t pings = 0;
+    String message;
+
+    LoRaReceiver receiver;
+    LoRaLogWriter logWriter;
+    LoRaPacket lastPacket;
+    bool hasPacket = false;
+
+    LoRaModemParams configParams() {
+        ConfigData& data = ConfigManager::getInstance().data;
+        LoRaModemParams p;
+        p.spreadingFactor = constrain(data.loraSpreadingFactor, 6, 12);
+        p.bandwidthHz = data.loraBandwidth;
+        p.codingRate = constrain(data.loraCodingRate, 5, 8);
+        return p;
+    }
+
+    void startReceive() {
+        extern SDManager sdManager;
+        message = "";
+        ConfigData& data = ConfigManager::getInstance().data;
+        if (!receiver.begin(data.loraFrequency, configParams(), data.loraTxPower)) {
+            message = "SX127x not found";
+            return;
+        }
+        hasPacket = false;
+        lastPackets = 0;
+        // Packets are still shown without a card, just not kept
+        if (!sdManager.isMounted() || !logWriter.begin()) message = "Not logging: no SD card";
+    }
+
+    void stopReceive() {
+        receiver.end();
+        logWriter.end();
+    }
+
+    void sendPing() {
+        message = "";
+        if (!receiver.isRunning()) {
+            message = "Start receive first";
+            return;
+        }
+        char payload[LORA_PING_LEN + 1];
+        snprintf(payload, sizeof(payload), "ESPChain %07lu", (unsigned long)pings);
+        uint32_t airtime = loraTimeOnAirUs(receiver.getParams(), LORA_PING_LEN);
+        uint32_t waitMs = receiver.getBudget().getWaitMs(airtime, millis());
+        if (!receiver.send((const uint8_t*)payload, LORA_PING_LEN)) {
+            message = waitMs ? "Duty cycle: wait " + String(waitMs / 1000) + "s" : "Radio busy";
+            return;
+        }
+        pings++;
+        message = "Ping sent, " + String(airtime / 1000.0f, 1) + "ms on air";
+    }
+
+    static String payloadPreview(const LoRaPacket& p) {
+        // Text if it looks like text, hex otherwise
+        bool printable = p.length > 0;
+        for (uint8_t i = 0; i < p.length && printable; i++) printable = p.data[i] >= 0x20 && p.data[i] < 0x7F;
+        String s;
+        for (uint8_t i = 0; i < p.length && s.length() < 36; i++) {
+            if (printable) {
+                s += (char)p.data[i];
+            } else {
+                char hex[3];
+                snprintf(hex, sizeof(hex), "%02X", p.data[i]);
+                s += hex;
+            }
+        }
+        return s;
+    }
+
+    void drawPackets(DisplayManager* display) {
+        TFT_eSPI* tft = display->getTFT();
+        LoRaRxStats s = receiver.getStats();
+        uint32_t used = receiver.getBudget().getUsedUs(millis());
+
+        tft->fillRect(0, 45, 320, 105, THEME_BG); // Keeps the hint line at the bottom
+        tft->setTextDatum(TL_DATUM);
+        tft->setTextColor(THEME_TEXT, THEME_BG);
+        tft->drawString("Packets: " + String(s.packets) + "   Sent: " + String(s.sent) + "   CRC: " + String(s.crcErrors), 10, 50, 2);
+        if (hasPacket) {
+            tft->drawString("Last: " + String(lastPacket.rssi) + " dBm  SNR " + String(lastPacket.snr, 1) + " dB  " +
+                            String(lastPacket.length) + " B", 10, 70, 2);
+            tft->setTextColor(THEME_WARN, THEME_BG);
+            tft->drawString(payloadPreview(lastPacket), 10, 90, 2);
+            tft->setTextColor(THEME_TEXT, THEME_BG);
+        } else {
+            tft->drawString("Listening...", 10, 70, 2);
+        }
+        tft->drawString("Logged: " + String(logWriter.getLines()) + " in " + String(logWriter.getWrites()) + " writes", 10, 110, 2);
+
+        tft->setTextColor((s.dropped || s.missed) ? THEME_ERROR : THEME_OK, THEME_BG);
+        tft->drawString("Dropped: " + String(s.dropped + s.missed) + "   TX duty: " +
+                        String(used * 100.0f / receiver.getBudget().getBudgetUs(), 1) + "% of budget", 10, 130, 2);
+        tft->setTextColor(THEME_TEXT, THEME_BG);
+    }
+
+public:
+    void init() override {
+        currentState = MENU;
+        menuIndex = 0;
+        message = "";
+    }
+
+    void loop() override {
+        extern DisplayManager displayManager;
+        if (currentState != PACKETS || !receiver.isRunning()) return;
+        // Redraw on new packets, and now and then for the duty cycle figure
+        if (receiver.getStats().packets != lastPackets || millis() - lastDraw > 1000) {
+            lastPackets = receiver.getStats().packets;
+            drawPackets(&displayManager);
+            lastDraw = millis();
+        }
+    }
+
+    // Runs from the menu loop whether or not the module is open
+    void backgroundLoop() override {
+        if (!receiver.isRunning()) return;
+        receiver.poll();
+        LoRaPacket packet;
+        while (receiver.read(packet)) {
+            logWriter.append(packet);
+            lastPacket = packet;
+            hasPacket = true;
+        }
+        logWriter.poll();
+    }
+
+    bool isBackgroundRunning() override {
+        return receiver.isRunning();
+    }
+
+    String getName() override {
+        return "LoRa";
+    }
+    const unsigned char* getIcon() override { return image_music_radio_streaming_bits; }
+    int getIconWidth() override { return 17; }
+    int getIconHeight() override { return 16; }
+    int getIconSpacing() override { return 14; }
+    int getIconOffsetY() override { return 1; }
+
+    String getDescription() override {
+        return "SX127x receive logger";
+    }
+
+    void drawMenu(DisplayManager* display) override {
+        extern SDManager sdManager;
+        display->clearContent();
+        display->drawStatusBar("LoRa", display->getBatteryVoltage(), sdManager.isMounted(), receiver.isRunning());
+        TFT_eSPI* tft = display->getTFT();
+
+        if (currentState == PACKETS) {
+            display->drawMenuTitle("Packets");
+            drawPackets(display);
+            tft->setTextDatum(MC_DATUM);
+            tft->drawString(logWriter.isOpen() ? LORA_LOG_FILE : "Not logging", 160, 160, 2);
+            return;
+        }
+
+        ConfigData& data = ConfigManager::getInstance().data;
+        LoRaModemParams p = configParams();
+        display->drawMenuTitle("LoRa");
+        display->drawMenuItem(receiver.isRunning() ? "Stop Receive" : "Start Receive", 0, menuIndex == 0);
+        display->drawMenuItem("Packets", 1, menuIndex == 1);
+        display->drawMenuItem("Send Ping", 2, menuIndex == 2);
+
+        // What a ping costs with the configured modem settings
+        DutyCycleBudget& budget = receiver.getBudget();
+        uint32_t airtime = loraTimeOnAirUs(p, LORA_PING_LEN);
+        tft->setTextDatum(TL_DATUM);
+        tft->setTextColor(THEME_TEXT, THEME_BG);
+        tft->drawString(String(data.loraFrequency / 1e6, 3) + " MHz  SF" + String(p.spreadingFactor) + "  BW" +
+                        String(p.bandwidthHz / 1000) + "k  CR4/" + String(p.codingRate), 10, 108, 2);
+        tft->drawString("Ping " + String(airtime / 1000.0f, 1) + "ms, " + String(budget.getBudgetUs() / airtime) +
+                        "/h at " + String(LORA_DUTY_CYCLE_PERMILLE / 10.0f, 1) + "% duty", 10, 124, 2);
+        if (message.length() > 0) {
+            tft->setTextDatum(MC_DATUM);
+            tft->setTextColor(THEME_ERROR, THEME_BG);
+            tft->drawString(message, 160, 152, 2);
+            tft->setTextColor(THEME_TEXT, THEME_BG);
+        }
+    }
+
+    bool handleInput(uint8_t button) override {
+        extern DisplayManager displayManager;
+
+        if (button == 3) { // Back / Long Press, receive keeps running in the background
+            if (currentState == MENU) return false;
+            currentState = MENU;
+            drawMenu(&displayManager);
+            return true;
+        }
+
+        if (button == 1) { // Scroll
+            if (currentState == MENU) menuIndex = (menuIndex + 1) % 3;
+            else currentState = MENU;
+            drawMenu(&displayManager);
+            return true;
+        }
+
+        if (button == 2) { // Select
+            if (currentState == MENU) {
+                if (menuIndex == 0) {
+                    if (receiver.isRunning()) stopReceive();
+                    else startReceive();
+                } else if (menuIndex == 1) {
+                    currentState = PACKETS;
+                } else {
+                    sendPing();
+                }
+            } else {
+                currentState = MENU;
+            }
+            drawMenu(&displayManager);
+            return true;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,180 @@
+#include "lora_receiver.h"
+#include <SPI.h>
+#include <LoRa.h>
+
+// SPI Pins matching SD Card
+#define SPI_MOSI 11
+#define SPI_MISO 13
+#define SPI_SCK  12
+
+bool LoRaReceiver::begin(long frequencyHz, const LoRaModemParams& modem, int txPower) {
+    if (running) return true;
+
+    // LoRa.begin() only calls SPI.begin() without pins, make sure the shared bus is up first
+    SPI.begin(SPI_SCK, SPI_MISO, SPI_MOSI);
+    LoRa.setPins(LORA_CS, LORA_RST, LORA_DIO0);
+    if (!LoRa.begin(frequencyHz)) {
+        Serial.println("LoRa: SX127x not found");
+        releaseBus();
+        return false;
+    }
+    LoRa.setSpreadingFactor(modem.spreadingFactor);
+    LoRa.setSignalBandwidth(modem.bandwidthHz);
+    LoRa.setCodingRate4(modem.codingRate);
+    LoRa.setPreambleLength(modem.preambleSymbols);
+    LoRa.setTxPower(constrain(txPower, 2, 20)); // PA_BOOST range
+    if (modem.crc) LoRa.enableCrc();
+    else LoRa.disableCrc();
+
+    params = modem;
+    frequency = frequencyHz;
+    memset(&stats, 0, sizeof(stats));
+    irqCount = handledIrqs = 0;
+    queueHead = queueTail = 0;
+    txPending = transmitting = false;
+    stopRequested = false;
+    running = true;
+
+    pinMode(LORA_DIO0, INPUT);
+    attachInterruptArg(LORA_DIO0, onDio0, this, RISING);
+    LoRa.receive(); // Continuous RX, DIO0 mapped to RxDone
+
+    if (xTaskCreate(radioLoop, "lora_radio", 4096, this, 3, &radioTask) != pdPASS) {
+        radioTask = nullptr; // poll() services the radio from the module loop instead
+    }
+    return true;
+}
+
+void IRAM_ATTR LoRaReceiver::onDio0(void* arg) {
+    LoRaReceiver* self = (LoRaReceiver*)arg;
+    self->irqMs = millis();
+    self->irqCount++;
+    if (self->radioTask) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(self->radioTask, &woken);
+        if (woken) portYIELD_FROM_ISR();
+    }
+}
+
+void LoRaReceiver::radioLoop(void* param) {
+    LoRaReceiver* self = static_cast<LoRaReceiver*>(param);
+    while (!self->stopRequested) {
+        // The timeout only bounds how long stop() and queued sends wait,
+        // and how late the end of a send is seen
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(self->transmitting ? LORA_TX_POLL_MS : 50));
+        self->service();
+    }
+    self->radioTask = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void LoRaReceiver::poll() {
+    if (running && !radioTask) service();
+}
+
+void LoRaReceiver::service() {
+    if (transmitting) {
+        // DIO0 stays mapped to RxDone, so the end of a send is polled:
+        // isTransmitting() reads the mode and clears TxDone once it is set
+        bool late = (int32_t)(millis() - txDeadlineMs) > 0;
+        if (LoRa.isTransmitting() && !late) return;
+        if (late) stats.txTimeouts++;
+        else stats.sent++;
+        transmitting = false;
+        LoRa.receive();
+    }
+
+    uint32_t count = irqCount;
+    uint32_t timestampMs = irqMs;
+    if (count != handledIrqs) {
+        // Continuous RX keeps only the newest packet in the FIFO
+        stats.missed += count - handledIrqs - 1;
+        handledIrqs = count;
+        receivePacket(timestampMs);
+    }
+    if (txPending) startTransmit();
+}
+
+void LoRaReceiver::receivePacket(uint32_t timestampMs) {
+    int len = LoRa.parsePacket();
+    if (len <= 0) {
+        stats.crcErrors++; // parsePacket() discards packets that failed CRC
+        LoRa.receive();
+        return;
+    }
+
+    uint32_t head = queueHead;
+    uint32_t next = (head + 1) & LORA_QUEUE_MASK;
+    if (next == __atomic_load_n(&queueTail, __ATOMIC_ACQUIRE)) {
+        stats.dropped++;
+        LoRa.receive();
+        return;
+    }
+
+    LoRaPacket& p = queue[head];
+    p.timestampMs = timestampMs;
+    p.frequencyHz = frequency;
+    p.spreadingFactor = params.spreadingFactor;
+    p.bandwidthHz = params.bandwidthHz;
+    p.length = 0;
+    while (LoRa.available() && p.length < LORA_MAX_PAYLOAD) p.data[p.length++] = LoRa.read();
+    p.rssi = LoRa.packetRssi();
+    p.snr = LoRa.packetSnr();
+    LoRa.receive(); // parsePacket() left the radio idle
+
+    stats.packets++;
+    stats.airtimeUs += loraTimeOnAirUs(params, p.length);
+    stats.lastRssi = p.rssi;
+    stats.lastSnr = p.snr;
+    __atomic_store_n(&queueHead, next, __ATOMIC_RELEASE);
+}
+
+bool LoRaReceiver::read(LoRaPacket& out) {
+    uint32_t tail = queueTail;
+    if (tail == __atomic_load_n(&queueHead, __ATOMIC_ACQUIRE)) return false;
+    out = queue[tail];
+    __atomic_store_n(&queueTail, (tail + 1) & LORA_QUEUE_MASK, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool LoRaReceiver::send(const uint8_t* data, uint8_t len) {
+    if (!running || txPending || transmitting) return false;
+    uint32_t airtime = loraTimeOnAirUs(params, len);
+    if (!budget.canTransmit(airtime, millis())) return false;
+    budget.record(airtime, millis());
+
+    memcpy(txData, data, len);
+    txLen = len;
+    txPending = true;
+    if (radioTask) xTaskNotifyGive(radioTask);
+    return true;
+}
+
+void LoRaReceiver::startTransmit() {
+    // The library only maps DIO0 to TxDone with its own onTxDone() handler,
+    // which would replace onDio0(); service() polls for the end instead
+    txDeadlineMs = millis() + loraTimeOnAirUs(params, txLen) / 1000 * 2 + LORA_TX_MARGIN_MS;
+    transmitting = true;
+    txPending = false;
+    LoRa.beginPacket();
+    LoRa.write(txData, txLen);
+    LoRa.endPacket(true);
+}
+
+void LoRaReceiver::end() {
+    if (!running) return;
+    detachInterrupt(LORA_DIO0);
+    stopRequested = true;
+    if (radioTask) xTaskNotifyGive(radioTask);
+    while (radioTask) delay(5);
+
+    LoRa.end();
+    releaseBus();
+    running = false;
+}
+
+// LoRa.end() calls SPI.end(), which also detaches the SD card
+void LoRaReceiver::releaseBus() {
+    digitalWrite(LORA_CS, HIGH);
+    SPI.begin(SPI_SCK, SPI_MISO, SPI_MOSI);
+}
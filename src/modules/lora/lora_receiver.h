@@ -0,0 +1,95 @@
+#pragma once
+#include <Arduino.h>
+#include "lora_airtime.h"
+#include "lora_log.h"
+
+// SX127x on the SD card's SPI bus (see SDManager)
+#ifndef LORA_CS
+#define LORA_CS 18
+#endif
+#ifndef LORA_DIO0
+#define LORA_DIO0 21 // RxDone, the end of a send is polled
+#endif
+#ifndef LORA_RST
+#define LORA_RST -1  // Not wired, the module resets on power up
+#endif
+
+#define LORA_TX_POLL_MS   5   // Radio task wake-up while a send is on air
+#define LORA_TX_MARGIN_MS 100 // Past twice the time on air a send is given up
+
+#define LORA_QUEUE_SLOTS 8 // Packets waiting for the logger, power of two
+#define LORA_QUEUE_MASK  (LORA_QUEUE_SLOTS - 1)
+
+static_assert((LORA_QUEUE_SLOTS & LORA_QUEUE_MASK) == 0, "queue size must be a power of two");
+
+struct LoRaRxStats {
+    uint32_t packets;    // Queued
+    uint32_t dropped;    // Queue full
+    uint32_t missed;     // RxDone interrupts that were overtaken by the next packet
+    uint32_t crcErrors;
+    uint32_t sent;
+    uint32_t txTimeouts; // Sends the radio never reported done
+    uint32_t airtimeUs;  // Received, a rough measure of how busy the channel is
+    int16_t lastRssi;
+    float lastSnr;
+};
+
+// Continuous receive with the SX127x's DIO0 as the RxDone interrupt. The
+// ISR only timestamps and wakes a radio task; the task reads the FIFO over
+// SPI and pushes the packet into a lock-free queue for the module loop to
+// log, so nothing in the ISR touches the bus and SD writes never delay a read.
+// The library's own onReceive() is not used because it reads the FIFO from
+// inside the interrupt.
+class LoRaReceiver {
+public:
+    bool begin(long frequencyHz, const LoRaModemParams& params, int txPower);
+    void end();
+    bool isRunning() { return running; }
+
+    // Services the radio when the task could not be started
+    void poll();
+
+    // Oldest queued packet, from the module loop
+    bool read(LoRaPacket& out);
+
+    // Queues a packet for the radio task. Refused while a transmission is
+    // pending or when it would overrun the duty cycle budget.
+    bool send(const uint8_t* data, uint8_t len);
+    bool isSending() { return txPending || transmitting; }
+
+    LoRaRxStats getStats() { return stats; }
+    DutyCycleBudget& getBudget() { return budget; }
+    const LoRaModemParams& getParams() { return params; }
+    long getFrequency() { return frequency; }
+
+private:
+    LoRaModemParams params;
+    long frequency = 0;
+    volatile bool running = false;
+    volatile bool stopRequested = false;
+    TaskHandle_t radioTask = nullptr;
+
+    volatile uint32_t irqCount = 0;  // Written by the ISR
+    volatile uint32_t irqMs = 0;
+    uint32_t handledIrqs = 0;
+
+    LoRaPacket queue[LORA_QUEUE_SLOTS];
+    volatile uint32_t queueHead = 0; // Written by the radio task
+    volatile uint32_t queueTail = 0; // Written by read()
+
+    uint8_t txData[LORA_MAX_PAYLOAD];
+    uint8_t txLen = 0;
+    volatile bool txPending = false;
+    volatile bool transmitting = false;
+    uint32_t txDeadlineMs = 0;
+    DutyCycleBudget budget;
+
+    LoRaRxStats stats;
+
+    static void IRAM_ATTR onDio0(void* arg);
+    static void radioLoop(void* param);
+    void service();
+    void receivePacket(uint32_t timestampMs);
+    void startTransmit();
+    void releaseBus();
+};
@@ -18,18 +18,20 @@ private:
     };
     State currentState;
     int menuIndex;
-    int selectedIndex;
     bool isScanning;
     std::vector<String> scanResults;
+    ListView resultList;
     
 public:
     void init() override {
         // Initialization code for NRF24 module
         currentState = MENU;
         menuIndex = 0;
-        selectedIndex = 0;
         isScanning = false;
         scanResults.clear();
+        extern DisplayManager displayManager;
+        resultList.begin(&displayManager, [this](int index, ListRow& row) { row.text = scanResults[index]; });
+        resultList.reset(0);
 
     }
     void loop() override {
@@ -80,7 +82,7 @@ public:
                 display->drawMenuItem(isScanning ? "Stop Scan" : "Start Scan", 0, menuIndex == 0);
                 if (isScanning) {
                     display->getTFT()->setTextDatum(MC_DATUM);
-                    display->getTFT()->setTextColor(TFT_GREEN, THEME_BG);
+                    display->getTFT()->setTextColor(THEME_OK, THEME_BG);
                     display->getTFT()->drawString("Scanning...", 160, 160, 2);
                 }
                 display->drawMenuItem("View Results", 1, menuIndex == 1);
@@ -92,7 +94,7 @@ public:
                     display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
                     display->getTFT()->drawString("No Devices Found", 160, 100, 2);
                     display->getTFT()->setTextDatum(MC_DATUM);
-                    display->getTFT()->setTextColor(TFT_RED, THEME_BG);
+                    display->getTFT()->setTextColor(THEME_ERROR, THEME_BG);
                     display->getTFT()->drawString("Warning: Not Scanning", 160, 130, 2);
                     display->getTFT()->setTextDatum(MC_DATUM);
                     display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
@@ -101,17 +103,8 @@ public:
                     display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
                     display->getTFT()->drawString("Scanning...", 160, 100, 2);
                 } else {
-                    // Show 5 items centered around selectedIndex
-                    int start = 0;
-                    if (selectedIndex > 2) start = selectedIndex - 2;
-                    if (start + 5 > scanResults.size()) start = scanResults.size() - 5;
-                    if (start < 0) start = 0;
-
-                    for (int i = 0; i < 5 && (start + i) < scanResults.size(); i++) {
-                        int idx = start + i;
-                        String label = scanResults[idx];
-                        display->drawMenuItem(label, i, idx == selectedIndex);
-                    }
+                    resultList.setCount(scanResults.size());
+                    resultList.draw();
                 }
                 break;
             case SNIFFER:
@@ -165,7 +158,10 @@ public:
                     break;
                 case VIEW_RESULTS:
                     if (!scanResults.empty()) {
-                        selectedIndex = (selectedIndex + 1) % scanResults.size();
+                        resultList.setCount(scanResults.size());
+                        resultList.next();
+                        resultList.update();
+                        return true;
                     }
                     break;
                 default:
@@ -203,7 +199,7 @@ public:
                         break;
                     case 1:
                         currentState = VIEW_RESULTS;
-                        selectedIndex = 0;
+                        resultList.reset(scanResults.size());
                         break;
                     }
                 }
@@ -52,8 +52,9 @@ public:
             display->drawMenuItem("Bright: " + String(data.displayBrightness), 0, menuIndex == 0);
             String toStr = (data.displayTimeout == -1) ? "Always On" : String(data.displayTimeout) + "s";
             display->drawMenuItem("Timeout: " + toStr, 1, menuIndex == 1);
-            display->drawMenuItem("Back", 2, menuIndex == 2);
-            display->drawScrollBar(3, 0, 5);
+            display->drawMenuItem("Theme: " + String(activeTheme.name), 2, menuIndex == 2);
+            display->drawMenuItem("Back", 3, menuIndex == 3);
+            display->drawScrollBar(4, 0, 5);
         }
         else if (currentState == STATE_WIFI) {
             display->drawMenuItem("AutoScan: " + getBoolStr(data.wifiAutoScan), 0, menuIndex == 0);
@@ -85,7 +86,7 @@ public:
         if (button == 1) { // Scroll
             int maxItems = 0;
             if (currentState == STATE_MAIN) maxItems = 5;
-            else if (currentState == STATE_DISPLAY) maxItems = 3;
+            else if (currentState == STATE_DISPLAY) maxItems = 4;
             else if (currentState == STATE_WIFI) maxItems = 4;
             else if (currentState == STATE_BADUSB) maxItems = 4;
             else if (currentState == STATE_TIME) maxItems = 4;
@@ -125,7 +126,11 @@ public:
                         if (data.displayTimeout > 60) data.displayTimeout = -1;
                     }
                 }
-                else if (menuIndex == 2) { currentState = STATE_MAIN; menuIndex = 0; }
+                else if (menuIndex == 2) { // Theme, the menu system repaints everything once
+                    data.displayTheme = THEMES[(themeIndex(activeTheme.name) + 1) % THEME_COUNT].name;
+                    if (displayManager.setTheme(data.displayTheme)) return true;
+                }
+                else if (menuIndex == 3) { currentState = STATE_MAIN; menuIndex = 0; }
             }
             else if (currentState == STATE_WIFI) {
                 if (menuIndex == 0) data.wifiAutoScan = !data.wifiAutoScan;
@@ -1,2 +1,91 @@
-#include <Arduino.h>
-// CC1101 driver implementation
+#include "cc1101_driver.h"
+#include <ELECHOUSE_CC1101_SRC_DRV.h>
+
+// SPI Pins matching SD Card
+#define SPI_MOSI 11
+#define SPI_MISO 13
+#define SPI_SCK  12
+
+#define CC1101_RX_BW_KHZ 270.0 // Wide enough for cheap remotes drifting off 433.92
+
+bool CC1101Driver::begin() {
+    ELECHOUSE_cc1101.setSpiPin(SPI_SCK, SPI_MISO, SPI_MOSI, CC1101_CS);
+    ELECHOUSE_cc1101.setGDO0(CC1101_GDO0);
+
+    connected = ELECHOUSE_cc1101.getCC1101();
+    if (!connected) {
+        Serial.println("CC1101 not found");
+        releaseBus();
+        return false;
+    }
+
+    ELECHOUSE_cc1101.Init();
+    ELECHOUSE_cc1101.setCCMode(0);    // Raw data on GDO0 instead of the FIFO
+    ELECHOUSE_cc1101.setPktFormat(3); // Asynchronous serial mode
+    ELECHOUSE_cc1101.setModulation(modulation);
+    ELECHOUSE_cc1101.setMHZ(frequency);
+    ELECHOUSE_cc1101.setRxBW(CC1101_RX_BW_KHZ);
+    ELECHOUSE_cc1101.setSidle();
+    releaseBus();
+    return true;
+}
+
+// The library calls SPI.end() after every register access, which also
+// detaches the SD card. Re-attach the shared pins once it is done.
+void CC1101Driver::releaseBus() {
+    digitalWrite(CC1101_CS, HIGH);
+    SPI.begin(SPI_SCK, SPI_MISO, SPI_MOSI);
+}
+
+bool CC1101Driver::isValidFrequency(float mhz) {
+    return (mhz >= 300 && mhz <= 348) || (mhz >= 387 && mhz <= 464) || (mhz >= 779 && mhz <= 928);
+}
+
+bool CC1101Driver::setFrequency(float mhz) {
+    if (!isValidFrequency(mhz)) return false;
+    frequency = mhz;
+    if (connected) {
+        ELECHOUSE_cc1101.setMHZ(mhz);
+        releaseBus();
+    }
+    return true;
+}
+
+void CC1101Driver::setModulation(uint8_t mod) {
+    modulation = mod;
+    if (connected) {
+        ELECHOUSE_cc1101.setModulation(mod);
+        releaseBus();
+    }
+}
+
+bool CC1101Driver::startAsyncRx() {
+    if (!connected) return false;
+    ELECHOUSE_cc1101.SetRx();
+    releaseBus();
+    pinMode(CC1101_GDO0, INPUT);
+    return true;
+}
+
+bool CC1101Driver::startAsyncTx() {
+    if (!connected) return false;
+    pinMode(CC1101_GDO0, OUTPUT);
+    digitalWrite(CC1101_GDO0, LOW); // Carrier off until the first pulse
+    ELECHOUSE_cc1101.SetTx();
+    releaseBus();
+    return true;
+}
+
+void CC1101Driver::idle() {
+    if (!connected) return;
+    ELECHOUSE_cc1101.setSidle();
+    releaseBus();
+    pinMode(CC1101_GDO0, INPUT);
+}
+
+int CC1101Driver::getRssi() {
+    if (!connected) return 0;
+    int rssi = ELECHOUSE_cc1101.getRssi();
+    releaseBus();
+    return rssi;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <Arduino.h>
+#include <SPI.h>
+
+// CC1101 on the SD card's SPI bus (see SDManager)
+#ifndef CC1101_CS
+#define CC1101_CS 1
+#endif
+#ifndef CC1101_GDO0
+#define CC1101_GDO0 16 // Async serial data: demodulated RX out, TX in
+#endif
+
+#define CC1101_MOD_2FSK 0
+#define CC1101_MOD_ASK  2 // ASK/OOK, what most fixed code remotes use
+
+class CC1101Driver {
+public:
+    bool begin();
+    bool isConnected() { return connected; }
+
+    static bool isValidFrequency(float mhz);
+    bool setFrequency(float mhz);
+    float getFrequency() { return frequency; }
+    void setModulation(uint8_t modulation);
+    uint8_t getModulation() { return modulation; }
+
+    // Async serial mode: no packet engine, GDO0 carries the raw demodulated
+    // signal so edges can be timed by the capture ISR
+    bool startAsyncRx();
+    bool startAsyncTx();
+    void idle();
+    int getRssi();
+
+private:
+    bool connected = false;
+    float frequency = 433.92;
+    uint8_t modulation = CC1101_MOD_ASK;
+
+    void releaseBus();
+};
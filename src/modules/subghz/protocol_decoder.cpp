@@ -0,0 +1,218 @@
+#include "protocol_decoder.h"
+
+// Non-inverted protocols from the rc-switch library's table, then a
+// generic Manchester fallback. Order matters: first match wins.
+static const OokProtocol protocols[] = {
+    // name             coding          te range    0      1      sync    bits
+    {"PT2262/EV1527",   OOK_PWM,        175, 600,   1, 3,  3, 1,  1, 31,  12, 32},
+    {"RC-Switch 2",     OOK_PWM,        400, 900,   1, 2,  2, 1,  1, 10,  12, 32},
+    {"RC-Switch 3",     OOK_PWM,        60,  150,   4, 11, 9, 6,  30, 71, 12, 32},
+    {"RC-Switch 4",     OOK_PWM,        250, 500,   1, 3,  3, 1,  1, 6,   12, 32},
+    {"RC-Switch 5",     OOK_PWM,        300, 700,   1, 2,  2, 1,  6, 14,  12, 32},
+    {"HS2303-PT",       OOK_PWM,        90,  220,   1, 6,  6, 1,  2, 62,  12, 32},
+    {"Manchester",      OOK_MANCHESTER, 150, 1500,  0, 0,  0, 0,  0, 0,   16, 64},
+};
+#define PROTOCOL_COUNT (sizeof(protocols) / sizeof(protocols[0]))
+
+const OokProtocol* ProtocolDecoder::getProtocols(int& count) {
+    count = PROTOCOL_COUNT;
+    return protocols;
+}
+
+static inline bool near(uint32_t actual, uint32_t expected) {
+    uint32_t diff = actual > expected ? actual - expected : expected - actual;
+    return (uint64_t)diff * 100 <= (uint64_t)expected * OOK_TOLERANCE;
+}
+
+void ProtocolDecoder::reset() {
+    frameLen = 0;
+    overflow = false;
+    frames = 0;
+    decoded = 0;
+    portENTER_CRITICAL(&resultLock);
+    resultCount = 0;
+    resultHead = 0;
+    portEXIT_CRITICAL(&resultLock);
+}
+
+bool ProtocolDecoder::feed(uint32_t durationUs, bool level) {
+    if (!level && durationUs >= OOK_FRAME_GAP_US) {
+        bool ok = frameLen > 1 && !overflow && decodeFrame(durationUs);
+        frameLen = 0;
+        overflow = false;
+        return ok;
+    }
+    if (frameLen == 0 && !level) return false; // Frames start high
+    if (frameLen >= OOK_FRAME_MAX_PULSES) {
+        overflow = true;
+        return false;
+    }
+    frame[frameLen++] = durationUs;
+    return false;
+}
+
+bool ProtocolDecoder::decodeFrame(uint32_t gapUs) {
+    frames++;
+    // The last pulse is the sync high for PWM protocols, keep it out of the estimate
+    clusterPulses(frameLen - 1);
+    if (clusterCount == 0) return false;
+
+    DecodedCode code;
+    for (size_t i = 0; i < PROTOCOL_COUNT; i++) {
+        const OokProtocol& p = protocols[i];
+        bool ok = p.coding == OOK_PWM ? matchPwm(p, gapUs, code) : matchManchester(p, code);
+        if (ok) {
+            code.protocol = &p;
+            publish(code);
+            decoded++;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Single pass: join the first cluster within tolerance, or open a new one
+void ProtocolDecoder::clusterPulses(size_t count) {
+    clusterCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t d = frame[i];
+        int c = 0;
+        while (c < clusterCount && !near(d, clusters[c].centroid)) c++;
+        if (c == clusterCount) {
+            if (clusterCount == OOK_MAX_CLUSTERS) continue; // Outlier
+            clusters[c] = {0, 0, d};
+            clusterCount++;
+        }
+        clusters[c].sum += d;
+        clusters[c].count++;
+        clusters[c].centroid = clusters[c].sum / clusters[c].count;
+    }
+
+    // Shortest first
+    for (int i = 1; i < clusterCount; i++) {
+        PulseCluster key = clusters[i];
+        int j = i - 1;
+        while (j >= 0 && clusters[j].centroid > key.centroid) {
+            clusters[j + 1] = clusters[j];
+            j--;
+        }
+        clusters[j + 1] = key;
+    }
+}
+
+bool ProtocolDecoder::matchPwm(const OokProtocol& p, uint32_t gapUs, DecodedCode& out) {
+    if ((frameLen - 1) % 2 != 0) return false;
+    uint8_t bits = (frameLen - 1) / 2;
+    if (bits < p.minBits || bits > p.maxBits) return false;
+
+    // The shortest cluster is the protocol's shortest shape element
+    uint8_t minUnits = std::min(std::min(p.zeroHigh, p.zeroLow), std::min(p.oneHigh, p.oneLow));
+    uint32_t te = clusters[0].centroid / minUnits;
+    if (te < p.teMin || te > p.teMax) return false;
+    if (!near(frame[frameLen - 1], p.syncHigh * te) || !near(gapUs, p.syncLow * te)) return false;
+
+    uint64_t code = 0;
+    uint32_t zeroHigh = p.zeroHigh * te, zeroLow = p.zeroLow * te;
+    uint32_t oneHigh = p.oneHigh * te, oneLow = p.oneLow * te;
+    for (int i = 0; i < bits; i++) {
+        uint32_t high = frame[2 * i];
+        uint32_t low = frame[2 * i + 1];
+        if (near(high, zeroHigh) && near(low, zeroLow)) code <<= 1;
+        else if (near(high, oneHigh) && near(low, oneLow)) code = (code << 1) | 1;
+        else return false;
+    }
+
+    out.code = code;
+    out.bits = bits;
+    out.te = te;
+    return true;
+}
+
+bool ProtocolDecoder::matchManchester(const OokProtocol& p, DecodedCode& out) {
+    // Pulses are one or two half-bits long
+    uint32_t te = clusters[0].centroid;
+    if (te < p.teMin || te > p.teMax) return false;
+    if (clusterCount > 2 || (clusterCount == 2 && !near(clusters[1].centroid, 2 * te))) return false;
+
+    // Frames are bounded by low gaps, which can hold the first half of the
+    // first bit and the second half of the last one. Try both alignments.
+    for (int alignment = 0; alignment < 2; alignment++) {
+        uint64_t code = 0;
+        int bits = 0;
+        int firstHalf = alignment ? LOW : -1;
+        bool valid = true;
+
+        for (uint16_t i = 0; i < frameLen && valid; i++) {
+            int halves = near(frame[i], te) ? 1 : (near(frame[i], 2 * te) ? 2 : 0);
+            if (halves == 0) {
+                valid = false;
+                break;
+            }
+            int level = (i % 2 == 0) ? HIGH : LOW;
+            for (int h = 0; h < halves; h++) {
+                if (firstHalf < 0) {
+                    firstHalf = level;
+                } else if (firstHalf == level) {
+                    valid = false; // No mid-bit transition
+                    break;
+                } else {
+                    code = (code << 1) | (firstHalf == LOW ? 1 : 0); // IEEE 802.3: low to high is 1
+                    bits++;
+                    firstHalf = -1;
+                }
+            }
+        }
+        if (valid && firstHalf == HIGH) {
+            code <<= 1; // High then the gap: a trailing 0
+            bits++;
+        }
+
+        if (valid && bits >= p.minBits && bits <= p.maxBits) {
+            out.code = code;
+            out.bits = bits;
+            out.te = te;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ProtocolDecoder::publish(const DecodedCode& code) {
+    uint32_t now = millis();
+    portENTER_CRITICAL(&resultLock);
+    for (int i = 0; i < resultCount; i++) {
+        DecodedCode& r = results[i];
+        if (r.protocol == code.protocol && r.code == code.code && r.bits == code.bits &&
+            now - r.lastSeenMs < OOK_REPEAT_WINDOW_MS) {
+            r.repeats++;
+            r.lastSeenMs = now;
+            portEXIT_CRITICAL(&resultLock);
+            return;
+        }
+    }
+    DecodedCode& slot = results[resultHead];
+    slot = code;
+    slot.repeats = 1;
+    slot.lastSeenMs = now;
+    resultHead = (resultHead + 1) % OOK_RESULT_SLOTS;
+    if (resultCount < OOK_RESULT_SLOTS) resultCount++;
+    portEXIT_CRITICAL(&resultLock);
+}
+
+int ProtocolDecoder::getResults(DecodedCode* out, int max) {
+    portENTER_CRITICAL(&resultLock);
+    int n = std::min(max, resultCount);
+    for (int i = 0; i < n; i++) {
+        out[i] = results[(resultHead - 1 - i + OOK_RESULT_SLOTS) % OOK_RESULT_SLOTS];
+    }
+    portEXIT_CRITICAL(&resultLock);
+    return n;
+}
+
+String formatCode(const DecodedCode& code) {
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%llX", (unsigned long long)code.code);
+    String s = String(code.protocol->name) + " " + hex + " (" + String(code.bits) + "b)";
+    if (code.repeats > 1) s += " x" + String(code.repeats);
+    return s;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <Arduino.h>
+
+#define OOK_FRAME_MAX_PULSES  256
+#define OOK_FRAME_GAP_US      2000 // A low pulse this long ends a frame
+#define OOK_MAX_CLUSTERS      4
+#define OOK_TOLERANCE         35   // Percent, for clustering and matching
+#define OOK_RESULT_SLOTS      8
+#define OOK_REPEAT_WINDOW_MS  500  // Same code again within this counts as a repeat
+
+enum OokCoding : uint8_t {
+    OOK_PWM,        // Each bit is a high/low pair of fixed shape
+    OOK_MANCHESTER  // Half-bits of te, a transition in every bit
+};
+
+// Timings are in units of te, the protocol's base pulse width
+struct OokProtocol {
+    const char* name;
+    OokCoding coding;
+    uint16_t teMin, teMax;      // us
+    uint8_t zeroHigh, zeroLow;  // PWM only
+    uint8_t oneHigh, oneLow;
+    uint8_t syncHigh, syncLow;  // Last high pulse and the gap after it, PWM only
+    uint8_t minBits, maxBits;
+};
+
+struct PulseCluster {
+    uint32_t sum;
+    uint16_t count;
+    uint32_t centroid;
+};
+
+struct DecodedCode {
+    const OokProtocol* protocol;
+    uint64_t code;       // Last 64 bits, MSB first on air
+    uint8_t bits;
+    uint16_t te;
+    uint16_t repeats;
+    uint32_t lastSeenMs;
+};
+
+// Streaming OOK/ASK decoder. Pulses are buffered until a long low gap ends
+// the frame, then the frame's widths are clustered to estimate te, and the
+// protocol table is tried in order; the first matcher that slices every
+// pulse into a valid bit wins. Work per pulse is a store, per frame it is
+// O(pulses * protocols), cheap enough to run in the capture writer task.
+class ProtocolDecoder {
+public:
+    void reset();
+
+    // One glitch-filtered pulse, true when it ended a frame that decoded
+    bool feed(uint32_t durationUs, bool level);
+
+    // Newest first, safe to call from another task
+    int getResults(DecodedCode* out, int max);
+
+    uint32_t getFrames() { return frames; }
+    uint32_t getDecoded() { return decoded; }
+
+    static const OokProtocol* getProtocols(int& count);
+
+private:
+    uint32_t frame[OOK_FRAME_MAX_PULSES];
+    uint16_t frameLen = 0;
+    bool overflow = false;
+
+    PulseCluster clusters[OOK_MAX_CLUSTERS];
+    int clusterCount = 0;
+
+    DecodedCode results[OOK_RESULT_SLOTS];
+    int resultCount = 0;
+    int resultHead = 0;
+    portMUX_TYPE resultLock = portMUX_INITIALIZER_UNLOCKED;
+
+    uint32_t frames = 0;
+    uint32_t decoded = 0;
+
+    bool decodeFrame(uint32_t gapUs);
+    void clusterPulses(size_t count);
+    bool matchPwm(const OokProtocol& p, uint32_t gapUs, DecodedCode& out);
+    bool matchManchester(const OokProtocol& p, DecodedCode& out);
+    void publish(const DecodedCode& code);
+};
+
+String formatCode(const DecodedCode& code);
@@ -0,0 +1,59 @@
+#include "pulse_codec.h"
+
+static_assert(sizeof(PulseFileHeader) == 32, "pulse file header layout");
+
+size_t PulseEncoder::encode(uint32_t duration, uint8_t* out) {
+    // Differences wrap mod 2^32, so any duration round-trips
+    int32_t diff = (int32_t)(duration - prev[parity]);
+    uint32_t zz = ((uint32_t)diff << 1) ^ (uint32_t)(diff >> 31);
+    prev[parity] = duration;
+    parity ^= 1;
+
+    size_t n = 0;
+    while (zz >= 0x80) {
+        out[n++] = (uint8_t)(zz | 0x80);
+        zz >>= 7;
+    }
+    out[n++] = (uint8_t)zz;
+    return n;
+}
+
+void PulseDecoder::reset() {
+    prev[0] = prev[1] = 0;
+    parity = 0;
+    value = 0;
+    shift = 0;
+    errors = 0;
+}
+
+bool PulseDecoder::feed(uint8_t b, uint32_t& duration) {
+    if (shift >= 7 * PULSE_VARINT_MAX) {
+        // Corrupt input, drop bytes until the varint ends
+        if (!(b & 0x80)) {
+            errors++;
+            value = 0;
+            shift = 0;
+        }
+        return false;
+    }
+
+    value |= (uint32_t)(b & 0x7F) << shift;
+    shift += 7;
+    if (b & 0x80) return false;
+
+    int32_t diff = (int32_t)((value >> 1) ^ (0u - (value & 1)));
+    duration = prev[parity] + (uint32_t)diff;
+    prev[parity] = duration;
+    parity ^= 1;
+    value = 0;
+    shift = 0;
+    return true;
+}
+
+size_t PulseDecoder::decode(const uint8_t* in, size_t len, uint32_t* out, size_t maxOut) {
+    size_t count = 0;
+    for (size_t i = 0; i < len && count < maxOut; i++) {
+        if (feed(in[i], out[count])) count++;
+    }
+    return count;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <Arduino.h>
+
+// Pulse train files written by SignalCapture: a fixed header, then one
+// varint per pulse. Levels alternate starting with firstLevel, so only
+// durations are stored. Each one is coded as the zigzag difference to the
+// previous pulse of the same level; remotes repeat a handful of widths, so
+// most pulses take a single byte.
+#define PULSE_FILE_MAGIC   0x534C5045 // "EPLS"
+#define PULSE_FILE_VERSION 1
+#define PULSE_FILE_EXT     ".pls"
+#define PULSE_VARINT_MAX   5          // Bytes for a 32-bit value
+
+struct PulseFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;    // Pulses start here, lets readers skip newer fields
+    uint32_t frequencyKhz;
+    uint8_t modulation;     // SmartRC numbering, 2 = ASK/OOK
+    uint8_t firstLevel;
+    uint16_t resolutionNs;  // Timestamp tick, 1000 = 1us
+    uint32_t pulseCount;
+    uint32_t durationMs;
+    uint32_t droppedEdges;  // 0 = no gaps in the recording
+    uint32_t reserved;
+};
+
+class PulseEncoder {
+public:
+    void reset() { prev[0] = prev[1] = 0; parity = 0; }
+
+    // Writes up to PULSE_VARINT_MAX bytes to out, returns the count
+    size_t encode(uint32_t duration, uint8_t* out);
+
+private:
+    uint32_t prev[2] = {0, 0};
+    uint8_t parity = 0;
+};
+
+// Byte at a time so a file can be decoded in chunks of any size
+class PulseDecoder {
+public:
+    void reset();
+
+    // True when b completed a pulse, stored in duration
+    bool feed(uint8_t b, uint32_t& duration);
+
+    // Decodes a whole buffer, returns the number of pulses written to out
+    size_t decode(const uint8_t* in, size_t len, uint32_t* out, size_t maxOut);
+
+    bool isPartial() { return shift != 0; }  // Input ended inside a varint
+    uint32_t getErrors() { return errors; }  // Overlong varints skipped
+
+private:
+    uint32_t prev[2] = {0, 0};
+    uint8_t parity = 0;
+    uint32_t value = 0;
+    uint8_t shift = 0;
+    uint32_t errors = 0;
+};
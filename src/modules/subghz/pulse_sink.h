@@ -0,0 +1,50 @@
+#pragma once
+#include <Arduino.h>
+
+#define PULSE_ITEM_MAX_US 32767 // 15-bit duration field, 1us ticks
+
+// Same bit layout as the RMT peripheral's rmt_item32_t: two pulses per
+// word. A zero duration ends the transmission.
+struct PulseItem {
+    uint32_t duration0 : 15;
+    uint32_t level0 : 1;
+    uint32_t duration1 : 15;
+    uint32_t level1 : 1;
+};
+static_assert(sizeof(PulseItem) == 4, "PulseItem must match rmt_item32_t");
+
+// Where replayed pulses end up. send() returns straight away and the items
+// must stay untouched until waitDone() succeeds, so the caller can fill a
+// second buffer while the first one is on air.
+class PulseSink {
+public:
+    virtual ~PulseSink() {}
+    virtual bool begin() = 0;
+    virtual bool send(const PulseItem* items, size_t count) = 0;
+    virtual bool waitDone(uint32_t timeoutMs) = 0;
+    // Idle time between the end of the previous send and the start of the
+    // last one, i.e. how much a hand-over stretched the low pulse it fell in
+    virtual uint32_t lastGapUs() = 0;
+    virtual void end() = 0;
+};
+
+#ifndef SIMULATOR
+// RMT TX channel driving the CC1101's GDO0 (async serial TX input)
+class RmtPulseSink : public PulseSink {
+public:
+    explicit RmtPulseSink(uint8_t pin) : pin(pin) {}
+    bool begin() override;
+    bool send(const PulseItem* items, size_t count) override;
+    bool waitDone(uint32_t timeoutMs) override;
+    uint32_t lastGapUs() override { return gapUs; }
+    void end() override;
+
+    void IRAM_ATTR markTxEnd(); // From the RMT end-of-transmission interrupt
+
+private:
+    uint8_t pin;
+    bool installed = false;
+    volatile int64_t txEndUs = 0;
+    uint32_t gapUs = 0;
+};
+#endif
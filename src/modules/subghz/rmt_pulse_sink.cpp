@@ -0,0 +1,59 @@
+#include "pulse_sink.h"
+#ifndef SIMULATOR
+#include <driver/rmt.h>
+#include <esp_timer.h>
+
+#define RMT_TX_CHANNEL RMT_CHANNEL_0
+#define RMT_TX_MEM_BLOCKS 2 // 96 items in RMT RAM, refilled from the buffer by the driver
+
+static_assert(sizeof(PulseItem) == sizeof(rmt_item32_t), "PulseItem must match rmt_item32_t");
+
+static void IRAM_ATTR txEndCallback(rmt_channel_t channel, void* arg) {
+    static_cast<RmtPulseSink*>(arg)->markTxEnd();
+}
+
+void IRAM_ATTR RmtPulseSink::markTxEnd() {
+    txEndUs = esp_timer_get_time();
+}
+
+bool RmtPulseSink::begin() {
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, RMT_TX_CHANNEL);
+    config.clk_div = 80; // 1us ticks from the 80MHz APB clock
+    config.mem_block_num = RMT_TX_MEM_BLOCKS;
+    config.tx_config.carrier_en = false;
+    config.tx_config.idle_output_en = true;
+    config.tx_config.idle_level = RMT_IDLE_LEVEL_LOW; // Carrier off between chunks
+
+    if (rmt_config(&config) != ESP_OK || rmt_driver_install(RMT_TX_CHANNEL, 0, 0) != ESP_OK) {
+        Serial.println("RMT TX init failed");
+        return false;
+    }
+    rmt_register_tx_end_callback(txEndCallback, this);
+    installed = true;
+    txEndUs = 0;
+    gapUs = 0;
+    return true;
+}
+
+bool RmtPulseSink::send(const PulseItem* items, size_t count) {
+    if (!installed) return false;
+    int64_t now = esp_timer_get_time();
+    gapUs = txEndUs ? (uint32_t)(now - txEndUs) : 0;
+    // Non-blocking: the driver keeps reading from items while it transmits
+    return rmt_write_items(RMT_TX_CHANNEL, (const rmt_item32_t*)items, count, false) == ESP_OK;
+}
+
+bool RmtPulseSink::waitDone(uint32_t timeoutMs) {
+    if (!installed) return false;
+    return rmt_wait_tx_done(RMT_TX_CHANNEL, pdMS_TO_TICKS(timeoutMs)) == ESP_OK;
+}
+
+void RmtPulseSink::end() {
+    if (!installed) return;
+    rmt_register_tx_end_callback(nullptr, nullptr);
+    rmt_driver_uninstall(RMT_TX_CHANNEL);
+    installed = false;
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+}
+#endif
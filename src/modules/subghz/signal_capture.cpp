@@ -1,2 +1,196 @@
-#include <Arduino.h>
-// Signal capture implementation
+#include "signal_capture.h"
+#ifndef SIMULATOR
+#include <esp_heap_caps.h>
+#endif
+
+#define PULSE_HIGH_BIT 0x80000000u
+
+bool SignalCapture::start(const String& capturePath, uint8_t gdoPin, uint32_t frequencyKhz, uint8_t modulation) {
+    if (running) return false;
+
+    // The ISR touches the ring, so it must not end up in PSRAM
+#ifdef SIMULATOR
+    ring = (uint32_t*)malloc(SUBGHZ_RING_SIZE * sizeof(uint32_t));
+#else
+    ring = (uint32_t*)heap_caps_malloc(SUBGHZ_RING_SIZE * sizeof(uint32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#endif
+    writeBuf = (uint8_t*)malloc(SUBGHZ_WRITE_CHUNK);
+    if (!ring || !writeBuf) {
+        Serial.println("SubGHz: out of memory for capture buffers");
+        release();
+        return false;
+    }
+
+    if (!SD.exists(SUBGHZ_CAPTURE_DIR)) SD.mkdir(SUBGHZ_CAPTURE_DIR);
+    file = SD.open(capturePath, FILE_WRITE);
+    if (!file) {
+        Serial.println("SubGHz: failed to create " + capturePath);
+        release();
+        return false;
+    }
+    path = capturePath;
+    pin = gdoPin;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = PULSE_FILE_MAGIC;
+    header.version = PULSE_FILE_VERSION;
+    header.headerSize = sizeof(PulseFileHeader);
+    header.frequencyKhz = frequencyKhz;
+    header.modulation = modulation;
+    header.resolutionNs = 1000; // micros()
+    file.write((const uint8_t*)&header, sizeof(header)); // Counts are patched in stop()
+
+    encoder.reset();
+    ringHead = ringTail = 0;
+    edges = dropped = isrMaxCycles = 0;
+    writeLen = 0;
+    hasPending = false;
+    pulses = glitches = maxBacklog = shortestUs = bytesWritten = 0;
+    stopRequested = false;
+
+    startMs = millis();
+    lastEdgeUs = micros();
+    running = true;
+    attachInterruptArg(pin, onEdge, this, CHANGE);
+
+    if (xTaskCreate(writerLoop, "subghz_writer", 4096, this, 2, &writerTask) != pdPASS) {
+        writerTask = nullptr; // poll() drains from the module loop instead
+    }
+    return true;
+}
+
+void IRAM_ATTR SignalCapture::onEdge(void* arg) {
+    SignalCapture* self = (SignalCapture*)arg;
+    uint32_t startCycles = ESP.getCycleCount();
+    self->recordEdge(micros(), digitalRead(self->pin));
+    uint32_t cycles = ESP.getCycleCount() - startCycles;
+    if (cycles > self->isrMaxCycles) self->isrMaxCycles = cycles;
+}
+
+void IRAM_ATTR SignalCapture::recordEdge(uint32_t nowUs, int newLevel) {
+    edges++;
+    uint32_t head = ringHead;
+    uint32_t next = (head + 1) & SUBGHZ_RING_MASK;
+    if (next == __atomic_load_n(&ringTail, __ATOMIC_ACQUIRE)) {
+        // Keep lastEdgeUs so the next pulse absorbs this one's time
+        dropped++;
+        return;
+    }
+    uint32_t duration = nowUs - lastEdgeUs;
+    lastEdgeUs = nowUs;
+    ring[head] = (duration & ~PULSE_HIGH_BIT) | (newLevel ? 0 : PULSE_HIGH_BIT); // The pulse that just ended
+    __atomic_store_n(&ringHead, next, __ATOMIC_RELEASE);
+}
+
+void SignalCapture::writerLoop(void* param) {
+    SignalCapture* self = static_cast<SignalCapture*>(param);
+    while (!self->stopRequested) {
+        self->drain();
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    self->writerTask = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void SignalCapture::poll() {
+    if (running && !writerTask) drain();
+}
+
+void SignalCapture::drain() {
+    uint32_t head = __atomic_load_n(&ringHead, __ATOMIC_ACQUIRE);
+    uint32_t tail = ringTail;
+    uint32_t backlog = (head - tail) & SUBGHZ_RING_MASK;
+    if (backlog > maxBacklog) maxBacklog = backlog;
+
+    while (tail != head) {
+        uint32_t entry = ring[tail];
+        push(entry & ~PULSE_HIGH_BIT, (entry & PULSE_HIGH_BIT) != 0);
+        tail = (tail + 1) & SUBGHZ_RING_MASK;
+    }
+    __atomic_store_n(&ringTail, tail, __ATOMIC_RELEASE);
+}
+
+void SignalCapture::push(uint32_t durationUs, bool level) {
+    if (!hasPending) {
+        pendingLevel = level;
+        pendingUs = durationUs;
+        hasPending = true;
+        return;
+    }
+    // Same level twice means an edge went missing, or this is the rest of
+    // a pulse that a glitch split; either way it belongs to the pending one
+    if (level == pendingLevel) {
+        pendingUs += durationUs;
+        return;
+    }
+    if (durationUs < SUBGHZ_MIN_PULSE_US) {
+        glitches++;
+        pendingUs += durationUs;
+        return;
+    }
+    emit(pendingUs);
+    pendingLevel = level;
+    pendingUs = durationUs;
+}
+
+void SignalCapture::emit(uint32_t durationUs) {
+    if (pulses == 0) header.firstLevel = pendingLevel;
+    if (writeLen + PULSE_VARINT_MAX > SUBGHZ_WRITE_CHUNK) flush();
+    writeLen += encoder.encode(durationUs, writeBuf + writeLen);
+    if (decoder) decoder->feed(durationUs, pendingLevel);
+    pulses++;
+    if (shortestUs == 0 || durationUs < shortestUs) shortestUs = durationUs;
+}
+
+void SignalCapture::flush() {
+    if (writeLen == 0) return;
+    size_t written = file.write(writeBuf, writeLen);
+    if (written != writeLen) Serial.println("SubGHz: SD write failed");
+    bytesWritten += written;
+    writeLen = 0;
+}
+
+void SignalCapture::stop() {
+    if (!running) return;
+    detachInterrupt(pin);
+    stopRequested = true;
+    while (writerTask) delay(5);
+
+    drain();
+    // The level held since the last edge is the final pulse
+    push(micros() - lastEdgeUs, digitalRead(pin) == HIGH);
+    if (hasPending) emit(pendingUs);
+    flush();
+
+    header.pulseCount = pulses;
+    header.durationMs = millis() - startMs;
+    header.droppedEdges = dropped;
+    file.seek(0);
+    file.write((const uint8_t*)&header, sizeof(header));
+    file.close();
+
+    running = false;
+    release();
+}
+
+void SignalCapture::release() {
+    free(ring);
+    free(writeBuf);
+    ring = nullptr;
+    writeBuf = nullptr;
+}
+
+CaptureStats SignalCapture::getStats() {
+    CaptureStats s;
+    s.edges = edges;
+    s.pulses = pulses;
+    s.glitches = glitches;
+    s.dropped = dropped;
+    s.maxBacklog = maxBacklog;
+    s.shortestUs = shortestUs;
+    s.bytesWritten = bytesWritten + writeLen;
+    s.durationMs = running ? millis() - startMs : header.durationMs;
+    s.resolutionNs = 1000;
+    s.isrMaxNs = isrMaxCycles * 1000 / ESP.getCpuFreqMHz();
+    return s;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <Arduino.h>
+#include <SD.h>
+#include "pulse_codec.h"
+#include "protocol_decoder.h"
+
+#define SUBGHZ_CAPTURE_DIR "/subghz"
+
+#ifndef SUBGHZ_RING_SIZE
+#define SUBGHZ_RING_SIZE 8192    // Edges, power of two. ~400ms of backlog at 20k edges/s
+#endif
+#define SUBGHZ_RING_MASK (SUBGHZ_RING_SIZE - 1)
+#define SUBGHZ_WRITE_CHUNK 4096  // Bytes per SD write
+#define SUBGHZ_MIN_PULSE_US 15   // Shorter pulses are demodulator noise, merged into their neighbours
+
+static_assert((SUBGHZ_RING_SIZE & SUBGHZ_RING_MASK) == 0, "ring size must be a power of two");
+
+struct CaptureStats {
+    uint32_t edges;         // Seen by the ISR
+    uint32_t pulses;        // Written, after glitch filtering
+    uint32_t glitches;
+    uint32_t dropped;       // Edges lost to a full ring
+    uint32_t maxBacklog;    // Peak ring fill, compare to SUBGHZ_RING_SIZE
+    uint32_t shortestUs;    // Shortest pulse kept
+    uint32_t bytesWritten;
+    uint32_t durationMs;
+    uint32_t resolutionNs;  // Timestamp tick
+    uint32_t isrMaxNs;      // Worst ISR run time, edges closer than this blur
+};
+
+// Records GDO0 edges while the CC1101 is in async RX mode. The edge ISR only
+// timestamps into a lock-free ring; a writer task drains it, glitch filters,
+// encodes (see pulse_codec.h) and writes to SD in SUBGHZ_WRITE_CHUNK blocks,
+// so SD latency never stalls the ISR as long as the ring has room.
+class SignalCapture {
+public:
+    bool start(const String& path, uint8_t pin, uint32_t frequencyKhz, uint8_t modulation);
+    void stop();
+    bool isRunning() { return running; }
+
+    // Drains the ring when the writer task could not be started
+    void poll();
+
+    // Optional, fed every pulse as it is written (from the writer task)
+    void setDecoder(ProtocolDecoder* d) { decoder = d; }
+
+    CaptureStats getStats();
+    const String& getPath() { return path; }
+
+    // ISR body, also driven directly by the simulator and benchmarks
+    void IRAM_ATTR recordEdge(uint32_t nowUs, int newLevel);
+
+private:
+    // Ring entries: pulse duration in us, bit 31 set for a high pulse
+    uint32_t* ring = nullptr;
+    volatile uint32_t ringHead = 0;  // Written by the ISR
+    volatile uint32_t ringTail = 0;  // Written by the drain
+    volatile uint32_t lastEdgeUs = 0;
+    volatile uint32_t edges = 0;
+    volatile uint32_t dropped = 0;
+    volatile uint32_t isrMaxCycles = 0;
+
+    uint8_t pin = 0;
+    volatile bool running = false;
+    volatile bool stopRequested = false;
+    TaskHandle_t writerTask = nullptr;
+
+    File file;
+    String path;
+    PulseFileHeader header;
+    PulseEncoder encoder;
+    ProtocolDecoder* decoder = nullptr;
+    uint8_t* writeBuf = nullptr;
+    size_t writeLen = 0;
+    uint32_t startMs = 0;
+
+    // One pulse held back so missed edges and glitches can be merged into it
+    bool hasPending = false;
+    bool pendingLevel = false;
+    uint32_t pendingUs = 0;
+
+    uint32_t pulses = 0;
+    uint32_t glitches = 0;
+    uint32_t maxBacklog = 0;
+    uint32_t shortestUs = 0;
+    uint32_t bytesWritten = 0;
+
+    static void IRAM_ATTR onEdge(void* arg);
+    static void writerLoop(void* param);
+    void drain();
+    void push(uint32_t durationUs, bool level);
+    void emit(uint32_t durationUs);
+    void flush();
+    void release();
+};
@@ -0,0 +1,213 @@
+#include "signal_replay.h"
+#ifndef SIMULATOR
+#include <esp_heap_caps.h>
+#endif
+
+// --- Reader ---
+
+bool PulseFileReader::open(const String& path) {
+    close();
+    file = SD.open(path, FILE_READ);
+    if (!file) {
+        Serial.println("SubGHz: cannot open " + path);
+        return false;
+    }
+    if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) || header.magic != PULSE_FILE_MAGIC ||
+        header.version != PULSE_FILE_VERSION || header.headerSize < sizeof(header)) {
+        Serial.println("SubGHz: not a pulse file: " + path);
+        close();
+        return false;
+    }
+    file.seek(header.headerSize);
+    decoder.reset();
+    len = pos = 0;
+    level = header.firstLevel;
+    return true;
+}
+
+void PulseFileReader::close() {
+    if (file) file.close();
+}
+
+bool PulseFileReader::next(uint32_t& durationUs, bool& pulseLevel) {
+    while (true) {
+        if (pos >= len) {
+            len = file.read(buf, sizeof(buf));
+            pos = 0;
+            if (len == 0) return false;
+        }
+        if (decoder.feed(buf[pos++], durationUs)) {
+            pulseLevel = level;
+            level = !level;
+            return true;
+        }
+    }
+}
+
+// --- Replay ---
+
+static inline void setHalf(PulseItem* items, size_t half, uint32_t us, bool level) {
+    PulseItem& item = items[half >> 1];
+    if (half & 1) {
+        item.duration1 = us;
+        item.level1 = level;
+    } else {
+        item.duration0 = us;
+        item.level0 = level;
+        item.duration1 = 0; // End marker unless the second half gets filled
+        item.level1 = 0;
+    }
+}
+
+bool SignalReplay::start(const String& path, PulseSink* pulseSink) {
+    if (running) return false;
+    if (!reader.open(path)) return false;
+
+    // The RMT interrupt copies from these, keep them out of PSRAM
+    for (int i = 0; i < 2; i++) {
+#ifdef SIMULATOR
+        buffers[i] = (PulseItem*)malloc(SUBGHZ_TX_CHUNK_ITEMS * sizeof(PulseItem));
+#else
+        buffers[i] = (PulseItem*)heap_caps_malloc(SUBGHZ_TX_CHUNK_ITEMS * sizeof(PulseItem), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#endif
+    }
+    if (!buffers[0] || !buffers[1]) {
+        Serial.println("SubGHz: out of memory for replay buffers");
+        release();
+        return false;
+    }
+
+    sink = pulseSink;
+    if (!sink->begin()) {
+        release();
+        return false;
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    carryUs = 0;
+    fileDone = false;
+    restartUs = SUBGHZ_TX_RESTART_US;
+    errorSum = 0;
+    stopRequested = false;
+    running = true;
+
+    if (xTaskCreate(replayTask, "subghz_replay", 4096, this, 3, &task) != pdPASS) {
+        task = nullptr;
+        run(); // No task available, replay inline
+    }
+    return true;
+}
+
+void SignalReplay::replayTask(void* param) {
+    SignalReplay* self = static_cast<SignalReplay*>(param);
+    self->run();
+    self->task = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void SignalReplay::stop() {
+    stopRequested = true;
+    while (running) delay(5);
+}
+
+int SignalReplay::getProgress() {
+    uint32_t total = reader.getHeader().pulseCount;
+    if (total == 0) return running ? 0 : 100;
+    return std::min<uint32_t>(stats.pulses * 100 / total, 100);
+}
+
+void SignalReplay::run() {
+    unsigned long startMs = millis();
+    uint32_t compensation[2] = {0, 0};
+    uint32_t airUs[2] = {0, 0};
+    int cur = 0;
+
+    size_t count = fillChunk(buffers[cur], compensation[cur]);
+    airUs[cur] = chunkUs;
+    if (count > 0 && sink->send(buffers[cur], count)) {
+        stats.chunks++;
+        while (!stopRequested) {
+            // Decode the next chunk while this one is on air
+            int next = cur ^ 1;
+            count = (fileDone && carryUs == 0) ? 0 : fillChunk(buffers[next], compensation[next]);
+            airUs[next] = chunkUs;
+
+            if (!sink->waitDone(airUs[cur] / 1000 + 1000)) {
+                Serial.println("SubGHz: TX timed out");
+                break;
+            }
+            if (count == 0 || !sink->send(buffers[next], count)) break;
+            stats.chunks++;
+            recordHandOver(sink->lastGapUs(), compensation[cur]);
+            cur = next;
+        }
+    }
+    sink->waitDone(airUs[cur] / 1000 + 1000);
+    sink->end();
+    reader.close();
+    release();
+
+    stats.durationMs = millis() - startMs;
+    running = false;
+    Serial.println("SubGHz replay: " + String(stats.pulses) + " pulses in " + String(stats.chunks) +
+                   " chunks, max error " + String(stats.maxErrorUs) + "us, drift " + String(stats.driftUs) + "us");
+}
+
+size_t SignalReplay::fillChunk(PulseItem* items, uint32_t& compensation) {
+    const size_t capacity = SUBGHZ_TX_CHUNK_ITEMS * 2;
+    size_t halves = 0;
+    bool handOver = false;
+    compensation = 0;
+    chunkUs = 0;
+
+    while (halves < capacity) {
+        if (carryUs == 0) {
+            if (handOver) break;
+            if (!reader.next(carryUs, carryLevel)) {
+                fileDone = true;
+                break;
+            }
+            stats.pulses++;
+            // End the chunk in this pulse, early by the time a restart takes
+            if (!carryLevel && halves >= SUBGHZ_TX_TARGET_ITEMS * 2 && carryUs >= SUBGHZ_TX_SPLIT_GAP_US) {
+                compensation = std::min(restartUs, carryUs / 2);
+                carryUs -= compensation;
+                handOver = true;
+            }
+            if (carryUs == 0) continue;
+        }
+        // Pulses longer than one item can hold are split, same level
+        uint32_t piece = std::min<uint32_t>(carryUs, PULSE_ITEM_MAX_US);
+        setHalf(items, halves++, piece, carryLevel);
+        carryUs -= piece;
+        chunkUs += piece;
+    }
+
+    // Buffer full before a hand-over point: the restart lands mid-pulse
+    if (halves == capacity && !handOver && (carryUs > 0 || !fileDone)) stats.forcedSplits++;
+    return (halves + 1) / 2;
+}
+
+void SignalReplay::recordHandOver(uint32_t gapUs, uint32_t compensation) {
+    int32_t error = (int32_t)gapUs - (int32_t)compensation;
+    uint32_t absError = error < 0 ? -error : error;
+
+    stats.handOvers++;
+    stats.driftUs += error;
+    errorSum += absError;
+    stats.meanErrorUs = (float)errorSum / stats.handOvers;
+    if (absError > stats.maxErrorUs) stats.maxErrorUs = absError;
+
+    if (error > SUBGHZ_TX_UNDERRUN_US) {
+        stats.underruns++;
+    } else {
+        restartUs = (restartUs * 7 + gapUs) / 8;
+    }
+    stats.restartUs = restartUs;
+}
+
+void SignalReplay::release() {
+    free(buffers[0]);
+    free(buffers[1]);
+    buffers[0] = buffers[1] = nullptr;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <Arduino.h>
+#include <SD.h>
+#include "pulse_codec.h"
+#include "pulse_sink.h"
+
+#define SUBGHZ_TX_CHUNK_ITEMS  1024 // Items per buffer, two buffers
+#define SUBGHZ_TX_TARGET_ITEMS 256  // Hand over at the next long low pulse after this many
+#define SUBGHZ_TX_SPLIT_GAP_US 1000 // Low pulses long enough to hide a chunk hand-over
+#define SUBGHZ_TX_RESTART_US   20   // First guess at the hand-over latency, refined as it runs
+#define SUBGHZ_TX_UNDERRUN_US  200  // Hand-over errors beyond this mean the next chunk was late
+
+// Streams a .pls file, pulse by pulse, in 512 byte reads
+class PulseFileReader {
+public:
+    bool open(const String& path);
+    void close();
+    bool next(uint32_t& durationUs, bool& level);
+    const PulseFileHeader& getHeader() { return header; }
+
+private:
+    File file;
+    PulseFileHeader header;
+    PulseDecoder decoder;
+    uint8_t buf[512];
+    size_t len = 0;
+    size_t pos = 0;
+    bool level = false;
+};
+
+struct ReplayStats {
+    uint32_t pulses;        // Read from the file
+    uint32_t chunks;
+    uint32_t handOvers;
+    uint32_t forcedSplits;  // Hand-overs without a long low pulse to hide in
+    uint32_t underruns;
+    uint32_t maxErrorUs;    // Worst |actual - file| over all pulses
+    float meanErrorUs;      // Per hand-over
+    int32_t driftUs;        // Replay length minus file length
+    uint32_t restartUs;     // Current hand-over latency estimate
+    uint32_t durationMs;
+};
+
+// Pulses are timed by the sink (RMT on the device), never by the CPU. The
+// next chunk is decoded while the current one is on air; each hand-over
+// lands inside a long low pulse that is cut short by the expected restart
+// latency, and whatever the sink measures beyond that is the timing error.
+class SignalReplay {
+public:
+    bool start(const String& path, PulseSink* sink);
+    void stop();
+    bool isRunning() { return running; }
+    ReplayStats getStats() { return stats; }
+    const PulseFileHeader& getHeader() { return reader.getHeader(); }
+    int getProgress(); // Percent of the file's pulses sent
+
+private:
+    PulseFileReader reader;
+    PulseSink* sink = nullptr;
+    PulseItem* buffers[2] = {nullptr, nullptr};
+    volatile bool running = false;
+    volatile bool stopRequested = false;
+    TaskHandle_t task = nullptr;
+    ReplayStats stats;
+
+    // Chunk builder state
+    uint32_t carryUs = 0;    // Rest of a pulse that did not fit the last chunk
+    bool carryLevel = false;
+    bool fileDone = false;
+    uint32_t chunkUs = 0;    // Airtime of the chunk filled last
+    uint32_t restartUs = SUBGHZ_TX_RESTART_US;
+    uint64_t errorSum = 0;
+
+    static void replayTask(void* param);
+    void run();
+    size_t fillChunk(PulseItem* items, uint32_t& compensation);
+    void recordHandOver(uint32_t gapUs, uint32_t compensation);
+    void release();
+};
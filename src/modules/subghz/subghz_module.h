@@ -0,0 +1,284 @@
+#pragma once
+#include <Arduino.h>
+#include "module_base.h"
+#include "display_manager.h"
+#include "sd_manager.h"
+#include "../../ui/icons.h"
+#include "cc1101_driver.h"
+#include "signal_capture.h"
+#include "signal_replay.h"
+#include "protocol_decoder.h"
+#include "pulse_sink.h"
+
+#define SUBGHZ_FREQ_COUNT 5
+
+class SubGHzModule : public Module {
+private:
+    enum State {
+        MENU,
+        CAPTURING,
+        CAPTURE_DONE,
+        REPLAYING,
+        REPLAY_DONE
+    };
+
+    State currentState = MENU;
+    int menuIndex = 0;
+    int freqIndex = 2;
+    bool radioReady = false;
+    bool radioChecked = false;
+    unsigned long lastDraw = 0;
+    String message;
+
+    const float frequencies[SUBGHZ_FREQ_COUNT] = {315.00, 390.00, 433.92, 868.35, 915.00};
+
+    CC1101Driver radio;
+    SignalCapture capture;
+    ProtocolDecoder decoder;
+    SignalReplay replay;
+    RmtPulseSink txSink{CC1101_GDO0};
+    String lastCapture;
+
+    void startCapture() {
+        extern SDManager sdManager;
+        message = "";
+        if (!radioChecked) {
+            radioReady = radio.begin();
+            radioChecked = true;
+        }
+        if (!radioReady) {
+            message = "CC1101 not found";
+            return;
+        }
+        if (!sdManager.isMounted()) {
+            message = "No SD card";
+            return;
+        }
+
+        float mhz = frequencies[freqIndex];
+        radio.setFrequency(mhz);
+        radio.setModulation(CC1101_MOD_ASK);
+        radio.startAsyncRx();
+
+        decoder.reset();
+        capture.setDecoder(&decoder);
+
+        uint32_t khz = (uint32_t)(mhz * 1000 + 0.5f);
+        String path = String(SUBGHZ_CAPTURE_DIR) + "/raw_" + String(khz) + "_" + String(millis()) + PULSE_FILE_EXT;
+        if (!capture.start(path, CC1101_GDO0, khz, CC1101_MOD_ASK)) {
+            radio.idle();
+            message = "Capture failed";
+            return;
+        }
+        currentState = CAPTURING;
+    }
+
+    void stopCapture() {
+        capture.stop();
+        radio.idle();
+        currentState = CAPTURE_DONE;
+        lastCapture = capture.getPath();
+
+        CaptureStats s = capture.getStats();
+        Serial.println("SubGHz capture " + capture.getPath() + ": " + String(s.pulses) + " pulses, " +
+                       String(s.bytesWritten) + " bytes, " + String(s.dropped) + " dropped, ISR max " +
+                       String(s.isrMaxNs) + "ns");
+    }
+
+    void startReplay() {
+        message = "";
+        if (lastCapture.length() == 0) {
+            message = "Capture something first";
+            return;
+        }
+        if (!radioReady) {
+            message = "CC1101 not found";
+            return;
+        }
+
+        // Transmit on the frequency the file was recorded at
+        PulseFileReader probe;
+        if (!probe.open(lastCapture)) {
+            message = "Cannot read capture";
+            return;
+        }
+        radio.setFrequency(probe.getHeader().frequencyKhz / 1000.0f);
+        probe.close();
+
+        radio.startAsyncTx();
+        currentState = REPLAYING;
+        if (!replay.start(lastCapture, &txSink)) {
+            radio.idle();
+            currentState = MENU;
+            message = "Replay failed";
+        }
+    }
+
+    void drawReplayStats(DisplayManager* display) {
+        TFT_eSPI* tft = display->getTFT();
+        ReplayStats s = replay.getStats();
+
+        tft->fillRect(0, 45, 320, 105, THEME_BG);
+        tft->setTextDatum(TL_DATUM);
+        tft->setTextColor(THEME_TEXT, THEME_BG);
+        tft->drawString("Sent: " + String(replay.getProgress()) + "%   Pulses: " + String(s.pulses), 10, 50, 2);
+        tft->drawString("Chunks: " + String(s.chunks) + "   Restart: " + String(s.restartUs) + "us", 10, 70, 2);
+        tft->drawString("Error max: " + String(s.maxErrorUs) + "us  mean: " + String(s.meanErrorUs, 1) + "us", 10, 90, 2);
+        tft->drawString("Drift: " + String(s.driftUs) + "us", 10, 110, 2);
+
+        tft->setTextColor((s.underruns || s.forcedSplits) ? THEME_ERROR : THEME_OK, THEME_BG);
+        tft->drawString("Underruns: " + String(s.underruns) + "   Forced splits: " + String(s.forcedSplits), 10, 130, 2);
+        tft->setTextColor(THEME_TEXT, THEME_BG);
+    }
+
+    void drawStats(DisplayManager* display) {
+        TFT_eSPI* tft = display->getTFT();
+        CaptureStats s = capture.getStats();
+
+        tft->fillRect(0, 45, 320, 105, THEME_BG); // Keeps the hint line at the bottom
+        tft->setTextDatum(TL_DATUM);
+        tft->setTextColor(THEME_TEXT, THEME_BG);
+        tft->drawString("Time: " + String(s.durationMs / 1000.0f, 1) + "s   Edges: " + String(s.edges), 10, 50, 2);
+        tft->drawString("Pulses: " + String(s.pulses) + "   Written: " + String(s.bytesWritten) + " B", 10, 70, 2);
+        tft->drawString("Res: " + String(s.resolutionNs / 1000) + "us  ISR max: " + String(s.isrMaxNs) + "ns", 10, 90, 2);
+
+        tft->setTextColor(s.dropped ? THEME_ERROR : THEME_OK, THEME_BG);
+        tft->drawString("Dropped: " + String(s.dropped) + "   Backlog: " +
+                        String(s.maxBacklog * 100 / SUBGHZ_RING_SIZE) + "%", 10, 110, 2);
+
+        // Newest decoded code, updated live from the writer task
+        DecodedCode code;
+        tft->setTextColor(THEME_WARN, THEME_BG);
+        if (decoder.getResults(&code, 1) == 1) {
+            tft->drawString(formatCode(code), 10, 130, 2);
+        } else {
+            tft->drawString("Frames: " + String(decoder.getFrames()) + ", none decoded", 10, 130, 2);
+        }
+        tft->setTextColor(THEME_TEXT, THEME_BG);
+    }
+
+public:
+    void init() override {
+        currentState = MENU;
+        menuIndex = 0;
+        message = "";
+    }
+
+    void loop() override {
+        extern DisplayManager displayManager;
+        if (currentState == REPLAYING && !replay.isRunning()) {
+            radio.idle();
+            currentState = REPLAY_DONE;
+            drawMenu(&displayManager);
+            return;
+        }
+        if (currentState != CAPTURING && currentState != REPLAYING) return;
+        capture.poll();
+        if (millis() - lastDraw > 250) {
+            if (currentState == CAPTURING) drawStats(&displayManager);
+            else drawReplayStats(&displayManager);
+            lastDraw = millis();
+        }
+    }
+
+    // Both only stop from this module's input, which joins their tasks, but
+    // the ISR and the tasks hold this pointer until they have
+    bool isBackgroundRunning() override {
+        return capture.isRunning() || replay.isRunning();
+    }
+
+    String getName() override {
+        return "SubGHz";
+    }
+    const unsigned char* getIcon() override { return image_music_radio_streaming_bits; }
+    int getIconWidth() override { return 17; }
+    int getIconHeight() override { return 16; }
+    int getIconSpacing() override { return 14; }
+    int getIconOffsetY() override { return 1; }
+
+    String getDescription() override {
+        return "CC1101 raw capture/replay";
+    }
+
+    void drawMenu(DisplayManager* display) override {
+        extern SDManager sdManager;
+        display->clearContent();
+        display->drawStatusBar("SubGHz", display->getBatteryVoltage(), sdManager.isMounted(), false);
+        TFT_eSPI* tft = display->getTFT();
+
+        switch (currentState) {
+            case MENU:
+                display->drawMenuTitle("SubGHz");
+                display->drawMenuItem("Capture Raw", 0, menuIndex == 0);
+                display->drawMenuItem("Freq: " + String(frequencies[freqIndex], 2) + " MHz", 1, menuIndex == 1);
+                display->drawMenuItem("Replay Last", 2, menuIndex == 2);
+                if (message.length() > 0) {
+                    tft->setTextDatum(MC_DATUM);
+                    tft->setTextColor(THEME_ERROR, THEME_BG);
+                    tft->drawString(message, 160, 140, 2);
+                    tft->setTextColor(THEME_TEXT, THEME_BG);
+                }
+                break;
+            case CAPTURING:
+                display->drawMenuTitle("Capturing " + String(frequencies[freqIndex], 2));
+                drawStats(display);
+                tft->setTextDatum(MC_DATUM);
+                tft->drawString("Click: Stop", 160, 160, 2);
+                break;
+            case CAPTURE_DONE:
+                display->drawMenuTitle("Saved");
+                drawStats(display);
+                tft->setTextDatum(MC_DATUM);
+                tft->drawString(capture.getPath(), 160, 160, 2);
+                break;
+            case REPLAYING:
+            case REPLAY_DONE:
+                display->drawMenuTitle(currentState == REPLAYING ? "Replaying" : "Replay Done");
+                drawReplayStats(display);
+                tft->setTextDatum(MC_DATUM);
+                tft->drawString(currentState == REPLAYING ? "Click: Stop" : lastCapture, 160, 160, 2);
+                break;
+        }
+    }
+
+    bool handleInput(uint8_t button) override {
+        extern DisplayManager displayManager;
+
+        if (currentState == CAPTURING) {
+            stopCapture(); // Any button
+            drawMenu(&displayManager);
+            return true;
+        }
+        if (currentState == REPLAYING) {
+            replay.stop(); // loop() moves on to REPLAY_DONE
+            return true;
+        }
+
+        if (button == 3) { // Back / Long Press
+            if (currentState == MENU) return false;
+            currentState = MENU;
+            drawMenu(&displayManager);
+            return true;
+        }
+
+        if (button == 1) { // Scroll
+            if (currentState == MENU) menuIndex = (menuIndex + 1) % 3;
+            else currentState = MENU;
+            drawMenu(&displayManager);
+            return true;
+        }
+
+        if (button == 2) { // Select
+            if (currentState == MENU) {
+                if (menuIndex == 0) startCapture();
+                else if (menuIndex == 1) freqIndex = (freqIndex + 1) % SUBGHZ_FREQ_COUNT;
+                else startReplay();
+            } else {
+                currentState = MENU;
+            }
+            drawMenu(&displayManager);
+            return true;
+        }
+        return true;
+    }
+};
@@ -15,22 +15,24 @@
 extern SDManager sdManager;
 extern DisplayManager displayManager;
 
-// Global objects for MSC callbacks
-static SdFat sdFat;
+// Global objects for MSC callbacks. The card belongs to the module, so its
+// sector cache goes away with it; this points at it while MSC is running.
+static SdFat* mscCard = nullptr;
 static USBMSC MSC;
 
 // Callbacks
 static int32_t onRead(uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
-    if (!sdFat.card()->readSectors(lba, (uint8_t*)buffer, bufsize / 512)) return -1;
+    if (!mscCard || !mscCard->card()->readSectors(lba, (uint8_t*)buffer, bufsize / 512)) return -1;
     return bufsize;
 }
 
 static int32_t onWrite(uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
-    if (!sdFat.card()->writeSectors(lba, buffer, bufsize / 512)) return -1;
+    if (!mscCard || !mscCard->card()->writeSectors(lba, buffer, bufsize / 512)) return -1;
     return bufsize;
 }
 
 class USBStorageModule : public Module {
+    SdFat sdFat;
     bool isRunning = false;
     bool initFailed = false;
 
@@ -58,7 +60,7 @@ public:
         display->drawMenuTitle("USB Storage");
         
         display->getTFT()->setTextDatum(MC_DATUM);
-        display->getTFT()->setTextColor(TFT_WHITE, TFT_BLACK); 
+        display->getTFT()->setTextColor(THEME_TEXT, THEME_BG); 
         
         if (initFailed) {
             display->getTFT()->drawString("SD Init Failed!", 160, 80, 4);
@@ -100,6 +102,7 @@ public:
         MSC.onWrite(onWrite);
         MSC.mediaPresent(true);
         
+        mscCard = &sdFat;
         uint32_t secCount = sdFat.card()->sectorCount();
         MSC.begin(secCount, 512);
         USB.begin();
@@ -117,6 +120,7 @@ public:
         
         MSC.mediaPresent(false);
         MSC.end();
+        mscCard = nullptr;
         
         delay(500);
         
@@ -0,0 +1,168 @@
+#include "airtime.h"
+#include "phy_rate.h"
+
+// Non-HT rate codes that are DSSS/CCK with the short preamble
+static const uint16_t shortPreamble = 0x00E0;
+// HT data bits per symbol for MCS 0-7 on one stream, 20MHz and 40MHz
+static const uint16_t htBitsPerSymbol[2][8] = {
+    {26, 52, 78, 104, 156, 208, 234, 260},
+    {54, 108, 162, 216, 324, 432, 486, 540}};
+
+#define OFDM_SERVICE_TAIL_BITS 22 // 16 service bits before the PSDU, 6 tail bits after
+#define SIGNAL_EXTENSION_US    6  // 2.4GHz OFDM frames end with 6us of silence
+
+uint32_t frameAirtimeUs(const wifi_pkt_rx_ctrl_t& rx, uint16_t len) {
+    uint32_t bits = 8 * (uint32_t)len;
+    if (rx.sig_mode != 0) {
+        // HT mixed format: legacy preamble and SIG, HT-SIG, HT-STF, one HT-LTF per stream
+        uint8_t streams = rx.mcs / 8 + 1;
+        uint32_t perSymbol = htBitsPerSymbol[rx.cwb ? 1 : 0][rx.mcs % 8] * streams;
+        uint32_t symbols = (bits + OFDM_SERVICE_TAIL_BITS + perSymbol - 1) / perSymbol;
+        uint32_t dataUs = rx.sgi ? (symbols * 36 + 39) / 40 * 4 : symbols * 4; // 3.6us symbols, padded to 4us
+        return 20 + 8 + 4 + 4 * streams + dataUs + SIGNAL_EXTENSION_US;
+    }
+    uint8_t code = rx.rate & 0x0F;
+    uint8_t units = phyRateUnits(code) ? phyRateUnits(code) : 2;
+    if (code < 8) {
+        uint32_t preamble = (shortPreamble & (1 << code)) ? 96 : 192;
+        return preamble + (bits * 2 + units - 1) / units;
+    }
+    uint32_t perSymbol = units * 2; // 4us symbols: bits per symbol = 4 x Mbps
+    uint32_t symbols = (bits + OFDM_SERVICE_TAIL_BITS + perSymbol - 1) / perSymbol;
+    return 20 + symbols * 4 + SIGNAL_EXTENSION_US;
+}
+
+size_t formatAirtimeRow(const AirtimeSample& s, char* out, size_t max) {
+    int n = snprintf(out, max, "%lu,%u,%lu,%lu,%u.%u,%lu,%lu,%lu,%lu,%lu\n",
+                     (unsigned long)s.timestampMs, s.channel, (unsigned long)s.dwellMs,
+                     (unsigned long)s.delta.airtimeUs, s.utilization / 10, s.utilization % 10,
+                     (unsigned long)(s.delta.mgmt + s.delta.ctrl + s.delta.data), (unsigned long)s.delta.mgmt,
+                     (unsigned long)s.delta.ctrl, (unsigned long)s.delta.data, (unsigned long)s.delta.retries);
+    return n > 0 && (size_t)n < max ? n : 0;
+}
+
+void AirtimeAnalyzer::clear() {
+    memset(cores, 0, sizeof(cores));
+    memset(utilization, 0, sizeof(utilization));
+    channel = 0;
+    frames = retries = visits = 0;
+}
+
+void AirtimeAnalyzer::account(const wifi_pkt_rx_ctrl_t& rx, const uint8_t* frame) {
+    uint8_t ch = rx.channel;
+    if (ch < 1 || ch > AIRTIME_CHANNELS || rx.sig_len < 2) return;
+    Core& core = cores[xPortGetCoreID() % AIRTIME_CORES];
+    AirtimeCounters& c = core.channels[ch - 1];
+
+    // Only the part after the previous frame's end is new airtime
+    uint32_t start = rx.timestamp;
+    uint32_t end = start + frameAirtimeUs(rx, rx.sig_len);
+    if (core.busy && (int32_t)(core.busyUntilUs - start) > 0) start = core.busyUntilUs;
+    if ((int32_t)(end - start) > 0) {
+        c.airtimeUs += end - start;
+        core.busyUntilUs = end;
+    }
+    core.busy = true;
+
+    switch (frame[0] >> 2 & 3) {
+        case 0: c.mgmt++; break;
+        case 1: c.ctrl++; break;
+        case 2: c.data++; break;
+    }
+    if (frame[1] & 0x08) c.retries++;
+}
+
+void AirtimeAnalyzer::read(uint8_t ch, AirtimeCounters& out) {
+    out = {};
+    if (ch < 1 || ch > AIRTIME_CHANNELS) return;
+    for (uint8_t i = 0; i < AIRTIME_CORES; i++) {
+        const volatile AirtimeCounters& c = cores[i].channels[ch - 1];
+        out.airtimeUs += c.airtimeUs;
+        out.mgmt += c.mgmt;
+        out.ctrl += c.ctrl;
+        out.data += c.data;
+        out.retries += c.retries;
+    }
+}
+
+void AirtimeAnalyzer::enter(uint8_t ch, uint32_t nowMs) {
+    channel = ch;
+    enteredMs = nowMs;
+    read(ch, atEntry);
+}
+
+bool AirtimeAnalyzer::leave(uint32_t nowMs, AirtimeSample& out) {
+    if (channel == 0) return false;
+    AirtimeCounters now;
+    read(channel, now);
+    out.timestampMs = nowMs;
+    out.channel = channel;
+    out.dwellMs = nowMs - enteredMs;
+    out.delta.airtimeUs = now.airtimeUs - atEntry.airtimeUs;
+    out.delta.mgmt = now.mgmt - atEntry.mgmt;
+    out.delta.ctrl = now.ctrl - atEntry.ctrl;
+    out.delta.data = now.data - atEntry.data;
+    out.delta.retries = now.retries - atEntry.retries;
+    uint64_t dwellUs = (uint64_t)out.dwellMs * 1000;
+    out.utilization = dwellUs ? (uint16_t)std::min<uint64_t>(1000, out.delta.airtimeUs * 1000ULL / dwellUs) : 0;
+
+    utilization[channel - 1] = out.utilization;
+    frames += out.delta.mgmt + out.delta.ctrl + out.delta.data;
+    retries += out.delta.retries;
+    visits++;
+    channel = 0;
+    return true;
+}
+
+bool AirtimeCsvWriter::begin(const String& filePath) {
+    if (open) return true;
+    if (!SD.exists(AIRTIME_DIR)) SD.mkdir(AIRTIME_DIR);
+    file = SD.open(filePath, FILE_WRITE);
+    if (!file) {
+        Serial.println("Airtime: failed to open " + filePath);
+        return false;
+    }
+    file.print(AIRTIME_CSV_HEADER);
+    path = filePath;
+    open = true;
+    bufferLen = 0;
+    rows = writes = errors = 0;
+    return true;
+}
+
+bool AirtimeCsvWriter::append(const AirtimeSample& sample) {
+    if (!open) return false;
+    if (bufferLen + AIRTIME_ROW_MAX > sizeof(buffer)) flush();
+
+    size_t len = formatAirtimeRow(sample, buffer + bufferLen, sizeof(buffer) - bufferLen);
+    if (len == 0) {
+        errors++;
+        return false;
+    }
+    if (bufferLen == 0) oldestMs = millis();
+    bufferLen += len;
+    rows++;
+    return true;
+}
+
+void AirtimeCsvWriter::poll() {
+    if (open && bufferLen > 0 && millis() - oldestMs >= AIRTIME_FLUSH_MS) flush();
+}
+
+void AirtimeCsvWriter::flush() {
+    if (!open || bufferLen == 0) return;
+    if (file.write((const uint8_t*)buffer, bufferLen) != bufferLen) {
+        Serial.println("Airtime: SD write failed");
+        errors++;
+    }
+    file.flush();
+    writes++;
+    bufferLen = 0;
+}
+
+void AirtimeCsvWriter::end() {
+    if (!open) return;
+    flush();
+    file.close();
+    open = false;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <Arduino.h>
+#include <SD.h>
+#include <esp_wifi.h>
+
+#define AIRTIME_CHANNELS   13   // 2.4GHz channels swept, 14 is Japan 802.11b only
+#define AIRTIME_CORES      2
+#define AIRTIME_DWELL_MS   250  // Per channel per sweep, ~3.3s for the band
+#define AIRTIME_DIR        "/airtime"
+#define AIRTIME_CSV_HEADER "uptime_ms,channel,dwell_ms,airtime_us,utilization_pct,frames,mgmt,ctrl,data,retries\n"
+#define AIRTIME_ROW_MAX    96
+#define AIRTIME_BUFFER     2048 // Bytes per SD write, ~40 visits
+#define AIRTIME_FLUSH_MS   5000
+
+// On-air time of one PPDU: preamble plus symbols for len bytes (FCS
+// included, as sig_len counts it) at the frame's rate. Non-HT rates are
+// wifi_phy_rate_t codes, HT frames use MCS, bandwidth and guard interval.
+uint32_t frameAirtimeUs(const wifi_pkt_rx_ctrl_t& rx, uint16_t len);
+
+// Counts for one channel. Every field is a 32-bit word written by one core
+// only, so readers never see a torn value; they take differences, which
+// stay right across wraparound.
+struct AirtimeCounters {
+    uint32_t airtimeUs;
+    uint32_t mgmt;
+    uint32_t ctrl;
+    uint32_t data;
+    uint32_t retries;
+};
+
+// One visit to a channel, the difference of its counters over the dwell
+struct AirtimeSample {
+    uint32_t timestampMs;  // millis() when the visit ended
+    uint8_t channel;
+    uint32_t dwellMs;
+    AirtimeCounters delta;
+    uint16_t utilization;  // Per mille of the dwell the channel was busy
+};
+
+// One CSV row, newline terminated. Returns its length, 0 if out is too small.
+size_t formatAirtimeRow(const AirtimeSample& sample, char* out, size_t max);
+
+// Airtime and frame counts per channel from the promiscuous callback.
+// account() only touches the counters of the core it runs on; the loop
+// reads both through enter()/leave() at its own pace.
+class AirtimeAnalyzer {
+public:
+    void clear();
+    // Callback side: one frame as received, sig_len bytes long
+    void account(const wifi_pkt_rx_ctrl_t& rx, const uint8_t* frame);
+
+    // Loop side: a visit to a channel starts, then ends with its sample
+    void enter(uint8_t channel, uint32_t nowMs);
+    bool leave(uint32_t nowMs, AirtimeSample& out);
+
+    void read(uint8_t channel, AirtimeCounters& out); // Both cores summed, channel 1..AIRTIME_CHANNELS
+    uint8_t getChannel() { return channel; }
+    uint16_t getUtilization(uint8_t channel) { return channel >= 1 && channel <= AIRTIME_CHANNELS ? utilization[channel - 1] : 0; }
+    uint32_t getFrames() { return frames; }  // Loop side total from finished visits
+    uint32_t getRetries() { return retries; }
+    uint32_t getVisits() { return visits; }
+
+private:
+    struct Core {
+        AirtimeCounters channels[AIRTIME_CHANNELS];
+        uint32_t busyUntilUs;  // End of the last frame, so overlapping estimates count once
+        bool busy;
+    };
+    Core cores[AIRTIME_CORES] = {};
+
+    uint8_t channel = 0;
+    uint32_t enteredMs = 0;
+    AirtimeCounters atEntry = {};
+    uint16_t utilization[AIRTIME_CHANNELS] = {};
+    uint32_t frames = 0;
+    uint32_t retries = 0;
+    uint32_t visits = 0;
+};
+
+// Appends visits to a CSV time series in AIRTIME_BUFFER blocks
+class AirtimeCsvWriter {
+public:
+    bool begin(const String& path);
+    void end();
+    bool isOpen() { return open; }
+
+    bool append(const AirtimeSample& sample);
+    void poll();   // Time based flush, call from the module loop
+    void flush();
+
+    const String& getPath() { return path; }
+    uint32_t getRows() { return rows; }
+    uint32_t getWrites() { return writes; }
+    uint32_t getErrors() { return errors; }
+
+private:
+    File file;
+    String path;
+    bool open = false;
+    char buffer[AIRTIME_BUFFER];
+    size_t bufferLen = 0;
+    uint32_t oldestMs = 0;
+    uint32_t rows = 0;
+    uint32_t writes = 0;
+    uint32_t errors = 0;
+};
@@ -0,0 +1,461 @@
+#include "ap_store.h"
+#include "table_util.h"
+#include <vector>
+#include <algorithm>
+
+#define FILE_INDEX 0
+#define FILE_DATA  1
+
+#define BSSID_SLOTS     51 // Per index page
+#define CELL_SLOTS      9
+#define RECORDS_PER_PAGE 8
+#define NODES_PER_PAGE  32
+
+struct __attribute__((packed)) BssidSlot {
+    uint8_t bssid[6];
+    uint32_t record;
+};
+
+struct __attribute__((packed)) BssidPage {
+    uint16_t used;
+    BssidSlot slots[BSSID_SLOTS];
+};
+
+struct __attribute__((packed)) CellTop {
+    uint32_t record; // AP_STORE_NONE when unused
+    int8_t rssi;
+};
+
+struct __attribute__((packed)) CellSlot {
+    uint32_t cell;
+    uint32_t head;  // Newest node
+    uint32_t count; // Nodes in the chain, stale ones included
+    CellTop top[AP_STORE_CELL_TOP]; // Strongest records, so most queries never walk the chain
+};
+
+struct __attribute__((packed)) CellPage {
+    uint16_t used;
+    CellSlot slots[CELL_SLOTS];
+};
+
+struct __attribute__((packed)) SpatialNode {
+    uint32_t record;
+    uint32_t next;
+    uint32_t cell;
+    int8_t rssi;    // The record's strength when the node was added
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(BssidPage) <= AP_STORE_PAGE, "BSSID bucket must fit a page");
+static_assert(sizeof(CellPage) <= AP_STORE_PAGE, "cell bucket must fit a page");
+static_assert(sizeof(SpatialNode) * NODES_PER_PAGE == AP_STORE_PAGE, "nodes must tile a page");
+static_assert(sizeof(ApRecord) * RECORDS_PER_PAGE == AP_STORE_PAGE, "records must tile a page");
+static_assert(sizeof(ApStoreHeader) <= AP_STORE_PAGE, "header must fit a page");
+
+// Bit n of v moves to bit 2n
+static uint32_t spread16(uint32_t v) {
+    v &= 0xFFFF;
+    v = (v | v << 8) & 0x00FF00FF;
+    v = (v | v << 4) & 0x0F0F0F0F;
+    v = (v | v << 2) & 0x33333333;
+    v = (v | v << 1) & 0x55555555;
+    return v;
+}
+
+static uint32_t squash16(uint32_t v) {
+    v &= 0x55555555;
+    v = (v | v >> 1) & 0x33333333;
+    v = (v | v >> 2) & 0x0F0F0F0F;
+    v = (v | v >> 4) & 0x00FF00FF;
+    v = (v | v >> 8) & 0x0000FFFF;
+    return v;
+}
+
+static uint32_t cellOf(uint32_t lat16, uint32_t lon16) {
+    return spread16(lon16) << 1 | spread16(lat16);
+}
+
+uint32_t geohash32(int32_t latE7, int32_t lonE7) {
+    // Same bits as halving the range 16 times, without the loop
+    uint32_t lat = (uint32_t)(((int64_t)latE7 + 900000000) * 65536 / 1800000001);
+    uint32_t lon = (uint32_t)(((int64_t)lonE7 + 1800000000) * 65536 / 3600000001);
+    return cellOf(lat, lon);
+}
+
+void geohashString(uint32_t cell, char* out, uint8_t chars) {
+    static const char base32[] = "0123456789bcdefghjkmnpqrstuvwxyz";
+    chars = std::min<uint8_t>(chars, 6);
+    for (uint8_t i = 0; i < chars; i++) out[i] = base32[(cell >> (27 - 5 * i)) & 31];
+    out[chars] = '\0';
+}
+
+// Neighbouring cells differ in a few low bits, mix them before bucketing
+static uint32_t hashCell(uint32_t cell) {
+    cell ^= cell >> 16;
+    cell *= 0x85EBCA6B;
+    cell ^= cell >> 13;
+    cell *= 0xC2B2AE35;
+    cell ^= cell >> 16;
+    return cell;
+}
+
+bool ApStore::begin(const char* indexPath, const char* dataPath, uint32_t bssidPages, uint32_t cellPages) {
+    end();
+    cache = (uint8_t*)malloc(AP_STORE_CACHE_PAGES * AP_STORE_PAGE);
+    if (!cache) {
+        Serial.println("AP store: no memory for the page cache");
+        return false;
+    }
+    for (CachedPage& p : cached) p = {0, false, AP_STORE_NONE, 0};
+    useClock = 0;
+
+    bool valid = SD.exists(indexPath) && SD.exists(dataPath);
+    if (valid) {
+        File f = SD.open(indexPath, FILE_READ);
+        valid = f && f.read((uint8_t*)&header, sizeof(header)) == sizeof(header) && header.magic == AP_STORE_MAGIC &&
+                header.version == AP_STORE_VERSION && header.pageSize == AP_STORE_PAGE;
+        if (f) f.close();
+        if (!valid) Serial.println("AP store: " + String(indexPath) + " is not a store, recreating");
+    }
+    if (!valid && !create(indexPath, dataPath, bssidPages, cellPages)) {
+        end();
+        return false;
+    }
+
+    files[FILE_INDEX] = SD.open(indexPath, AP_STORE_RW);
+    files[FILE_DATA] = SD.open(dataPath, AP_STORE_RW);
+    if (!files[FILE_INDEX] || !files[FILE_DATA]) {
+        Serial.println("AP store: failed to open " + String(indexPath));
+        if (files[FILE_INDEX]) files[FILE_INDEX].close();
+        if (files[FILE_DATA]) files[FILE_DATA].close();
+        end();
+        return false;
+    }
+    filePages[FILE_INDEX] = files[FILE_INDEX].size() / AP_STORE_PAGE;
+    filePages[FILE_DATA] = files[FILE_DATA].size() / AP_STORE_PAGE;
+    open = true;
+    dropped = pageReads = pageWrites = cacheHits = cacheMisses = 0;
+    return true;
+}
+
+// Both hashes are preallocated so a bucket read never lands past the end of the file
+bool ApStore::create(const char* indexPath, const char* dataPath, uint32_t bssidPages, uint32_t cellPages) {
+    String dir = indexPath;
+    dir = dir.substring(0, dir.lastIndexOf('/'));
+    if (dir.length() && !SD.exists(dir)) SD.mkdir(dir);
+
+    File index = SD.open(indexPath, FILE_WRITE);
+    File data = SD.open(dataPath, FILE_WRITE);
+    bool ok = index && data;
+    uint32_t total = 1 + bssidPages + cellPages;
+    memset(cache, 0, AP_STORE_PAGE);
+    for (uint32_t i = 0; i < total && ok; i++) ok = index.write(cache, AP_STORE_PAGE) == AP_STORE_PAGE;
+
+    // Header last, an interrupted create is just recreated next time
+    header = {};
+    header.magic = AP_STORE_MAGIC;
+    header.version = AP_STORE_VERSION;
+    header.pageSize = AP_STORE_PAGE;
+    header.bssidPages = bssidPages;
+    header.cellPages = cellPages;
+    ok = ok && index.seek(0) && index.write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+    if (index) index.close();
+    if (data) data.close();
+
+    if (!ok) Serial.println("AP store: failed to create " + String(indexPath));
+    else Serial.println("AP store: created " + String(indexPath) + ", " + String(total * AP_STORE_PAGE / 1024) + "KB index");
+    return ok;
+}
+
+void ApStore::end() {
+    if (open) {
+        flush();
+        files[FILE_INDEX].close();
+        files[FILE_DATA].close();
+        open = false;
+    }
+    free(cache);
+    cache = nullptr;
+}
+
+void ApStore::flush() {
+    if (!open) return;
+    for (uint32_t i = 0; i < AP_STORE_CACHE_PAGES; i++) {
+        if (cached[i].page != AP_STORE_NONE && cached[i].dirty) writeBack(cached[i], cache + i * AP_STORE_PAGE);
+    }
+    // Header after the pages it counts
+    files[FILE_INDEX].seek(0);
+    files[FILE_INDEX].write((const uint8_t*)&header, sizeof(header));
+    files[FILE_INDEX].flush();
+    files[FILE_DATA].flush();
+}
+
+void ApStore::writeBack(CachedPage& p, uint8_t* data) {
+    File& f = files[p.file];
+    if (!f.seek(p.page * AP_STORE_PAGE) || f.write(data, AP_STORE_PAGE) != AP_STORE_PAGE) {
+        Serial.println("AP store: SD write failed");
+    }
+    pageWrites++;
+    p.dirty = false;
+    if (p.page >= filePages[p.file]) filePages[p.file] = p.page + 1;
+}
+
+// Pointer into the cache, valid until the next page() call
+uint8_t* ApStore::page(uint8_t file, uint32_t n, bool dirty) {
+    useClock++;
+    CachedPage* victim = &cached[0];
+    for (CachedPage& p : cached) {
+        if (p.page == n && p.file == file) {
+            cacheHits++;
+            p.lastUse = useClock;
+            p.dirty |= dirty;
+            return cache + (&p - cached) * AP_STORE_PAGE;
+        }
+        if (p.lastUse < victim->lastUse) victim = &p;
+    }
+
+    cacheMisses++;
+    uint8_t* data = cache + (victim - cached) * AP_STORE_PAGE;
+    if (victim->page != AP_STORE_NONE && victim->dirty) writeBack(*victim, data);
+    // Data pages past the end are new; pages still in a hole were written back when evicted
+    if (n < filePages[file] && files[file].seek(n * AP_STORE_PAGE) &&
+        files[file].read(data, AP_STORE_PAGE) == AP_STORE_PAGE) {
+        pageReads++;
+    } else {
+        memset(data, 0, AP_STORE_PAGE);
+    }
+    *victim = {file, dirty, n, useClock};
+    return data;
+}
+
+ApRecord* ApStore::record(uint32_t addr, bool dirty) {
+    return (ApRecord*)page(FILE_DATA, addr / RECORDS_PER_PAGE, dirty) + addr % RECORDS_PER_PAGE;
+}
+
+// Finds bssid's slot, or the free one it would go in. False when every bucket is full.
+bool ApStore::probeBssid(const uint8_t* bssid, uint32_t& pageNo, uint16_t& index, bool& found) {
+    uint32_t home = fnv1a(bssid, 6) % header.bssidPages;
+    for (uint32_t k = 0; k < header.bssidPages; k++) {
+        pageNo = 1 + (home + k) % header.bssidPages;
+        BssidPage* b = (BssidPage*)page(FILE_INDEX, pageNo, false);
+        for (uint16_t i = 0; i < b->used; i++) {
+            if (memcmp(b->slots[i].bssid, bssid, 6) == 0) {
+                index = i;
+                found = true;
+                return true;
+            }
+        }
+        if (b->used < BSSID_SLOTS) {
+            index = b->used;
+            found = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ApStore::probeCell(uint32_t cell, uint32_t& pageNo, uint16_t& index, bool& found) {
+    uint32_t home = hashCell(cell) % header.cellPages;
+    for (uint32_t k = 0; k < header.cellPages; k++) {
+        pageNo = 1 + header.bssidPages + (home + k) % header.cellPages;
+        CellPage* c = (CellPage*)page(FILE_INDEX, pageNo, false);
+        for (uint16_t i = 0; i < c->used; i++) {
+            if (c->slots[i].cell == cell) {
+                index = i;
+                found = true;
+                return true;
+            }
+        }
+        if (c->used < CELL_SLOTS) {
+            index = c->used;
+            found = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ApStore::addNode(uint32_t recordAddr, uint32_t cell, int8_t rssi) {
+    uint32_t pageNo;
+    uint16_t index;
+    bool found;
+    if (!probeCell(cell, pageNo, index, found)) {
+        dropped++; // Still found by BSSID, just not by place
+        return;
+    }
+
+    if (header.nodes % NODES_PER_PAGE == 0) header.nodePage = header.dataPages++;
+    uint32_t addr = header.nodePage * NODES_PER_PAGE + header.nodes % NODES_PER_PAGE;
+    header.nodes++;
+
+    CellPage* c = (CellPage*)page(FILE_INDEX, pageNo, true);
+    CellSlot& slot = c->slots[index];
+    if (!found) {
+        slot.cell = cell;
+        slot.head = AP_STORE_NONE;
+        slot.count = 0;
+        for (CellTop& t : slot.top) t.record = AP_STORE_NONE;
+        c->used++;
+        header.cells++;
+    }
+    uint32_t next = slot.head;
+    slot.head = addr;
+    slot.count++;
+
+    // Strength only grows, so the record's entry is raised in place or it
+    // takes the weakest one's
+    CellTop* weakest = &slot.top[0];
+    for (CellTop& t : slot.top) {
+        if (t.record == recordAddr) {
+            weakest = &t;
+            break;
+        }
+        if (weakest->record != AP_STORE_NONE && (t.record == AP_STORE_NONE || t.rssi < weakest->rssi)) weakest = &t;
+    }
+    if (weakest->record == recordAddr || weakest->record == AP_STORE_NONE || rssi > weakest->rssi) {
+        weakest->record = recordAddr;
+        weakest->rssi = rssi;
+    }
+
+    SpatialNode* node = (SpatialNode*)page(FILE_DATA, addr / NODES_PER_PAGE, true) + addr % NODES_PER_PAGE;
+    node->record = recordAddr;
+    node->next = next;
+    node->cell = cell;
+    node->rssi = rssi;
+}
+
+SightingResult ApStore::observe(const ApSighting& ap) {
+    if (!open) return SIGHTING_DROPPED;
+    uint32_t pageNo;
+    uint16_t index;
+    bool found;
+    if (!probeBssid(ap.bssid, pageNo, index, found)) {
+        dropped++;
+        return SIGHTING_DROPPED;
+    }
+    header.observations++;
+    uint32_t cell = geohash32(ap.fix.latE7, ap.fix.lonE7);
+
+    if (!found) {
+        if (header.records % RECORDS_PER_PAGE == 0) header.recordPage = header.dataPages++;
+        uint32_t addr = header.recordPage * RECORDS_PER_PAGE + header.records % RECORDS_PER_PAGE;
+        header.records++;
+
+        BssidPage* b = (BssidPage*)page(FILE_INDEX, pageNo, true);
+        memcpy(b->slots[index].bssid, ap.bssid, 6);
+        b->slots[index].record = addr;
+        b->used++;
+
+        ApRecord* r = record(addr, true);
+        memcpy(r->bssid, ap.bssid, 6);
+        r->ssidLen = std::min<uint8_t>(ap.ssidLen, 32);
+        memset(r->ssid, 0, sizeof(r->ssid));
+        memcpy(r->ssid, ap.ssid, r->ssidLen);
+        r->authMode = ap.authMode;
+        r->channel = ap.channel;
+        r->rssi = ap.rssi;
+        r->observations = 1;
+        r->latE7 = ap.fix.latE7;
+        r->lonE7 = ap.fix.lonE7;
+        r->cell = cell;
+        r->firstSeen = ap.firstSeen;
+        r->lastSeen = ap.fix.unixTime;
+        addNode(addr, cell, ap.rssi);
+        return SIGHTING_NEW;
+    }
+
+    uint32_t addr = ((BssidPage*)page(FILE_INDEX, pageNo, false))->slots[index].record;
+    ApRecord* r = record(addr, true);
+    if (r->observations < 0xFFFF) r->observations++;
+    if (ap.fix.unixTime > r->lastSeen) r->lastSeen = ap.fix.unixTime;
+    if (ap.rssi <= r->rssi) return SIGHTING_SEEN;
+
+    r->rssi = ap.rssi;
+    r->channel = ap.channel;
+    r->latE7 = ap.fix.latE7;
+    r->lonE7 = ap.fix.lonE7;
+    r->cell = cell;
+    addNode(addr, cell, ap.rssi); // Older nodes of this record are now stale
+    return SIGHTING_STRONGER;
+}
+
+bool ApStore::find(const uint8_t* bssid, ApRecord& out) {
+    uint32_t pageNo;
+    uint16_t index;
+    bool found;
+    if (!open || !probeBssid(bssid, pageNo, index, found) || !found) return false;
+    uint32_t addr = ((BssidPage*)page(FILE_INDEX, pageNo, false))->slots[index].record;
+    out = *record(addr, false);
+    return true;
+}
+
+uint8_t ApStore::nearest(int32_t latE7, int32_t lonE7, ApRecord* out, uint8_t max) {
+    if (!open || max == 0) return 0;
+
+    uint32_t center = geohash32(latE7, lonE7);
+    uint32_t lat = squash16(center);
+    uint32_t lon = squash16(center >> 1);
+    uint32_t cells[9];
+    uint8_t cellCount = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        int32_t y = (int32_t)lat + dy;
+        if (y < 0 || y > 0xFFFF) continue; // No wrap over the poles
+        for (int dx = -1; dx <= 1; dx++) cells[cellCount++] = cellOf(y, (lon + dx) & 0xFFFF);
+    }
+
+    // The cells' top lists first; records are read for the winners only
+    std::vector<std::pair<int8_t, uint32_t>> candidates;
+    candidates.reserve(9 * AP_STORE_CELL_TOP);
+    uint32_t heads[9];
+    bool spilled = false; // A top list may be missing records that the chain has
+    for (uint8_t i = 0; i < cellCount; i++) {
+        uint32_t pageNo;
+        uint16_t index;
+        bool found;
+        heads[i] = AP_STORE_NONE;
+        if (!probeCell(cells[i], pageNo, index, found) || !found) continue;
+        CellSlot& slot = ((CellPage*)page(FILE_INDEX, pageNo, false))->slots[index];
+        for (CellTop& t : slot.top) {
+            if (t.record != AP_STORE_NONE) candidates.emplace_back((int8_t)t.rssi, (uint32_t)t.record);
+        }
+        heads[i] = slot.head;
+        spilled |= slot.count > AP_STORE_CELL_TOP;
+    }
+    bool stale = false;
+    uint8_t n = select(candidates, cells, cellCount, out, max, stale);
+    if (n == max || !stale || !spilled) return n;
+
+    // Records that moved away left holes in a top list: fall back to the
+    // newest nodes of each chain
+    for (uint8_t i = 0; i < cellCount; i++) {
+        uint32_t addr = heads[i];
+        for (uint32_t walked = 0; addr != AP_STORE_NONE && walked < AP_STORE_CELL_WALK; walked++) {
+            SpatialNode* node = (SpatialNode*)page(FILE_DATA, addr / NODES_PER_PAGE, false) + addr % NODES_PER_PAGE;
+            candidates.emplace_back((int8_t)node->rssi, (uint32_t)node->record);
+            addr = node->next;
+        }
+    }
+    return select(candidates, cells, cellCount, out, max, stale);
+}
+
+// Strongest first, checked against the records: a candidate whose record has
+// since got stronger or moved out of the cells is stale
+uint8_t ApStore::select(std::vector<std::pair<int8_t, uint32_t>>& candidates, const uint32_t* cells,
+                        uint8_t cellCount, ApRecord* out, uint8_t max, bool& stale) {
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<int8_t, uint32_t>& a, const std::pair<int8_t, uint32_t>& b) { return a.first > b.first; });
+    uint8_t n = 0;
+    for (size_t i = 0; i < candidates.size() && n < max; i++) {
+        ApRecord* r = record(candidates[i].second, false);
+        bool inside = false;
+        for (uint8_t c = 0; c < cellCount; c++) inside |= r->cell == cells[c];
+        if (r->rssi != candidates[i].first || !inside) {
+            stale = true;
+            continue;
+        }
+        bool duplicate = false;
+        for (uint8_t j = 0; j < n; j++) duplicate |= memcmp(out[j].bssid, r->bssid, 6) == 0;
+        if (!duplicate) out[n++] = *r;
+    }
+    return n;
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <Arduino.h>
+#include <SD.h>
+#include <vector>
+#include "wardrive.h"
+
+#define AP_STORE_INDEX       "/wardrive/aps.idx"
+#define AP_STORE_DATA        "/wardrive/aps.dat"
+#define AP_STORE_RW          "r+"  // Read/write without truncating, not one of the FILE_ modes
+#define AP_STORE_PAGE        512   // One SD sector
+#ifndef AP_STORE_CACHE_PAGES
+#define AP_STORE_CACHE_PAGES 24    // 12KB of RAM, the only part of the store kept in memory
+#endif
+#define AP_STORE_BSSID_PAGES 4096  // 2MB of index, ~150k BSSIDs before buckets start to spill
+#define AP_STORE_CELL_PAGES  2048  // 1MB, ~13k geohash cells
+#define AP_STORE_CELL_TOP    8     // Strongest records kept in each cell's bucket
+#define AP_STORE_CELL_WALK   256   // Newest nodes read per cell when a top list is stale
+#define AP_STORE_NONE        0xFFFFFFFF
+#define AP_STORE_MAGIC       0x31535041 // "APS1"
+#define AP_STORE_VERSION     1
+
+// 32 bit geohash, 16 bits each of longitude and latitude interleaved
+// longitude first like the base32 form: cells are ~610 x 305m at the
+// equator, so a cell and its 8 neighbours cover about 1.8 x 0.9km.
+uint32_t geohash32(int32_t latE7, int32_t lonE7);
+
+// The first chars (up to 6) of the base32 geohash of a cell
+void geohashString(uint32_t cell, char* out, uint8_t chars = 6);
+
+// One AP as stored on the card, 8 to a page
+struct __attribute__((packed)) ApRecord {
+    uint8_t bssid[6];
+    uint8_t ssidLen;
+    char ssid[32];         // Not terminated
+    uint8_t authMode;
+    uint8_t channel;
+    int8_t rssi;           // Strongest so far
+    uint16_t observations; // Times stored, saturating
+    int32_t latE7;         // Where rssi was measured
+    int32_t lonE7;
+    uint32_t cell;         // geohash32() of latE7/lonE7
+    uint32_t firstSeen;    // UTC
+    uint32_t lastSeen;
+};
+static_assert(sizeof(ApRecord) == 64, "records must tile a page");
+
+struct __attribute__((packed)) ApStoreHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t pageSize;
+    uint32_t bssidPages;
+    uint32_t cellPages;
+    uint32_t records;
+    uint32_t nodes;
+    uint32_t cells;
+    uint32_t dataPages;
+    uint32_t recordPage;   // Data page being filled with records
+    uint32_t nodePage;     // And with spatial nodes
+    uint32_t observations;
+};
+
+// Persistent AP database for long surveys, far bigger than RAM. Two files:
+//
+//   aps.idx  header page, then a BSSID hash of AP_STORE_BSSID_PAGES bucket
+//            pages, then a geohash cell hash of AP_STORE_CELL_PAGES. Both are
+//            preallocated and spill into the next page when a bucket is full.
+//   aps.dat  pages of ApRecords and of spatial nodes, appended as needed.
+//
+// Each cell keeps its AP_STORE_CELL_TOP strongest records in its bucket and
+// points at a newest-first chain of nodes {record, rssi} for the rest. A
+// record that gets stronger, or moves cell, gets a new node and leaves the
+// old one stale; nearest() checks candidates against the record itself.
+// Everything goes through a small LRU page cache written back on flush().
+class ApStore {
+public:
+    bool begin(const char* indexPath = AP_STORE_INDEX, const char* dataPath = AP_STORE_DATA,
+               uint32_t bssidPages = AP_STORE_BSSID_PAGES, uint32_t cellPages = AP_STORE_CELL_PAGES);
+    void end();
+    ~ApStore() { end(); }
+    bool isOpen() { return open; }
+
+    // Adds or updates the AP, keeping the strongest sighting and where it was
+    SightingResult observe(const ApSighting& ap);
+    bool find(const uint8_t* bssid, ApRecord& out);
+
+    // Strongest APs in the cell around latE7/lonE7 and its neighbours. Returns how many.
+    uint8_t nearest(int32_t latE7, int32_t lonE7, ApRecord* out, uint8_t max);
+
+    // Writes back dirty pages and the header
+    void flush();
+
+    uint32_t getRecords() { return header.records; }
+    uint32_t getCells() { return header.cells; }
+    uint32_t getNodes() { return header.nodes; }
+    uint32_t getObservations() { return header.observations; }
+    uint32_t getDropped() { return dropped; }
+    uint32_t getPageReads() { return pageReads; }
+    uint32_t getPageWrites() { return pageWrites; }
+    uint32_t getCacheHits() { return cacheHits; }
+    uint32_t getCacheMisses() { return cacheMisses; }
+
+private:
+    struct CachedPage {
+        uint8_t file;
+        bool dirty;
+        uint32_t page;   // AP_STORE_NONE when the slot is free
+        uint32_t lastUse;
+    };
+
+    File files[2];
+    uint32_t filePages[2] = {0, 0}; // Pages on the card, reads past this are zeros
+    ApStoreHeader header = {};
+    bool open = false;
+
+    uint8_t* cache = nullptr;
+    CachedPage cached[AP_STORE_CACHE_PAGES];
+    uint32_t useClock = 0;
+
+    uint32_t dropped = 0;
+    uint32_t pageReads = 0;
+    uint32_t pageWrites = 0;
+    uint32_t cacheHits = 0;
+    uint32_t cacheMisses = 0;
+
+    bool create(const char* indexPath, const char* dataPath, uint32_t bssidPages, uint32_t cellPages);
+    uint8_t* page(uint8_t file, uint32_t n, bool dirty);
+    void writeBack(CachedPage& p, uint8_t* data);
+    ApRecord* record(uint32_t addr, bool dirty);
+    bool probeBssid(const uint8_t* bssid, uint32_t& pageNo, uint16_t& index, bool& found);
+    bool probeCell(uint32_t cell, uint32_t& pageNo, uint16_t& index, bool& found);
+    void addNode(uint32_t recordAddr, uint32_t cell, int8_t rssi);
+    uint8_t select(std::vector<std::pair<int8_t, uint32_t>>& candidates, const uint32_t* cells, uint8_t cellCount,
+                   ApRecord* out, uint8_t max, bool& stale);
+};
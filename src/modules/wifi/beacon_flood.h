@@ -0,0 +1,109 @@
+#pragma once
+#include <Arduino.h>
+#include <SD.h>
+#include <esp_wifi.h>
+
+#define BEACON_FRAME_MAX   128  // Header, fixed fields, SSID, rates, DS, TIM and RSN
+#define BEACON_POOL_MAX    64
+#define BEACON_SEQ_OFFSET  22
+#define BEACON_TSF_OFFSET  24
+#define BEACON_DIR         "/beacons"
+#define BEACON_SSID_FILE   "/beacons/ssids.txt" // One SSID per line, # for comments
+#define BEACON_BURST       8    // Frames the controller lets out at once after a stall
+#define BEACON_WINDOW_US   1000000
+
+// Beacon for ssid from bssid on channel, open or WPA2-PSK/CCMP. Sequence
+// number and timestamp are left zero for patchBeacon(). Returns the frame
+// length, 0 if max is too small; channelOffset gets the DS parameter byte.
+size_t buildBeacon(uint8_t* out, size_t max, const uint8_t* bssid, const uint8_t* ssid, uint8_t ssidLen,
+                   uint8_t channel, bool wpa2, uint8_t* channelOffset = nullptr);
+// The only fields that change from one transmission to the next
+void patchBeacon(uint8_t* frame, uint16_t seq, uint64_t tsfUs);
+// Locally administered BSSID from the SSID and its place in the list, the same every run
+void beaconBssid(uint8_t* out, const uint8_t* ssid, uint8_t ssidLen, uint16_t index);
+
+struct BeaconTemplate {
+    uint8_t frame[BEACON_FRAME_MAX];
+    uint8_t len;
+    uint8_t channelOffset;
+    uint16_t seq; // Per BSSID, 12 bits
+};
+
+// Frames built once when the list is loaded; transmitting one only patches
+// its sequence number and timestamp.
+class BeaconPool {
+public:
+    bool begin(uint16_t capacity = BEACON_POOL_MAX);
+    void end();
+    ~BeaconPool() { end(); }
+
+    bool add(const uint8_t* ssid, uint8_t len, uint8_t channel, bool wpa2);
+    uint16_t load(const String& path, uint8_t channel, bool wpa2); // SSIDs from the card, returns how many
+    void fill(const char* prefix, uint16_t count, uint8_t channel, bool wpa2); // prefix-01, prefix-02...
+    void setChannel(uint8_t channel);
+
+    BeaconTemplate& next(); // Round robin
+    uint16_t size() { return count; }
+    const BeaconTemplate& get(uint16_t i) { return templates[i]; }
+
+private:
+    BeaconTemplate* templates = nullptr;
+    uint16_t capacity = 0;
+    uint16_t count = 0;
+    uint16_t cursor = 0;
+};
+
+// Token bucket in fixed point: every microsecond earns targetFps credit and
+// a frame costs a million, so rates from 1 to thousands of frames per second
+// come out exact. Credit is capped at BEACON_BURST frames, so a stall does
+// not turn into a long burst afterwards. Achieved rate is counted over
+// BEACON_WINDOW_US windows.
+class TxRateController {
+public:
+    void begin(uint32_t targetFps, uint32_t nowUs);
+    void setTarget(uint32_t fps) { target = fps; }
+    uint32_t getTarget() { return target; }
+
+    uint32_t ready(uint32_t nowUs);  // Frames that may go now
+    uint32_t waitUs();               // Until the next one, after ready() returned 0
+    void sent(bool ok);
+
+    uint32_t getAchievedFps() { return achieved; } // Last full window
+    uint32_t getSent() { return sentOk; }
+    uint32_t getFailed() { return failed; }
+
+private:
+    uint32_t target = 0;
+    uint64_t credit = 0;
+    uint32_t lastUs = 0;
+    uint32_t windowStartUs = 0;
+    uint32_t windowFrames = 0;
+    uint32_t achieved = 0;
+    uint32_t sentOk = 0;
+    uint32_t failed = 0; // Driver queue full
+};
+
+// Sends the pool round robin at the controller's rate from a task of its
+// own, or from poll() on the module loop when the task can't be started.
+class BeaconFlood {
+public:
+    bool start(uint32_t fps);
+    void stop();
+    void poll();
+    bool isRunning() { return running; }
+
+    BeaconPool& getPool() { return pool; }
+    TxRateController& getRate() { return rate; }
+
+private:
+    BeaconPool pool;
+    TxRateController rate;
+    volatile bool running = false;
+    volatile bool stopRequested = false;
+    TaskHandle_t txTask = nullptr;
+    uint64_t tsfUs = 0;
+    uint32_t lastMicros = 0;
+
+    static void txLoop(void* param);
+    uint32_t transmit(); // Returns the microseconds until the next frame is due
+};
@@ -0,0 +1,69 @@
+#include "capture_schedule.h"
+
+void ChannelSchedule::begin(CaptureSchedule scheduleMode) {
+    mode = scheduleMode;
+    count = index = 0;
+    started = false;
+    holdUntilMs = 0;
+    hops = holds = 0;
+}
+
+void ChannelSchedule::addTarget(uint8_t channel) {
+    if (channel < 1 || channel > CAPTURE_MAX_CHANNELS) return;
+    for (uint8_t i = 0; i < count; i++) {
+        if (channels[i] == channel) {
+            targets[i]++;
+            return;
+        }
+    }
+    // Kept in channel order so a pass sweeps the band once
+    uint8_t i = count++;
+    while (i > 0 && channels[i - 1] > channel) {
+        channels[i] = channels[i - 1];
+        targets[i] = targets[i - 1];
+        i--;
+    }
+    channels[i] = channel;
+    targets[i] = 1;
+}
+
+void ChannelSchedule::enter(uint8_t i, uint32_t nowMs) {
+    index = i;
+    dwellStartMs = nowMs;
+    uint32_t dwell = CAPTURE_DWELL_MS;
+    if (mode == SCHEDULE_ADAPTIVE) dwell += (targets[i] - 1) * CAPTURE_DWELL_PER_AP;
+    dwellEndMs = nowMs + dwell;
+    holdUntilMs = nowMs;
+}
+
+uint8_t ChannelSchedule::update(uint32_t nowMs, bool& hopped) {
+    hopped = false;
+    if (count == 0) return 0;
+    if (!started) {
+        started = true;
+        enter(0, nowMs);
+        hopped = true;
+        return channels[index];
+    }
+    if ((int32_t)(nowMs - dwellEndMs) < 0) return channels[index];
+    // A handshake under way keeps us here, up to the cap
+    if (mode == SCHEDULE_ADAPTIVE && (int32_t)(nowMs - holdUntilMs) < 0 &&
+        nowMs - dwellStartMs < CAPTURE_HOLD_MAX_MS) {
+        return channels[index];
+    }
+    if (count > 1) {
+        enter((index + 1) % count, nowMs);
+        hops++;
+        hopped = true;
+    } else {
+        enter(index, nowMs);
+    }
+    return channels[index];
+}
+
+void ChannelSchedule::onProgress(uint8_t channel, uint32_t nowMs) {
+    if (mode != SCHEDULE_ADAPTIVE || !started || channel != channels[index]) return;
+    uint32_t until = nowMs + CAPTURE_HOLD_MS;
+    if ((int32_t)(holdUntilMs - dwellEndMs) <= 0 && (int32_t)(until - dwellEndMs) > 0) holds++; // Visits held over
+    holdUntilMs = until;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <Arduino.h>
+
+#define CAPTURE_MAX_TARGETS  16
+#define CAPTURE_MAX_CHANNELS 14
+#define CAPTURE_DWELL_MS     250  // Per channel per pass
+#define CAPTURE_DWELL_PER_AP 50   // Adaptive: extra time per target on the channel
+#define CAPTURE_HOLD_MS      1500 // Adaptive: stay this long after EAPOL progress
+#define CAPTURE_HOLD_MAX_MS  6000 // But never this long on one channel in one visit
+
+enum CaptureSchedule : uint8_t {
+    SCHEDULE_ROUND_ROBIN, // Same dwell everywhere
+    SCHEDULE_ADAPTIVE     // Longer on busy channels, held while a handshake is under way
+};
+
+// Which channel a multi-target capture listens on. update() is called from
+// the loop, onProgress() from the capture path; the hold is a single word
+// so no lock is needed between them.
+class ChannelSchedule {
+public:
+    void begin(CaptureSchedule mode);
+    void addTarget(uint8_t channel);
+
+    // Channel to listen on at nowMs, hopped is set when it just changed
+    uint8_t update(uint32_t nowMs, bool& hopped);
+    void onProgress(uint8_t channel, uint32_t nowMs);
+
+    CaptureSchedule getMode() { return mode; }
+    uint8_t getChannel() { return count ? channels[index] : 0; }
+    uint8_t getChannelCount() { return count; }
+    uint32_t getHops() { return hops; }
+    uint32_t getHolds() { return holds; } // Visits that outlasted their dwell
+
+private:
+    CaptureSchedule mode = SCHEDULE_ADAPTIVE;
+    uint8_t channels[CAPTURE_MAX_CHANNELS];
+    uint8_t targets[CAPTURE_MAX_CHANNELS]; // Targets on each channel
+    uint8_t count = 0;
+    uint8_t index = 0;
+    bool started = false;
+    uint32_t dwellStartMs = 0;
+    uint32_t dwellEndMs = 0;
+    volatile uint32_t holdUntilMs = 0;
+    uint32_t hops = 0;
+    uint32_t holds = 0;
+
+    void enter(uint8_t i, uint32_t nowMs);
+};
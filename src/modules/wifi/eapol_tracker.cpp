@@ -0,0 +1,176 @@
+#include "eapol_tracker.h"
+
+#define KEY_INFO_PAIRWISE 0x0008
+#define KEY_INFO_INSTALL  0x0040
+#define KEY_INFO_ACK      0x0080
+#define KEY_INFO_MIC      0x0100
+#define KEY_INFO_SECURE   0x0200
+#define KEY_BODY_MIN      95 // Key descriptor up to the key data length
+#define EAPOL_MIC_OFFSET  81 // 802.1X header + descriptor up to the MIC
+
+static const uint8_t snapEapol[8] = {0xAA, 0xAA, 0x03, 0x00, 0x00, 0x00, 0x88, 0x8E};
+
+int eapolOffset(const uint8_t* f, int len) {
+    if (len < 24 || (f[0] & 0x0C) != 0x08) return -1; // Data frames only
+    if (f[1] & 0x40) return -1;                       // Protected, nothing to read
+    int header = 24;
+    if ((f[1] & 0x03) == 0x03) header += 6;           // WDS has a fourth address
+    if (f[0] & 0x80) {
+        header += 2;                                  // QoS control
+        if (f[1] & 0x80) header += 4;                 // HT control
+    }
+    if (len < header + 8 + 4 || memcmp(f + header, snapEapol, 8) != 0) return -1;
+    return header + 8;
+}
+
+bool parseEapolKey(const uint8_t* f, int len, EapolKey& out) {
+    int offset = eapolOffset(f, len);
+    if (offset < 0) return false;
+    bool toDs = f[1] & 0x01;
+    bool fromDs = f[1] & 0x02;
+    if (toDs == fromDs) return false; // Only AP <-> station handshakes
+
+    const uint8_t* e = f + offset;
+    uint16_t bodyLength = e[2] << 8 | e[3];
+    if (e[1] != 3 || bodyLength < KEY_BODY_MIN || offset + 4 + bodyLength > len) return false; // EAPOL-Key
+    const uint8_t* k = e + 4;
+    if (k[0] != 2 && k[0] != 254) return false; // RSN or WPA key descriptor
+
+    uint16_t info = k[1] << 8 | k[2];
+    uint16_t dataLength = k[93] << 8 | k[94];
+    if (!(info & KEY_INFO_PAIRWISE) || KEY_BODY_MIN + dataLength > bodyLength) return false;
+
+    bool zeroNonce = true;
+    for (int i = 13; i < 45 && zeroNonce; i++) zeroNonce = k[i] == 0;
+    if (info & KEY_INFO_ACK) {
+        if (!(info & KEY_INFO_MIC)) out.message = EAPOL_M1;
+        else if (info & KEY_INFO_INSTALL) out.message = EAPOL_M3;
+        else return false;
+        if (!fromDs) return false;
+    } else {
+        if (!(info & KEY_INFO_MIC)) return false;
+        // M4 is secure and usually has no nonce; some WPA1 stacks leave the bit clear
+        out.message = (info & KEY_INFO_SECURE) || zeroNonce ? EAPOL_M4 : EAPOL_M2;
+        if (!toDs) return false;
+    }
+
+    out.bssid = fromDs ? f + 10 : f + 4;
+    out.station = fromDs ? f + 4 : f + 10;
+    out.keyInfo = info;
+    out.replayCounter = 0;
+    for (int i = 5; i < 13; i++) out.replayCounter = out.replayCounter << 8 | k[i];
+    out.nonce = k + 13;
+    out.mic = k + 77;
+    out.keyData = k + KEY_BODY_MIN;
+    out.keyDataLength = dataLength;
+    out.eapol = e;
+    out.eapolLength = 4 + bodyLength;
+    return true;
+}
+
+const uint8_t* findPmkid(const EapolKey& key) {
+    if (key.message != EAPOL_M1) return nullptr; // Later key data is encrypted
+    const uint8_t* p = key.keyData;
+    const uint8_t* end = key.keyData + key.keyDataLength;
+    while (p + 2 <= end && p + 2 + p[1] <= end) {
+        // PMKID KDE: dd <len> 00 0f ac 04 <PMKID>
+        if (p[0] == 0xDD && p[1] >= 20 && p[2] == 0x00 && p[3] == 0x0F && p[4] == 0xAC && p[5] == 0x04) {
+            for (int i = 0; i < 16; i++) {
+                if (p[6 + i]) return p + 6;
+            }
+            return nullptr;
+        }
+        p += 2 + p[1];
+    }
+    return nullptr;
+}
+
+void EapolTracker::clear() {
+    for (EapolSession& s : sessions) s.used = 0;
+    last = nullptr;
+    complete = pmkids = frames = replaced = 0;
+}
+
+// Free slots first, then the oldest finished session, then the oldest of all
+EapolSession& EapolTracker::lookup(const uint8_t* bssid, const uint8_t* station, uint32_t nowMs) {
+    EapolSession* free = nullptr;
+    EapolSession* oldestDone = nullptr;
+    EapolSession* oldest = &sessions[0];
+    for (EapolSession& s : sessions) {
+        if (!s.used) {
+            if (!free) free = &s;
+            continue;
+        }
+        if (memcmp(s.bssid, bssid, 6) == 0 && memcmp(s.station, station, 6) == 0) return s;
+        if (s.pair != EAPOL_PAIR_NONE && (!oldestDone || s.lastMs < oldestDone->lastMs)) oldestDone = &s;
+        if (s.lastMs < oldest->lastMs) oldest = &s;
+    }
+
+    EapolSession* s = free ? free : (oldestDone ? oldestDone : oldest);
+    if (!free) replaced++;
+    memcpy(s->bssid, bssid, 6);
+    memcpy(s->station, station, 6);
+    s->messages = 0;
+    s->pair = EAPOL_PAIR_NONE;
+    s->used = 1;
+    s->hasPmkid = 0;
+    s->eapolLength = 0;
+    s->firstMs = s->lastMs = nowMs;
+    return *s;
+}
+
+EapolResult EapolTracker::observe(const EapolKey& key, uint8_t channel, uint32_t nowMs) {
+    frames++;
+    EapolSession& s = lookup(key.bssid, key.station, nowMs);
+    last = &s;
+    const uint8_t* pmkid = s.hasPmkid ? nullptr : findPmkid(key);
+    if (pmkid) {
+        memcpy(s.pmkid, pmkid, 16);
+        s.hasPmkid = 1;
+        pmkids++;
+    }
+    if (s.pair != EAPOL_PAIR_NONE) {
+        s.lastMs = nowMs;
+        return EAPOL_REPEAT;
+    }
+    if (s.messages && nowMs - s.lastMs > EAPOL_EXCHANGE_MS) s.messages = 0;
+
+    uint8_t index = key.message == EAPOL_M1 ? 0 : key.message == EAPOL_M2 ? 1 : key.message == EAPOL_M3 ? 2 : 3;
+    s.messages |= key.message;
+    s.replay[index] = key.replayCounter;
+    s.channel = channel;
+    s.lastMs = nowMs;
+    if (key.message == EAPOL_M1 || key.message == EAPOL_M3) {
+        memcpy(s.anonce, key.nonce, 32);
+    } else if (key.message == EAPOL_M2) {
+        memcpy(s.mic, key.mic, 16);
+        s.eapolLength = key.eapolLength <= EAPOL_FRAME_MAX ? key.eapolLength : 0;
+        memcpy(s.eapol, key.eapol, s.eapolLength);
+        if (s.eapolLength) memset(s.eapol + EAPOL_MIC_OFFSET, 0, 16);
+    }
+
+    // The AP answers M2 with M3 one replay step on; M2 echoes M1's counter
+    if ((s.messages & (EAPOL_M1 | EAPOL_M2)) == (EAPOL_M1 | EAPOL_M2) && s.replay[1] == s.replay[0]) {
+        s.pair = EAPOL_PAIR_M1M2;
+    } else if ((s.messages & (EAPOL_M2 | EAPOL_M3)) == (EAPOL_M2 | EAPOL_M3) && s.replay[2] == s.replay[1] + 1) {
+        s.pair = EAPOL_PAIR_M2M3;
+    }
+    if (s.pair == EAPOL_PAIR_NONE) return EAPOL_PROGRESS;
+    complete++;
+    return EAPOL_COMPLETE;
+}
+
+const EapolSession* EapolTracker::find(const uint8_t* bssid, const uint8_t* station) {
+    for (const EapolSession& s : sessions) {
+        if (s.used && memcmp(s.bssid, bssid, 6) == 0 && memcmp(s.station, station, 6) == 0) return &s;
+    }
+    return nullptr;
+}
+
+uint8_t EapolTracker::getInProgress(uint32_t nowMs) {
+    uint8_t n = 0;
+    for (const EapolSession& s : sessions) {
+        if (s.used && s.pair == EAPOL_PAIR_NONE && s.messages && nowMs - s.lastMs <= EAPOL_EXCHANGE_MS) n++;
+    }
+    return n;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <Arduino.h>
+
+#define EAPOL_MAX_SESSIONS 32
+#define EAPOL_EXCHANGE_MS  2000 // Messages further apart than this start a new exchange
+#define EAPOL_FRAME_MAX    256  // Longest M2 kept for export, hashcat's own limit
+
+#define EAPOL_M1 0x01
+#define EAPOL_M2 0x02
+#define EAPOL_M3 0x04
+#define EAPOL_M4 0x08
+
+// Crackable message pairs, numbered like hashcat's message_pair field
+#define EAPOL_PAIR_NONE  0xFF
+#define EAPOL_PAIR_M1M2  0x00 // ANonce from M1, MIC from M2, same replay counter
+#define EAPOL_PAIR_M2M3  0x02 // ANonce from M3, MIC from M2, M3 one replay step later
+
+// An EAPOL-Key frame picked out of an 802.11 data frame. Pointers are into
+// that frame and only valid as long as it is.
+struct EapolKey {
+    const uint8_t* bssid;
+    const uint8_t* station;
+    uint8_t message;          // EAPOL_M1..EAPOL_M4
+    uint16_t keyInfo;
+    uint64_t replayCounter;
+    const uint8_t* nonce;     // 32 bytes
+    const uint8_t* mic;       // 16 bytes
+    const uint8_t* keyData;
+    uint16_t keyDataLength;
+    const uint8_t* eapol;     // From the 802.1X header to the end of the key data
+    uint16_t eapolLength;
+};
+
+// Offset of the 802.1X header in an unprotected 802.11 data frame with an
+// EAPOL LLC/SNAP header, -1 for any other frame
+int eapolOffset(const uint8_t* frame, int len);
+
+// Parses an unprotected 802.11 data frame carrying an EAPOL-Key message.
+// False for anything else, including frames too short for what they claim.
+bool parseEapolKey(const uint8_t* frame, int len, EapolKey& out);
+
+// PMKID from the RSN key data of an M1, nullptr when there is none. APs
+// that don't cache PMKs often send all zeros, that counts as none too.
+const uint8_t* findPmkid(const EapolKey& key);
+
+// Handshake progress of one (BSSID, station) pair, with what a hashcat
+// line needs: the ANonce, and M2's MIC and EAPOL frame
+struct EapolSession {
+    uint8_t bssid[6];
+    uint8_t station[6];
+    uint8_t messages;     // EAPOL_M* seen in the current exchange
+    uint8_t pair;         // EAPOL_PAIR_* of the first crackable pair, or EAPOL_PAIR_NONE
+    uint8_t channel;
+    uint8_t used;
+    uint8_t hasPmkid;
+    uint64_t replay[4];   // Replay counter of each message in the current exchange
+    uint32_t firstMs;
+    uint32_t lastMs;
+    uint8_t pmkid[16];
+    uint8_t anonce[32];   // From the last M1 or M3
+    uint8_t mic[16];      // From the last M2
+    uint16_t eapolLength; // M2 from the 802.1X header with its MIC zeroed, 0 if too long
+    uint8_t eapol[EAPOL_FRAME_MAX];
+};
+
+enum EapolResult : uint8_t {
+    EAPOL_PROGRESS,   // A handshake moved on
+    EAPOL_COMPLETE,   // This pair just became crackable
+    EAPOL_REPEAT      // Pair already complete, nothing new
+};
+
+// Fixed table of handshake sessions, ~11KB. Called from the capture path
+// only, so the table needs no lock; other tasks just read the counters.
+class EapolTracker {
+public:
+    void clear();
+    EapolResult observe(const EapolKey& key, uint8_t channel, uint32_t nowMs);
+    const EapolSession* find(const uint8_t* bssid, const uint8_t* station);
+    const EapolSession* getLast() { return last; } // Session of the last observe()
+
+    // Sessions part way through an exchange, none of them complete
+    uint8_t getInProgress(uint32_t nowMs);
+    uint32_t getComplete() { return complete; }
+    uint32_t getPmkids() { return pmkids; }
+    uint32_t getFrames() { return frames; }
+    uint32_t getReplaced() { return replaced; }
+    const EapolSession& getSession(uint8_t i) { return sessions[i]; }
+
+private:
+    EapolSession sessions[EAPOL_MAX_SESSIONS] = {};
+    EapolSession* last = nullptr;
+    uint32_t complete = 0;
+    uint32_t pmkids = 0;
+    uint32_t frames = 0;
+    uint32_t replaced = 0; // Sessions evicted to make room
+
+    EapolSession& lookup(const uint8_t* bssid, const uint8_t* station, uint32_t nowMs);
+};
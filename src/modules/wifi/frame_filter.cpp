@@ -0,0 +1,49 @@
+#include "frame_filter.h"
+
+void FrameFilter::set(FrameConsumer consumer, const FrameNeeds& consumerNeeds) {
+    needs[consumer] = consumerNeeds;
+    active |= 1 << consumer;
+}
+
+void FrameFilter::clear(FrameConsumer consumer) {
+    needs[consumer] = {};
+    active &= ~(1 << consumer);
+}
+
+void FrameFilter::plan() {
+    uint8_t next = current ^ 1;
+    uint8_t* table = tables[next];
+    memset(table, 0, sizeof(tables[0]));
+    uint16_t wanted[3] = {0, 0, 0};
+    for (uint8_t c = 0; c < FRAME_CONSUMERS; c++) {
+        if (!(active & (1 << c))) continue;
+        for (uint8_t type = 0; type < 3; type++) {
+            wanted[type] |= needs[c].subtypes[type];
+            for (uint8_t subtype = 0; subtype < 16; subtype++) {
+                if (needs[c].subtypes[type] & FRAME_SUBTYPE(subtype)) table[subtype << 2 | type] |= 1 << c;
+            }
+        }
+    }
+
+    filterMask = 0;
+    if (wanted[FRAME_MGMT]) filterMask |= WIFI_PROMIS_FILTER_MASK_MGMT;
+    if (wanted[FRAME_CTRL]) filterMask |= WIFI_PROMIS_FILTER_MASK_CTRL;
+    if (wanted[FRAME_DATA]) filterMask |= WIFI_PROMIS_FILTER_MASK_DATA;
+
+    // The driver has a bit for control subtypes 7-15 (wrapper to CF-End+Ack), none below
+    ctrlFilterMask = 0;
+    for (uint8_t subtype = 0; subtype < 16 && wanted[FRAME_CTRL]; subtype++) {
+        if (!(wanted[FRAME_CTRL] & FRAME_SUBTYPE(subtype))) continue;
+        if (subtype < 7) {
+            ctrlFilterMask = WIFI_PROMIS_CTRL_FILTER_MASK_ALL;
+            break;
+        }
+        ctrlFilterMask |= 1u << (16 + subtype);
+    }
+    current = next;
+}
+
+void FrameFilter::resetCounters() {
+    callbacks = rejected = 0;
+    callbackCycles = 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_wifi.h>
+
+// Users of the promiscuous callback, at most 8
+enum FrameConsumer : uint8_t {
+    FRAME_STATIONS,   // Station scan: data frames to or from the target
+    FRAME_HANDSHAKES, // Handshake capture: EAPOL rides in Data and QoS Data
+    FRAME_AIRTIME,    // Channel usage: every frame the radio hears
+    FRAME_PROBES,     // Probe log: probe requests
+    FRAME_CONSUMERS
+};
+
+#define FRAME_MGMT 0
+#define FRAME_CTRL 1
+#define FRAME_DATA 2
+
+#define FRAME_SUBTYPE(s)     (1u << (s))
+#define FRAME_ALL_SUBTYPES   0xFFFF
+#define FRAME_DATA_SUBTYPE   0x0  // Data
+#define FRAME_QOS_SUBTYPE    0x8  // QoS Data
+
+// Subtypes a consumer wants, one mask per frame type
+struct FrameNeeds {
+    uint16_t subtypes[3]; // Indexed by FRAME_MGMT, FRAME_CTRL, FRAME_DATA
+};
+
+// Works out the narrowest driver filter that still passes every frame an
+// active consumer declared, and a table from the first frame control byte
+// to the consumers that want the frame. The driver can only filter by type,
+// plus control subtypes, so the table does the rest in the callback.
+//
+// plan() runs on the loop and writes the table the callback isn't reading,
+// then flips a single byte, so no lock is needed between them.
+class FrameFilter {
+public:
+    void set(FrameConsumer consumer, const FrameNeeds& needs);
+    void clear(FrameConsumer consumer);
+    void plan();
+
+    bool isActive() { return active != 0; }
+    bool wants(FrameConsumer consumer) { return active & (1 << consumer); }
+    uint32_t getFilterMask() { return filterMask; }         // WIFI_PROMIS_FILTER_MASK_*
+    uint32_t getCtrlFilterMask() { return ctrlFilterMask; } // WIFI_PROMIS_CTRL_FILTER_MASK_*
+
+    // Consumers for a frame, 0 when nobody wants it. Called from the callback.
+    uint8_t dispatch(const uint8_t* frame) {
+        callbacks++;
+        uint8_t consumers = tables[current][frame[0] >> 2];
+        if (!consumers) rejected++;
+        return consumers;
+    }
+    void addCycles(uint32_t cycles) { callbackCycles += cycles; }
+
+    // Since the last resetCounters()
+    uint32_t getCallbacks() { return callbacks; }
+    uint32_t getRejected() { return rejected; } // Reached the callback but nobody wanted them
+    uint64_t getCallbackCycles() { return callbackCycles; }
+    void resetCounters();
+
+private:
+    FrameNeeds needs[FRAME_CONSUMERS] = {};
+    uint8_t active = 0;
+    uint8_t tables[2][64] = {}; // Indexed by frame control byte 0 >> 2: subtype << 2 | type
+    volatile uint8_t current = 0;
+    uint32_t filterMask = 0;
+    uint32_t ctrlFilterMask = 0;
+    volatile uint32_t callbacks = 0;
+    volatile uint32_t rejected = 0;
+    volatile uint64_t callbackCycles = 0;
+};
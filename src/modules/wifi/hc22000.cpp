@@ -0,0 +1,118 @@
+#include "hc22000.h"
+
+static char* putHex(char* p, const uint8_t* data, size_t n) {
+    static const char hexDigits[] = "0123456789abcdef";
+    for (size_t i = 0; i < n; i++) {
+        *p++ = hexDigits[data[i] >> 4];
+        *p++ = hexDigits[data[i] & 0x0F];
+    }
+    return p;
+}
+
+// WPA*<type>*<pmkid or mic>*<ap>*<sta>*<essid>*
+static char* putHead(char* p, char type, const uint8_t* hash, const EapolSession& s, const uint8_t* essid,
+                     uint8_t essidLen) {
+    memcpy(p, "WPA*0", 5);
+    p += 5;
+    *p++ = type;
+    *p++ = '*';
+    p = putHex(p, hash, 16);
+    *p++ = '*';
+    p = putHex(p, s.bssid, 6);
+    *p++ = '*';
+    p = putHex(p, s.station, 6);
+    *p++ = '*';
+    p = putHex(p, essid, essidLen);
+    *p++ = '*';
+    return p;
+}
+
+size_t formatPmkidLine(const EapolSession& s, const uint8_t* essid, uint8_t essidLen, char* out, size_t max) {
+    if (!s.hasPmkid || essidLen == 0 || essidLen > 32 || max < 7 + 32 + 2 * 12 + 64 + 8) return 0;
+    char* p = putHead(out, '1', s.pmkid, s, essid, essidLen);
+    memcpy(p, "**\n", 4); // No ANonce, EAPOL or message pair
+    return p + 3 - out;
+}
+
+size_t formatHandshakeLine(const EapolSession& s, const uint8_t* essid, uint8_t essidLen, char* out, size_t max) {
+    if (s.pair == EAPOL_PAIR_NONE || s.eapolLength == 0 || essidLen == 0 || essidLen > 32) return 0;
+    size_t needed = 7 + 32 + 2 * 12 + 64 + 64 + (size_t)s.eapolLength * 2 + 2 + 8;
+    if (max < needed) return 0;
+    char* p = putHead(out, '2', s.mic, s, essid, essidLen);
+    p = putHex(p, s.anonce, 32);
+    *p++ = '*';
+    p = putHex(p, s.eapol, s.eapolLength);
+    *p++ = '*';
+    p = putHex(p, &s.pair, 1);
+    *p++ = '\n';
+    *p = '\0';
+    return p - out;
+}
+
+bool Hc22000Writer::begin(const String& path) {
+    end();
+    queueHead = queueTail = 0;
+    pmkids = handshakes = skipped = dropped = errors = 0;
+    file = SD.open(path, FILE_APPEND);
+    open = file;
+    if (!open) Serial.println("Capture: failed to open " + path);
+    return open;
+}
+
+bool Hc22000Writer::writePmkid(const EapolSession& s, const uint8_t* essid, uint8_t essidLen) {
+    char* line = reserve();
+    if (!line || !commit(formatPmkidLine(s, essid, essidLen, line, HC22000_LINE_MAX))) return false;
+    pmkids++;
+    return true;
+}
+
+bool Hc22000Writer::writeHandshake(const EapolSession& s, const uint8_t* essid, uint8_t essidLen) {
+    char* line = reserve();
+    if (!line || !commit(formatHandshakeLine(s, essid, essidLen, line, HC22000_LINE_MAX))) return false;
+    handshakes++;
+    return true;
+}
+
+// The free slot at the head, nullptr when the file is closed or poll() is behind
+char* Hc22000Writer::reserve() {
+    if (!open) {
+        errors++;
+        return nullptr;
+    }
+    uint32_t head = queueHead;
+    if (((head + 1) & HC22000_QUEUE_MASK) == __atomic_load_n(&queueTail, __ATOMIC_ACQUIRE)) {
+        dropped++;
+        return nullptr;
+    }
+    return lines[head];
+}
+
+bool Hc22000Writer::commit(size_t len) {
+    if (len == 0) {
+        skipped++;
+        return false;
+    }
+    uint32_t head = queueHead;
+    lengths[head] = len;
+    __atomic_store_n(&queueHead, (head + 1) & HC22000_QUEUE_MASK, __ATOMIC_RELEASE);
+    return true;
+}
+
+void Hc22000Writer::poll() {
+    uint32_t tail = queueTail;
+    if (!open || tail == __atomic_load_n(&queueHead, __ATOMIC_ACQUIRE)) return;
+    while (tail != __atomic_load_n(&queueHead, __ATOMIC_ACQUIRE)) {
+        if (file.write((const uint8_t*)lines[tail], lengths[tail]) != lengths[tail]) errors++;
+        tail = (tail + 1) & HC22000_QUEUE_MASK;
+        __atomic_store_n(&queueTail, tail, __ATOMIC_RELEASE);
+    }
+    // Lines are rare and each one is a result, so they go to the card now
+    file.flush();
+}
+
+void Hc22000Writer::end() {
+    if (!open) return;
+    poll();
+    open = false;
+    file.close();
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <Arduino.h>
+#include <SD.h>
+#include "eapol_tracker.h"
+
+// WPA*02*mic*ap*sta*essid*anonce*eapol*pair with a full size EAPOL frame
+#define HC22000_LINE_MAX (7 + 32 + 2 * 12 + 64 + 64 + EAPOL_FRAME_MAX * 2 + 2 + 8)
+
+// One hashcat 22000 line, newline terminated. Returns its length, 0 when the
+// session has nothing of that kind, the ESSID is unknown or out is too small.
+size_t formatPmkidLine(const EapolSession& s, const uint8_t* essid, uint8_t essidLen, char* out, size_t max);
+size_t formatHandshakeLine(const EapolSession& s, const uint8_t* essid, uint8_t essidLen, char* out, size_t max);
+
+#define HC22000_QUEUE_LINES 4 // Lines between two polls, power of two
+#define HC22000_QUEUE_MASK  (HC22000_QUEUE_LINES - 1)
+
+static_assert((HC22000_QUEUE_LINES & HC22000_QUEUE_MASK) == 0, "queue size must be a power of two");
+
+// Hashcat lines next to a capture. writePmkid() and writeHandshake() run in
+// the promiscuous callback and only format into a small ring of lines;
+// poll() on the loop writes them out, so the WiFi task never waits for the
+// card. begin() opens the file. Nothing here allocates after begin().
+class Hc22000Writer {
+public:
+    bool begin(const String& path);
+    void end();                       // Writes what is queued, then closes
+
+    bool writePmkid(const EapolSession& s, const uint8_t* essid, uint8_t essidLen);
+    bool writeHandshake(const EapolSession& s, const uint8_t* essid, uint8_t essidLen);
+    void poll();
+
+    uint32_t getPmkids() { return pmkids; }
+    uint32_t getHandshakes() { return handshakes; }
+    uint32_t getSkipped() { return skipped; } // Hidden ESSID or M2 too long
+    uint32_t getDropped() { return dropped; } // Queue full
+    uint32_t getErrors() { return errors; }
+
+private:
+    File file;
+    volatile bool open = false;
+    char lines[HC22000_QUEUE_LINES][HC22000_LINE_MAX];
+    uint16_t lengths[HC22000_QUEUE_LINES];
+    volatile uint32_t queueHead = 0; // Written by the callback
+    volatile uint32_t queueTail = 0; // Written by poll()
+    uint32_t pmkids = 0;
+    uint32_t handshakes = 0;
+    uint32_t skipped = 0;
+    uint32_t dropped = 0;
+    uint32_t errors = 0;
+
+    char* reserve();
+    bool commit(size_t len);
+};
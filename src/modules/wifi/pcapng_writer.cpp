@@ -0,0 +1,227 @@
+#include "pcapng_writer.h"
+#include "phy_rate.h"
+
+#define BLOCK_SHB 0x0A0D0D0A
+#define BLOCK_IDB 0x00000001
+#define BLOCK_EPB 0x00000006
+#define EPB_OVERHEAD 32 // Block header, interface, timestamp, lengths and trailer
+
+static_assert(PCAPNG_BLOCK >= EPB_OVERHEAD + PCAPNG_SNAPLEN + 3, "a block must hold the longest packet");
+
+static void put16(uint8_t* p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = v >> (8 * i);
+}
+
+static size_t pad4(size_t n) {
+    return (n + 3) & ~(size_t)3;
+}
+
+// Option with its value padded to 4 bytes
+static size_t putOption(uint8_t* p, uint16_t code, const void* value, uint16_t len) {
+    put16(p, code);
+    put16(p + 2, len);
+    memcpy(p + 4, value, len);
+    memset(p + 4 + len, 0, pad4(len) - len);
+    return 4 + pad4(len);
+}
+
+static size_t optionSize(const char* text) {
+    return 4 + pad4(strlen(text));
+}
+
+size_t encodeSectionHeader(uint8_t* out, size_t max, const char* comment) {
+    static const char hardware[] = "ESP32-S3";
+    static const char application[] = "ESP-Chain";
+    size_t total = 28 + optionSize(comment) + optionSize(hardware) + optionSize(application) + 4;
+    if (max < total) return 0;
+    put32(out, BLOCK_SHB);
+    put32(out + 4, total);
+    put32(out + 8, 0x1A2B3C4D);   // Byte order magic
+    put16(out + 12, 1);           // Version 1.0
+    put16(out + 14, 0);
+    memset(out + 16, 0xFF, 8);    // Section length unknown
+    size_t p = 24;
+    p += putOption(out + p, 1, comment, strlen(comment));          // opt_comment
+    p += putOption(out + p, 2, hardware, strlen(hardware));        // shb_hardware
+    p += putOption(out + p, 4, application, strlen(application));  // shb_userappl
+    put32(out + p, 0);                                             // opt_endofopt
+    put32(out + p + 4, total);
+    return total;
+}
+
+size_t encodeInterfaceDescription(uint8_t* out, size_t max, const char* name) {
+    const uint8_t resolution = 6; // Microseconds
+    size_t total = 16 + optionSize(name) + 8 + 4 + 4;
+    if (max < total) return 0;
+    put32(out, BLOCK_IDB);
+    put32(out + 4, total);
+    put16(out + 8, LINKTYPE_IEEE802_11_RADIOTAP);
+    put16(out + 10, 0);
+    put32(out + 12, PCAPNG_SNAPLEN);
+    size_t p = 16;
+    p += putOption(out + p, 2, name, strlen(name));                // if_name
+    p += putOption(out + p, 9, &resolution, 1);                    // if_tsresol
+    put32(out + p, 0);
+    put32(out + p + 4, total);
+    return total;
+}
+
+size_t encodeRadiotap(uint8_t* out, const wifi_pkt_rx_ctrl_t& rx) {
+    bool ht = rx.sig_mode != 0;
+    uint8_t rate = ht ? 0 : phyRateUnits(rx.rate);
+    uint8_t channel = rx.channel;
+    memset(out, 0, PCAPNG_RADIOTAP_MAX);
+
+    // Fields in bit order, each aligned to its own size
+    uint32_t present = 1 << 0 | 1 << 1 | 1 << 3 | 1 << 5 | 1 << 6;
+    size_t p = 8;
+    uint32_t tsft = rx.timestamp;
+    put32(out + p, tsft);                                          // TSFT, MAC clock in us
+    p += 8;
+    out[p++] = 0x10 | (!ht && rx.rate >= 5 && rx.rate < 8 ? 0x02 : 0x00); // Flags: FCS at the end, short preamble
+    if (rate) {
+        present |= 1 << 2;
+        out[p++] = rate;
+    }
+    p = (p + 1) & ~(size_t)1;
+    put16(out + p, channel == 14 ? 2484 : 2407 + 5 * channel);
+    put16(out + p + 2, 0x0080 | (!ht && rx.rate < 8 ? 0x0020 : 0x0040)); // 2GHz, CCK or OFDM
+    p += 4;
+    out[p++] = (uint8_t)(int8_t)rx.rssi;                           // dBm signal
+    out[p++] = (uint8_t)(int8_t)rx.noise_floor;                    // dBm noise
+    if (ht) {
+        present |= 1 << 19;
+        out[p++] = 0x07;                                           // Bandwidth, MCS and GI known
+        out[p++] = (rx.cwb ? 0x01 : 0x00) | (rx.sgi ? 0x04 : 0x00);
+        out[p++] = rx.mcs;
+    }
+    put16(out + 2, p);
+    put32(out + 4, present);
+    return p;
+}
+
+static uint16_t capturedLength(uint16_t len, size_t radiotap) {
+    return len + radiotap > PCAPNG_SNAPLEN ? PCAPNG_SNAPLEN - radiotap : len;
+}
+
+size_t enhancedPacketSize(const wifi_pkt_rx_ctrl_t& rx, uint16_t len) {
+    size_t radiotap = 8 + 8 + 1 + 1 + 4 + 2 + (rx.sig_mode ? 3 : 0); // Rate and its alignment pad share a byte
+    return EPB_OVERHEAD + pad4(radiotap + capturedLength(len, radiotap));
+}
+
+size_t encodeEnhancedPacket(uint8_t* out, size_t max, uint64_t timestampUs, const wifi_pkt_rx_ctrl_t& rx,
+                            const uint8_t* frame, uint16_t len) {
+    size_t total = enhancedPacketSize(rx, len);
+    if (max < total) return 0;
+    size_t radiotap = encodeRadiotap(out + 28, rx);
+    uint16_t captured = capturedLength(len, radiotap);
+    put32(out, BLOCK_EPB);
+    put32(out + 4, total);
+    put32(out + 8, 0);                                             // Interface 0
+    put32(out + 12, timestampUs >> 32);
+    put32(out + 16, (uint32_t)timestampUs);
+    put32(out + 20, radiotap + captured);
+    put32(out + 24, radiotap + len);
+    memcpy(out + 28 + radiotap, frame, captured);
+    memset(out + 28 + radiotap + captured, 0, total - EPB_OVERHEAD - radiotap - captured);
+    put32(out + total - 4, total);
+    return total;
+}
+
+bool PcapngWriter::begin(const String& filePath, uint64_t epochUs) {
+    end();
+    file = SD.open(filePath, FILE_WRITE);
+    if (!file) {
+        Serial.println("Capture: failed to open " + filePath);
+        return false;
+    }
+    path = filePath;
+
+    uint8_t header[192];
+    size_t n = encodeSectionHeader(header, sizeof(header), epochUs ? "Timestamps from the RTC" : "Timestamps since boot, no RTC");
+    n += encodeInterfaceDescription(header + n, sizeof(header) - n, "esp32-wifi");
+    if (file.write(header, n) != n) errors++;
+    file.flush();
+
+    lastMicros = micros();
+    clockUs = epochUs ? epochUs : lastMicros;
+    used[0] = used[1] = 0;
+    active = 0;
+    pending = false;
+    packets = dropped = writes = errors = 0;
+    open = true;
+    return true;
+}
+
+void PcapngWriter::swap() {
+    pending = true;
+    active ^= 1;
+    used[active] = 0;
+}
+
+bool PcapngWriter::append(const wifi_pkt_rx_ctrl_t& rx, const uint8_t* frame, uint16_t len) {
+    if (!open) return false;
+    size_t need = enhancedPacketSize(rx, len);
+
+    portENTER_CRITICAL(&lock);
+    uint32_t now = micros();
+    clockUs += (uint32_t)(now - lastMicros);
+    lastMicros = now;
+    if (used[active] + need > PCAPNG_BLOCK) {
+        if (pending) {
+            dropped++;
+            portEXIT_CRITICAL(&lock);
+            return false;
+        }
+        swap();
+    }
+    if (used[active] == 0) oldestMs = millis();
+    uint8_t* block = blocks[active];
+    used[active] += encodeEnhancedPacket(block + used[active], PCAPNG_BLOCK - used[active], clockUs, rx, frame, len);
+    packets++;
+    portEXIT_CRITICAL(&lock);
+    return true;
+}
+
+void PcapngWriter::poll() {
+    if (!open) return;
+    if (!pending) {
+        portENTER_CRITICAL(&lock);
+        uint32_t now = micros(); // Keeps the clock going through quiet spells longer than micros() wraps
+        clockUs += (uint32_t)(now - lastMicros);
+        lastMicros = now;
+        if (used[active] > 0 && millis() - oldestMs >= PCAPNG_FLUSH_MS) swap();
+        portEXIT_CRITICAL(&lock);
+    }
+    // append() leaves the pending block and the active index alone until this clears
+    if (pending) {
+        writeBlock(active ^ 1);
+        pending = false;
+    }
+}
+
+void PcapngWriter::writeBlock(uint8_t index) {
+    size_t n = used[index];
+    if (n == 0) return;
+    if (file.write(blocks[index], n) != n) {
+        Serial.println("Capture: SD write failed");
+        errors++;
+    }
+    file.flush();
+    writes++;
+}
+
+// Call once the callback no longer hands frames to append()
+void PcapngWriter::end() {
+    if (!open) return;
+    open = false;
+    if (pending) writeBlock(active ^ 1);
+    writeBlock(active);
+    pending = false;
+    file.close();
+}
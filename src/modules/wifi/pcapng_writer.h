@@ -0,0 +1,62 @@
+#pragma once
+#include <Arduino.h>
+#include <SD.h>
+#include <esp_wifi.h>
+
+#define PCAPNG_BLOCK        8192 // Bytes per SD write, two of them in RAM
+#define PCAPNG_FLUSH_MS     2000 // A quiet capture still reaches the card this often
+#define PCAPNG_SNAPLEN      2500 // Longest 802.11 frame the radio hands over
+#define PCAPNG_RADIOTAP_MAX 32
+#define LINKTYPE_IEEE802_11_RADIOTAP 127
+
+// Block encoders. Each returns the bytes written to out, 0 if max is too small.
+// Everything is little endian, as the section header declares.
+size_t encodeSectionHeader(uint8_t* out, size_t max, const char* comment);
+size_t encodeInterfaceDescription(uint8_t* out, size_t max, const char* name);
+// Radiotap header from rx_ctrl: TSFT, flags (FCS at end, short preamble), rate or MCS, channel, signal and noise
+size_t encodeRadiotap(uint8_t* out, const wifi_pkt_rx_ctrl_t& rx);
+// Enhanced packet block of a frame with its radiotap header, timestamp in microseconds
+size_t encodeEnhancedPacket(uint8_t* out, size_t max, uint64_t timestampUs, const wifi_pkt_rx_ctrl_t& rx,
+                            const uint8_t* frame, uint16_t len);
+size_t enhancedPacketSize(const wifi_pkt_rx_ctrl_t& rx, uint16_t len);
+
+// pcapng capture file with one radiotap interface. append() runs in the
+// promiscuous callback and only copies into the active block; poll() on the
+// loop writes full blocks, so the WiFi task never waits for the card. When
+// both blocks are full, packets are dropped and counted.
+class PcapngWriter {
+public:
+    // epochUs is the wall clock now, or 0 to stamp packets with time since boot
+    bool begin(const String& path, uint64_t epochUs);
+    void end();
+    bool isOpen() { return open; }
+
+    bool append(const wifi_pkt_rx_ctrl_t& rx, const uint8_t* frame, uint16_t len);
+    void poll();
+
+    const String& getPath() { return path; }
+    uint32_t getPackets() { return packets; }
+    uint32_t getDropped() { return dropped; }
+    uint32_t getWrites() { return writes; }
+    uint32_t getErrors() { return errors; }
+
+private:
+    File file;
+    String path;
+    volatile bool open = false;
+    uint8_t blocks[2][PCAPNG_BLOCK];
+    volatile size_t used[2] = {0, 0};
+    volatile uint8_t active = 0;     // Block append() fills
+    volatile bool pending = false;   // The other one is full and waits for poll()
+    uint32_t oldestMs = 0;           // First packet in the active block
+    uint64_t clockUs = 0;            // Wall clock of lastMicros
+    uint32_t lastMicros = 0;
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    uint32_t packets = 0;
+    uint32_t dropped = 0;
+    uint32_t writes = 0;
+    uint32_t errors = 0;
+
+    void swap();
+    void writeBlock(uint8_t index);
+};
@@ -0,0 +1,9 @@
+#pragma once
+#include <stdint.h>
+
+// Non-HT wifi_phy_rate_t codes (rx_ctrl.rate) in 500kbps units, as radiotap's
+// rate field has them, 0 for the unused code 4
+inline uint8_t phyRateUnits(uint8_t code) {
+    static const uint8_t units[16] = {2, 4, 11, 22, 0, 4, 11, 22, 96, 48, 24, 12, 108, 72, 36, 18};
+    return units[code & 0x0F];
+}
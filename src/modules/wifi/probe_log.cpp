@@ -0,0 +1,265 @@
+#include "probe_log.h"
+#include "table_util.h"
+
+static void putLe32(uint8_t* p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+bool InternTable::begin(uint32_t maxEntries, uint32_t arenaBytes) {
+    end();
+    // At most three quarters full, so misses stay a few probes long
+    uint32_t slotCount = 16;
+    while (slotCount < maxEntries + maxEntries / 3) slotCount <<= 1;
+    slots = (Slot*)allocLarge(slotCount * sizeof(Slot));
+    offsets = (uint32_t*)allocLarge(maxEntries * sizeof(uint32_t));
+    arena = (uint8_t*)allocLarge(arenaBytes);
+    if (!slots || !offsets || !arena) {
+        end();
+        return false;
+    }
+    mask = slotCount - 1;
+    capacity = maxEntries;
+    arenaSize = arenaBytes;
+    clear();
+    return true;
+}
+
+void InternTable::end() {
+    free(slots);
+    free(offsets);
+    free(arena);
+    slots = nullptr;
+    offsets = nullptr;
+    arena = nullptr;
+    mask = capacity = arenaSize = 0;
+    count = arenaUsed = dropped = 0;
+}
+
+void InternTable::clear() {
+    if (slots) memset(slots, 0xFF, (mask + 1) * sizeof(Slot));
+    count = arenaUsed = dropped = 0;
+}
+
+uint32_t InternTable::lookup(const uint8_t* key, uint8_t len, uint32_t hash, uint32_t& slot) {
+    uint32_t i = hash & mask;
+    while (slots[i].id != PROBE_NO_ID) {
+        if (slots[i].hash == hash) {
+            const uint8_t* stored = arena + offsets[slots[i].id];
+            if (stored[0] == len && memcmp(stored + 1, key, len) == 0) break;
+        }
+        i = (i + 1) & mask;
+    }
+    slot = i;
+    return slots[i].id;
+}
+
+uint32_t InternTable::find(const uint8_t* key, uint8_t len) {
+    if (!slots) return PROBE_NO_ID;
+    uint32_t slot;
+    return lookup(key, len, fnv1a(key, len), slot);
+}
+
+uint32_t InternTable::intern(const uint8_t* key, uint8_t len) {
+    if (!slots) return PROBE_NO_ID;
+    uint32_t hash = fnv1a(key, len);
+    uint32_t slot;
+    uint32_t id = lookup(key, len, hash, slot);
+    if (id != PROBE_NO_ID) return id;
+
+    if (count >= capacity || arenaUsed + 1 + len > arenaSize) {
+        dropped++;
+        return PROBE_NO_ID;
+    }
+    id = count++;
+    offsets[id] = arenaUsed;
+    arena[arenaUsed] = len;
+    memcpy(arena + arenaUsed + 1, key, len);
+    arenaUsed += 1 + len;
+    slots[slot].hash = hash;
+    slots[slot].id = id;
+    return id;
+}
+
+const uint8_t* InternTable::get(uint32_t id, uint8_t& len) {
+    if (id >= count) {
+        len = 0;
+        return nullptr;
+    }
+    const uint8_t* stored = arena + offsets[id];
+    len = stored[0];
+    return stored + 1;
+}
+
+bool parseProbeRequest(const uint8_t* frame, uint16_t len, ProbeSighting& out) {
+    if (len < 24 + 4 || frame[0] != 0x40) return false; // Management, probe request
+    uint16_t end = len - 4;                             // FCS
+    uint16_t pos = 24;
+    while (pos + 2 <= end) {
+        uint8_t id = frame[pos];
+        uint8_t elementLen = frame[pos + 1];
+        if (pos + 2 + elementLen > end) return false;
+        if (id == 0) {
+            if (elementLen > 32) return false;
+            memcpy(out.mac, frame + 10, 6);
+            out.ssidLen = elementLen;
+            memcpy(out.ssid, frame + pos + 2, elementLen);
+            return true;
+        }
+        pos += 2 + elementLen;
+    }
+    return false;
+}
+
+size_t encodeProbeCheckpoint(uint8_t* out, uint32_t timeMs, uint32_t ssids, uint32_t clients, uint32_t probes) {
+    out[0] = PROBE_TAG_CHECKPOINT;
+    putLe32(out + 1, timeMs);
+    putLe32(out + 5, ssids);
+    putLe32(out + 9, clients);
+    putLe32(out + 13, probes);
+    return PROBE_CHECKPOINT_LEN;
+}
+
+size_t encodeProbeSsid(uint8_t* out, uint32_t id, const uint8_t* ssid, uint8_t len) {
+    out[0] = PROBE_TAG_SSID;
+    putLe32(out + 1, id);
+    out[5] = len;
+    memcpy(out + 6, ssid, len);
+    return 6 + len;
+}
+
+size_t encodeProbeRecord(uint8_t* out, const ProbeSighting& probe, uint32_t ssidId) {
+    out[0] = PROBE_TAG_PROBE;
+    putLe32(out + 1, probe.timeMs);
+    putLe32(out + 5, ssidId);
+    memcpy(out + 9, probe.mac, 6);
+    out[15] = (uint8_t)probe.rssi;
+    out[16] = probe.channel;
+    return PROBE_RECORD_LEN;
+}
+
+bool ProbeLogWriter::begin(const String& filePath) {
+    if (open) return true;
+    if (!SD.exists(PROBE_DIR)) SD.mkdir(PROBE_DIR);
+    file = SD.open(filePath, FILE_WRITE);
+    if (!file) {
+        Serial.println("Probes: failed to open " + filePath);
+        return false;
+    }
+    file.write((const uint8_t*)PROBE_MAGIC, 8);
+    path = filePath;
+    open = true;
+    bufferLen = 0;
+    nextSsid = 0;
+    bytes = 8;
+    writes = errors = 0;
+    return true;
+}
+
+// Room for len more bytes, a new block starting with its checkpoint
+bool ProbeLogWriter::reserve(ProbeHarvester& harvester, size_t len) {
+    if (bufferLen + len > sizeof(buffer)) flush();
+    if (bufferLen == 0) {
+        bufferLen = encodeProbeCheckpoint(buffer, millis(), harvester.getSsids().getCount(), harvester.getClients(),
+                                          harvester.getProbes());
+        oldestMs = millis();
+    }
+    return bufferLen + len <= sizeof(buffer);
+}
+
+bool ProbeLogWriter::append(ProbeHarvester& harvester, const ProbeSighting& probe, uint32_t ssidId) {
+    if (!open) return false;
+    InternTable& ssids = harvester.getSsids();
+    while (nextSsid <= ssidId && nextSsid < ssids.getCount()) {
+        uint8_t len;
+        const uint8_t* ssid = ssids.get(nextSsid, len);
+        if (!reserve(harvester, 6 + len)) return false;
+        bufferLen += encodeProbeSsid(buffer + bufferLen, nextSsid, ssid, len);
+        nextSsid++;
+    }
+    if (!reserve(harvester, PROBE_RECORD_LEN)) return false;
+    bufferLen += encodeProbeRecord(buffer + bufferLen, probe, ssidId);
+    return true;
+}
+
+void ProbeLogWriter::poll() {
+    if (open && bufferLen > 0 && millis() - oldestMs >= PROBE_FLUSH_MS) flush();
+}
+
+void ProbeLogWriter::flush() {
+    if (!open || bufferLen == 0) return;
+    if (file.write(buffer, bufferLen) != bufferLen) {
+        Serial.println("Probes: SD write failed");
+        errors++;
+    }
+    file.flush();
+    bytes += bufferLen;
+    writes++;
+    bufferLen = 0;
+}
+
+void ProbeLogWriter::end() {
+    if (!open) return;
+    flush();
+    file.close();
+    open = false;
+}
+
+bool ProbeHarvester::begin(uint32_t maxSsids, uint32_t maxClients) {
+    end();
+    bool ok = ssids.begin(maxSsids, maxSsids * (PROBE_ARENA_BYTES / PROBE_MAX_SSIDS)) &&
+              clients.begin(maxClients, maxClients * 7);
+    if (!ok) {
+        end();
+        Serial.println("Probes: no memory for " + String(maxSsids) + " SSIDs");
+        return false;
+    }
+    static const uint8_t none = 0;
+    ssids.intern(&none, 0); // Wildcard probes are always id 0
+    return true;
+}
+
+void ProbeHarvester::end() {
+    ssids.end();
+    clients.end();
+    head = tail = dropped = 0;
+    probes = wildcard = 0;
+    last = {};
+}
+
+bool ProbeHarvester::push(const wifi_pkt_rx_ctrl_t& rx, const uint8_t* frame, uint32_t nowMs) {
+    uint32_t h = head;
+    if (h - tail >= PROBE_QUEUE) {
+        dropped++;
+        return false;
+    }
+    ProbeSighting& p = queue[h % PROBE_QUEUE];
+    if (!parseProbeRequest(frame, rx.sig_len, p)) return false;
+    p.timeMs = nowMs;
+    p.rssi = rx.rssi;
+    p.channel = rx.channel;
+    head = h + 1; // Publishes the filled entry
+    return true;
+}
+
+uint32_t ProbeHarvester::add(const ProbeSighting& probe, ProbeLogWriter* log) {
+    clients.intern(probe.mac, 6);
+    uint32_t id = ssids.intern(probe.ssid, probe.ssidLen);
+    probes++;
+    if (probe.ssidLen == 0) wildcard++;
+    last = probe;
+    if (log && id != PROBE_NO_ID) log->append(*this, probe, id);
+    return id;
+}
+
+uint32_t ProbeHarvester::drain(ProbeLogWriter* log) {
+    uint32_t n = 0;
+    while (tail != head) {
+        add(queue[tail % PROBE_QUEUE], log);
+        tail = tail + 1;
+        n++;
+    }
+    return n;
+}
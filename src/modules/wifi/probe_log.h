@@ -0,0 +1,150 @@
+#pragma once
+#include <Arduino.h>
+#include <SD.h>
+#include <esp_wifi.h>
+
+#define PROBE_MAX_SSIDS   8192   // Distinct SSIDs per session, PSRAM when there is some
+#define PROBE_ARENA_BYTES 131072 // SSID bytes, ~16 per SSID
+#define PROBE_MAX_CLIENTS 16384
+#define PROBE_MIN_SSIDS   1024   // Fallback when the big tables do not fit
+#define PROBE_MIN_CLIENTS 2048
+#define PROBE_NO_ID       0xFFFFFFFF
+#define PROBE_QUEUE       64     // Probes between the callback and the loop
+#define PROBE_HOP_MS      500
+#define PROBE_DIR         "/probes"
+#define PROBE_MAGIC       "ECPROBE1"
+#define PROBE_BLOCK       4096   // Bytes per SD write
+#define PROBE_FLUSH_MS    5000
+
+// Log records, little endian, each starting with its tag
+#define PROBE_TAG_CHECKPOINT 'K' // u32 uptime ms, u32 SSIDs, u32 clients, u32 probes: totals so far
+#define PROBE_TAG_SSID       'D' // u32 id, u8 length, SSID bytes: defined before the first probe using it
+#define PROBE_TAG_PROBE      'P' // u32 uptime ms, u32 SSID id, u8 mac[6], i8 rssi, u8 channel
+#define PROBE_CHECKPOINT_LEN 17
+#define PROBE_RECORD_LEN     17
+
+// Interns byte strings of up to 255 bytes as dense ids from 0. Open
+// addressing table of (hash, id) with linear probing; the bytes live once
+// in an arena, so a name seen a thousand times costs a probe and a compare
+// instead of a String per sighting. Ids are handed out in order and never
+// change, which is what lets the log define each SSID only once.
+class InternTable {
+public:
+    bool begin(uint32_t maxEntries, uint32_t arenaBytes);
+    void end();
+    ~InternTable() { end(); }
+    void clear();
+
+    // Id of key, added if new; PROBE_NO_ID when the table or the arena is full
+    uint32_t intern(const uint8_t* key, uint8_t len);
+    uint32_t find(const uint8_t* key, uint8_t len);
+    const uint8_t* get(uint32_t id, uint8_t& len);
+
+    uint32_t getCount() { return count; }
+    uint32_t getCapacity() { return capacity; }
+    uint32_t getArenaUsed() { return arenaUsed; }
+    uint32_t getDropped() { return dropped; }
+    uint32_t getMemory() { return !slots ? 0 : (mask + 1) * sizeof(Slot) + capacity * sizeof(uint32_t) + arenaSize; }
+
+private:
+    struct Slot {
+        uint32_t hash;
+        uint32_t id; // PROBE_NO_ID when empty
+    };
+    Slot* slots = nullptr;
+    uint32_t mask = 0;
+    uint32_t* offsets = nullptr; // Arena offset of each id: length byte, then the key
+    uint8_t* arena = nullptr;
+    uint32_t arenaSize = 0;
+    uint32_t arenaUsed = 0;
+    uint32_t capacity = 0;
+    uint32_t count = 0;
+    uint32_t dropped = 0;
+
+    uint32_t lookup(const uint8_t* key, uint8_t len, uint32_t hash, uint32_t& slot);
+};
+
+// One probe request as heard
+struct ProbeSighting {
+    uint32_t timeMs;
+    uint8_t mac[6];
+    int8_t rssi;
+    uint8_t channel;
+    uint8_t ssidLen; // 0 for a wildcard probe
+    uint8_t ssid[32];
+};
+
+// Source address and SSID element of a probe request, len as in sig_len (FCS included)
+bool parseProbeRequest(const uint8_t* frame, uint16_t len, ProbeSighting& out);
+
+// Record encoders, each returns the bytes written to out
+size_t encodeProbeCheckpoint(uint8_t* out, uint32_t timeMs, uint32_t ssids, uint32_t clients, uint32_t probes);
+size_t encodeProbeSsid(uint8_t* out, uint32_t id, const uint8_t* ssid, uint8_t len);
+size_t encodeProbeRecord(uint8_t* out, const ProbeSighting& probe, uint32_t ssidId);
+
+class ProbeHarvester;
+
+// Binary probe log. Every PROBE_BLOCK write starts with a checkpoint of
+// the totals, and SSIDs new to the dictionary are written once, ahead of
+// the first probe that refers to them, so the file can be read back up to
+// the last complete block however the session ended.
+class ProbeLogWriter {
+public:
+    bool begin(const String& path);
+    void end();
+    bool isOpen() { return open; }
+
+    bool append(ProbeHarvester& harvester, const ProbeSighting& probe, uint32_t ssidId);
+    void poll();   // Time based flush, call from the module loop
+    void flush();
+
+    const String& getPath() { return path; }
+    uint32_t getBytes() { return bytes; }
+    uint32_t getWrites() { return writes; }
+    uint32_t getErrors() { return errors; }
+
+private:
+    File file;
+    String path;
+    bool open = false;
+    uint8_t buffer[PROBE_BLOCK];
+    size_t bufferLen = 0;
+    uint32_t nextSsid = 0; // First id not defined in the file yet
+    uint32_t oldestMs = 0;
+    uint32_t bytes = 0;
+    uint32_t writes = 0;
+    uint32_t errors = 0;
+
+    bool reserve(ProbeHarvester& harvester, size_t len);
+};
+
+// Probe requests from the promiscuous callback. push() only parses and
+// queues; drain() on the loop interns clients and SSIDs and hands each
+// probe to the log, so the tables are never touched from two tasks.
+class ProbeHarvester {
+public:
+    bool begin(uint32_t maxSsids = PROBE_MAX_SSIDS, uint32_t maxClients = PROBE_MAX_CLIENTS);
+    void end();
+
+    bool push(const wifi_pkt_rx_ctrl_t& rx, const uint8_t* frame, uint32_t nowMs); // Callback side
+    uint32_t drain(ProbeLogWriter* log);                                         // Loop side
+    uint32_t add(const ProbeSighting& probe, ProbeLogWriter* log);              // One probe, returns its SSID id
+
+    InternTable& getSsids() { return ssids; }
+    uint32_t getClients() { return clients.getCount(); }
+    uint32_t getProbes() { return probes; }
+    uint32_t getWildcard() { return wildcard; }
+    uint32_t getDropped() { return dropped; } // Queue full
+    const ProbeSighting& getLast() { return last; }
+
+private:
+    InternTable ssids;
+    InternTable clients;
+    ProbeSighting queue[PROBE_QUEUE];
+    volatile uint32_t head = 0; // Written by push()
+    volatile uint32_t tail = 0; // Written by drain()
+    volatile uint32_t dropped = 0;
+    uint32_t probes = 0;
+    uint32_t wildcard = 0;
+    ProbeSighting last = {};
+};
@@ -0,0 +1,222 @@
+#include "scan_results.h"
+#include "table_util.h"
+#include <algorithm>
+
+static_assert(SCAN_RESULTS_MAX < 32768, "the index holds 16 bit slots at under half load");
+
+// Fold the FNV-1a hash so the high bits pick the slot too
+static uint16_t bssidHash(const uint8_t* bssid) {
+    uint32_t h = fnv1a(bssid, 6);
+    return h ^ h >> 16;
+}
+
+String apSsidString(const APInfo& ap) {
+    if (ap.ssidLen == 0) return "<HIDDEN>";
+    char ssid[33];
+    memcpy(ssid, ap.ssid, ap.ssidLen);
+    ssid[ap.ssidLen] = '\0';
+    return String(ssid);
+}
+
+String apBssidString(const APInfo& ap) {
+    char text[18];
+    const uint8_t* b = ap.bssid;
+    sprintf(text, "%02X:%02X:%02X:%02X:%02X:%02X", b[0], b[1], b[2], b[3], b[4], b[5]);
+    return String(text);
+}
+
+bool ScanResults::begin(uint16_t tableCapacity) {
+    if (entries && capacity == tableCapacity) return true;
+    end();
+    uint32_t indexSize = 16;
+    while (indexSize < 2u * tableCapacity) indexSize <<= 1;
+    entries = (APInfo*)allocLarge(tableCapacity * sizeof(APInfo));
+    state = (SlotState*)allocLarge(tableCapacity * sizeof(SlotState));
+    order = (uint16_t*)allocLarge(tableCapacity * sizeof(uint16_t));
+    index = (uint16_t*)allocLarge(indexSize * sizeof(uint16_t));
+    freeSlots = (uint16_t*)allocLarge(tableCapacity * sizeof(uint16_t));
+    deltas = (ScanDelta*)allocLarge(tableCapacity * sizeof(ScanDelta));
+    if (!entries || !state || !order || !index || !freeSlots || !deltas) {
+        Serial.println("WiFi: no memory for " + String(tableCapacity) + " scan results");
+        end();
+        return false;
+    }
+    capacity = tableCapacity;
+    indexMask = indexSize - 1;
+    clear();
+    return true;
+}
+
+void ScanResults::end() {
+    free(entries);
+    free(state);
+    free(order);
+    free(index);
+    free(freeSlots);
+    free(deltas);
+    entries = nullptr;
+    state = nullptr;
+    order = index = freeSlots = nullptr;
+    deltas = nullptr;
+    capacity = indexMask = 0;
+    count = highWater = freeCount = deltaCount = ordered = 0;
+}
+
+void ScanResults::clear() {
+    count = highWater = freeCount = deltaCount = ordered = 0;
+    membersChanged = false;
+    if (index) memset(index, 0xFF, (indexMask + 1) * sizeof(uint16_t));
+}
+
+uint16_t ScanResults::load(int16_t scanCount, bool showHidden, uint32_t nowMs) {
+    beginScan();
+    for (int16_t i = 0; i < scanCount; i++) {
+        // The driver's own record, WiFi.SSID() and BSSIDstr() would each build a String
+        const wifi_ap_record_t* r = (const wifi_ap_record_t*)WiFi.getScanInfoByIndex(i);
+        if (!r) continue;
+        uint8_t len = strnlen((const char*)r->ssid, 32);
+        if (len == 0 && !showHidden) continue;
+        update(r->bssid, r->ssid, len, r->rssi, r->primary, r->authmode, nowMs);
+    }
+    endScan();
+    return count;
+}
+
+void ScanResults::beginScan() {
+    scan++;
+    deltaCount = 0;
+}
+
+uint16_t ScanResults::find(const uint8_t* bssid) const {
+    if (!index) return SCAN_NO_SLOT;
+    for (uint16_t i = bssidHash(bssid) & indexMask; index[i] != SCAN_NO_SLOT; i = (i + 1) & indexMask) {
+        if (memcmp(entries[index[i]].bssid, bssid, 6) == 0) return index[i];
+    }
+    return SCAN_NO_SLOT;
+}
+
+void ScanResults::insertIndex(uint16_t slot) {
+    uint16_t i = bssidHash(entries[slot].bssid) & indexMask;
+    while (index[i] != SCAN_NO_SLOT) i = (i + 1) & indexMask;
+    index[i] = slot;
+}
+
+void ScanResults::addDelta(uint16_t slot, ScanChange change) {
+    deltas[deltaCount++] = {slot, change};
+    state[slot].changedScan = scan;
+}
+
+APInfo* ScanResults::update(const uint8_t* bssid, const uint8_t* ssid, uint8_t ssidLen, int8_t rssi,
+                            uint8_t channel, uint8_t encryption, uint32_t nowMs) {
+    uint16_t slot = find(bssid);
+    bool added = slot == SCAN_NO_SLOT;
+    if (added) {
+        if (freeCount > 0) {
+            slot = freeSlots[--freeCount];
+        } else if (highWater < capacity) {
+            slot = highWater++;
+        } else {
+            dropped++;
+            return nullptr;
+        }
+        APInfo& fresh = entries[slot];
+        memcpy(fresh.bssid, bssid, 6);
+        fresh.ssidLen = 0;
+        fresh.rssi = rssi;
+        fresh.firstSeenMs = nowMs;
+        state[slot] = {(int16_t)(rssi * 16), 0, 0, true};
+        insertIndex(slot);
+        addDelta(slot, SCAN_ADDED);
+        membersChanged = true;
+        count++;
+    }
+
+    APInfo* ap = &entries[slot];
+    SlotState& st = state[slot];
+    bool changed = ap->channel != channel || ap->encryption != encryption;
+    // A hidden SSID can show up later in a probe response, keep it once known
+    if (ssidLen > 0) {
+        uint8_t len = std::min<uint8_t>(ssidLen, sizeof(ap->ssid));
+        changed |= ap->ssidLen != len || memcmp(ap->ssid, ssid, len) != 0;
+        ap->ssidLen = len;
+        memcpy(ap->ssid, ssid, len);
+    }
+    st.rssiQ4 += (rssi * 16 - st.rssiQ4) / (1 << SCAN_RSSI_SHIFT);
+    int average = (st.rssiQ4 + (st.rssiQ4 < 0 ? -8 : 8)) / 16;
+    if (abs(average - ap->rssi) >= SCAN_RSSI_STEP) {
+        ap->rssi = average;
+        changed = true;
+    }
+    ap->channel = channel;
+    ap->encryption = encryption;
+    ap->lastScan = scan;
+    ap->lastSeenMs = nowMs;
+    st.misses = 0;
+    if (changed && !added && st.changedScan != scan) addDelta(slot, SCAN_CHANGED);
+    return ap;
+}
+
+// Counts a miss for everything the scan did not see and removes what has been gone too long
+void ScanResults::endScan() {
+    bool removed = false;
+    for (uint16_t slot = 0; slot < highWater; slot++) {
+        SlotState& st = state[slot];
+        if (!st.used || entries[slot].lastScan == scan) continue;
+        if (++st.misses < SCAN_MISSES_MAX) continue;
+        st.used = false;
+        freeSlots[freeCount++] = slot;
+        addDelta(slot, SCAN_REMOVED);
+        count--;
+        removed = true;
+    }
+    if (removed) rebuildIndex();
+    if (removed || membersChanged) rebuildOrder();
+    membersChanged = false;
+}
+
+void ScanResults::rebuildIndex() {
+    memset(index, 0xFF, (indexMask + 1) * sizeof(uint16_t));
+    for (uint16_t slot = 0; slot < highWater; slot++) {
+        if (state[slot].used) insertIndex(slot);
+    }
+}
+
+// The last order without the removed slots, then the new ones in the order they were found
+void ScanResults::rebuildOrder() {
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < ordered; i++) {
+        if (state[order[i]].used) order[n++] = order[i];
+    }
+    for (uint16_t i = 0; i < deltaCount; i++) {
+        if (deltas[i].change == SCAN_ADDED) order[n++] = deltas[i].slot;
+    }
+    ordered = n;
+}
+
+int16_t ScanResults::indexOf(const uint8_t* bssid) const {
+    uint16_t slot = find(bssid);
+    for (uint16_t i = 0; i < count && slot != SCAN_NO_SLOT; i++) {
+        if (order[i] == slot) return i;
+    }
+    return -1;
+}
+
+// Insertion sort: stable without the buffer std::stable_sort allocates, and
+// close to linear since the last order is nearly sorted already
+template <typename Before>
+static void sortOrder(uint16_t* order, uint16_t count, Before before) {
+    for (uint16_t i = 1; i < count; i++) {
+        uint16_t slot = order[i];
+        uint16_t j = i;
+        for (; j > 0 && before(slot, order[j - 1]); j--) order[j] = order[j - 1];
+        order[j] = slot;
+    }
+}
+
+void ScanResults::sortByRssi() {
+    sortOrder(order, count, [this](uint16_t a, uint16_t b) { return entries[a].rssi > entries[b].rssi; });
+}
+
+void ScanResults::sortByChannel() {
+    sortOrder(order, count, [this](uint16_t a, uint16_t b) { return entries[a].channel < entries[b].channel; });
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <Arduino.h>
+#include <WiFi.h>
+
+#define SCAN_RESULTS_MAX 256 // APs tracked across scans, ~18KB with the index, PSRAM when there is some
+#define SCAN_MISSES_MAX  3   // Scans in a row an AP may be missing from before it is removed
+#define SCAN_RSSI_SHIFT  2   // Smoothing: each scan moves the average a quarter of the way
+#define SCAN_RSSI_STEP   3   // dB the average must move before the shown RSSI follows
+#define SCAN_NO_SLOT     0xFFFF
+
+// One AP from the last scan. Plain bytes so updates and copies never touch
+// the heap; text is only made when a screen draws it.
+struct APInfo {
+    uint8_t bssid[6];
+    uint8_t ssidLen;      // 0 for a hidden network
+    char ssid[32];        // ssidLen bytes, not terminated
+    int8_t rssi;          // Smoothed, moves in SCAN_RSSI_STEP steps
+    uint8_t channel;
+    uint8_t encryption;   // wifi_auth_mode_t
+    uint8_t lastScan;     // Scan it was last seen in
+    uint32_t firstSeenMs;
+    uint32_t lastSeenMs;
+};
+static_assert(sizeof(APInfo) == 52, "APInfo grew");
+
+// SSID for display, "<HIDDEN>" when there is none
+String apSsidString(const APInfo& ap);
+// "AA:BB:CC:DD:EE:FF" like WiFi.BSSIDstr()
+String apBssidString(const APInfo& ap);
+
+enum ScanChange : uint8_t {
+    SCAN_ADDED,
+    SCAN_REMOVED,  // The slot keeps its data until the next scan
+    SCAN_CHANGED   // Shown RSSI, channel, encryption or a hidden SSID learned
+};
+
+struct ScanDelta {
+    uint16_t slot;
+    ScanChange change;
+};
+
+// Scan history in a fixed arena. Each finished scan is merged in: a BSSID
+// keeps its slot for as long as it is tracked, its RSSI is averaged over
+// scans, and it is only removed after SCAN_MISSES_MAX scans in a row
+// without it, so one weak scan does not empty the list. BSSIDs are found
+// through an open addressing index. The merge leaves a list of deltas,
+// and sorting permutes a list of slots, stably, starting from the last
+// order, so rows only move when their RSSI or channel really differ.
+class ScanResults {
+public:
+    bool begin(uint16_t capacity = SCAN_RESULTS_MAX); // Keeps the history when already allocated
+    void end();
+    ~ScanResults() { end(); }
+
+    // Merges the finished async scan of count APs. Returns how many are tracked.
+    uint16_t load(int16_t count, bool showHidden, uint32_t nowMs);
+
+    // Adds or updates one AP seen in the current scan, nullptr when full
+    APInfo* update(const uint8_t* bssid, const uint8_t* ssid, uint8_t ssidLen, int8_t rssi, uint8_t channel,
+                   uint8_t encryption, uint32_t nowMs);
+    void beginScan();
+    void endScan();
+    void clear();
+
+    void sortByRssi();
+    void sortByChannel();
+
+    // Sorted view
+    const APInfo& operator[](uint16_t i) const { return entries[order[i]]; }
+    uint16_t slotAt(uint16_t i) const { return order[i]; }
+    int16_t indexOf(const uint8_t* bssid) const; // Position in the sorted view, -1 if not tracked
+    uint16_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    uint32_t getDropped() const { return dropped; }
+
+    // What the last merge did
+    const APInfo& atSlot(uint16_t slot) const { return entries[slot]; }
+    bool changedInLastScan(uint16_t slot) const { return state[slot].changedScan == scan; }
+    uint16_t getDeltaCount() const { return deltaCount; }
+    const ScanDelta& getDelta(uint16_t i) const { return deltas[i]; }
+
+private:
+    struct SlotState {
+        int16_t rssiQ4;      // Average in 1/16 dB
+        uint8_t misses;
+        uint8_t changedScan; // Scan that added or changed it
+        bool used;
+    };
+    APInfo* entries = nullptr;
+    SlotState* state = nullptr;
+    uint16_t* order = nullptr;     // Used slots, sorted
+    uint16_t* index = nullptr;     // BSSID hash to slot, SCAN_NO_SLOT when empty
+    uint16_t* freeSlots = nullptr;
+    ScanDelta* deltas = nullptr;
+    uint16_t capacity = 0;
+    uint16_t indexMask = 0;
+    uint16_t count = 0;
+    uint16_t ordered = 0;          // Slots in order, count before this scan's adds and removes
+    uint16_t highWater = 0;        // Slots ever handed out, free ones below it are in freeSlots
+    uint16_t freeCount = 0;
+    uint16_t deltaCount = 0;
+    uint8_t scan = 0;
+    bool membersChanged = false;   // Adds or removes since the order was rebuilt
+    uint32_t dropped = 0;
+
+    uint16_t find(const uint8_t* bssid) const;
+    void insertIndex(uint16_t slot);
+    void rebuildIndex();
+    void rebuildOrder();
+    void addDelta(uint16_t slot, ScanChange change);
+};
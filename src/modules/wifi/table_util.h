@@ -0,0 +1,26 @@
+#pragma once
+#include <Arduino.h>
+#ifndef SIMULATOR
+#include <esp_heap_caps.h>
+#endif
+
+// Helpers the hash tables of the WiFi modules share
+
+#define FNV1A_SEED  2166136261u
+#define FNV1A_PRIME 16777619u
+
+// FNV-1a over len bytes. Vendor OUIs repeat, so every byte of a BSSID counts.
+// Pass the previous result as h to hash a key in parts.
+inline uint32_t fnv1a(const uint8_t* data, size_t len, uint32_t h = FNV1A_SEED) {
+    for (size_t i = 0; i < len; i++) h = (h ^ data[i]) * FNV1A_PRIME;
+    return h;
+}
+
+// PSRAM when the board has it, internal RAM otherwise. Release with free().
+inline void* allocLarge(size_t size) {
+#ifndef SIMULATOR
+    void* p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (p) return p;
+#endif
+    return malloc(size);
+}
@@ -0,0 +1,126 @@
+#include "wardrive.h"
+#include "table_util.h"
+
+static_assert((WARDRIVE_TABLE_SLOTS & (WARDRIVE_TABLE_SLOTS - 1)) == 0, "table size must be a power of two");
+static_assert(WARDRIVE_TABLE_SLOTS <= 65536, "dirty list holds 16 bit indexes");
+
+bool BssidTable::begin(uint32_t tableSlots) {
+    end();
+    entries = (ApSighting*)allocLarge(tableSlots * sizeof(ApSighting));
+    dirty = (uint16_t*)allocLarge(tableSlots * sizeof(uint16_t));
+    if (!entries || !dirty) {
+        Serial.println("Wardrive: no memory for " + String(tableSlots) + " APs");
+        end();
+        return false;
+    }
+    slots = tableSlots;
+    mask = slots - 1;
+    clear();
+    dropped = evicted = 0;
+    return true;
+}
+
+void BssidTable::end() {
+    free(entries);
+    free(dirty);
+    entries = nullptr;
+    dirty = nullptr;
+    slots = 0;
+    count = dirtyCount = 0;
+}
+
+void BssidTable::clear() {
+    for (uint32_t i = 0; i < slots; i++) entries[i].flags = 0;
+    count = 0;
+    dirtyCount = 0;
+}
+
+// The low bytes alone would cluster, hash all 6
+uint32_t BssidTable::home(const uint8_t* bssid) {
+    return fnv1a(bssid, 6) & mask;
+}
+
+SightingResult BssidTable::observe(const uint8_t* bssid, const char* ssid, uint8_t ssidLen, uint8_t authMode,
+                                   uint8_t channel, int8_t rssi, const GeoFix& fix) {
+    uint32_t i = home(bssid);
+    while (entries[i].flags & AP_FLAG_USED) {
+        ApSighting& e = entries[i];
+        if (memcmp(e.bssid, bssid, 6) == 0) {
+            e.lastSeenMs = fix.timestampMs;
+            if (rssi <= e.rssi) return SIGHTING_SEEN;
+            e.rssi = rssi;
+            e.channel = channel;
+            e.fix = fix;
+            if (!(e.flags & AP_FLAG_DIRTY)) {
+                e.flags |= AP_FLAG_DIRTY;
+                dirty[dirtyCount++] = i;
+            }
+            return SIGHTING_STRONGER;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // Keep an eighth of the slots free so probes stay short until the next eviction
+    if (count >= slots - slots / 8) {
+        dropped++;
+        return SIGHTING_DROPPED;
+    }
+    ApSighting& e = entries[i];
+    memcpy(e.bssid, bssid, 6);
+    e.ssidLen = std::min<uint8_t>(ssidLen, 32);
+    memcpy(e.ssid, ssid, e.ssidLen);
+    e.ssid[e.ssidLen] = '\0';
+    e.authMode = authMode;
+    e.channel = channel;
+    e.rssi = rssi;
+    e.flags = AP_FLAG_USED | AP_FLAG_DIRTY;
+    e.firstSeen = fix.unixTime;
+    e.lastSeenMs = fix.timestampMs;
+    e.fix = fix;
+    dirty[dirtyCount++] = i;
+    count++;
+    return SIGHTING_NEW;
+}
+
+const ApSighting* BssidTable::find(const uint8_t* bssid) {
+    uint32_t i = home(bssid);
+    while (entries[i].flags & AP_FLAG_USED) {
+        if (memcmp(entries[i].bssid, bssid, 6) == 0) return &entries[i];
+        i = (i + 1) & mask;
+    }
+    return nullptr;
+}
+
+uint32_t BssidTable::evict(uint32_t nowMs) {
+    if (dirtyCount > 0 || !needsEvict()) return 0;
+    uint32_t before = count;
+
+    for (uint32_t i = 0; i < slots; i++) {
+        if ((entries[i].flags & AP_FLAG_USED) && nowMs - entries[i].lastSeenMs > WARDRIVE_EVICT_AGE_MS) {
+            entries[i].flags = 0;
+            count--;
+        }
+    }
+    if (needsEvict()) {
+        clear(); // Everything was seen recently, start over rather than thrash
+    } else {
+        // Close the holes so probes do not stop early. Starting just past an empty
+        // slot means every entry's probe path has been rebuilt before it moves.
+        uint32_t start = 0;
+        while (entries[start].flags & AP_FLAG_USED) start++;
+        for (uint32_t k = 1; k <= slots; k++) {
+            uint32_t i = (start + k) & mask;
+            if (entries[i].flags & AP_FLAG_USED) reinsert(i);
+        }
+    }
+    evicted += before - count;
+    return before - count;
+}
+
+void BssidTable::reinsert(uint32_t index) {
+    ApSighting e = entries[index];
+    entries[index].flags = 0;
+    uint32_t i = home(e.bssid);
+    while (entries[i].flags & AP_FLAG_USED) i = (i + 1) & mask;
+    entries[i] = e;
+}
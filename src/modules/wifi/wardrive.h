@@ -0,0 +1,88 @@
+#pragma once
+#include <Arduino.h>
+#include "../gps/gps_reader.h"
+
+#ifndef WARDRIVE_TABLE_SLOTS
+#define WARDRIVE_TABLE_SLOTS 4096 // Power of two, ~300KB, PSRAM when there is some
+#endif
+#define WARDRIVE_MIN_SLOTS    512  // Fallback when the big table does not fit
+#define WARDRIVE_MAX_LOAD     75   // Percent of slots before written entries are evicted
+#define WARDRIVE_EVICT_AGE_MS 120000 // Written entries not seen for this long go first
+
+#define AP_FLAG_USED  0x01
+#define AP_FLAG_DIRTY 0x02 // New or stronger since the last flush
+
+// One BSSID with the strongest sighting so far and where it was
+struct ApSighting {
+    uint8_t bssid[6];
+    uint8_t ssidLen;
+    char ssid[33];        // Null terminated, ssidLen bytes
+    uint8_t authMode;     // wifi_auth_mode_t
+    uint8_t channel;
+    int8_t rssi;
+    uint8_t flags;
+    uint32_t firstSeen;   // UTC, from the GPS
+    uint32_t lastSeenMs;  // millis()
+    GeoFix fix;           // Where rssi was measured
+};
+
+enum SightingResult : uint8_t {
+    SIGHTING_NEW,
+    SIGHTING_STRONGER,
+    SIGHTING_SEEN,      // Nothing to write
+    SIGHTING_DROPPED    // Table full of unwritten entries
+};
+
+// Open addressing table keyed by BSSID with linear probing. A survey sees
+// the same APs over and over while driving past, so most sightings are a
+// probe and a compare; only new or stronger ones are marked dirty and
+// queued for the CSV writer, which then writes each of them once per flush
+// however often it was seen in between.
+class BssidTable {
+public:
+    bool begin(uint32_t slots = WARDRIVE_TABLE_SLOTS);
+    void end();
+    ~BssidTable() { end(); }
+    void clear();
+
+    SightingResult observe(const uint8_t* bssid, const char* ssid, uint8_t ssidLen, uint8_t authMode,
+                           uint8_t channel, int8_t rssi, const GeoFix& fix);
+    const ApSighting* find(const uint8_t* bssid);
+
+    // Hands every dirty entry to fn and marks it written
+    template <typename F>
+    uint32_t drainDirty(F fn) {
+        for (uint32_t i = 0; i < dirtyCount; i++) {
+            ApSighting& e = entries[dirty[i]];
+            e.flags &= ~AP_FLAG_DIRTY;
+            fn(e);
+        }
+        uint32_t n = dirtyCount;
+        dirtyCount = 0;
+        return n;
+    }
+
+    // Frees slots held by written entries once the table is past WARDRIVE_MAX_LOAD
+    // percent. Only valid with nothing dirty, i.e. right after drainDirty().
+    uint32_t evict(uint32_t nowMs);
+
+    bool needsEvict() { return count * 100 >= slots * WARDRIVE_MAX_LOAD; }
+    uint32_t getCount() { return count; }
+    uint32_t getDirtyCount() { return dirtyCount; }
+    uint32_t getSlots() { return slots; }
+    uint32_t getDropped() { return dropped; }
+    uint32_t getEvicted() { return evicted; }
+
+private:
+    ApSighting* entries = nullptr;
+    uint16_t* dirty = nullptr; // Indexes into entries, in the order they became dirty
+    uint32_t slots = 0;
+    uint32_t mask = 0;
+    uint32_t count = 0;
+    uint32_t dirtyCount = 0;
+    uint32_t dropped = 0;
+    uint32_t evicted = 0;
+
+    uint32_t home(const uint8_t* bssid);
+    void reinsert(uint32_t index);
+};
@@ -0,0 +1,82 @@
+#include "wifi_module.h"
+#include "sd_manager.h"
+
+#define AIRTIME_CHART_TOP    68
+#define AIRTIME_CHART_HEIGHT 70
+
+// Every frame type and subtype, the analyzer counts what it can't decode too
+static const FrameNeeds airtimeFrames = {{FRAME_ALL_SUBTYPES, FRAME_ALL_SUBTYPES, FRAME_ALL_SUBTYPES}};
+
+void WiFiModule::startAirtime() {
+    extern SDManager sdManager;
+    isScanning = false; // Hopping channels would spoil the scan
+    WiFi.scanDelete();
+
+    airtime.clear();
+    if (sdManager.isMounted()) airtimeCsv.begin(String(AIRTIME_DIR) + "/airtime_" + String(millis()) + ".csv");
+    airtimeHold = false;
+    airtimeChannel = 1;
+    esp_wifi_set_channel(airtimeChannel, WIFI_SECOND_CHAN_NONE);
+    airtimeHopMs = millis();
+    airtime.enter(airtimeChannel, airtimeHopMs);
+    isAnalyzingAirtime = true;
+
+    frameFilter.set(FRAME_AIRTIME, airtimeFrames);
+    applyFrameFilter();
+}
+
+void WiFiModule::stopAirtime() {
+    if (!isAnalyzingAirtime) return;
+    isAnalyzingAirtime = false;
+    frameFilter.clear(FRAME_AIRTIME);
+    applyFrameFilter();
+    AirtimeSample sample;
+    if (airtime.leave(millis(), sample)) airtimeCsv.append(sample);
+    airtimeCsv.end();
+    Serial.println("Airtime: " + String(airtime.getVisits()) + " visits, " + String(airtime.getFrames()) + " frames, " +
+                   String(airtimeCsv.getRows()) + " rows in " + String(airtimeCsv.getWrites()) + " writes");
+}
+
+// Ends the visit every dwell, so held channels still give a time series
+void WiFiModule::airtimeLoop() {
+    uint32_t now = millis();
+    if (now - airtimeHopMs >= AIRTIME_DWELL_MS) {
+        AirtimeSample sample;
+        if (airtime.leave(now, sample)) airtimeCsv.append(sample);
+        if (!airtimeHold) {
+            airtimeChannel = airtimeChannel % AIRTIME_CHANNELS + 1;
+            esp_wifi_set_channel(airtimeChannel, WIFI_SECOND_CHAN_NONE);
+        }
+        airtime.enter(airtimeChannel, now);
+        airtimeHopMs = now;
+    }
+    airtimeCsv.poll();
+}
+
+void WiFiModule::drawAirtime(DisplayManager* display) {
+    TFT_eSPI* tft = display->getTFT();
+    tft->fillRect(0, 45, 320, 105, THEME_BG); // Keeps the file name at the bottom
+
+    uint16_t busy = airtime.getUtilization(airtimeChannel);
+    uint32_t frames = airtime.getFrames();
+    tft->setTextDatum(TL_DATUM);
+    tft->setTextColor(THEME_TEXT, THEME_BG);
+    tft->drawString(String(airtimeHold ? "Holding ch " : "Ch ") + String(airtimeChannel) + "  Busy " +
+                    String(busy / 10) + "." + String(busy % 10) + "%  Retry " +
+                    String(frames ? airtime.getRetries() * 100 / frames : 0) + "%  Frames " + String(frames),
+                    10, 50, 2);
+
+    // Last visit to each channel, full height is 100% busy
+    for (uint8_t ch = 1; ch <= AIRTIME_CHANNELS; ch++) {
+        int x = 4 + (ch - 1) * 24;
+        uint16_t permille = airtime.getUtilization(ch);
+        int h = permille * AIRTIME_CHART_HEIGHT / 1000;
+        uint16_t color = permille < 300 ? THEME_OK : permille < 600 ? THEME_WARN : THEME_ERROR;
+        tft->drawRect(x, AIRTIME_CHART_TOP, 20, AIRTIME_CHART_HEIGHT, THEME_TEXT);
+        if (h > 0) tft->fillRect(x + 1, AIRTIME_CHART_TOP + AIRTIME_CHART_HEIGHT - h, 18, h, color);
+        tft->setTextDatum(TC_DATUM);
+        tft->setTextColor(ch == airtimeChannel ? THEME_OK : THEME_TEXT, THEME_BG);
+        tft->drawString(String(ch), x + 10, AIRTIME_CHART_TOP + AIRTIME_CHART_HEIGHT + 3, 1);
+    }
+    tft->setTextColor(THEME_TEXT, THEME_BG);
+}
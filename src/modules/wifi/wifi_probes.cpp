@@ -0,0 +1,75 @@
+#include "wifi_module.h"
+#include "sd_manager.h"
+
+// Probe requests only, the driver passes all management frames and the table drops the rest
+static const FrameNeeds probeFrames = {{FRAME_SUBTYPE(0x4), 0, 0}};
+
+void WiFiModule::startProbes() {
+    extern SDManager sdManager;
+    isScanning = false; // Hopping channels would spoil the scan
+    WiFi.scanDelete();
+
+    if (!probes.begin() && !probes.begin(PROBE_MIN_SSIDS, PROBE_MIN_CLIENTS)) return;
+    if (sdManager.isMounted()) probeLog.begin(String(PROBE_DIR) + "/probes_" + String(millis()) + ".bin");
+    probeChannel = 1;
+    esp_wifi_set_channel(probeChannel, WIFI_SECOND_CHAN_NONE);
+    probeHopMs = millis();
+    isHarvestingProbes = true;
+
+    frameFilter.set(FRAME_PROBES, probeFrames);
+    applyFrameFilter();
+}
+
+void WiFiModule::stopProbes() {
+    if (!isHarvestingProbes) return;
+    isHarvestingProbes = false;
+    frameFilter.clear(FRAME_PROBES);
+    applyFrameFilter();
+    probes.drain(&probeLog);
+    probeLog.end();
+    InternTable& ssids = probes.getSsids();
+    Serial.println("Probes: " + String(probes.getProbes()) + " from " + String(probes.getClients()) + " clients, " +
+                   String(ssids.getCount()) + " SSIDs in " + String(ssids.getArenaUsed()) + " bytes, " +
+                   String(probes.getDropped()) + " dropped, " + String(probeLog.getBytes()) + " bytes logged");
+    probes.end();
+}
+
+// Clients probe on every channel they scan, but some only for the networks they know
+void WiFiModule::probesLoop() {
+    probes.drain(&probeLog);
+    probeLog.poll();
+    if (millis() - probeHopMs >= PROBE_HOP_MS) {
+        probeChannel = probeChannel % 13 + 1;
+        esp_wifi_set_channel(probeChannel, WIFI_SECOND_CHAN_NONE);
+        probeHopMs = millis();
+    }
+}
+
+void WiFiModule::drawProbes(DisplayManager* display) {
+    TFT_eSPI* tft = display->getTFT();
+    tft->fillRect(0, 45, 320, 105, THEME_BG); // Keeps the file name at the bottom
+    tft->setTextDatum(TL_DATUM);
+    tft->setTextColor(THEME_TEXT, THEME_BG);
+
+    InternTable& ssids = probes.getSsids();
+    tft->drawString("Clients: " + String(probes.getClients()) + "  SSIDs: " + String(ssids.getCount()), 10, 50, 2);
+    tft->drawString("Probes: " + String(probes.getProbes()) + "  Wildcard: " + String(probes.getWildcard()), 10, 70, 2);
+    tft->drawString("Dictionary: " + String(ssids.getArenaUsed() / 1024.0f, 1) + " KB  Ch " + String(probeChannel), 10,
+                    90, 2);
+
+    const ProbeSighting& last = probes.getLast();
+    if (probes.getProbes() > 0) {
+        char mac[18];
+        snprintf(mac, sizeof(mac), "%02X:%02X:%02X:%02X:%02X:%02X", last.mac[0], last.mac[1], last.mac[2], last.mac[3],
+                 last.mac[4], last.mac[5]);
+        char name[33];
+        memcpy(name, last.ssid, last.ssidLen);
+        name[last.ssidLen] = '\0';
+        String ssid = last.ssidLen ? String(name) : String("<any>");
+        if (ssid.length() > 16) ssid = ssid.substring(0, 16) + "..";
+        tft->drawString(String(mac) + " " + String(last.rssi), 10, 110, 2);
+        tft->setTextColor(THEME_OK, THEME_BG);
+        tft->drawString("> " + ssid, 10, 130, 2);
+        tft->setTextColor(THEME_TEXT, THEME_BG);
+    }
+}
@@ -2,13 +2,30 @@
 #include <algorithm>
 
 void WiFiModule::init() {
+    extern DisplayManager displayManager;
     currentState = MENU;
     menuIndex = 0;
-    selectedIndex = 0;
     settingsIndex = 0;
-    isScanning = false;
-    WiFi.mode(WIFI_STA);
-    WiFi.disconnect();
+    scanResults.begin(); // Keeps what earlier visits found
+    menuList.begin(&displayManager, [this](int index, ListRow& row) { row.text = menuItems[index]; });
+    menuList.reset(sizeof(menuItems) / sizeof(menuItems[0]));
+    resultList.begin(&displayManager, [this](int index, ListRow& row) {
+        const APInfo& ap = scanResults[index];
+        int screenRow = index - resultList.getOffset();
+        if (screenRow >= 0 && screenRow < LIST_ROWS) drawnSlots[screenRow] = scanResults.slotAt(index);
+        row.text = apSsidString(ap);
+        if (row.text.length() > 14) row.text = row.text.substring(0, 14) + "..";
+        row.text += " (" + String(ap.rssi) + ")";
+    });
+    resultList.reset(scanResults.size());
+    stationList.begin(&displayManager, [this](int index, ListRow& row) {
+        row.text = detectedStations[index];
+        if (row.text == selectedStation) row.text = "> " + row.text;
+    });
+    if (!isScanning) { // A scan left running in the background carries on
+        WiFi.mode(WIFI_STA);
+        WiFi.disconnect();
+    }
     esp_log_level_set("wifi", ESP_LOG_NONE);
 }
 
@@ -29,33 +46,107 @@ void WiFiModule::loop() {
         }
     }
 
-    if (isScanning) {
-        int n = WiFi.scanComplete();
-        if (n == -2) {
-            // Start scan
-            WiFi.scanNetworks(true, showHidden, false, scanTimePerChannel);
-        } else if (n >= 0) {
-            // Scan done, process results
-            scanResults.clear();
-            for (int i = 0; i < n; ++i) {
-                APInfo ap;
-                ap.ssid = WiFi.SSID(i);
-                if (ap.ssid.isEmpty() && !showHidden) continue; 
-                if (ap.ssid.isEmpty()) ap.ssid = "<HIDDEN>";
-                
-                ap.rssi = WiFi.RSSI(i);
-                ap.channel = WiFi.channel(i);
-                ap.bssid = WiFi.BSSIDstr(i);
-                ap.encryption = WiFi.encryptionType(i);
-                scanResults.push_back(ap);
+    if (isCapturing || isMultiCapture) {
+        // Block and line writes happen here, never in the callback
+        pcap.poll();
+        hashes.poll();
+    }
+
+    if (isMultiCapture) {
+        multiCaptureLoop();
+        if (currentState == MULTI_CAPTURE) {
+            static unsigned long lastCaptureDraw = 0;
+            if (millis() - lastCaptureDraw > 500) {
+                drawMultiCapture(&displayManager);
+                lastCaptureDraw = millis();
             }
-            sortResults();
-            WiFi.scanDelete();
-            
-            // Restart scan immediately
-            WiFi.scanNetworks(true, showHidden, false, scanTimePerChannel);
         }
     }
+
+    if (isAnalyzingAirtime) {
+        airtimeLoop();
+        if (currentState == AIRTIME) {
+            static unsigned long lastAirtimeDraw = 0;
+            if (millis() - lastAirtimeDraw > 500) {
+                drawAirtime(&displayManager);
+                lastAirtimeDraw = millis();
+            }
+        }
+    }
+
+    if (beacons.isRunning()) {
+        beacons.poll(); // Only sends when the TX task could not be started
+        if (currentState == BEACONS) {
+            static unsigned long lastBeaconDraw = 0;
+            if (millis() - lastBeaconDraw > 500) {
+                drawBeacons(&displayManager);
+                lastBeaconDraw = millis();
+            }
+        }
+    }
+
+    if (isHarvestingProbes) {
+        probesLoop();
+        if (currentState == PROBES) {
+            static unsigned long lastProbeDraw = 0;
+            if (millis() - lastProbeDraw > 500) {
+                drawProbes(&displayManager);
+                lastProbeDraw = millis();
+            }
+        }
+    }
+
+    if (isWardriving) {
+        wardriveLoop();
+        if (currentState == WARDRIVE) {
+            static unsigned long lastWardriveDraw = 0;
+            if (millis() - lastWardriveDraw > 500) {
+                drawWardrive(&displayManager);
+                lastWardriveDraw = millis();
+            }
+        }
+    }
+}
+
+// Scanning goes on from the menu loop while the module is closed, so the
+// history keeps growing until the user stops it
+void WiFiModule::backgroundLoop() {
+    if (isScanning && !isWardriving) scanLoop();
+}
+
+bool WiFiModule::isBackgroundRunning() {
+    return isScanning || beacons.isRunning();
+}
+
+void WiFiModule::scanLoop() {
+    extern DisplayManager displayManager;
+
+    int n = WiFi.scanComplete();
+    if (n == -2) {
+        // Start scan
+        WiFi.scanNetworks(true, showHidden, false, scanTimePerChannel);
+    } else if (n >= 0) {
+        // Scan done, merge it into the history and keep the cursor on its AP
+        scanResults.load(n, showHidden, millis());
+        sortResults();
+        int index = scanResults.indexOf(selectedBssid);
+        resultList.setCount(scanResults.size());
+        selectResult(index >= 0 ? index : resultList.getSelected());
+        if (currentState == RESULTS) {
+            // Rows showing an AP the merge changed are stale, the rest only if they moved
+            for (int i = 0; i < LIST_ROWS && resultList.getOffset() + i < (int)scanResults.size(); i++) {
+                uint16_t slot = scanResults.slotAt(resultList.getOffset() + i);
+                if (slot != drawnSlots[i] || scanResults.changedInLastScan(slot)) {
+                    resultList.invalidate(resultList.getOffset() + i);
+                }
+            }
+            drawResults(&displayManager, false);
+        }
+        WiFi.scanDelete();
+        
+        // Restart scan immediately
+        WiFi.scanNetworks(true, showHidden, false, scanTimePerChannel);
+    }
 }
 
 String WiFiModule::getName() {
@@ -76,21 +167,54 @@ void WiFiModule::drawMenu(DisplayManager* display) {
     display->clearContent();
 
     switch (currentState) {
-        case MENU:
+        case MENU: {
             display->drawMenuTitle("WiFi Menu");
-            display->drawMenuItem("Scanner", 0, menuIndex == 0);
-            display->drawMenuItem("Settings", 1, menuIndex == 1);
+            menuList.draw();
+            break;
+        }
+
+        case AIRTIME:
+            display->drawMenuTitle("Channel Usage");
+            drawAirtime(display);
+            display->getTFT()->setTextDatum(MC_DATUM);
+            display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
+            display->getTFT()->drawString(airtimeCsv.isOpen() ? airtimeCsv.getPath() : "Not logging: no SD card", 160, 160, 2);
+            break;
+
+        case PROBES:
+            display->drawMenuTitle("Probe Log");
+            drawProbes(display);
+            display->getTFT()->setTextDatum(MC_DATUM);
+            display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
+            display->getTFT()->drawString(probeLog.isOpen() ? probeLog.getPath() : "Not logging: no SD card", 160, 160, 2);
+            break;
+
+        case BEACONS:
+            display->drawMenuTitle("Beacon Flood");
+            drawBeacons(display);
+            display->getTFT()->setTextDatum(MC_DATUM);
+            display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
+            display->getTFT()->drawString("Click: rate  Select: channel", 160, 160, 2);
+            break;
+
+        case WARDRIVE:
+            display->drawMenuTitle("Wardriving");
+            drawWardrive(display);
+            display->getTFT()->setTextDatum(MC_DATUM);
+            display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
+            display->getTFT()->drawString(wigle.isOpen() ? wigle.getPath() : "Not logging: no SD card", 160, 160, 2);
             break;
 
         case SCANNER_MENU:
             display->drawMenuTitle("WiFi Scanner");
             display->drawMenuItem(isScanning ? "Stop Scan" : "Start Scan", 0, menuIndex == 0);
             display->drawMenuItem("View Results", 1, menuIndex == 1);
+            display->drawMenuItem("Capture All", 2, menuIndex == 2);
             
             // Show status
             if (isScanning) {
                 display->getTFT()->setTextDatum(MC_DATUM);
-                display->getTFT()->setTextColor(TFT_GREEN, THEME_BG);
+                display->getTFT()->setTextColor(THEME_OK, THEME_BG);
                 display->getTFT()->drawString("Scanning...", 160, 160, 2);
             }
             break;
@@ -122,29 +246,7 @@ void WiFiModule::drawMenu(DisplayManager* display) {
             break;
 
         case RESULTS:
-            if (scanResults.empty()) {
-                display->getTFT()->setTextDatum(MC_DATUM);
-                display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
-                display->getTFT()->drawString("No Networks Found", 160, 100, 2);
-                if (isScanning) {
-                    display->getTFT()->drawString("Scanning...", 160, 130, 2);
-                }
-            } else {
-                display->drawMenuTitle("Results (" + String(scanResults.size()) + ")");
-                // Show 5 items centered around selectedIndex
-                int start = 0;
-                if (selectedIndex > 2) start = selectedIndex - 2;
-                if (start + 5 > (int)scanResults.size()) start = scanResults.size() - 5;
-                if (start < 0) start = 0;
-
-                for (int i = 0; i < 5 && (start + i) < (int)scanResults.size(); i++) {
-                    int idx = start + i;
-                    String label = scanResults[idx].ssid;
-                    if (label.length() > 14) label = label.substring(0, 14) + "..";
-                    label += " (" + String(scanResults[idx].rssi) + ")";
-                    display->drawMenuItem(label, i, idx == selectedIndex);
-                }
-            }
+            drawResults(display, true);
             break;
 
         case DETAILS:
@@ -153,18 +255,18 @@ void WiFiModule::drawMenu(DisplayManager* display) {
             display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
             
             // Moved up by 10 pixels
-            display->getTFT()->drawString("SSID: " + selectedTarget.ssid, 10, 30, 2);
-            display->getTFT()->drawString("BSSID: " + selectedTarget.bssid, 10, 50, 2);
+            display->getTFT()->drawString("SSID: " + apSsidString(selectedTarget), 10, 30, 2);
+            display->getTFT()->drawString("BSSID: " + apBssidString(selectedTarget), 10, 50, 2);
             display->getTFT()->drawString("CH: " + String(selectedTarget.channel), 10, 70, 2);
             display->getTFT()->drawString("RSSI: " + String(selectedTarget.rssi), 10, 90, 2);
-            display->getTFT()->drawString("Enc: " + getEncryptionName(selectedTarget.encryption), 10, 110, 2);
+            display->getTFT()->drawString("Enc: " + getEncryptionName((wifi_auth_mode_t)selectedTarget.encryption), 10, 110, 2);
             
             display->getTFT()->setTextDatum(MC_DATUM);
             display->getTFT()->drawString("Double Click: Options", 160, 150, 2);
             break;
 
         case TARGET_OPTIONS:
-            display->drawMenuTitle(selectedTarget.ssid);
+            display->drawMenuTitle(apSsidString(selectedTarget));
             display->drawMenuItem("Deauth Attack", 0, menuIndex == 0); 
             display->drawMenuItem("Capture Handshake", 1, menuIndex == 1);
             display->drawMenuItem("Mixed Attack", 2, menuIndex == 2);
@@ -177,7 +279,7 @@ void WiFiModule::drawMenu(DisplayManager* display) {
             display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
             display->getTFT()->drawString("Found: " + String(detectedStations.size()), 160, 100, 4);
             display->getTFT()->drawString("Double Click to List", 160, 140, 2);
-            display->getTFT()->fillCircle(160, 180, 5, (millis() / 500) % 2 == 0 ? TFT_GREEN : TFT_BLACK);
+            display->getTFT()->fillCircle(160, 180, 5, (millis() / 500) % 2 == 0 ? THEME_OK : THEME_BG);
             break;
 
         case STATION_LIST:
@@ -187,17 +289,8 @@ void WiFiModule::drawMenu(DisplayManager* display) {
                 display->getTFT()->drawString("Go Back to Scan", 160, 100, 2);
             } else {
                 display->drawMenuTitle("Select Client (" + String(detectedStations.size()) + ")");
-                int start = 0;
-                if (stationListIndex > 2) start = stationListIndex - 2;
-                if (start + 5 > (int)detectedStations.size()) start = detectedStations.size() - 5;
-                if (start < 0) start = 0;
-
-                for (int i = 0; i < 5 && (start + i) < (int)detectedStations.size(); i++) {
-                    int idx = start + i;
-                    String label = detectedStations[idx];
-                    if (label == selectedStation) label = "> " + label;
-                    display->drawMenuItem(label, i, idx == stationListIndex);
-                }
+                stationList.setCount(detectedStations.size());
+                stationList.draw();
             }
             break;
 
@@ -212,6 +305,14 @@ void WiFiModule::drawMenu(DisplayManager* display) {
         case ATTACK_MIXED:
             drawTerminal(display);
             break;
+
+        case MULTI_CAPTURE:
+            display->drawMenuTitle("Capture All");
+            drawMultiCapture(display);
+            display->getTFT()->setTextDatum(MC_DATUM);
+            display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
+            display->getTFT()->drawString("Select: switch schedule", 160, 160, 2);
+            break;
     }
 }
 
@@ -223,8 +324,7 @@ bool WiFiModule::handleInput(uint8_t button) {
             case MENU:
                 return false; 
             case SCANNER_MENU:
-                currentState = MENU;
-                // Do NOT stop scanning here, user wants background scan
+                currentState = MENU; // A running scan carries on from backgroundLoop()
                 break;
             case SETTINGS:
                 currentState = MENU;
@@ -253,6 +353,10 @@ bool WiFiModule::handleInput(uint8_t button) {
                 stopMixedAttack();
                 currentState = TARGET_OPTIONS;
                 break;
+            case MULTI_CAPTURE:
+                stopMultiCapture();
+                currentState = SCANNER_MENU;
+                break;
             case STATION_SCAN:
                 stopStationScan();
                 currentState = TARGET_OPTIONS;
@@ -260,6 +364,22 @@ bool WiFiModule::handleInput(uint8_t button) {
             case STATION_LIST:
                 currentState = STATION_SCAN; // Back to scanning
                 break;
+            case WARDRIVE:
+                stopWardrive();
+                currentState = MENU;
+                break;
+            case AIRTIME:
+                stopAirtime();
+                currentState = MENU;
+                break;
+            case PROBES:
+                stopProbes();
+                currentState = MENU;
+                break;
+            case BEACONS:
+                stopBeacons();
+                currentState = MENU;
+                break;
             default:
                 currentState = MENU;
                 break;
@@ -271,10 +391,11 @@ bool WiFiModule::handleInput(uint8_t button) {
     if (button == 1) { // Scroll (Single Click)
         switch (currentState) {
             case MENU:
-                menuIndex = (menuIndex + 1) % 2; 
-                break;
+                menuList.next();
+                menuList.update();
+                return true;
             case SCANNER_MENU:
-                menuIndex = (menuIndex + 1) % 2;
+                menuIndex = (menuIndex + 1) % 3;
                 break;
             case SETTINGS:
                 settingsIndex = (settingsIndex + 1) % 3;
@@ -285,7 +406,9 @@ bool WiFiModule::handleInput(uint8_t button) {
                 break;
             case RESULTS:
                 if (!scanResults.empty()) {
-                    selectedIndex = (selectedIndex + 1) % scanResults.size();
+                    selectResult((resultList.getSelected() + 1) % scanResults.size());
+                    drawResults(&displayManager, false);
+                    return true;
                 }
                 break;
             case DETAILS:
@@ -308,9 +431,19 @@ bool WiFiModule::handleInput(uint8_t button) {
                 break;
             case STATION_LIST:
                 if (!detectedStations.empty()) {
-                    stationListIndex = (stationListIndex + 1) % detectedStations.size();
+                    stationList.setCount(detectedStations.size());
+                    stationList.next();
+                    stationList.update();
+                    return true;
                 }
                 break;
+            case WARDRIVE:
+                break;
+            case BEACONS:
+                nextBeaconRate();
+                break;
+            default:
+                break;
         }
         drawMenu(&displayManager);
         return true;
@@ -319,10 +452,22 @@ bool WiFiModule::handleInput(uint8_t button) {
     if (button == 2) { // Select (Double Click)
         switch (currentState) {
             case MENU:
-                if (menuIndex == 0) { // Scanner
+                if (menuList.getSelected() == 0) { // Scanner
                     currentState = SCANNER_MENU;
                     menuIndex = 0;
-                } else if (menuIndex == 1) { // Settings
+                } else if (menuList.getSelected() == 1) { // Wardrive
+                    startWardrive();
+                    currentState = WARDRIVE;
+                } else if (menuList.getSelected() == 2) { // Channel Usage
+                    startAirtime();
+                    currentState = AIRTIME;
+                } else if (menuList.getSelected() == 3) { // Probe Log
+                    startProbes();
+                    if (isHarvestingProbes) currentState = PROBES;
+                } else if (menuList.getSelected() == 4) { // Beacon Flood
+                    startBeacons();
+                    if (beacons.isRunning()) currentState = BEACONS;
+                } else if (menuList.getSelected() == 5) { // Settings
                     currentState = SETTINGS;
                 }
                 break;
@@ -335,7 +480,10 @@ bool WiFiModule::handleInput(uint8_t button) {
                     }
                 } else if (menuIndex == 1) { // View Results
                     currentState = RESULTS;
-                    selectedIndex = 0;
+                    selectResult(0);
+                } else if (menuIndex == 2) { // Capture All
+                    startMultiCapture(SCHEDULE_ADAPTIVE);
+                    if (isMultiCapture) currentState = MULTI_CAPTURE;
                 }
                 break;
             case SETTINGS:
@@ -352,7 +500,7 @@ bool WiFiModule::handleInput(uint8_t button) {
                 break;
             case RESULTS:
                 if (!scanResults.empty()) {
-                    selectedTarget = scanResults[selectedIndex];
+                    selectedTarget = scanResults[resultList.getSelected()];
                     currentState = DETAILS;
                 }
                 break;
@@ -383,16 +531,30 @@ bool WiFiModule::handleInput(uint8_t button) {
                 break;
             case ATTACK_MIXED:
                 break;
+            case MULTI_CAPTURE:
+                startMultiCapture(captureSchedule.getMode() == SCHEDULE_ADAPTIVE ? SCHEDULE_ROUND_ROBIN : SCHEDULE_ADAPTIVE);
+                break;
             case STATION_SCAN:
                 currentState = STATION_LIST;
-                stationListIndex = 0;
+                stationList.reset(detectedStations.size());
                 break;
             case STATION_LIST:
                 if (!detectedStations.empty()) {
-                    selectedStation = detectedStations[stationListIndex];
+                    selectedStation = detectedStations[stationList.getSelected()];
                     currentState = TARGET_OPTIONS; // Go back to options with station selected
                 }
                 break;
+            case WARDRIVE:
+                flushWardrive(); // Push pending rows to the card now
+                break;
+            case AIRTIME:
+                airtimeHold = !airtimeHold;
+                break;
+            case BEACONS:
+                nextBeaconChannel();
+                break;
+            default:
+                break;
         }
         drawMenu(&displayManager);
         return true;
@@ -412,7 +574,7 @@ void WiFiModule::updateUI(DisplayManager* display) {
             display->getTFT()->setTextDatum(MC_DATUM);
             display->getTFT()->setTextColor(THEME_TEXT, THEME_BG);
             display->getTFT()->drawString("Found: " + String(detectedStations.size()), 160, 100, 4);
-            display->getTFT()->fillCircle(160, 180, 5, (millis() / 500) % 2 == 0 ? TFT_GREEN : TFT_BLACK);
+            display->getTFT()->fillCircle(160, 180, 5, (millis() / 500) % 2 == 0 ? THEME_OK : THEME_BG);
             break;
             
         default:
@@ -424,15 +586,40 @@ void WiFiModule::performScan() {
     // Deprecated, using async scan in loop
 }
 
+void WiFiModule::selectResult(int index) {
+    resultList.select(index);
+    if (!scanResults.empty()) memcpy(selectedBssid, scanResults[resultList.getSelected()].bssid, 6);
+}
+
+// Full draws clear the screen; otherwise only rows whose AP, selection or
+// data changed are drawn again, so a scan that moved nothing costs nothing.
+// The loop marks the rows a merge changed before calling this.
+void WiFiModule::drawResults(DisplayManager* display, bool full) {
+    TFT_eSPI* tft = display->getTFT();
+    if (scanResults.empty()) {
+        if (!full && resultsEmptyShown) return;
+        if (!full) display->clearContent();
+        tft->setTextDatum(MC_DATUM);
+        tft->setTextColor(THEME_TEXT, THEME_BG);
+        tft->drawString("No Networks Found", 160, 100, 2);
+        if (isScanning) tft->drawString("Scanning...", 160, 130, 2);
+        resultsEmptyShown = true;
+        return;
+    }
+    if (resultsEmptyShown && !full) display->clearContent();
+    full = full || resultsEmptyShown;
+    resultsEmptyShown = false;
+
+    display->drawMenuTitle("Results (" + String(scanResults.size()) + ")");
+    if (full) resultList.draw();
+    else resultList.update();
+}
+
 void WiFiModule::sortResults() {
     if (sortMethod == SORT_RSSI) {
-        std::sort(scanResults.begin(), scanResults.end(), [](const APInfo& a, const APInfo& b) {
-            return a.rssi > b.rssi; // Descending RSSI
-        });
+        scanResults.sortByRssi(); // Descending RSSI
     } else {
-        std::sort(scanResults.begin(), scanResults.end(), [](const APInfo& a, const APInfo& b) {
-            return a.channel < b.channel; // Ascending Channel
-        });
+        scanResults.sortByChannel(); // Ascending Channel
     }
 }
 
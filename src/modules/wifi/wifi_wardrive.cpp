@@ -0,0 +1,124 @@
+#include "wifi_module.h"
+#include "sd_manager.h"
+
+#define WARDRIVE_SCAN_MS_PER_CHAN 120   // Full sweep in ~1.7s, short enough to tag APs while moving
+#define WARDRIVE_FLUSH_ROWS       32    // Dirty APs before a write
+#define WARDRIVE_FLUSH_MS         10000 // Or this long, whichever comes first
+
+void WiFiModule::startWardrive() {
+    extern SDManager sdManager;
+    isScanning = false; // The survey owns the scanner until it stops
+    WiFi.scanDelete();
+
+    if (!sightings.begin(WARDRIVE_TABLE_SLOTS) && !sightings.begin(WARDRIVE_MIN_SLOTS)) return;
+    gps.begin();
+    if (sdManager.isMounted()) {
+        wigle.begin(String(WARDRIVE_DIR) + "/wigle_" + String(millis()) + ".csv");
+        apStore.begin();
+    }
+
+    wardriveScans = wardriveSeen = wardriveNoFix = 0;
+    wardriveHasBest = false;
+    wardriveStartMs = wardriveFlushMs = millis();
+    isWardriving = true;
+    WiFi.scanNetworks(true, true, false, WARDRIVE_SCAN_MS_PER_CHAN);
+}
+
+void WiFiModule::stopWardrive() {
+    if (!isWardriving) return;
+    isWardriving = false;
+    WiFi.scanDelete();
+    flushWardrive();
+    wigle.end();
+    gps.end();
+    Serial.println("Wardrive: " + String(sightings.getCount()) + " APs, " + String(wigle.getRows()) + " rows in " +
+                   String(wigle.getWrites()) + " writes, " + String(wardriveNoFix) + " without a fix, " +
+                   String(apStore.getRecords()) + " stored");
+    apStore.end();
+    sightings.end();
+}
+
+void WiFiModule::wardriveLoop() {
+    gps.poll();
+
+    int n = WiFi.scanComplete();
+    if (n == WIFI_SCAN_FAILED) {
+        WiFi.scanNetworks(true, true, false, WARDRIVE_SCAN_MS_PER_CHAN);
+    } else if (n >= 0) {
+        // The whole sweep is tagged with the fix at its end, at most GPS_FIX_MAX_AGE_MS old
+        GeoFix fix;
+        if (!gps.getFix(fix)) {
+            wardriveNoFix += n;
+        } else {
+            for (int i = 0; i < n; i++) {
+                String ssid = WiFi.SSID(i);
+                sightings.observe(WiFi.BSSID(i), ssid.c_str(), ssid.length(), WiFi.encryptionType(i),
+                                  WiFi.channel(i), WiFi.RSSI(i), fix);
+            }
+            wardriveSeen += n;
+        }
+        wardriveScans++;
+        WiFi.scanDelete();
+        WiFi.scanNetworks(true, true, false, WARDRIVE_SCAN_MS_PER_CHAN);
+    }
+
+    if (sightings.getDirtyCount() >= WARDRIVE_FLUSH_ROWS || millis() - wardriveFlushMs > WARDRIVE_FLUSH_MS) {
+        flushWardrive();
+    }
+}
+
+void WiFiModule::flushWardrive() {
+    sightings.drainDirty([this](const ApSighting& ap) {
+        wigle.append(ap);
+        apStore.observe(ap);
+    });
+    wigle.flush();
+    apStore.flush();
+
+    // Strongest AP around here from any drive, for the status screen
+    GeoFix fix;
+    if (apStore.isOpen() && gps.getFix(fix)) {
+        wardriveHasBest = apStore.nearest(fix.latE7, fix.lonE7, &wardriveBest, 1) == 1;
+    }
+    sightings.evict(millis()); // Only written entries can go
+    wardriveFlushMs = millis();
+}
+
+void WiFiModule::drawWardrive(DisplayManager* display) {
+    TFT_eSPI* tft = display->getTFT();
+    GeoFix fix;
+    bool hasFix = gps.getFix(fix);
+    unsigned long elapsed = millis() - wardriveStartMs;
+
+    tft->fillRect(0, 45, 320, 105, THEME_BG); // Keeps the file name at the bottom
+    tft->setTextDatum(TL_DATUM);
+    tft->setTextColor(hasFix ? THEME_OK : THEME_ERROR, THEME_BG);
+    if (hasFix) {
+        char pos[48];
+        snprintf(pos, sizeof(pos), "%.5f, %.5f", fix.latE7 / 1e7, fix.lonE7 / 1e7);
+        tft->drawString(String(pos) + "  " + String(fix.satellites) + " sats  " +
+                        String(fix.accuracyDm / 10.0f, 1) + "m", 10, 50, 2);
+    } else {
+        tft->drawString("No GPS fix (" + String(gps.getBytes()) + " bytes read)", 10, 50, 2);
+    }
+
+    tft->setTextColor(THEME_TEXT, THEME_BG);
+    tft->drawString("APs: " + String(sightings.getCount()) + "   Rows: " + String(wigle.getRows()) +
+                    "   Writes: " + String(wigle.getWrites()), 10, 70, 2);
+    tft->drawString("Scans: " + String(wardriveScans) + "   Seen/min: " +
+                    String(elapsed ? (uint32_t)(wardriveSeen * 60000ULL / elapsed) : 0) + "   Table: " +
+                    String(sightings.getCount() * 100 / std::max<uint32_t>(sightings.getSlots(), 1)) + "%", 10, 90, 2);
+    String best = "";
+    if (wardriveHasBest) {
+        char ssid[33];
+        memcpy(ssid, wardriveBest.ssid, wardriveBest.ssidLen);
+        ssid[wardriveBest.ssidLen] = '\0';
+        best = "   Best: " + String(ssid) + " " + String(wardriveBest.rssi);
+    }
+    tft->drawString("Stored: " + String(apStore.getRecords()) + best, 10, 110, 2);
+
+    uint32_t lost = wardriveNoFix + sightings.getDropped();
+    tft->setTextColor(lost ? THEME_WARN : THEME_OK, THEME_BG);
+    tft->drawString("No fix: " + String(wardriveNoFix) + "   Dropped: " + String(sightings.getDropped()), 10, 130, 2);
+    tft->setTextColor(THEME_TEXT, THEME_BG);
+}
@@ -0,0 +1,123 @@
+#include "wigle_csv.h"
+#include "esp_wifi.h"
+
+const char* wigleAuthMode(uint8_t authMode) {
+    switch (authMode) {
+        case WIFI_AUTH_OPEN: return "[ESS]";
+        case WIFI_AUTH_WEP: return "[WEP][ESS]";
+        case WIFI_AUTH_WPA_PSK: return "[WPA-PSK-CCMP+TKIP][ESS]";
+        case WIFI_AUTH_WPA2_PSK: return "[WPA2-PSK-CCMP][ESS]";
+        case WIFI_AUTH_WPA_WPA2_PSK: return "[WPA-PSK-CCMP+TKIP][WPA2-PSK-CCMP+TKIP][ESS]";
+        case WIFI_AUTH_WPA2_ENTERPRISE: return "[WPA2-EAP-CCMP][ESS]";
+        case WIFI_AUTH_WPA3_PSK: return "[RSN-SAE-CCMP][ESS]";
+        case WIFI_AUTH_WPA2_WPA3_PSK: return "[WPA2-PSK-CCMP][RSN-SAE-CCMP][ESS]";
+        case WIFI_AUTH_WAPI_PSK: return "[WAPI-PSK][ESS]";
+        default: return "[UNKNOWN][ESS]";
+    }
+}
+
+// "YYYY-MM-DD HH:MM:SS" from seconds since 1970, the inverse of makeUnixTime()
+static void formatUtc(uint32_t t, char* out) {
+    uint32_t days = t / 86400;
+    uint32_t secs = t % 86400;
+    int32_t z = days + 719468;
+    int32_t era = z / 146097;
+    uint32_t doe = z - era * 146097;
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    uint32_t day = doy - (153 * mp + 2) / 5 + 1;
+    uint32_t month = mp < 10 ? mp + 3 : mp - 9;
+    uint32_t year = yoe + era * 400 + (month <= 2);
+    sprintf(out, "%04lu-%02lu-%02lu %02lu:%02lu:%02lu", (unsigned long)year, (unsigned long)month,
+            (unsigned long)day, (unsigned long)(secs / 3600), (unsigned long)(secs / 60 % 60), (unsigned long)(secs % 60));
+}
+
+// Fixed point degrees, doubles would round the last digit
+static char* formatE7(int32_t v, char* p) {
+    uint32_t a = v < 0 ? -(int64_t)v : v;
+    return p + sprintf(p, "%s%lu.%07lu", v < 0 ? "-" : "", (unsigned long)(a / 10000000), (unsigned long)(a % 10000000));
+}
+
+// RFC 4180: quoted only when needed, control characters would break the row
+static char* formatSsid(const ApSighting& ap, char* p) {
+    bool quote = false;
+    for (uint8_t i = 0; i < ap.ssidLen; i++) {
+        char c = ap.ssid[i];
+        if (c == ',' || c == '"') quote = true;
+    }
+    if (quote) *p++ = '"';
+    for (uint8_t i = 0; i < ap.ssidLen; i++) {
+        char c = ap.ssid[i];
+        if ((uint8_t)c < 0x20 || c == 0x7F) c = '?';
+        if (c == '"') *p++ = '"';
+        *p++ = c;
+    }
+    if (quote) *p++ = '"';
+    return p;
+}
+
+size_t formatWigleRow(const ApSighting& ap, char* out, size_t max) {
+    // Worst case is well under WIGLE_ROW_MAX, so only the buffer size needs checking
+    if (max < WIGLE_ROW_MAX) return 0;
+    char* p = out;
+    const uint8_t* b = ap.bssid;
+    p += sprintf(p, "%02x:%02x:%02x:%02x:%02x:%02x,", b[0], b[1], b[2], b[3], b[4], b[5]);
+    p = formatSsid(ap, p);
+    p += sprintf(p, ",%s,", wigleAuthMode(ap.authMode));
+    formatUtc(ap.firstSeen, p);
+    p += strlen(p);
+    p += sprintf(p, ",%u,%d,", ap.channel, ap.rssi);
+    p = formatE7(ap.fix.latE7, p);
+    *p++ = ',';
+    p = formatE7(ap.fix.lonE7, p);
+    p += sprintf(p, ",%d,%u.%u,WIFI\n", ap.fix.altitudeM, ap.fix.accuracyDm / 10, ap.fix.accuracyDm % 10);
+    return p - out;
+}
+
+bool WigleCsvWriter::begin(const String& filePath) {
+    if (open) return true;
+    if (!SD.exists(WARDRIVE_DIR)) SD.mkdir(WARDRIVE_DIR);
+    bool isNew = !SD.exists(filePath);
+    file = SD.open(filePath, FILE_APPEND);
+    if (!file) {
+        Serial.println("Wardrive: failed to open " + filePath);
+        return false;
+    }
+    if (isNew) {
+        file.print(WIGLE_PRE_HEADER);
+        file.print(WIGLE_HEADER);
+    }
+    path = filePath;
+    open = true;
+    bufferLen = 0;
+    rows = writes = errors = 0;
+    return true;
+}
+
+bool WigleCsvWriter::append(const ApSighting& ap) {
+    if (!open) return false;
+    if (bufferLen + WIGLE_ROW_MAX > sizeof(buffer)) flush();
+    bufferLen += formatWigleRow(ap, buffer + bufferLen, sizeof(buffer) - bufferLen);
+    rows++;
+    return true;
+}
+
+void WigleCsvWriter::flush() {
+    if (!open || bufferLen == 0) return;
+    size_t written = file.write((const uint8_t*)buffer, bufferLen);
+    if (written != bufferLen) {
+        Serial.println("Wardrive: SD write failed");
+        errors++;
+    }
+    file.flush();
+    writes++;
+    bufferLen = 0;
+}
+
+void WigleCsvWriter::end() {
+    if (!open) return;
+    flush();
+    file.close();
+    open = false;
+}
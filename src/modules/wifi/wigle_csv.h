@@ -0,0 +1,42 @@
+#pragma once
+#include <Arduino.h>
+#include <SD.h>
+#include "wardrive.h"
+
+#define WARDRIVE_DIR      "/wardrive"
+#define WIGLE_PRE_HEADER  "WigleWifi-1.4,appRelease=1.0,model=T-Display-S3,release=1.0,device=ESP-Chain,display=ST7789,board=ESP32-S3,brand=LilyGO\n"
+#define WIGLE_HEADER      "MAC,SSID,AuthMode,FirstSeen,Channel,RSSI,CurrentLatitude,CurrentLongitude,AltitudeMeters,AccuracyMeters,Type\n"
+#define WIGLE_ROW_MAX     256
+#define WIGLE_BUFFER      4096 // Bytes per SD write, ~40 rows
+
+// One WiGLE CSV row, newline terminated. Returns its length, 0 if out is too small.
+size_t formatWigleRow(const ApSighting& ap, char* out, size_t max);
+
+// "[WPA2-PSK-CCMP][ESS]" style capabilities for a wifi_auth_mode_t
+const char* wigleAuthMode(uint8_t authMode);
+
+// Appends rows to a WiGLE 1.4 CSV in WIGLE_BUFFER blocks
+class WigleCsvWriter {
+public:
+    bool begin(const String& path);
+    void end();
+    bool isOpen() { return open; }
+
+    bool append(const ApSighting& ap);
+    void flush();
+
+    const String& getPath() { return path; }
+    uint32_t getRows() { return rows; }
+    uint32_t getWrites() { return writes; }
+    uint32_t getErrors() { return errors; }
+
+private:
+    File file;
+    String path;
+    bool open = false;
+    char buffer[WIGLE_BUFFER];
+    size_t bufferLen = 0;
+    uint32_t rows = 0;
+    uint32_t writes = 0;
+    uint32_t errors = 0;
+};
@@ -1,37 +1,30 @@
 #pragma once
-// UI icons/sprites
+// UI icons/sprites. The bitmaps come from PixelArt/*.png via the asset pack
+// (see include/asset_pack.h); these names resolve to the decoded bytes.
 #include <Arduino.h>
+#include "asset_pack.h"
 
-static const unsigned char PROGMEM image_folder_explorer_bits[] = {0x3c,0x00,0x00,0x42,0x00,0x00,0x81,0xff,0x00,0x80,0x00,0x80,0xbf,0xfe,0x80,0xc0,0x01,0x80,0x80,0x00,0x80,0x80,0x00,0x80,0x80,0x00,0x80,0x80,0x00,0x80,0x80,0x00,0x80,0x80,0x00,0x80,0x80,0x00,0x80,0x80,0x00,0x80,0x80,0x00,0x80,0x7f,0xff,0x00};
-static const unsigned char PROGMEM image_cloud_sync_bits[] = {0x00,0x00,0x00,0x07,0xc0,0x00,0x08,0x20,0x00,0x10,0x10,0x00,0x30,0x08,0x00,0x40,0x0e,0x00,0x80,0x01,0x00,0x82,0x20,0x80,0x47,0x20,0x80,0x2f,0xaf,0x00,0x02,0x20,0x00,0x02,0xf8,0x00,0x02,0x70,0x00,0x02,0x20,0x00,0x00,0x00,0x00,0x00,0x00,0x00};
-//static const unsigned char PROGMEM image_SDcardFail_bits[] = {0xff,0xe0,0xed,0xe0,0xff,0xe0,0xe1,0xe0,0xde,0xe0,0xff,0xe0,0xff,0xe0,0xe6,0x00};
-//static const unsigned char PROGMEM image_SDcardMounted_bits[] = {0xff,0xe0,0xff,0x20,0xff,0xe0,0xff,0x20,0xff,0xe0,0xff,0x20,0xff,0xe0,0xe6,0x00};
-static const unsigned char PROGMEM image_music_radio_streaming_bits[] = {0x00,0x00,0x00,0x00,0x00,0x00,0x20,0x02,0x00,0x40,0x01,0x00,0x48,0x09,0x00,0x90,0x84,0x80,0xa5,0xd2,0x80,0xa9,0x4a,0x80,0xa5,0xd2,0x80,0x90,0x84,0x80,0x48,0x09,0x00,0x40,0x01,0x00,0x20,0x02,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00};
-static const unsigned char PROGMEM image_micro_sd_bits[] = {0x3f,0xc0,0x60,0x20,0x40,0x20,0x40,0x20,0x47,0x30,0x48,0x90,0x4f,0x88,0x40,0x08,0x49,0x10,0x4a,0x90,0x44,0x88,0x40,0x08,0x47,0x88,0x58,0x68,0x37,0xb0,0x00,0x00};
-static const unsigned char PROGMEM image_micro_sd_no_card_bits[] = {0x3f,0xc0,0xa0,0x20,0x40,0x20,0x60,0x20,0x53,0x30,0x48,0x90,0x4c,0x88,0x42,0x08,0x49,0x10,0x4a,0x90,0x44,0xc8,0x40,0x28,0x47,0x90,0x58,0x68,0x37,0xd4,0x00,0x00};
+#define ICON(name) AssetPack::getInstance().getBitmap(name)
 
-
-static const unsigned char PROGMEM image_badusb_bits[] = {
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x03, 0xff, 0xf0, 0x02, 0x00, 0x10, 0x3e, 0x00, 0x10, 0x26, 0x00, 0x10,
-    0x26, 0x00, 0x10, 0x3e, 0x00, 0x10, 0x02, 0x00, 0x10, 0x03, 0xff, 0xf0,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-};
-
-static const unsigned char PROGMEM image_menu_information_sign_white_bits[] = {0x07,0xc0,0x18,0x30,0x23,0x08,0x42,0x84,0x43,0x04,0x80,0x02,0x83,0x82,0x82,0x82,0x82,0x82,0x82,0x82,0x42,0x84,0x43,0x84,0x20,0x08,0x18,0x30,0x07,0xc0,0x00,0x00};
-static const unsigned char PROGMEM image_menu_options_bits[] = {0x00,0x00,0xef,0xfc,0xa8,0x04,0xef,0xfc,0x00,0x00,0x00,0x00,0xef,0xfc,0xa8,0x04,0xef,0xfc,0x00,0x00,0x00,0x00,0xef,0xfc,0xa8,0x04,0xef,0xfc,0x00,0x00,0x00,0x00};
-static const unsigned char PROGMEM image_SDQuestion_bits[] = {0x07,0xff,0xff,0xff,0x00,0x0f,0xff,0xff,0xff,0x80,0x0f,0xff,0x3c,0xff,0x80,0x0e,0x49,0x24,0x93,0x80,0x0e,0x49,0x24,0x93,0x80,0x0e,0x49,0x24,0x93,0x80,0x0e,0x49,0x24,0x93,0x80,0x0e,0x49,0x24,0x93,0x80,0x0f,0xff,0xff,0xff,0x80,0x0f,0xff,0xff,0xff,0x80,0x0f,0xff,0xff,0xff,0x80,0x0f,0xff,0xff,0xff,0x80,0x0f,0xfe,0x03,0xff,0x80,0x0f,0xfc,0x01,0xff,0x80,0x0f,0xf8,0x00,0xff,0x80,0x0f,0xf0,0xf8,0x7f,0x80,0x17,0xe1,0xfc,0x3f,0x80,0x2f,0xe3,0xfe,0x3f,0x80,0x5f,0xe3,0xfe,0x3f,0x80,0x7f,0xe3,0xfe,0x3f,0x80,0x7f,0xe3,0xfe,0x3f,0x80,0x7f,0xf7,0xfc,0x3f,0x80,0x7f,0xff,0xf8,0x7f,0x80,0x7f,0xff,0xf0,0xff,0x80,0x1f,0xff,0xe1,0xff,0x80,0x1f,0xff,0xc3,0xff,0x80,0x1f,0xff,0xc7,0xff,0x80,0x1f,0xff,0x8f,0xff,0x80,0x17,0xff,0x8f,0xff,0x80,0x2f,0xff,0x8f,0xff,0x80,0x5f,0xff,0x8f,0xff,0x80,0x7f,0xff,0xdf,0xff,0x80,0x7f,0xff,0xff,0xff,0x80,0x7f,0xff,0xff,0xff,0x80,0x7f,0xff,0x8f,0xff,0x80,0x7f,0xff,0x8f,0xff,0x80,0x7f,0xff,0x8f,0xff,0x80,0x7f,0xff,0xff,0xff,0x80,0x7f,0xff,0xff,0xff,0x80,0x7f,0xff,0xff,0xff,0x80,0x7f,0xff,0xff,0xff,0x80,0x7f,0xff,0xff,0xff,0x80,0x3f,0xff,0xff,0xff,0x00};
-static const unsigned char PROGMEM image_device_sleep_mode_white_bits[] = {0x04,0x00,0x1c,0x0e,0x28,0x02,0x48,0x04,0x51,0xee,0x90,0x40,0x90,0x80,0x91,0xe0,0x88,0x00,0x88,0x06,0x46,0x1c,0x41,0xe4,0x20,0x08,0x18,0x30,0x07,0xc0,0x00,0x00};
-static const unsigned char PROGMEM image_monitor_bits[] = {0x00,0x00,0xff,0xff,0x80,0x01,0xbf,0xfd,0xa0,0x05,0xa0,0x05,0xa0,0x05,0xa0,0x05,0xa0,0x05,0xbf,0xfd,0x80,0x01,0xff,0xff,0x03,0xc0,0x03,0xc0,0x0f,0xf0,0x00,0x00};
-static const unsigned char PROGMEM image_wifi_bits[] = {0x01,0xf0,0x00,0x06,0x0c,0x00,0x18,0x03,0x00,0x21,0xf0,0x80,0x46,0x0c,0x40,0x88,0x02,0x20,0x10,0xe1,0x00,0x23,0x18,0x80,0x04,0x04,0x00,0x08,0x42,0x00,0x01,0xb0,0x00,0x02,0x08,0x00,0x00,0x40,0x00,0x00,0xa0,0x00,0x00,0x40,0x00,0x00,0x00,0x00};
-
-static const unsigned char PROGMEM image_battery_0_bits[] = {0x00,0x00,0x00,0x0f,0xff,0xfe,0x10,0x00,0x01,0x10,0x40,0x41,0x70,0x20,0x81,0x80,0x11,0x01,0x80,0x0a,0x01,0x80,0x04,0x01,0x80,0x0a,0x01,0x80,0x11,0x01,0x70,0x20,0x81,0x10,0x40,0x41,0x10,0x00,0x01,0x0f,0xff,0xfe,0x00,0x00,0x00,0x00,0x00,0x00};
-static const unsigned char PROGMEM image_battery_17_bits[] = {0x00,0x00,0x00,0x0f,0xff,0xfe,0x10,0x00,0x01,0x10,0x00,0x0d,0x70,0x00,0x0d,0x80,0x00,0x0d,0x80,0x00,0x0d,0x80,0x00,0x0d,0x80,0x00,0x0d,0x80,0x00,0x0d,0x70,0x00,0x0d,0x10,0x00,0x0d,0x10,0x00,0x01,0x0f,0xff,0xfe,0x00,0x00,0x00,0x00,0x00,0x00};
-static const unsigned char PROGMEM image_battery_33_bits[] = {0x00,0x00,0x00,0x0f,0xff,0xfe,0x10,0x00,0x01,0x10,0x00,0x6d,0x70,0x00,0x6d,0x80,0x00,0x6d,0x80,0x00,0x6d,0x80,0x00,0x6d,0x80,0x00,0x6d,0x80,0x00,0x6d,0x70,0x00,0x6d,0x10,0x00,0x6d,0x10,0x00,0x01,0x0f,0xff,0xfe,0x00,0x00,0x00,0x00,0x00,0x00};
-static const unsigned char PROGMEM image_battery_50_bits[] = {0x00,0x00,0x00,0x0f,0xff,0xfe,0x10,0x00,0x01,0x10,0x03,0x6d,0x70,0x03,0x6d,0x80,0x03,0x6d,0x80,0x03,0x6d,0x80,0x03,0x6d,0x80,0x03,0x6d,0x80,0x03,0x6d,0x70,0x03,0x6d,0x10,0x03,0x6d,0x10,0x00,0x01,0x0f,0xff,0xfe,0x00,0x00,0x00,0x00,0x00,0x00};
-static const unsigned char PROGMEM image_battery_67_bits[] = {0x00,0x00,0x00,0x0f,0xff,0xfe,0x10,0x00,0x01,0x10,0x1b,0x6d,0x70,0x1b,0x6d,0x80,0x1b,0x6d,0x80,0x1b,0x6d,0x80,0x1b,0x6d,0x80,0x1b,0x6d,0x80,0x1b,0x6d,0x70,0x1b,0x6d,0x10,0x1b,0x6d,0x10,0x00,0x01,0x0f,0xff,0xfe,0x00,0x00,0x00,0x00,0x00,0x00};
-static const unsigned char PROGMEM image_battery_83_bits[] = {0x00,0x00,0x00,0x0f,0xff,0xfe,0x10,0x00,0x01,0x10,0xdb,0x6d,0x70,0xdb,0x6d,0x80,0xdb,0x6d,0x80,0xdb,0x6d,0x80,0xdb,0x6d,0x80,0xdb,0x6d,0x80,0xdb,0x6d,0x70,0xdb,0x6d,0x10,0xdb,0x6d,0x10,0x00,0x01,0x0f,0xff,0xfe,0x00,0x00,0x00,0x00,0x00,0x00};
-static const unsigned char PROGMEM image_battery_full_bits[] = {0x00,0x00,0x00,0x0f,0xff,0xfe,0x10,0x00,0x01,0x16,0xdb,0x6d,0x76,0xdb,0x6d,0x86,0xdb,0x6d,0x86,0xdb,0x6d,0x86,0xdb,0x6d,0x86,0xdb,0x6d,0x86,0xdb,0x6d,0x76,0xdb,0x6d,0x16,0xdb,0x6d,0x10,0x00,0x01,0x0f,0xff,0xfe,0x00,0x00,0x00,0x00,0x00,0x00};
-static const unsigned char PROGMEM image_battery_charging_bits[] = {0x00,0x02,0x00,0x0f,0xe4,0xfe,0x10,0x0c,0x01,0x10,0x08,0x01,0x70,0x18,0x01,0x80,0x30,0x01,0x80,0x3f,0x81,0x80,0x7f,0x01,0x80,0x03,0x01,0x80,0x06,0x01,0x70,0x04,0x01,0x10,0x0c,0x01,0x10,0x08,0x01,0x0f,0xd3,0xfe,0x00,0x10,0x00,0x00,0x00,0x00};
+#define image_folder_explorer_bits             ICON("folder_explorer")
+#define image_cloud_sync_bits                  ICON("cloud_sync")
+#define image_music_radio_streaming_bits       ICON("music_radio_streaming")
+#define image_micro_sd_bits                    ICON("micro_sd")
+#define image_micro_sd_no_card_bits            ICON("micro_sd_no_card")
+#define image_badusb_bits                      ICON("badusb")
+#define image_menu_information_sign_white_bits ICON("menu_information_sign_white")
+#define image_menu_options_bits                ICON("menu_options")
+#define image_SDQuestion_bits                  ICON("SDQuestion")
+#define image_device_sleep_mode_white_bits     ICON("device_sleep_mode_white")
+#define image_monitor_bits                     ICON("monitor")
+#define image_wifi_bits                        ICON("wifi")
 
 // All battery icons are 24x16
+#define image_battery_0_bits                   ICON("battery_0")
+#define image_battery_17_bits                  ICON("battery_17")
+#define image_battery_33_bits                  ICON("battery_33")
+#define image_battery_50_bits                  ICON("battery_50")
+#define image_battery_67_bits                  ICON("battery_67")
+#define image_battery_83_bits                  ICON("battery_83")
+#define image_battery_full_bits                ICON("battery_full")
+#define image_battery_charging_bits            ICON("battery_charging")
@@ -1,2 +1,80 @@
 #pragma once
 // Color themes
+#include <stdint.h>
+#include <string.h>
+
+// What a color is for; drawing code asks for a role, never a theme
+enum ThemeColor : uint8_t {
+    COLOR_BG,
+    COLOR_PRIMARY,   // Selected row
+    COLOR_SECONDARY, // Status bar
+    COLOR_TEXT,      // On any of the three above
+    COLOR_ACCENT,
+    COLOR_BORDER,    // Row outlines and the scroll thumb
+    COLOR_OK,        // Status text and icons: working, found, within budget
+    COLOR_WARN,      // Degraded, waiting, getting close
+    COLOR_ERROR,     // Failed, lost, dropped
+    COLOR_COUNT
+};
+
+struct ThemePalette {
+    const char* name; // As in config.json's display.theme
+    uint16_t colors[COLOR_COUNT];
+};
+
+// RGB565, in ThemeColor order. The first one is the default.
+constexpr ThemePalette THEMES[] = {
+    {"purple_black", {0x0000, 0x780F, 0x4010, 0xFFFF, 0x911F, 0xFFFF, 0x07E0, 0xFFE0, 0xF800}},
+    {"green_matrix", {0x0000, 0x0320, 0x01A0, 0xFFFF, 0x07E0, 0x07E0, 0x07E0, 0xFFE0, 0xF800}},
+    {"amber_black",  {0x0000, 0x7A00, 0x4100, 0xFE60, 0xFD20, 0xFE60, 0x07E0, 0xFFE0, 0xF800}},
+    {"light",        {0xFFFF, 0xAEDF, 0xC618, 0x0000, 0x001F, 0x4208, 0x0300, 0x9A00, 0xB000}},
+};
+constexpr uint8_t THEME_COUNT = sizeof(THEMES) / sizeof(THEMES[0]);
+
+// Relative luminance with gamma 2 instead of the sRGB curve, close enough
+// for a 5/6 bit panel and cheap enough to evaluate at compile time
+constexpr double themeLuminance(uint16_t c) {
+    return 0.2126 * ((c >> 11) / 31.0) * ((c >> 11) / 31.0) +
+           0.7152 * (((c >> 5) & 0x3F) / 63.0) * (((c >> 5) & 0x3F) / 63.0) +
+           0.0722 * ((c & 0x1F) / 31.0) * ((c & 0x1F) / 31.0);
+}
+
+// WCAG contrast ratio, 1 to 21
+constexpr double themeContrast(uint16_t a, uint16_t b) {
+    return themeLuminance(a) > themeLuminance(b) ? (themeLuminance(a) + 0.05) / (themeLuminance(b) + 0.05)
+                                                 : (themeLuminance(b) + 0.05) / (themeLuminance(a) + 0.05);
+}
+
+// A status color is text on the background and an icon on the status bar
+constexpr bool themeStatusReadable(const ThemePalette& t, ThemeColor c) {
+    return themeContrast(t.colors[c], t.colors[COLOR_BG]) >= 4.5 &&
+           themeContrast(t.colors[c], t.colors[COLOR_SECONDARY]) >= 3.0;
+}
+
+// Body text at 4.5:1 wherever it is drawn, outlines and accents at 3:1
+constexpr bool themeReadable(const ThemePalette& t) {
+    return themeStatusReadable(t, COLOR_OK) && themeStatusReadable(t, COLOR_WARN) &&
+           themeStatusReadable(t, COLOR_ERROR) &&
+           themeContrast(t.colors[COLOR_TEXT], t.colors[COLOR_BG]) >= 4.5 &&
+           themeContrast(t.colors[COLOR_TEXT], t.colors[COLOR_PRIMARY]) >= 4.5 &&
+           themeContrast(t.colors[COLOR_TEXT], t.colors[COLOR_SECONDARY]) >= 4.5 &&
+           themeContrast(t.colors[COLOR_BORDER], t.colors[COLOR_BG]) >= 3.0 &&
+           themeContrast(t.colors[COLOR_ACCENT], t.colors[COLOR_BG]) >= 3.0;
+}
+
+constexpr bool themesReadable(uint8_t i = 0) {
+    return i == THEME_COUNT || (themeReadable(THEMES[i]) && themesReadable(i + 1));
+}
+static_assert(themesReadable(), "a theme fails the contrast checks");
+
+// Index of the named theme, -1 if there is none
+inline int themeIndex(const char* name) {
+    for (uint8_t i = 0; i < THEME_COUNT; i++) {
+        if (strcmp(THEMES[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// The palette in use, copied from THEMES by DisplayManager::setTheme().
+// THEME_* read it directly, so a draw costs one load per color.
+extern ThemePalette activeTheme;
@@ -0,0 +1,126 @@
+#pragma once
+// Tiny benchmark harness shared by the host (env:bench-native) and device
+// (env:bench) builds. Each case runs a warm-up pass and BENCH_RUNS timed
+// passes; the median per-op time is what compare.py tracks. Short cases
+// get their op count scaled up so a pass is long enough to time reliably.
+#include <Arduino.h>
+#include <vector>
+#include <algorithm>
+#ifdef SIMULATOR
+#include <chrono>
+#else
+#include <esp_timer.h>
+#endif
+
+#define BENCH_RUNS 5
+#define BENCH_MIN_PASS_US 20000
+#define BENCH_MAX_SCALE 1000
+
+struct BenchResult {
+    String name;
+    uint32_t ops;            // Operations per timed pass
+    float usPerOp;           // Median over the timed passes
+    float minUsPerOp;
+    float allocsPerOp;       // Heap allocations per op, < 0 when the target can't count them
+    const char* extraKey;    // Optional case specific metric (pixels, throughput...)
+    float extraValue;
+};
+
+class Bench {
+public:
+    void setFilter(const String& f) { filter = f; }
+
+    bool enabled(const char* name) {
+        return filter.length() == 0 || String(name).indexOf(filter) >= 0;
+    }
+
+    // Wall clock on both targets, the simulator's millis() is virtual
+    static uint64_t nowUs() {
+#ifdef SIMULATOR
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+        return esp_timer_get_time();
+#endif
+    }
+
+    // body(ops) must perform exactly `ops` operations, for any ops.
+    // Returns nullptr when the case is filtered out, otherwise the stored
+    // result so the caller can attach an extra metric.
+    template <typename F>
+    BenchResult* run(const char* name, uint32_t ops, F body) {
+        if (!enabled(name) || ops == 0) return nullptr;
+
+        // Warm-up: caches, lazily loaded files, first allocations
+        uint64_t warmStart = nowUs();
+        body(ops);
+        uint64_t warmUs = nowUs() - warmStart;
+        if (warmUs < BENCH_MIN_PASS_US) {
+            uint32_t scale = warmUs ? BENCH_MIN_PASS_US / warmUs + 1 : BENCH_MAX_SCALE;
+            ops *= std::min<uint32_t>(scale, BENCH_MAX_SCALE);
+        }
+
+        float samples[BENCH_RUNS];
+#ifdef SIMULATOR
+        uint64_t allocStart = simAllocCount();
+#endif
+        for (int i = 0; i < BENCH_RUNS; i++) {
+            uint64_t start = nowUs();
+            body(ops);
+            samples[i] = (float)(nowUs() - start) / ops;
+        }
+
+        BenchResult r;
+        r.name = name;
+        r.ops = ops;
+#ifdef SIMULATOR
+        r.allocsPerOp = (float)(simAllocCount() - allocStart) / ((float)ops * BENCH_RUNS);
+#else
+        r.allocsPerOp = -1;
+#endif
+        std::sort(samples, samples + BENCH_RUNS);
+        r.usPerOp = samples[BENCH_RUNS / 2];
+        r.minUsPerOp = samples[0];
+        r.extraKey = nullptr;
+        r.extraValue = 0;
+        results.push_back(r);
+
+        Serial.printf("# %-28s %10.2f us/op  (min %.2f, %u ops)\n", name, r.usPerOp, r.minUsPerOp, (unsigned)ops);
+        return &results.back();
+    }
+
+    // One line of JSON so it can be grepped out of a serial log
+    void printJson(const char* target) {
+        Serial.printf("{\"bench\":\"esp-chain\",\"target\":\"%s\",\"runs\":%d,\"results\":[", target, BENCH_RUNS);
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult& r = results[i];
+            Serial.printf("%s{\"name\":\"%s\",\"ops\":%u,\"us_per_op\":%.3f,\"min_us_per_op\":%.3f,\"ops_per_sec\":%.1f",
+                          i ? "," : "", r.name.c_str(), (unsigned)r.ops, r.usPerOp, r.minUsPerOp,
+                          r.usPerOp > 0 ? 1000000.0f / r.usPerOp : 0.0f);
+            if (r.allocsPerOp >= 0) Serial.printf(",\"allocs_per_op\":%.2f", r.allocsPerOp);
+            if (r.extraKey) Serial.printf(",\"%s\":%.1f", r.extraKey, r.extraValue);
+            Serial.print("}");
+        }
+        Serial.println("]}");
+    }
+
+    // Correctness checks run alongside the timings; the host exits non-zero on failure
+    bool check(bool ok, const String& what) {
+        if (!ok) {
+            Serial.println("# FAIL " + what);
+            failures++;
+        }
+        return ok;
+    }
+    int getFailures() { return failures; }
+
+    void clear() {
+        results.clear();
+        failures = 0;
+    }
+
+private:
+    std::vector<BenchResult> results;
+    String filter;
+    int failures = 0;
+};
@@ -0,0 +1,3651 @@
+// Benchmarks for the firmware's hot paths. Builds in place of main.cpp:
+//
+//   Host:   pio run -e bench-native && .pio/build/bench-native/program [--sd DIR] [--filter NAME]
+//   Device: pio run -e bench -t upload && pio device monitor > bench.log
+//           (Btn 14 re-runs the suite)
+//
+// Results are printed as a single JSON line, compare two runs with
+//   python3 test/bench/compare.py baseline.json current.json
+#include <Arduino.h>
+#include <SD.h>
+#include "bench.h"
+#include "display_manager.h"
+#include "sd_manager.h"
+#include "menu_system.h"
+#include "module_registry.h"
+#include "input_manager.h"
+#include "config_manager.h"
+#include "asset_pack.h"
+#include "bitmap_blit.h"
+#include "battery_monitor.h"
+#include "ui/icons.h"
+#include "USBHIDKeyboard.h"
+#include "modules/badusb/ducky_parser.h"
+#include "modules/wifi/wifi_module.h"
+#include "modules/wifi/wardrive.h"
+#include "modules/wifi/wigle_csv.h"
+#include "modules/wifi/ap_store.h"
+#include "modules/wifi/scan_results.h"
+#include "modules/wifi/eapol_tracker.h"
+#include "modules/wifi/capture_schedule.h"
+#include "modules/wifi/hc22000.h"
+#include "modules/wifi/pcapng_writer.h"
+#include "modules/wifi/frame_filter.h"
+#include "modules/wifi/airtime.h"
+#include "modules/wifi/probe_log.h"
+#include "modules/wifi/beacon_flood.h"
+#include "modules/wifi/table_util.h"
+#include "modules/gps/gps_reader.h"
+#include "modules/counter_module.h"
+#include "modules/file_explorer_module.h"
+#include "modules/settings_module.h"
+#include "modules/i2c/i2c_scanner_module.h"
+#include "modules/i2c/i2c_fingerprint.h"
+#include "modules/nrf24/nrf24_module.h"
+#include "modules/subghz/pulse_codec.h"
+#include "modules/subghz/signal_capture.h"
+#include "modules/subghz/signal_replay.h"
+#include "modules/subghz/protocol_decoder.h"
+#include "modules/lora/lora_airtime.h"
+#include "modules/lora/lora_log.h"
+#include "badusb_module.h"
+#ifndef SIMULATOR
+#include <esp_heap_caps.h>
+#include "modules/usb_storage_module.h"
+#include "modules/wifi_storage_module.h"
+#else
+#include "sim_pulse_sink.h"
+#endif
+
+DisplayManager displayManager;
+SDManager sdManager;
+MenuSystem menuSystem(&displayManager, &sdManager);
+InputManager inputManager(&menuSystem);
+
+CounterModule counterModule;
+FileExplorerModule fileExplorerModule;
+SettingsModule settingsModule;
+I2CScannerModule i2cScannerModule;
+NRF24Module nrf24Module;
+WiFiModule wifiModule;
+BadUSBModule badusbModule;
+#ifndef SIMULATOR
+USBStorageModule usbStorageModule;
+WiFiStorageModule wifiStorageModule;
+#endif
+
+#ifdef SIMULATOR
+#define BENCH_TARGET "native"
+#else
+#define BENCH_TARGET "esp32s3"
+#endif
+
+#define BENCH_DIR          "/bench"
+#define BENCH_LISTDIR      "/bench/listdir"
+#define BENCH_LISTDIR_FILES 256
+#define BENCH_FRAME_LEN    256 // Typical data frame
+#define BENCH_EAPOL_LEN    131 // 802.11 header + LLC/SNAP + EAPOL-Key M1
+#define BENCH_CAPTURE_FILE "/bench/_capture.pls"
+#define BENCH_REPLAY_FILE  "/bench/_replay.pls"
+#define BENCH_GDO0_PIN     16
+#define BENCH_CAPTURES_DIR "/bench/captures" // Optional real .pls recordings for the decoder cases
+#define BENCH_HANDSHAKES   "/bench/_handshakes.pcap"
+#define BENCH_PCAPS_DIR    "/bench/pcaps" // Optional real captures to replay, <name>.psk holds the passphrase
+#define BENCH_REFERENCE    "/bench/_reference.pcap"
+#define BENCH_HASHES       "/bench/_hashes.hc22000"
+#define BENCH_PCAPNG       "/bench/_capture.pcapng"
+#define BENCH_AIRTIME      "/bench/_airtime.pcapng"
+#define BENCH_PROBES       "/bench/_probes.bin"
+#define BENCH_PROBE_COUNT  3000
+#define BENCH_PROBE_CLIENTS 400
+#define BENCH_PROBE_NAMES  300
+#define BENCH_EPOCH_US     1760000000000000ULL // Oct 2025, stands in for the RTC
+#define BENCH_PASSPHRASE   "bench-passphrase"
+#define BENCH_ESSID        "ESP-Chain Bench"
+#define BENCH_CAPTURE_MIN  10 // Virtual minutes of traffic per schedule run
+#define BENCH_LORA_LOG     "/bench/_lora.csv"
+#define BENCH_WIGLE_FILE   "/bench/_wigle.csv"
+#define BENCH_WARDRIVE_APS 3000 // Distinct BSSIDs in the synthetic survey
+#define BENCH_SCAN_APS     40 // Simulated APs per scan, a busy street
+#define BENCH_HISTORY_APS  500 // Per merge cycle for scan_history_merge_500, 10 new each cycle
+#define BENCH_APSTORE_INDEX "/bench/_aps.idx"
+#define BENCH_APSTORE_DATA  "/bench/_aps.dat"
+#define BENCH_APSTORE_APS   100000 // On a 250 x 400 grid ~35m apart, ~100 per geohash cell
+#ifdef SIMULATOR
+#define BENCH_APSTORE_OBS   200000 // Per pass; warm-up + 5 passes stores 1.2M observations
+#define BENCH_PROBE_SSIDS   100000
+#else
+#define BENCH_APSTORE_OBS   2000   // Every op is a few random sector reads on the card
+#define BENCH_PROBE_SSIDS   20000  // ~1MB of tables and keys in PSRAM
+#endif
+
+static Bench bench;
+
+// Defined in badusb_module.cpp. begin() is never called here, so on the
+// device the HID reports are dropped instead of typed into the host PC.
+extern USBHIDKeyboard Keyboard;
+
+// --- Ducky Script ---
+
+// Only lines that don't sleep: every key press in processLine() waits 10ms
+// on hardware, which would drown out the parsing cost.
+static const char* duckyLines[] = {
+    "REM Open a terminal and print system info",
+    "STRING echo hello from the ducky parser",
+    "DEFAULT_DELAY 0",
+    "STRING The quick brown fox jumps over the lazy dog 0123456789",
+    "REM ------------------------------------------------",
+    "DELAY 0",
+    "STRING cd /tmp && ls -la",
+    "DEFAULTDELAY 0",
+    "rem lower case comment",
+    "STRING x",
+};
+#define DUCKY_LINE_COUNT (sizeof(duckyLines) / sizeof(duckyLines[0]))
+
+static void benchDucky() {
+    DuckyParser parser(&Keyboard);
+    std::vector<String> lines;
+    for (size_t i = 0; i < DUCKY_LINE_COUNT; i++) lines.push_back(duckyLines[i]);
+
+    bench.run("ducky_process_line", 2000, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) parser.processLine(lines[i % DUCKY_LINE_COUNT]);
+    });
+}
+
+// --- WiFi sniffer ---
+
+// wifi_promiscuous_pkt_t + frame, as handed to the promiscuous callback
+static uint8_t dataPkt[sizeof(wifi_promiscuous_pkt_t) + BENCH_FRAME_LEN];
+static uint8_t eapolPkt[sizeof(wifi_promiscuous_pkt_t) + BENCH_EAPOL_LEN];
+
+static void buildFrames() {
+    static const uint8_t bssid[6] = {0xa4, 0x2b, 0xb0, 0x11, 0x22, 0x33};
+    static const uint8_t sta[6] = {0x3c, 0x22, 0xfb, 0x44, 0x55, 0x66};
+
+    wifi_promiscuous_pkt_t* pkt = (wifi_promiscuous_pkt_t*)dataPkt;
+    memset(dataPkt, 0, sizeof(dataPkt));
+    pkt->rx_ctrl.sig_len = BENCH_FRAME_LEN;
+    pkt->rx_ctrl.rssi = -55;
+    uint8_t* f = pkt->payload;
+    f[0] = 0x08; f[1] = 0x02;                 // Data, FromDS
+    memcpy(&f[4], sta, 6);
+    memcpy(&f[10], bssid, 6);
+    memcpy(&f[16], bssid, 6);
+    const uint8_t snapIp[8] = {0xAA, 0xAA, 0x03, 0x00, 0x00, 0x00, 0x08, 0x00};
+    memcpy(&f[24], snapIp, 8);
+    for (int i = 32; i < BENCH_FRAME_LEN; i++) f[i] = (uint8_t)(i * 7 + 1) & 0x7F; // Never 0x88
+
+    pkt = (wifi_promiscuous_pkt_t*)eapolPkt;
+    memset(eapolPkt, 0, sizeof(eapolPkt));
+    pkt->rx_ctrl.sig_len = BENCH_EAPOL_LEN;
+    pkt->rx_ctrl.rssi = -55;
+    f = pkt->payload;
+    f[0] = 0x08; f[1] = 0x02;
+    memcpy(&f[4], sta, 6);
+    memcpy(&f[10], bssid, 6);
+    memcpy(&f[16], bssid, 6);
+    const uint8_t snapEapol[8] = {0xAA, 0xAA, 0x03, 0x00, 0x00, 0x00, 0x88, 0x8E};
+    memcpy(&f[24], snapEapol, 8);
+    f[32] = 0x02; f[33] = 0x03;               // 802.1X v2, EAPOL-Key
+    f[34] = 0x00; f[35] = 95;
+    f[36] = 0x02;                             // RSN key descriptor
+    f[37] = 0x00; f[38] = 0x8A;               // Key info: M1
+    for (int i = 39; i < BENCH_EAPOL_LEN; i++) f[i] = (uint8_t)(i * 13) & 0x7F;
+    f[129] = f[130] = 0;                      // No key data
+}
+
+static void benchSniffer() {
+    buildFrames();
+
+    // Idle callback: nothing armed, frames are dropped before the EAPOL check
+    bench.run("sniffer_frame_idle", 5000, [](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) WiFiModule::snifferCallback(dataPkt, WIFI_PKT_DATA);
+    });
+
+    if (bench.enabled("sniffer_frame_station_scan")) {
+        wifiModule.startStationScan();
+        bench.run("sniffer_frame_station_scan", 2000, [](uint32_t ops) {
+            for (uint32_t i = 0; i < ops; i++) WiFiModule::snifferCallback(dataPkt, WIFI_PKT_DATA);
+        });
+        wifiModule.stopStationScan();
+    }
+}
+
+// --- WiFi scan results ---
+
+// What WiFiModule::loop() did with a finished scan before ScanResults,
+// kept as the baseline for allocations and heap fragmentation
+struct LegacyAPInfo {
+    String ssid;
+    int32_t rssi;
+    uint8_t channel;
+    String bssid;
+    wifi_auth_mode_t encryption;
+};
+
+static void loadLegacyResults(std::vector<LegacyAPInfo>& results, int n) {
+    results.clear();
+    for (int i = 0; i < n; ++i) {
+        LegacyAPInfo ap;
+        ap.ssid = WiFi.SSID(i);
+        if (ap.ssid.isEmpty()) ap.ssid = "<HIDDEN>";
+        ap.rssi = WiFi.RSSI(i);
+        ap.channel = WiFi.channel(i);
+        ap.bssid = WiFi.BSSIDstr(i);
+        ap.encryption = WiFi.encryptionType(i);
+        results.push_back(ap);
+    }
+    std::sort(results.begin(), results.end(), [](const LegacyAPInfo& a, const LegacyAPInfo& b) { return a.rssi > b.rssi; });
+}
+
+// Largest free block against free heap: 0 when the free heap is in one piece
+static void attachFragmentation(BenchResult* r) {
+#ifndef SIMULATOR
+    if (!r) return;
+    size_t freeBytes = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    r->extraKey = "frag_pct";
+    r->extraValue = freeBytes ? 100.0f - heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) * 100.0f / freeBytes : 0;
+#endif
+}
+
+static void benchScanResults() {
+    if (!bench.enabled("wifi_scan_results")) return;
+#ifdef SIMULATOR
+    for (int i = 0; i < BENCH_SCAN_APS; i++) {
+        char ssid[24], bssid[18];
+        sprintf(ssid, i % 10 == 9 ? "" : "Bench Street %d", i);
+        sprintf(bssid, "a4:37:12:00:%02x:%02x", i / 7, i);
+        simAddAccessPoint(ssid, -40 - (i * 37) % 50, 1 + i % 13, bssid, WIFI_AUTH_WPA2_PSK);
+    }
+#endif
+    WiFi.mode(WIFI_STA);
+    int n = WiFi.scanNetworks(false, true);
+    if (n <= 0) return;
+
+    static ScanResults results;
+    if (!results.begin()) return;
+    results.clear();
+    results.load(n, true, 1000);
+    results.sortByRssi();
+    bool ok = results.size() == n;
+    for (uint16_t i = 1; i < results.size() && ok; i++) ok = results[i].rssi <= results[i - 1].rssi;
+    for (int i = 0; i < n && ok; i++) {
+        const APInfo* ap = nullptr;
+        for (uint16_t j = 0; j < results.size(); j++) {
+            if (memcmp(results[j].bssid, WiFi.BSSID(i), 6) == 0) ap = &results[j];
+        }
+        String ssid = WiFi.SSID(i);
+        ok = ap && apBssidString(*ap).equalsIgnoreCase(WiFi.BSSIDstr(i)) &&
+             apSsidString(*ap) == (ssid.isEmpty() ? "<HIDDEN>" : ssid) && ap->channel == WiFi.channel(i);
+    }
+    // A rescan updates in place and keeps when each AP was first seen
+    results.load(n, true, 2000);
+    ok = ok && results.size() == n && results[0].firstSeenMs == 1000 && results[0].lastSeenMs == 2000;
+    bench.check(ok, "wifi scan results merge");
+
+    std::vector<LegacyAPInfo> legacy;
+    BenchResult* r = bench.run("wifi_scan_results_legacy", 200, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) loadLegacyResults(legacy, n);
+    });
+    attachFragmentation(r);
+    std::vector<LegacyAPInfo>().swap(legacy);
+
+    r = bench.run("wifi_scan_results", 200, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            results.load(n, true, i);
+            results.sortByRssi();
+        }
+    });
+    attachFragmentation(r);
+    WiFi.scanDelete();
+}
+
+// One AP seen in the current scan, BSSID from its id
+static void benchSeen(ScanResults& results, uint32_t id, int8_t rssi, const char* ssid = "Net", uint8_t channel = 6) {
+    uint8_t bssid[6] = {0xA4, 0x37, (uint8_t)(id >> 24), (uint8_t)(id >> 16), (uint8_t)(id >> 8), (uint8_t)id};
+    results.update(bssid, (const uint8_t*)ssid, strlen(ssid), rssi, channel, WIFI_AUTH_WPA2_PSK, 1000);
+}
+
+static int benchIndexOf(ScanResults& results, uint32_t id) {
+    uint8_t bssid[6] = {0xA4, 0x37, (uint8_t)(id >> 24), (uint8_t)(id >> 16), (uint8_t)(id >> 8), (uint8_t)id};
+    return results.indexOf(bssid);
+}
+
+static uint16_t benchDeltas(ScanResults& results, ScanChange change) {
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < results.getDeltaCount(); i++) n += results.getDelta(i).change == change;
+    return n;
+}
+
+static bool checkScanHistory() {
+    ScanResults results;
+    if (!results.begin(8)) return false;
+    results.beginScan();
+    benchSeen(results, 1, -50);
+    benchSeen(results, 2, -60);
+    benchSeen(results, 3, -70);
+    results.endScan();
+    results.sortByRssi();
+    uint16_t slot2 = results.slotAt(1);
+    bool ok = results.size() == 3 && benchDeltas(results, SCAN_ADDED) == 3 && benchIndexOf(results, 2) == 1;
+
+    // A missing AP stays for SCAN_MISSES_MAX - 1 scans and keeps its slot, then goes
+    for (int scan = 1; scan <= SCAN_MISSES_MAX; scan++) {
+        results.beginScan();
+        benchSeen(results, 1, -50);
+        benchSeen(results, 3, -70);
+        results.endScan();
+        results.sortByRssi();
+        if (scan < SCAN_MISSES_MAX) {
+            ok = ok && results.size() == 3 && results.getDeltaCount() == 0 && results.slotAt(1) == slot2;
+        }
+    }
+    ok = ok && results.size() == 2 && results.getDeltaCount() == 1 && results.getDelta(0).change == SCAN_REMOVED &&
+         results.getDelta(0).slot == slot2 && benchIndexOf(results, 2) == -1 && benchIndexOf(results, 3) == 1;
+
+    // Jitter under the step moves nothing, a real drop is followed in steps
+    uint16_t changes = 0;
+    for (int scan = 0; scan < 10; scan++) {
+        results.beginScan();
+        benchSeen(results, 1, scan % 2 ? -48 : -53);
+        benchSeen(results, 3, -70);
+        results.endScan();
+        changes += results.getDeltaCount();
+    }
+    ok = ok && changes == 0 && results[0].rssi == -50;
+    results.beginScan();
+    benchSeen(results, 1, -80);
+    benchSeen(results, 3, -70);
+    results.endScan();
+    int8_t firstStep = results[0].rssi;
+    ok = ok && benchDeltas(results, SCAN_CHANGED) == 1 && firstStep < -50 && firstStep > -80;
+    for (int scan = 0; scan < 20; scan++) {
+        results.beginScan();
+        benchSeen(results, 1, -80);
+        benchSeen(results, 3, -70);
+        results.endScan();
+    }
+    results.sortByRssi();
+    ok = ok && abs(results[1].rssi + 80) < SCAN_RSSI_STEP && benchIndexOf(results, 3) == 0 && benchIndexOf(results, 1) == 1;
+
+    // A hidden SSID learned later is a change and is kept when the next scan hides it again
+    results.beginScan();
+    benchSeen(results, 4, -60, "");
+    results.endScan();
+    ok = ok && benchDeltas(results, SCAN_ADDED) == 1 && apSsidString(results[benchIndexOf(results, 4)]) == "<HIDDEN>";
+    results.beginScan();
+    benchSeen(results, 4, -60, "Found");
+    results.endScan();
+    results.beginScan();
+    benchSeen(results, 4, -60, "");
+    results.endScan();
+    ok = ok && apSsidString(results[benchIndexOf(results, 4)]) == "Found";
+
+    // Equal RSSI keeps the previous order, so rows do not swap back and forth
+    results.clear();
+    results.beginScan();
+    for (uint32_t id = 10; id < 14; id++) benchSeen(results, id, -60);
+    results.endScan();
+    for (int scan = 0; scan < 3 && ok; scan++) {
+        results.beginScan();
+        for (uint32_t id = 13; id >= 10; id--) benchSeen(results, id, -60);
+        results.endScan();
+        results.sortByRssi();
+        for (uint32_t id = 10; id < 14; id++) ok = ok && benchIndexOf(results, id) == (int)id - 10;
+    }
+
+    // A full table drops new APs, removed ones free their slots for the next
+    results.beginScan();
+    for (uint32_t id = 10; id < 20; id++) benchSeen(results, id, -60);
+    results.endScan();
+    ok = ok && results.size() == 8 && results.getDropped() == 2;
+    for (int scan = 0; scan < SCAN_MISSES_MAX; scan++) {
+        results.beginScan();
+        for (uint32_t id = 10; id < 14; id++) benchSeen(results, id, -60);
+        results.endScan();
+    }
+    results.beginScan();
+    for (uint32_t id = 10; id < 14; id++) benchSeen(results, id, -60);
+    for (uint32_t id = 30; id < 34; id++) benchSeen(results, id, -60);
+    results.endScan();
+    ok = ok && results.size() == 8 && results.getDropped() == 2 && benchIndexOf(results, 33) == 7;
+    return ok;
+}
+
+static void benchScanHistory() {
+    if (bench.enabled("scan_history")) bench.check(checkScanHistory(), "scan history slots, misses, deltas and smoothing");
+
+    // A city center scan every cycle: 500 APs, a few new ones, RSSI jumping around
+    static ScanResults results;
+    if (!bench.enabled("scan_history_merge_500") || !results.begin(BENCH_HISTORY_APS + 64)) return;
+    results.clear();
+    BenchResult* r = bench.run("scan_history_merge_500", 200, [](uint32_t ops) {
+        for (uint32_t cycle = 0; cycle < ops; cycle++) {
+            results.beginScan();
+            for (uint32_t i = 0; i < BENCH_HISTORY_APS; i++) {
+                uint32_t id = cycle * 10 + i;
+                benchSeen(results, id, -40 - (id * 37) % 50 - (id ^ cycle) % 5, "Bench Street", 1 + id % 13);
+            }
+            results.endScan();
+            results.sortByRssi();
+        }
+    });
+    if (r) {
+        r->extraKey = "tracked";
+        r->extraValue = results.size();
+    }
+    results.end();
+}
+
+// --- PCAP ---
+
+// The bench target is hidden, so its captures are "/capture/_HIDDEN__<millis>.pcapng"
+static void removeBenchCaptures() {
+    std::vector<FileEntry> files = sdManager.listDir("/capture");
+    for (const auto& f : files) {
+        if (!f.isDirectory && f.name.startsWith("_") && (f.name.endsWith(".pcapng") || f.name.endsWith(".hc22000"))) {
+            SD.remove("/capture/" + f.name);
+        }
+    }
+}
+
+static uint16_t benchLe16(const uint8_t* p) {
+    return p[0] | p[1] << 8;
+}
+
+static uint32_t benchLe32(const uint8_t* p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// pcapng reader written from the spec, not from pcapng_writer.cpp. It
+// rejects what Wireshark's reader rejects: bad block lengths or trailers,
+// options running past their block, missing end-of-options, non-zero
+// padding, packets longer than the snaplen or their original length.
+struct BenchPcapng {
+    File file;
+    bool sectionSeen = false;
+    uint32_t interfaces = 0;
+    uint16_t linktype = 0;
+    uint32_t snaplen = 0;
+    uint8_t tsresol = 6;
+    String ifName, hardware, application, comment;
+    String error;
+    uint8_t block[4096];
+};
+
+static bool benchPcapngFail(BenchPcapng& r, const String& error) {
+    r.error = error;
+    return false;
+}
+
+// Options from p to the trailer, strings copied out by code
+static bool benchPcapngOptions(BenchPcapng& r, const uint8_t* p, size_t len, uint32_t blockType) {
+    size_t i = 0;
+    while (i + 4 <= len) {
+        uint16_t code = benchLe16(p + i), length = benchLe16(p + i + 2);
+        size_t padded = (length + 3) & ~3u;
+        if (code == 0) return length == 0 && i + 4 == len ? true : benchPcapngFail(r, "option after end");
+        if (i + 4 + padded > len) return benchPcapngFail(r, "option past block");
+        for (size_t j = length; j < padded; j++) {
+            if (p[i + 4 + j] != 0) return benchPcapngFail(r, "option padding");
+        }
+        String value;
+        for (uint16_t j = 0; j < length; j++) value += (char)p[i + 4 + j];
+        if (code == 1) r.comment = value;
+        if (blockType == 0x0A0D0D0A && code == 2) r.hardware = value;
+        if (blockType == 0x0A0D0D0A && code == 4) r.application = value;
+        if (blockType == 1 && code == 2) r.ifName = value;
+        if (blockType == 1 && code == 9) r.tsresol = length == 1 ? p[i + 4] : 0xFF;
+        i += 4 + padded;
+    }
+    return len == 0 ? true : benchPcapngFail(r, "no end of options");
+}
+
+static bool benchPcapngOpen(BenchPcapng& r, const String& path) {
+    r.sectionSeen = false;
+    r.interfaces = r.snaplen = 0;
+    r.linktype = 0;
+    r.tsresol = 6;
+    r.ifName = r.hardware = r.application = r.comment = r.error = "";
+    r.file = SD.open(path, FILE_READ);
+    return r.file ? true : benchPcapngFail(r, "open");
+}
+
+// Next packet of the file, false at the end or on the first error
+static bool benchPcapngNext(BenchPcapng& r, uint64_t& timestamp, const uint8_t*& data, uint32_t& captured,
+                            uint32_t& original) {
+    for (;;) {
+        uint8_t head[8];
+        int n = r.file.read(head, 8);
+        if (n == 0) {
+            r.file.close();
+            return r.sectionSeen ? false : benchPcapngFail(r, "empty");
+        }
+        uint32_t type = benchLe32(head), length = benchLe32(head + 4);
+        if (n != 8 || length < 12 || length % 4 || length > sizeof(r.block)) return benchPcapngFail(r, "block length");
+        memcpy(r.block, head, 8);
+        if (r.file.read(r.block + 8, length - 8) != (size_t)(length - 8)) return benchPcapngFail(r, "truncated block");
+        if (benchLe32(r.block + length - 4) != length) return benchPcapngFail(r, "block trailer");
+        const uint8_t* b = r.block;
+
+        if (type == 0x0A0D0D0A) {
+            if (length < 28 || benchLe32(b + 8) != 0x1A2B3C4D) return benchPcapngFail(r, "byte order magic");
+            if (benchLe16(b + 12) != 1 || benchLe16(b + 14) != 0) return benchPcapngFail(r, "version");
+            r.sectionSeen = true;
+            r.interfaces = 0;
+            if (!benchPcapngOptions(r, b + 24, length - 28, type)) return false;
+            continue;
+        }
+        if (!r.sectionSeen) return benchPcapngFail(r, "no section header");
+        if (type == 1) {
+            if (length < 20) return benchPcapngFail(r, "interface length");
+            r.linktype = benchLe16(b + 8);
+            r.snaplen = benchLe32(b + 12);
+            r.tsresol = 6;
+            r.interfaces++;
+            if (!benchPcapngOptions(r, b + 16, length - 20, type)) return false;
+            continue;
+        }
+        if (type != 6) continue; // Blocks we don't read
+
+        if (length < 32) return benchPcapngFail(r, "packet length");
+        if (benchLe32(b + 8) >= r.interfaces) return benchPcapngFail(r, "unknown interface");
+        captured = benchLe32(b + 20);
+        original = benchLe32(b + 24);
+        size_t padded = (captured + 3) & ~3u;
+        if (captured > original || (r.snaplen && captured > r.snaplen)) return benchPcapngFail(r, "captured length");
+        if (28 + padded + 4 > length) return benchPcapngFail(r, "packet past block");
+        for (size_t j = captured; j < padded; j++) {
+            if (b[28 + j] != 0) return benchPcapngFail(r, "packet padding");
+        }
+        if (!benchPcapngOptions(r, b + 28 + padded, length - 32 - padded, type)) return false;
+        timestamp = (uint64_t)benchLe32(b + 12) << 32 | benchLe32(b + 16);
+        data = b + 28;
+        return true;
+    }
+}
+
+// Radiotap header fields, walked bit by bit with each field's alignment
+// and size from radiotap.org
+struct BenchRadiotap {
+    uint16_t length;
+    uint32_t present;
+    uint64_t tsft;
+    uint8_t flags, rate;
+    uint16_t frequency, channelFlags;
+    int8_t signal, noise;
+    uint8_t mcsKnown, mcsFlags, mcs;
+};
+
+static bool benchParseRadiotap(const uint8_t* p, uint32_t len, BenchRadiotap& out) {
+    static const uint8_t align[20] = {8, 1, 1, 2, 2, 1, 1, 2, 2, 2, 1, 1, 1, 1, 2, 2, 1, 1, 4, 1};
+    static const uint8_t size[20] = {8, 1, 1, 4, 2, 1, 1, 2, 2, 2, 1, 1, 1, 1, 2, 2, 1, 1, 8, 3};
+    memset(&out, 0, sizeof(out));
+    if (len < 8 || p[0] != 0 || p[1] != 0) return false;
+    out.length = benchLe16(p + 2);
+    out.present = benchLe32(p + 4);
+    if (out.length > len || (out.present & 0xFFF00000)) return false; // Extended bitmaps aren't used here
+    uint32_t o = 8;
+    for (int bit = 0; bit < 20; bit++) {
+        if (!(out.present & (1u << bit))) continue;
+        o = (o + align[bit] - 1) & ~(uint32_t)(align[bit] - 1);
+        if (o + size[bit] > out.length) return false;
+        const uint8_t* f = p + o;
+        switch (bit) {
+            case 0: out.tsft = benchLe32(f) | (uint64_t)benchLe32(f + 4) << 32; break;
+            case 1: out.flags = f[0]; break;
+            case 2: out.rate = f[0]; break;
+            case 3: out.frequency = benchLe16(f); out.channelFlags = benchLe16(f + 2); break;
+            case 5: out.signal = (int8_t)f[0]; break;
+            case 6: out.noise = (int8_t)f[0]; break;
+            case 19: out.mcsKnown = f[0]; out.mcsFlags = f[1]; out.mcs = f[2]; break;
+        }
+        o += size[bit];
+    }
+    return o == out.length;
+}
+
+static void benchPcap() {
+    if (!sdManager.isMounted() || !bench.enabled("pcap_write_eapol")) return;
+    buildFrames();
+
+    // Callback into the active block, the loop writes it out
+    static uint32_t appended;
+    appended = 0;
+    wifiModule.startHandshakeCapture();
+    BenchResult* r = bench.run("pcap_write_eapol", 50, [](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            WiFiModule::snifferCallback(eapolPkt, WIFI_PKT_DATA);
+            wifiModule.loop();
+        }
+        appended += ops;
+    });
+    wifiModule.stopHandshakeCapture();
+
+    // Every frame must be in the file, none lost to a full block
+    static BenchPcapng reader; // 4KB block buffer
+    uint32_t packets = 0;
+    std::vector<FileEntry> files = sdManager.listDir("/capture");
+    for (const auto& f : files) {
+        if (f.isDirectory || !f.name.startsWith("_") || !f.name.endsWith(".pcapng")) continue;
+        uint64_t ts, last = 0;
+        const uint8_t* data;
+        uint32_t captured, original;
+        bool ok = benchPcapngOpen(reader, "/capture/" + f.name);
+        while (ok && benchPcapngNext(reader, ts, data, captured, original)) {
+            ok = ts >= last && original == captured && captured > BENCH_EAPOL_LEN &&
+                 memcmp(data + captured - BENCH_EAPOL_LEN, eapolPkt + sizeof(wifi_promiscuous_pkt_t), BENCH_EAPOL_LEN) == 0;
+            last = ts;
+            packets++;
+        }
+        if (!ok && reader.error.length() == 0) reader.error = "frame mismatch";
+    }
+    bench.check(reader.error.length() == 0 && packets == appended,
+                "pcapng capture file (" + String(packets) + "/" + String(appended) + " packets" +
+                (reader.error.length() ? ", " + reader.error : String("")) + ")");
+    removeBenchCaptures();
+
+    if (r) {
+        wifi_pkt_rx_ctrl_t rx = ((wifi_promiscuous_pkt_t*)eapolPkt)->rx_ctrl;
+        r->extraKey = "kb_per_sec";
+        r->extraValue = enhancedPacketSize(rx, BENCH_EAPOL_LEN) * 1000000.0f / (r->usPerOp * 1024.0f);
+    }
+}
+
+// Encoder output against bytes worked out by hand from the pcapng and
+// radiotap specs, then the writer's blocks through the reader above
+static bool checkPcapngGolden() {
+    wifi_pkt_rx_ctrl_t rx = {};
+    rx.rssi = -42;
+    rx.rate = 0x0B;       // 6 Mbps OFDM
+    rx.noise_floor = -95;
+    rx.channel = 6;
+    rx.timestamp = 0x01020304;
+    const uint8_t frame[4] = {0xD4, 0x00, 0x00, 0x00}; // ACK stub, FCS left out
+    const uint8_t golden[60] = {
+        0x06, 0x00, 0x00, 0x00, 0x3C, 0x00, 0x00, 0x00,  // EPB, 60 bytes
+        0x00, 0x00, 0x00, 0x00,                          // Interface 0
+        0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,  // Timestamp high, low
+        0x1C, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00,  // Captured, original: 24 + 4
+        0x00, 0x00, 0x18, 0x00, 0x6F, 0x00, 0x00, 0x00,  // Radiotap v0, 24 bytes, TSFT flags rate channel signal noise
+        0x04, 0x03, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00,  // TSFT
+        0x10, 0x0C, 0x85, 0x09, 0xC0, 0x00, 0xD6, 0xA1,  // FCS, 6 Mbps, 2437 MHz, 2GHz OFDM, -42, -95
+        0xD4, 0x00, 0x00, 0x00,                          // Frame
+        0x3C, 0x00, 0x00, 0x00};                         // Trailer
+    uint8_t out[96];
+    size_t n = encodeEnhancedPacket(out, sizeof(out), 0x0000000100000002ULL, rx, frame, sizeof(frame));
+    if (n != sizeof(golden) || memcmp(out, golden, n) != 0 || enhancedPacketSize(rx, sizeof(frame)) != n) return false;
+    if (encodeEnhancedPacket(out, n - 1, 0, rx, frame, sizeof(frame)) != 0) return false;
+
+    // HT: MCS instead of rate, at its 1 byte alignment after the noise
+    rx.sig_mode = 1;
+    rx.mcs = 7;
+    rx.cwb = 1;
+    rx.sgi = 1;
+    rx.channel = 14;
+    BenchRadiotap rt;
+    n = encodeRadiotap(out, rx);
+    return n == 27 && benchParseRadiotap(out, n, rt) && rt.present == 0x8006B && rt.rate == 0 &&
+           rt.frequency == 2484 && rt.channelFlags == 0xC0 && rt.mcsKnown == 0x07 && rt.mcsFlags == 0x05 &&
+           rt.mcs == 7 && rt.signal == -42 && rt.noise == -95 && rt.flags == 0x10 && rt.tsft == 0x01020304;
+}
+
+static void benchPcapng() {
+    if (bench.enabled("pcapng")) bench.check(checkPcapngGolden(), "pcapng golden packet block");
+
+    // Writer without poll(): both blocks fill, then packets are dropped
+    if (sdManager.isMounted() && bench.enabled("pcapng")) {
+        static PcapngWriter writer;
+        static uint8_t frame[1500];
+        wifi_pkt_rx_ctrl_t rx = {};
+        rx.rssi = -60;
+        rx.noise_floor = -92;
+        uint32_t accepted = 0, sent = 0;
+        bool ok = writer.begin(BENCH_PCAPNG, BENCH_EPOCH_US);
+        for (; sent < 40; sent++) {
+            rx.channel = 1 + sent % 13;
+            rx.rate = sent % 16;
+            rx.sig_mode = sent % 3 == 0;
+            rx.mcs = sent % 8;
+            rx.timestamp = micros();
+            uint16_t len = 100 + sent * 97 % 1400;
+            for (uint16_t i = 0; i < len; i++) frame[i] = (uint8_t)(i + sent);
+            if (writer.append(rx, frame, len)) accepted++;
+#ifdef SIMULATOR
+            simAdvanceMicros(1000);
+#else
+            delayMicroseconds(1000);
+#endif
+        }
+        ok = ok && writer.getDropped() == sent - accepted && writer.getDropped() > 0 && writer.getWrites() == 0;
+        writer.poll();
+        ok = ok && writer.getWrites() == 1 && writer.append(rx, frame, 100);
+        accepted++;
+        writer.end();
+        ok = ok && writer.getErrors() == 0 && writer.getPackets() == accepted;
+
+        // What the reader makes of it: header fields, radiotap per packet, clock
+        static BenchPcapng reader;
+        uint64_t ts, first = 0, last = 0;
+        const uint8_t* data;
+        uint32_t captured, original, packets = 0;
+        ok = ok && benchPcapngOpen(reader, BENCH_PCAPNG);
+        while (ok && benchPcapngNext(reader, ts, data, captured, original)) {
+            BenchRadiotap rt;
+            ok = benchParseRadiotap(data, captured, rt) && (rt.flags & 0x10) && rt.signal == -60 && rt.noise == -92 &&
+                 rt.frequency >= 2412 && rt.frequency <= 2472 && (rt.frequency - 2407) % 5 == 0 &&
+                 (rt.mcsKnown != 0) == ((rt.present >> 19) & 1) && captured - rt.length >= 100 && ts >= last;
+            if (packets == 0) first = ts;
+            last = ts;
+            packets++;
+        }
+        ok = ok && reader.error.length() == 0 && packets == accepted && reader.linktype == 127 && reader.tsresol == 6 &&
+             reader.ifName == "esp32-wifi" && reader.hardware == "ESP32-S3" && reader.application == "ESP-Chain";
+        // Anchored to the epoch given to begin(), a millisecond or more between packets
+        ok = ok && first >= BENCH_EPOCH_US && first - BENCH_EPOCH_US < 1000000 && last - first >= 1000ULL * (packets - 1);
+        bench.check(ok, "pcapng writer blocks (" + String(packets) + " packets, " + String(writer.getDropped()) +
+                        " dropped" + (reader.error.length() ? ", " + reader.error : String("")) + ")");
+        SD.remove(BENCH_PCAPNG);
+    }
+
+    if (bench.enabled("pcapng_encode")) {
+        buildFrames();
+        BenchResult* r = bench.run("pcapng_encode", 5000, [](uint32_t ops) {
+            static uint8_t block[PCAPNG_BLOCK];
+            const wifi_promiscuous_pkt_t* pkt = (const wifi_promiscuous_pkt_t*)eapolPkt;
+            size_t used = 0;
+            for (uint32_t i = 0; i < ops; i++) {
+                size_t n = encodeEnhancedPacket(block + used, sizeof(block) - used, i, pkt->rx_ctrl, pkt->payload, BENCH_EAPOL_LEN);
+                used = n ? used + n : 0;
+            }
+        });
+#ifdef SIMULATOR
+        if (r) bench.check(r->allocsPerOp == 0, "pcapng encoding allocation-free");
+#endif
+        if (r) {
+            r->extraKey = "bytes_per_op";
+            r->extraValue = enhancedPacketSize(((wifi_promiscuous_pkt_t*)eapolPkt)->rx_ctrl, BENCH_EAPOL_LEN);
+        }
+    }
+}
+
+// --- Frame filter ---
+
+// Plans for each mix of consumers: driver masks and who gets which frame
+static bool checkFrameFilter() {
+    static FrameFilter filter;
+    const FrameNeeds handshakes = {{0, 0, FRAME_SUBTYPE(FRAME_DATA_SUBTYPE) | FRAME_SUBTYPE(FRAME_QOS_SUBTYPE)}};
+    const FrameNeeds stations = {{0, 0, FRAME_ALL_SUBTYPES}};
+    const FrameNeeds acks = {{FRAME_SUBTYPE(8), FRAME_SUBTYPE(13), 0}}; // Beacons and ACKs
+    const uint8_t beacon[1] = {0x80}, ack[1] = {0xD4}, rts[1] = {0xB4};
+    const uint8_t data[1] = {0x08}, qos[1] = {0x88}, null[1] = {0x48};
+
+    filter.plan();
+    bool ok = !filter.isActive() && filter.getFilterMask() == 0 && filter.dispatch(data) == 0;
+
+    filter.set(FRAME_HANDSHAKES, handshakes);
+    filter.plan();
+    ok = ok && filter.getFilterMask() == WIFI_PROMIS_FILTER_MASK_DATA && filter.getCtrlFilterMask() == 0;
+    ok = ok && filter.dispatch(data) == 1 << FRAME_HANDSHAKES && filter.dispatch(qos) == 1 << FRAME_HANDSHAKES &&
+         filter.dispatch(null) == 0 && filter.dispatch(beacon) == 0;
+
+    filter.set(FRAME_STATIONS, stations);
+    filter.plan();
+    uint8_t both = 1 << FRAME_HANDSHAKES | 1 << FRAME_STATIONS;
+    ok = ok && filter.getFilterMask() == WIFI_PROMIS_FILTER_MASK_DATA && filter.dispatch(qos) == both &&
+         filter.dispatch(null) == 1 << FRAME_STATIONS;
+
+    // Control subtypes narrow the control filter too; a beacon needs all of management
+    filter.set(FRAME_STATIONS, acks);
+    filter.plan();
+    ok = ok && filter.getFilterMask() == (WIFI_PROMIS_FILTER_MASK_MGMT | WIFI_PROMIS_FILTER_MASK_CTRL | WIFI_PROMIS_FILTER_MASK_DATA) &&
+         filter.getCtrlFilterMask() == WIFI_PROMIS_CTRL_FILTER_MASK_ACK && filter.dispatch(ack) == 1 << FRAME_STATIONS &&
+         filter.dispatch(rts) == 0 && filter.dispatch(beacon) == 1 << FRAME_STATIONS && filter.dispatch(null) == 0;
+
+    filter.clear(FRAME_STATIONS);
+    filter.clear(FRAME_HANDSHAKES);
+    filter.plan();
+    return ok && !filter.isActive() && filter.getFilterMask() == 0 && filter.dispatch(qos) == 0;
+}
+
+#ifdef SIMULATOR
+// A busy channel as the radio sees it: mostly beacons and control frames,
+// some data, one EAPOL frame in 64
+struct BenchAirFrame {
+    uint8_t frame[BENCH_EAPOL_LEN];
+    int len;
+    wifi_promiscuous_pkt_type_t type;
+};
+static BenchAirFrame benchAir[64];
+
+static void buildAirMix() {
+    const uint8_t* eapol = eapolPkt + sizeof(wifi_promiscuous_pkt_t);
+    const uint8_t* data = dataPkt + sizeof(wifi_promiscuous_pkt_t);
+    for (int i = 0; i < 64; i++) {
+        BenchAirFrame& a = benchAir[i];
+        memcpy(a.frame, data, BENCH_EAPOL_LEN);
+        a.len = BENCH_EAPOL_LEN;
+        a.type = WIFI_PKT_DATA;
+        int kind = i % 16;
+        if (i == 63) {
+            memcpy(a.frame, eapol, BENCH_EAPOL_LEN);
+        } else if (kind < 6) {
+            a.frame[0] = 0x80;                    // Beacon
+            a.type = WIFI_PKT_MGMT;
+        } else if (kind < 7) {
+            a.frame[0] = 0x40;                    // Probe request
+            a.type = WIFI_PKT_MGMT;
+        } else if (kind < 12) {
+            a.frame[0] = kind < 10 ? 0xD4 : kind < 11 ? 0xB4 : 0x94; // ACK, RTS, block ack
+            a.len = kind < 10 ? 10 : kind < 11 ? 16 : 32;
+            a.type = WIFI_PKT_CTRL;
+        } else if (kind < 13) {
+            a.frame[0] = 0x48;                    // Null data, power save
+        } else {
+            a.frame[0] = 0x88;                    // QoS data
+        }
+    }
+}
+
+static uint32_t benchAirCallbacks;
+
+// The handshake capture on the air mix, with its planned driver filter or
+// with the driver passing everything as before the filter existed
+static BenchResult* benchAirMix(const char* name, bool unfiltered) {
+    wifiModule.startHandshakeCapture();
+    if (unfiltered) {
+        wifi_promiscuous_filter_t all = {WIFI_PROMIS_FILTER_MASK_ALL};
+        esp_wifi_set_promiscuous_filter(&all);
+        all.filter_mask = WIFI_PROMIS_CTRL_FILTER_MASK_ALL;
+        esp_wifi_set_promiscuous_ctrl_filter(&all);
+    }
+    uint32_t before = simWifiRxCount();
+    static uint32_t frames;
+    frames = 0;
+    BenchResult* r = bench.run(name, 200, [](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            const BenchAirFrame& a = benchAir[i % 64];
+            simWifiInjectFrame(a.frame, a.len, a.type);
+        }
+        frames += ops;
+    });
+    benchAirCallbacks = simWifiRxCount() - before;
+    wifiModule.stopHandshakeCapture();
+    removeBenchCaptures();
+    if (r) {
+        r->extraKey = "callbacks_per_frame";
+        r->extraValue = frames ? (float)benchAirCallbacks / frames : 0;
+    }
+    return r;
+}
+#endif
+
+static void benchFrameFilter() {
+    if (bench.enabled("frame_filter")) bench.check(checkFrameFilter(), "frame filter plans");
+#ifdef SIMULATOR
+    if (!sdManager.isMounted() || !bench.enabled("sniffer_air_mix")) return;
+    buildFrames();
+    buildAirMix();
+    BenchResult* before = benchAirMix("sniffer_air_mix_unfiltered", true);
+    BenchResult* after = benchAirMix("sniffer_air_mix_filtered", false);
+    if (before && after) {
+        bench.check(after->extraValue < before->extraValue / 2,
+                    "frame filter callbacks (" + String(after->extraValue, 2) + " vs " + String(before->extraValue, 2) +
+                    " per frame)");
+    }
+#endif
+}
+
+// --- Channel usage ---
+
+// rx_ctrl of a received frame, the fields airtime depends on
+static wifi_pkt_rx_ctrl_t benchRx(uint8_t channel, uint32_t timestamp, uint16_t len, uint8_t rate, int mcs = -1,
+                                  bool wide = false, bool sgi = false) {
+    wifi_pkt_rx_ctrl_t rx = {};
+    rx.channel = channel;
+    rx.timestamp = timestamp;
+    rx.sig_len = len;
+    rx.rate = rate;
+    rx.rssi = -60;
+    rx.noise_floor = -95;
+    if (mcs >= 0) {
+        rx.sig_mode = 1;
+        rx.mcs = mcs;
+        rx.cwb = wide;
+        rx.sgi = sgi;
+    }
+    return rx;
+}
+
+// Durations worked out from the 802.11 TXTIME formulas (17.3.4, 19.4.3)
+static bool checkAirtimeVectors() {
+    return frameAirtimeUs(benchRx(1, 0, 100, 0x00), 100) == 992 &&        // 1M long preamble: 192 + 800
+           frameAirtimeUs(benchRx(1, 0, 1500, 0x07), 1500) == 1187 &&     // 11M short: 96 + ceil(12000 / 11)
+           frameAirtimeUs(benchRx(1, 0, 100, 0x0B), 100) == 166 &&        // 6M: 20 + 4 x 35 + 6
+           frameAirtimeUs(benchRx(1, 0, 1500, 0x0C), 1500) == 250 &&      // 54M: 20 + 4 x 56 + 6
+           frameAirtimeUs(benchRx(1, 0, 1500, 0, 7), 1500) == 230 &&      // MCS7 20MHz: 36 + 4 x 47 + 6
+           frameAirtimeUs(benchRx(1, 0, 1500, 0, 7, false, true), 1500) == 214 && // Short GI: 47 x 3.6 -> 172
+           frameAirtimeUs(benchRx(1, 0, 1500, 0, 7, true, true), 1500) == 126 &&  // 40MHz: 23 x 3.6 -> 84
+           frameAirtimeUs(benchRx(1, 0, 14, 0x09), 14) == 34;             // ACK at 24M: 20 + 4 x 2 + 6
+}
+
+struct BenchAirtimeFrame {
+    uint8_t channel;
+    uint32_t timestamp;
+    uint16_t len;
+    uint8_t rate;
+    int mcs;
+    bool wide, sgi;
+    uint8_t fc0, fc1;
+};
+
+// Two channels of traffic with overlapping estimates and retries. Channel 6
+// is 992 + 0 (inside the first) + 158 (past its end) + 214 + 126 + 1187 =
+// 2677us; channel 11 is 166 + 34 = 200us.
+static const BenchAirtimeFrame benchAirtimeFrames[] = {
+    {6, 1000, 100, 0x00, -1, false, false, 0x80, 0x00},  // Beacon, 1M
+    {6, 1500, 100, 0x0B, -1, false, false, 0x80, 0x00},  // Beacon, 6M, heard inside the last one
+    {6, 1900, 1500, 0x0C, -1, false, false, 0x08, 0x08}, // Data retry, 54M, overlaps by 92us
+    {6, 5000, 1500, 0x00, 7, false, true, 0x88, 0x01},   // QoS data, MCS7 short GI
+    {6, 6000, 1500, 0x00, 7, true, true, 0x88, 0x02},    // QoS data, MCS7 40MHz short GI
+    {6, 7000, 1500, 0x07, -1, false, false, 0x08, 0x01}, // Data, 11M short preamble
+    {11, 10000, 100, 0x0B, -1, false, false, 0x08, 0x09},// Data retry, 6M
+    {11, 10200, 14, 0x09, -1, false, false, 0xD4, 0x00}, // ACK, 24M
+};
+
+// Radiotap back to rx_ctrl, as the analyzer would have seen the frame
+static bool benchRxFromRadiotap(const BenchRadiotap& rt, uint32_t captured, wifi_pkt_rx_ctrl_t& rx) {
+    static const uint8_t units[16] = {2, 4, 11, 22, 0, 4, 11, 22, 96, 48, 24, 12, 108, 72, 36, 18};
+    rx = {};
+    rx.channel = (rt.frequency - 2407) / 5;
+    rx.timestamp = (uint32_t)rt.tsft;
+    rx.sig_len = captured - rt.length;
+    rx.rssi = rt.signal;
+    rx.noise_floor = rt.noise;
+    if (rt.present & (1u << 19)) {
+        rx.sig_mode = 1;
+        rx.mcs = rt.mcs;
+        rx.cwb = (rt.mcsFlags & 0x03) == 1;
+        rx.sgi = (rt.mcsFlags & 0x04) != 0;
+        return true;
+    }
+    for (uint8_t code = 0; code < 16; code++) {
+        bool shortPreamble = code >= 5 && code < 8;
+        if (units[code] == rt.rate && shortPreamble == ((rt.flags & 0x02) != 0)) {
+            rx.rate = code;
+            return true;
+        }
+    }
+    return false;
+}
+
+// The traffic above through the pcapng writer, read back and accounted
+static bool checkAirtimeReplay(String& detail) {
+    static PcapngWriter writer;
+    static uint8_t frame[1500];
+    if (!writer.begin(BENCH_AIRTIME, BENCH_EPOCH_US)) return false;
+    for (const BenchAirtimeFrame& f : benchAirtimeFrames) {
+        memset(frame, 0, f.len);
+        frame[0] = f.fc0;
+        frame[1] = f.fc1;
+        writer.append(benchRx(f.channel, f.timestamp, f.len, f.rate, f.mcs, f.wide, f.sgi), frame, f.len);
+    }
+    writer.end();
+
+    static AirtimeAnalyzer analyzer;
+    static BenchPcapng reader;
+    analyzer.clear();
+    analyzer.enter(6, 0);
+    uint64_t ts;
+    const uint8_t* data;
+    uint32_t captured, original, packets = 0;
+    bool ok = benchPcapngOpen(reader, BENCH_AIRTIME);
+    while (ok && benchPcapngNext(reader, ts, data, captured, original)) {
+        BenchRadiotap rt;
+        wifi_pkt_rx_ctrl_t rx;
+        ok = benchParseRadiotap(data, captured, rt) && benchRxFromRadiotap(rt, captured, rx);
+        if (ok) analyzer.account(rx, data + rt.length);
+        packets++;
+    }
+    SD.remove(BENCH_AIRTIME);
+    ok = ok && reader.error.length() == 0 && packets == sizeof(benchAirtimeFrames) / sizeof(benchAirtimeFrames[0]);
+
+    // A 250ms visit to channel 6, then what channel 11 holds
+    AirtimeSample sample;
+    AirtimeCounters eleven;
+    ok = ok && analyzer.leave(250, sample);
+    analyzer.read(11, eleven);
+    char row[AIRTIME_ROW_MAX];
+    ok = ok && formatAirtimeRow(sample, row, sizeof(row)) > 0;
+    detail = String(sample.delta.airtimeUs) + "/2677us, " + String(eleven.airtimeUs) + "/200us";
+    return ok && sample.delta.airtimeUs == 2677 && sample.utilization == 10 && sample.delta.mgmt == 2 &&
+           sample.delta.ctrl == 0 && sample.delta.data == 4 && sample.delta.retries == 1 &&
+           strcmp(row, "250,6,250,2677,1.0,6,2,0,4,1\n") == 0 && eleven.airtimeUs == 200 && eleven.ctrl == 1 &&
+           eleven.data == 1 && eleven.retries == 1 && analyzer.getUtilization(6) == 10 && analyzer.getFrames() == 6;
+}
+
+static void benchAirtime() {
+    if (bench.enabled("airtime")) {
+        bench.check(checkAirtimeVectors(), "airtime txtime vectors");
+        if (sdManager.isMounted()) {
+            String detail;
+            bool ok = checkAirtimeReplay(detail);
+            bench.check(ok, "airtime pcapng replay (" + detail + ")");
+        }
+    }
+
+    // Per frame cost in the callback, next to sniffer_air_mix_filtered
+    buildFrames();
+    BenchResult* r = bench.run("airtime_account", 5000, [](uint32_t ops) {
+        static AirtimeAnalyzer analyzer;
+        const wifi_promiscuous_pkt_t* pkt = (const wifi_promiscuous_pkt_t*)eapolPkt;
+        wifi_pkt_rx_ctrl_t rx = pkt->rx_ctrl;
+        rx.channel = 6;
+        rx.rate = 0x0B;
+        for (uint32_t i = 0; i < ops; i++) {
+            rx.timestamp = i * 200;
+            analyzer.account(rx, pkt->payload);
+        }
+    });
+#ifdef SIMULATOR
+    if (r) bench.check(r->allocsPerOp == 0, "airtime accounting allocation-free");
+#endif
+}
+
+// --- Probe log ---
+
+// Probe request from mac for ssid (wildcard when len is 0), rates element
+// after it, FCS zeroed. Returns the length as sig_len would have it.
+static uint16_t benchProbeFrame(uint8_t* f, const uint8_t* mac, const char* ssid, uint8_t len) {
+    memset(f, 0, 24);
+    f[0] = 0x40;
+    memset(f + 4, 0xFF, 6);
+    memcpy(f + 10, mac, 6);
+    memset(f + 16, 0xFF, 6);
+    uint16_t n = 24;
+    f[n++] = 0;
+    f[n++] = len;
+    memcpy(f + n, ssid, len);
+    n += len;
+    const uint8_t rates[6] = {0x01, 0x04, 0x02, 0x04, 0x0B, 0x16};
+    memcpy(f + n, rates, sizeof(rates));
+    n += sizeof(rates);
+    memset(f + n, 0, 4);
+    return n + 4;
+}
+
+static bool checkProbeParse() {
+    static const uint8_t mac[6] = {0x3c, 0x22, 0xfb, 0x01, 0x02, 0x03};
+    uint8_t f[96];
+    ProbeSighting p;
+    uint16_t len = benchProbeFrame(f, mac, "Airport_Free", 12);
+    bool ok = parseProbeRequest(f, len, p) && memcmp(p.mac, mac, 6) == 0 && p.ssidLen == 12 &&
+              memcmp(p.ssid, "Airport_Free", 12) == 0;
+    len = benchProbeFrame(f, mac, "", 0);
+    ok = ok && parseProbeRequest(f, len, p) && p.ssidLen == 0;
+    len = benchProbeFrame(f, mac, "Truncated", 9);
+    ok = ok && !parseProbeRequest(f, 24 + 2 + 4 + 4, p); // SSID element runs past the FCS
+    f[0] = 0x50;                                          // Probe response
+    return ok && !parseProbeRequest(f, len, p);
+}
+
+static bool checkInternTable() {
+    InternTable table;
+    if (!table.begin(4, 16)) return false;
+    uint32_t a = table.intern((const uint8_t*)"home", 4);
+    uint32_t b = table.intern((const uint8_t*)"work", 4);
+    uint32_t again = table.intern((const uint8_t*)"home", 4);
+    uint8_t len;
+    const uint8_t* key = table.get(b, len);
+    bool ok = a == 0 && b == 1 && again == 0 && key && len == 4 && memcmp(key, "work", 4) == 0 &&
+              table.find((const uint8_t*)"hom", 3) == PROBE_NO_ID && table.getArenaUsed() == 10;
+    // 10 of 16 arena bytes used: a 6 byte key no longer fits, a 5 byte one does
+    ok = ok && table.intern((const uint8_t*)"cafe-1", 6) == PROBE_NO_ID && table.intern((const uint8_t*)"cafe1", 5) == 2;
+    ok = ok && table.intern((const uint8_t*)"", 0) == PROBE_NO_ID && table.getDropped() == 2; // Arena full
+    table.clear();
+    ok = ok && table.getCount() == 0 && table.find((const uint8_t*)"home", 4) == PROBE_NO_ID &&
+         table.intern((const uint8_t*)"a", 1) == 0 && table.intern((const uint8_t*)"b", 1) == 1 &&
+         table.intern((const uint8_t*)"c", 1) == 2 && table.intern((const uint8_t*)"d", 1) == 3 &&
+         table.intern((const uint8_t*)"e", 1) == PROBE_NO_ID; // Four entries at most
+    table.end();
+    return ok;
+}
+
+// A street's worth of phones: BENCH_PROBE_CLIENTS MACs asking for a few
+// networks each out of BENCH_PROBE_NAMES, one in five a wildcard probe
+static void benchProbeSighting(uint32_t i, ProbeSighting& p) {
+    uint32_t client = i % BENCH_PROBE_CLIENTS;
+    p.mac[0] = 0xDA;
+    p.mac[1] = 0xA1;
+    p.mac[2] = 0x19;
+    p.mac[3] = client >> 16;
+    p.mac[4] = client >> 8;
+    p.mac[5] = client;
+    p.rssi = -40 - (int8_t)(i % 50);
+    p.channel = 1 + i % 13;
+    p.timeMs = i * 10;
+    if (i % 5 == 0) {
+        p.ssidLen = 0;
+        return;
+    }
+    uint32_t name = (client * 7 + i % 3) % BENCH_PROBE_NAMES;
+    p.ssidLen = snprintf((char*)p.ssid, sizeof(p.ssid), "%s-%u", name & 1 ? "FRITZ!Box 7590" : "Vodafone", name);
+}
+
+// Probes through the callback queue and the log, then the file decoded the
+// way an offline tool would: every probe back, its SSID defined before use
+static bool checkProbeLogReplay(String& detail) {
+    static ProbeHarvester harvester;
+    static ProbeLogWriter log;
+    if (!harvester.begin(PROBE_MIN_SSIDS, PROBE_MIN_CLIENTS) || !log.begin(BENCH_PROBES)) return false;
+    uint8_t f[96];
+    uint32_t csvBytes = 0;
+    for (uint32_t i = 0; i < BENCH_PROBE_COUNT; i++) {
+        ProbeSighting p;
+        benchProbeSighting(i, p);
+        wifi_pkt_rx_ctrl_t rx = {};
+        rx.rssi = p.rssi;
+        rx.channel = p.channel;
+        rx.sig_len = benchProbeFrame(f, p.mac, (const char*)p.ssid, p.ssidLen);
+        harvester.push(rx, f, p.timeMs);
+        if (i % 32 == 31) harvester.drain(&log);
+        // The same probe as a text row: time, MAC, RSSI, channel, SSID
+        csvBytes += 8 + 1 + 17 + 1 + 3 + 1 + 2 + 1 + p.ssidLen + 1;
+    }
+    harvester.drain(&log);
+    log.end();
+    uint32_t ssids = harvester.getSsids().getCount(), clients = harvester.getClients();
+    harvester.end();
+
+    File file = SD.open(BENCH_PROBES, FILE_READ);
+    if (!file) return false;
+    std::vector<uint8_t> data(file.size());
+    file.read(data.data(), data.size());
+    file.close();
+    SD.remove(BENCH_PROBES);
+
+    std::vector<String> names;
+    uint32_t pos = 8, probes = 0, checkpoints = 0;
+    bool ok = data.size() > 8 && memcmp(data.data(), PROBE_MAGIC, 8) == 0;
+    while (ok && pos < data.size()) {
+        const uint8_t* r = data.data() + pos;
+        if (r[0] == PROBE_TAG_CHECKPOINT) {
+            ok = benchLe32(r + 5) <= names.size() + 1 && benchLe32(r + 13) >= probes;
+            checkpoints++;
+            pos += PROBE_CHECKPOINT_LEN;
+        } else if (r[0] == PROBE_TAG_SSID) {
+            ok = benchLe32(r + 1) == names.size();
+            char name[33] = {};
+            memcpy(name, r + 6, std::min<uint8_t>(r[5], 32));
+            names.push_back(name);
+            pos += 6 + r[5];
+        } else if (r[0] == PROBE_TAG_PROBE) {
+            ProbeSighting p;
+            benchProbeSighting(probes++, p);
+            uint32_t id = benchLe32(r + 5);
+            ok = id < names.size() && benchLe32(r + 1) == p.timeMs && memcmp(r + 9, p.mac, 6) == 0 &&
+                 (int8_t)r[15] == p.rssi && r[16] == p.channel && names[id].length() == p.ssidLen &&
+                 memcmp(names[id].c_str(), p.ssid, p.ssidLen) == 0;
+            pos += PROBE_RECORD_LEN;
+        } else {
+            ok = false;
+        }
+    }
+    detail = String(probes) + " probes, " + String(names.size()) + " SSIDs, " + String(data.size()) + " bytes vs " +
+             String(csvBytes) + " as CSV";
+    return ok && pos == data.size() && probes == BENCH_PROBE_COUNT && names.size() == ssids &&
+           clients == BENCH_PROBE_CLIENTS && checkpoints == log.getWrites() && checkpoints > 1 && data.size() < csvBytes / 2;
+}
+
+// Distinct SSID-like keys for the intern cases, packed as length + bytes
+static std::vector<uint8_t> benchSsidKeys;
+static std::vector<uint32_t> benchSsidOffsets;
+
+static void buildSsidKeys() {
+    if (!benchSsidOffsets.empty()) return;
+    char name[33];
+    for (uint32_t i = 0; i < BENCH_PROBE_SSIDS; i++) {
+        int n = snprintf(name, sizeof(name), "%s_%05X", i % 3 ? "NETGEAR" : "eduroam-guest-", i * 2654435761u >> 12);
+        benchSsidOffsets.push_back(benchSsidKeys.size());
+        benchSsidKeys.push_back(n);
+        benchSsidKeys.insert(benchSsidKeys.end(), name, name + n);
+    }
+}
+
+static uint32_t benchInternKey(InternTable& table, uint32_t i, bool lookup) {
+    const uint8_t* key = benchSsidKeys.data() + benchSsidOffsets[i];
+    return lookup ? table.find(key + 1, key[0]) : table.intern(key + 1, key[0]);
+}
+
+static void benchProbes() {
+    if (bench.enabled("probe_log")) {
+        bench.check(checkProbeParse(), "probe request parse");
+        bench.check(checkInternTable(), "intern table ids and limits");
+        if (sdManager.isMounted()) {
+            String detail;
+            bool ok = checkProbeLogReplay(detail);
+            bench.check(ok, "probe log replay (" + detail + ")");
+        }
+    }
+
+    // Insert and lookup rates with the table filling up to BENCH_PROBE_SSIDS
+    static InternTable table;
+    if (!bench.enabled("probe_intern") && !bench.enabled("probe_lookup")) return;
+    if (!table.begin(BENCH_PROBE_SSIDS, BENCH_PROBE_SSIDS * 24)) {
+        bench.check(false, "probe intern table allocation");
+        return;
+    }
+    buildSsidKeys();
+    BenchResult* r = bench.run("probe_intern", BENCH_PROBE_SSIDS, [](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            uint32_t k = i % BENCH_PROBE_SSIDS;
+            if (k == 0) table.clear();
+            benchInternKey(table, k, false);
+        }
+    });
+    if (r) {
+        r->extraKey = "bytes_per_ssid";
+        r->extraValue = (float)table.getMemory() / BENCH_PROBE_SSIDS;
+    }
+
+    table.clear();
+    for (uint32_t i = 0; i < BENCH_PROBE_SSIDS; i++) benchInternKey(table, i, false);
+    bool found = table.getCount() == BENCH_PROBE_SSIDS;
+    for (uint32_t i = 0; i < BENCH_PROBE_SSIDS && found; i++) found = benchInternKey(table, i, true) == i;
+    bench.check(found, "probe intern " + String(BENCH_PROBE_SSIDS) + " SSIDs, all found");
+    bench.run("probe_lookup", BENCH_PROBE_SSIDS, [](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) benchInternKey(table, (i * 7919) % BENCH_PROBE_SSIDS, true);
+    });
+    table.end();
+}
+
+// --- Beacon generation ---
+
+static bool checkBeaconTemplate() {
+    static const uint8_t bssid[6] = {0x02, 0xEC, 0x00, 0x11, 0x22, 0x33};
+    static const uint8_t golden[] = {
+        0x80, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,       // Beacon to broadcast
+        0x02, 0xEC, 0x00, 0x11, 0x22, 0x33, 0x02, 0xEC, 0x00, 0x11, 0x22, 0x33, // SA, BSSID
+        0x00, 0x00, 0, 0, 0, 0, 0, 0, 0, 0,                                // Sequence, timestamp
+        0x64, 0x00, 0x01, 0x04,                                            // 100 TU, ESS + short slot
+        0x00, 0x03, 'L', 'a', 'b',
+        0x01, 0x08, 0x82, 0x84, 0x8B, 0x96, 0x24, 0x30, 0x48, 0x6C,
+        0x03, 0x01, 0x06,
+        0x05, 0x04, 0x00, 0x01, 0x00, 0x00};
+    uint8_t frame[BEACON_FRAME_MAX];
+    uint8_t channelOffset = 0;
+    size_t len = buildBeacon(frame, sizeof(frame), bssid, (const uint8_t*)"Lab", 3, 6, false, &channelOffset);
+    bool ok = len == sizeof(golden) && memcmp(frame, golden, len) == 0 && channelOffset == 53;
+    len = buildBeacon(frame, sizeof(frame), bssid, (const uint8_t*)"Lab", 3, 6, true);
+    ok = ok && len == sizeof(golden) + 22 && frame[34] == 0x11 && frame[60] == 0x30 && frame[81] == 0x00;
+    ok = ok && buildBeacon(frame, 59, bssid, (const uint8_t*)"Lab", 3, 6, false) == 0;
+
+    patchBeacon(frame, 0xABC, 0x0102030405060708ULL);
+    ok = ok && frame[22] == 0xC0 && frame[23] == 0xAB && frame[24] == 0x08 && frame[31] == 0x01;
+
+    // 32 byte SSIDs fit with RSN, BSSIDs are locally administered and differ per entry
+    BeaconPool pool;
+    pool.begin(4);
+    pool.fill("01234567890123456789012345678", 3, 1, true);
+    ok = ok && pool.size() == 3 && pool.get(0).len == 36 + 34 + 10 + 3 + 6 + 22 &&
+         (pool.get(0).frame[10] & 0x03) == 0x02 && memcmp(pool.get(0).frame + 10, pool.get(1).frame + 10, 6) != 0;
+    pool.setChannel(11);
+    ok = ok && pool.get(2).frame[pool.get(2).channelOffset] == 11;
+    ok = ok && &pool.next() == &pool.get(0) && &pool.next() == &pool.get(1) && &pool.next() == &pool.get(2) &&
+         &pool.next() == &pool.get(0);
+    pool.end();
+    return ok;
+}
+
+// A TX loop on a virtual clock, woken every tickUs, sending what the controller allows
+static uint32_t benchRateRun(TxRateController& rate, uint32_t& nowUs, uint32_t durationUs, uint32_t tickUs) {
+    uint32_t sent = 0;
+    for (uint32_t t = 0; t < durationUs; t += tickUs, nowUs += tickUs) {
+        for (uint32_t n = rate.ready(nowUs); n > 0; n--, sent++) rate.sent(true);
+    }
+    return sent;
+}
+
+static bool checkRateController(String& detail) {
+    TxRateController rate;
+    uint32_t now = 0xFFF00000; // Wraps during the run
+    rate.begin(100, now);
+    uint32_t sent = benchRateRun(rate, now, 3000000, 1000);
+    bool ok = sent == 300 && rate.getAchievedFps() == 100;
+    detail = String(sent) + "/300 at 100/s";
+
+    // Coarse wakeups still average out, up to the burst cap per wakeup. The
+    // first frame goes at once, then one per 1/rate up to the last wakeup.
+    rate.begin(1000, now);
+    sent = benchRateRun(rate, now, 3000000, 5000);
+    ok = ok && sent == 1 + 2995 && rate.getAchievedFps() == 1000;
+    detail += ", " + String(sent) + "/2996 at 1000/s";
+    rate.begin(5000, now);
+    sent = benchRateRun(rate, now, 1000000, 10000);
+    ok = ok && sent == 1 + 99 * BEACON_BURST;
+
+    // Idle time only buys a burst, refused frames still spend credit, waits are exact
+    rate.begin(100, now);
+    rate.sent(true);
+    now += 5000000;
+    ok = ok && rate.ready(now) == BEACON_BURST;
+    for (int i = 0; i < BEACON_BURST; i++) rate.sent(i % 2 == 0);
+    ok = ok && rate.ready(now) == 0 && rate.getFailed() == BEACON_BURST / 2 && rate.waitUs() == 10000;
+    now += 4000;
+    ok = ok && rate.ready(now) == 0 && rate.waitUs() == 6000;
+    return ok;
+}
+
+static void benchBeacons() {
+    if (bench.enabled("beacon_gen")) {
+        bench.check(checkBeaconTemplate(), "beacon template build and patch");
+        String detail;
+        bool ok = checkRateController(detail);
+        bench.check(ok, "beacon rate controller (" + detail + ")");
+#ifdef SIMULATOR
+        // The real sender on the virtual clock, polled like the module loop does without a task
+        static BeaconFlood flood;
+        flood.getPool().begin();
+        flood.getPool().fill("Bench", 8, 6, true);
+        uint32_t before = simWifiTxCount();
+        flood.start(250);
+        for (int i = 0; i < 2000; i++) {
+            simAdvanceMicros(1000);
+            flood.poll();
+        }
+        uint32_t frames = simWifiTxCount() - before;
+        uint32_t achieved = flood.getRate().getAchievedFps();
+        flood.stop();
+        flood.getPool().end();
+        bench.check(frames == 501 && achieved == 250,
+                    "beacon flood on the virtual clock (" + String(frames) + " frames, " + String(achieved) + "/s)");
+#endif
+    }
+
+    // Per frame work in the TX loop with the pool, against building every frame from scratch
+    static BeaconPool pool;
+    if (!pool.begin()) return;
+    pool.fill("Bench", BEACON_POOL_MAX, 6, true);
+    bench.run("beacon_template_patch", 10000, [](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            BeaconTemplate& t = pool.next();
+            patchBeacon(t.frame, t.seq, (uint64_t)i * 1024);
+            t.seq = (t.seq + 1) & 0x0FFF;
+        }
+    });
+    bench.run("beacon_build", 10000, [](uint32_t ops) {
+        static uint8_t frame[BEACON_FRAME_MAX];
+        uint8_t bssid[6];
+        for (uint32_t i = 0; i < ops; i++) {
+            const BeaconTemplate& t = pool.get(i % BEACON_POOL_MAX);
+            const uint8_t* ssid = t.frame + 38;
+            beaconBssid(bssid, ssid, t.frame[37], i % BEACON_POOL_MAX);
+            buildBeacon(frame, sizeof(frame), bssid, ssid, t.frame[37], 6, true);
+            patchBeacon(frame, i & 0x0FFF, (uint64_t)i * 1024);
+        }
+    });
+    pool.end();
+}
+
+// --- Handshake capture ---
+
+#define BENCH_KEY_M1 0x008A // Pairwise, ACK
+#define BENCH_KEY_M2 0x010A // Pairwise, MIC
+#define BENCH_KEY_M3 0x13CA // Pairwise, install, ACK, MIC, secure, encrypted key data
+#define BENCH_KEY_M4 0x030A // Pairwise, MIC, secure
+
+// 802.11 data frame carrying one EAPOL-Key message, returns its length
+// ANonce (AP) or SNonce (station), both made up from the sender's address
+static void benchNonce(uint8_t* out, const uint8_t* addr) {
+    for (int i = 0; i < 32; i++) out[i] = (uint8_t)(i * 31 + addr[0] + addr[5] * 7);
+}
+
+// 802.11 data frame carrying one EAPOL-Key message, returns its length. An
+// M1 given a PMKID carries it in a PMKID KDE.
+static int buildEapolFrame(uint8_t* f, const uint8_t* bssid, const uint8_t* sta, uint8_t message, uint64_t replay,
+                           bool qos, const uint8_t* pmkid = nullptr) {
+    bool fromAp = message == EAPOL_M1 || message == EAPOL_M3;
+    uint16_t info = message == EAPOL_M1 ? BENCH_KEY_M1 : message == EAPOL_M2 ? BENCH_KEY_M2
+                  : message == EAPOL_M3 ? BENCH_KEY_M3 : BENCH_KEY_M4;
+    uint16_t dataLength = message == EAPOL_M2 ? 22 : message == EAPOL_M3 ? 56 : pmkid ? 22 : 0; // RSN IE, wrapped GTK
+    int h = qos ? 26 : 24;
+    memset(f, 0, h + 8 + 4 + 95 + dataLength);
+    f[0] = qos ? 0x88 : 0x08;
+    f[1] = fromAp ? 0x02 : 0x01;
+    memcpy(&f[4], fromAp ? sta : bssid, 6);
+    memcpy(&f[10], fromAp ? bssid : sta, 6);
+    memcpy(&f[16], bssid, 6);
+    const uint8_t snapEapol[8] = {0xAA, 0xAA, 0x03, 0x00, 0x00, 0x00, 0x88, 0x8E};
+    memcpy(&f[h], snapEapol, 8);
+    uint8_t* e = f + h + 8;
+    e[0] = 0x02; e[1] = 0x03;
+    e[2] = (95 + dataLength) >> 8; e[3] = (95 + dataLength) & 0xFF;
+    uint8_t* k = e + 4;
+    k[0] = 0x02;
+    k[1] = info >> 8; k[2] = info & 0xFF;
+    k[4] = 16;                                                      // Key length
+    for (int i = 0; i < 8; i++) k[5 + i] = replay >> (56 - 8 * i);
+    if (message != EAPOL_M4) benchNonce(k + 13, fromAp ? bssid : sta);
+    if (message != EAPOL_M1) for (int i = 0; i < 16; i++) k[77 + i] = (uint8_t)(i * 17 + message);
+    k[93] = dataLength >> 8; k[94] = dataLength & 0xFF;
+    for (int i = 0; i < dataLength; i++) k[95 + i] = (uint8_t)(i + 0x30);
+    if (message == EAPOL_M1 && pmkid) {
+        const uint8_t kde[6] = {0xDD, 0x14, 0x00, 0x0F, 0xAC, 0x04};
+        memcpy(k + 95, kde, 6);
+        memcpy(k + 101, pmkid, 16);
+    }
+    return h + 8 + 4 + 95 + dataLength;
+}
+
+static void benchCaptureAddress(uint8_t* out, uint8_t kind, uint32_t i) {
+    out[0] = kind; out[1] = 0x0c; out[2] = 0x42;
+    out[3] = i >> 16; out[4] = i >> 8; out[5] = i;
+}
+
+static bool observeFrame(EapolTracker& tracker, const uint8_t* f, int len, uint32_t nowMs, EapolResult* result = nullptr) {
+    EapolKey key;
+    if (!parseEapolKey(f, len, key)) return false;
+    EapolResult r = tracker.observe(key, 1, nowMs);
+    if (result) *result = r;
+    return true;
+}
+
+static bool checkEapolSessions() {
+    uint8_t f[256], ap[6], sta[6];
+    benchCaptureAddress(ap, 0xa4, 1);
+    benchCaptureAddress(sta, 0x3c, 1);
+    EapolTracker tracker;
+    tracker.clear();
+    EapolResult r = EAPOL_PROGRESS;
+
+    // M1 + M2 share a replay counter
+    bool ok = observeFrame(tracker, f, buildEapolFrame(f, ap, sta, EAPOL_M1, 7, false), 1000, &r) && r == EAPOL_PROGRESS;
+    ok = ok && observeFrame(tracker, f, buildEapolFrame(f, ap, sta, EAPOL_M2, 7, true), 1010, &r) && r == EAPOL_COMPLETE;
+    const EapolSession* s = tracker.find(ap, sta);
+    ok = ok && s && s->pair == EAPOL_PAIR_M1M2 && tracker.getComplete() == 1;
+    ok = ok && observeFrame(tracker, f, buildEapolFrame(f, ap, sta, EAPOL_M3, 8, false), 1020, &r) && r == EAPOL_REPEAT;
+
+    // M2 + M3 one replay step later, M1 missed
+    benchCaptureAddress(sta, 0x3c, 2);
+    ok = ok && observeFrame(tracker, f, buildEapolFrame(f, ap, sta, EAPOL_M2, 3, false), 2000, &r) && r == EAPOL_PROGRESS;
+    ok = ok && observeFrame(tracker, f, buildEapolFrame(f, ap, sta, EAPOL_M3, 4, false), 2005, &r) && r == EAPOL_COMPLETE;
+    s = tracker.find(ap, sta);
+    ok = ok && s && s->pair == EAPOL_PAIR_M2M3;
+
+    // M1 and M2 of different exchanges, M3 and M4 alone: nothing crackable
+    benchCaptureAddress(sta, 0x3c, 3);
+    ok = ok && observeFrame(tracker, f, buildEapolFrame(f, ap, sta, EAPOL_M1, 10, false), 3000, &r) && r == EAPOL_PROGRESS;
+    ok = ok && observeFrame(tracker, f, buildEapolFrame(f, ap, sta, EAPOL_M2, 12, false), 3010, &r) && r == EAPOL_PROGRESS;
+    benchCaptureAddress(sta, 0x3c, 4);
+    ok = ok && observeFrame(tracker, f, buildEapolFrame(f, ap, sta, EAPOL_M3, 20, false), 3000, &r) && r == EAPOL_PROGRESS;
+    ok = ok && observeFrame(tracker, f, buildEapolFrame(f, ap, sta, EAPOL_M4, 20, false), 3010, &r) && r == EAPOL_PROGRESS;
+    ok = ok && tracker.getComplete() == 2 && tracker.getInProgress(3010) == 2;
+
+    // An M2 long after its M1 belongs to another exchange
+    benchCaptureAddress(sta, 0x3c, 5);
+    ok = ok && observeFrame(tracker, f, buildEapolFrame(f, ap, sta, EAPOL_M1, 30, false), 4000, &r) && r == EAPOL_PROGRESS;
+    ok = ok && observeFrame(tracker, f, buildEapolFrame(f, ap, sta, EAPOL_M2, 30, false), 4000 + EAPOL_EXCHANGE_MS + 1, &r) &&
+         r == EAPOL_PROGRESS;
+    ok = ok && tracker.getInProgress(4000 + 2 * EAPOL_EXCHANGE_MS + 2) == 0;
+
+    // Frames that are not handshake messages
+    int len = buildEapolFrame(f, ap, sta, EAPOL_M1, 1, false);
+    EapolKey key;
+    f[1] |= 0x40;                                             // Protected
+    ok = ok && !parseEapolKey(f, len, key);
+    len = buildEapolFrame(f, ap, sta, EAPOL_M2, 1, false);
+    f[1] = 0x02;                                              // M2 can't come from the AP
+    ok = ok && !parseEapolKey(f, len, key);
+    len = buildEapolFrame(f, ap, sta, EAPOL_M3, 1, false);
+    ok = ok && !parseEapolKey(f, len - 1, key);               // Truncated key data
+    ok = ok && !parseEapolKey(dataPkt + sizeof(wifi_promiscuous_pkt_t), BENCH_FRAME_LEN, key);
+    return ok;
+}
+
+// Handshakes of aps APs with two stations each, the first station's
+// exchange missing M1 and every third AP's second station mismatched
+static uint32_t writeHandshakePcap(const char* path, uint32_t aps, bool pcapng = false) {
+    static PcapngWriter writer;
+    File file;
+    if (pcapng) {
+        if (!writer.begin(path, BENCH_EPOCH_US)) return 0;
+    } else {
+        file = SD.open(path, FILE_WRITE);
+        if (!file) return 0;
+        const uint32_t header[6] = {0xa1b2c3d4, 0x00040002, 0, 0, 65535, 105};
+        file.write((const uint8_t*)header, sizeof(header));
+    }
+
+    uint8_t f[256], ap[6], sta[6];
+    uint32_t expected = 0, ms = 0;
+    for (uint32_t i = 0; i < aps; i++) {
+        benchCaptureAddress(ap, 0xa4, i);
+        for (uint32_t n = 0; n < 2; n++) {
+            benchCaptureAddress(sta, 0x3c, i * 2 + n);
+            bool mismatched = n == 1 && i % 3 == 0;
+            for (uint8_t m = n == 0 ? 1 : 0; m < 4; m++) {
+                uint64_t replay = 100 + i + (m >= 2) + (mismatched && m == 1 ? 5 : 0);
+                int len = buildEapolFrame(f, ap, sta, 1 << m, replay, m & 1);
+                ms += 3;
+                if (pcapng) {
+                    // As the radio hands it over: FCS on the end, the clock moving on
+                    wifi_pkt_rx_ctrl_t rx = {};
+                    rx.channel = 1;
+                    rx.rssi = -50;
+                    memset(f + len, 0, 4);
+                    writer.append(rx, f, len + 4);
+                    writer.poll();
+#ifdef SIMULATOR
+                    simAdvanceMicros(3000);
+#else
+                    delayMicroseconds(3000);
+#endif
+                    continue;
+                }
+                const uint32_t rec[4] = {ms / 1000, (ms % 1000) * 1000, (uint32_t)len, (uint32_t)len};
+                file.write((const uint8_t*)rec, sizeof(rec));
+                file.write(f, len);
+            }
+            // Mismatched M1/M2 with no good M2/M3 either
+            if (!mismatched) expected++;
+        }
+    }
+    if (pcapng) {
+        writer.end();
+        return writer.getDropped() == 0 ? expected : 0;
+    }
+    file.close();
+    return expected;
+}
+
+// Feeds a classic pcap or a pcapng of 802.11 frames (with or without
+// radiotap) through a tracker, using the capture timestamps. With lines,
+// ESSIDs are learnt from beacons and probe responses and every hashcat line
+// the capture path would write is collected. False when it isn't either.
+static bool replayPcap(const String& path, EapolTracker& tracker, std::vector<String>* lines = nullptr) {
+    File file = SD.open(path, FILE_READ);
+    if (!file) return false;
+    uint32_t header[6];
+    bool isPcapng = file.read((uint8_t*)header, sizeof(header)) == sizeof(header) && header[0] == 0x0A0D0D0A;
+    if (!isPcapng && (header[0] != 0xa1b2c3d4 || (header[5] != 105 && header[5] != 127))) {
+        file.close();
+        return false;
+    }
+    static uint8_t frame[4096];
+    static char line[HC22000_LINE_MAX];
+    std::vector<APInfo> essids;
+
+    auto feed = [&](const uint8_t* f, int len, uint32_t ms) {
+        if (lines && len >= 38 && (f[0] == 0x80 || f[0] == 0x50) && f[36] == 0 && f[37] > 0 && f[37] <= 32 &&
+            38 + f[37] <= len) {
+            bool known = false;
+            for (const APInfo& ap : essids) known = known || memcmp(ap.bssid, f + 16, 6) == 0;
+            if (!known) {
+                APInfo ap = {};
+                memcpy(ap.bssid, f + 16, 6);
+                ap.ssidLen = f[37];
+                memcpy(ap.ssid, f + 38, ap.ssidLen);
+                essids.push_back(ap);
+            }
+            return;
+        }
+
+        EapolKey key;
+        if (!parseEapolKey(f, len, key)) return;
+        uint32_t pmkids = tracker.getPmkids();
+        EapolResult result = tracker.observe(key, 1, ms);
+        if (!lines) return;
+        const APInfo* ap = nullptr;
+        for (const APInfo& e : essids) {
+            if (memcmp(e.bssid, key.bssid, 6) == 0) ap = &e;
+        }
+        if (!ap) return;
+        if (tracker.getPmkids() != pmkids &&
+            formatPmkidLine(*tracker.getLast(), (const uint8_t*)ap->ssid, ap->ssidLen, line, sizeof(line))) {
+            lines->push_back(line);
+        }
+        if (result == EAPOL_COMPLETE &&
+            formatHandshakeLine(*tracker.getLast(), (const uint8_t*)ap->ssid, ap->ssidLen, line, sizeof(line))) {
+            lines->push_back(line);
+        }
+    };
+
+    if (isPcapng) {
+        file.close();
+        static BenchPcapng reader;
+        uint64_t ts;
+        const uint8_t* data;
+        uint32_t captured, original;
+        if (!benchPcapngOpen(reader, path)) return false;
+        while (benchPcapngNext(reader, ts, data, captured, original)) {
+            int offset = 0, len = captured;
+            if (reader.linktype == 127) {
+                BenchRadiotap rt;
+                if (!benchParseRadiotap(data, captured, rt)) continue;
+                offset = rt.length;
+                if (rt.flags & 0x10) len -= 4; // FCS
+            } else if (reader.linktype != 105) {
+                continue;
+            }
+            uint64_t ms = reader.tsresol == 6 ? ts / 1000 : reader.tsresol == 9 ? ts / 1000000 : ts;
+            if (len > offset) feed(data + offset, len - offset, (uint32_t)ms);
+        }
+        if (reader.error.length()) Serial.println("Replay " + path + ": " + reader.error);
+        return reader.error.length() == 0;
+    }
+
+    uint32_t rec[4];
+    while (file.read((uint8_t*)rec, sizeof(rec)) == sizeof(rec)) {
+        if (rec[2] > sizeof(frame) || file.read(frame, rec[2]) != (size_t)rec[2]) break;
+        int offset = 0;
+        if (header[5] == 127) offset = rec[2] >= 4 ? frame[2] | frame[3] << 8 : rec[2]; // Radiotap length
+        if (offset >= (int)rec[2]) continue;
+        feed(frame + offset, rec[2] - offset, rec[0] * 1000 + rec[1] / 1000);
+    }
+    file.close();
+    return true;
+}
+
+// SHA-1 and what WPA2-PSK builds on it, to check exported lines the way
+// hashcat does: PBKDF2 for the PMK, the PRF for the KCK, HMAC for the MIC
+struct BenchSha1 {
+    uint32_t h[5];
+    uint8_t block[64];
+    uint64_t bytes;
+
+    void begin() {
+        const uint32_t init[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+        memcpy(h, init, sizeof(h));
+        bytes = 0;
+    }
+
+    void compress() {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) w[i] = block[i * 4] << 24 | block[i * 4 + 1] << 16 | block[i * 4 + 2] << 8 | block[i * 4 + 3];
+        for (int i = 16; i < 80; i++) {
+            uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+            w[i] = x << 1 | x >> 31;
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+            uint32_t t = (a << 5 | a >> 27) + f + e + k + w[i];
+            e = d; d = c; c = b << 30 | b >> 2; b = a; a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    void add(const uint8_t* data, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            block[bytes++ % 64] = data[i];
+            if (bytes % 64 == 0) compress();
+        }
+    }
+
+    void finish(uint8_t* out) {
+        uint64_t bits = bytes * 8;
+        uint8_t pad = 0x80;
+        add(&pad, 1);
+        pad = 0;
+        while (bytes % 64 != 56) add(&pad, 1);
+        for (int i = 7; i >= 0; i--) {
+            uint8_t b = bits >> (i * 8);
+            add(&b, 1);
+        }
+        for (int i = 0; i < 20; i++) out[i] = h[i / 4] >> (24 - 8 * (i % 4));
+    }
+};
+
+// Keys up to 64 bytes, all WPA2 ever uses here
+static void hmacSha1(const uint8_t* key, size_t keyLen, const uint8_t* data, size_t len, uint8_t* out) {
+    uint8_t pad[64], inner[20];
+    BenchSha1 sha;
+    for (int i = 0; i < 64; i++) pad[i] = (i < (int)keyLen ? key[i] : 0) ^ 0x36;
+    sha.begin();
+    sha.add(pad, 64);
+    sha.add(data, len);
+    sha.finish(inner);
+    for (int i = 0; i < 64; i++) pad[i] ^= 0x36 ^ 0x5C;
+    sha.begin();
+    sha.add(pad, 64);
+    sha.add(inner, 20);
+    sha.finish(out);
+}
+
+static void wpaPmk(const char* passphrase, const uint8_t* essid, uint8_t essidLen, uint8_t* pmk) {
+    uint8_t salt[36], u[20], t[20];
+    memcpy(salt, essid, essidLen);
+    for (uint8_t blockIndex = 1; blockIndex <= 2; blockIndex++) {
+        salt[essidLen] = salt[essidLen + 1] = salt[essidLen + 2] = 0;
+        salt[essidLen + 3] = blockIndex;
+        hmacSha1((const uint8_t*)passphrase, strlen(passphrase), salt, essidLen + 4, u);
+        memcpy(t, u, 20);
+        for (int i = 1; i < 4096; i++) {
+            hmacSha1((const uint8_t*)passphrase, strlen(passphrase), u, 20, u);
+            for (int j = 0; j < 20; j++) t[j] ^= u[j];
+        }
+        memcpy(pmk + (blockIndex - 1) * 20, t, blockIndex == 1 ? 20 : 12);
+    }
+}
+
+static void wpaPmkid(const uint8_t* pmk, const uint8_t* ap, const uint8_t* sta, uint8_t* pmkid) {
+    uint8_t data[20], out[20];
+    memcpy(data, "PMK Name", 8);
+    memcpy(data + 8, ap, 6);
+    memcpy(data + 14, sta, 6);
+    hmacSha1(pmk, 32, data, 20, out);
+    memcpy(pmkid, out, 16);
+}
+
+// First 16 bytes of the PTK
+static void wpaKck(const uint8_t* pmk, const uint8_t* ap, const uint8_t* sta, const uint8_t* anonce,
+                   const uint8_t* snonce, uint8_t* kck) {
+    uint8_t data[100], out[20];
+    memcpy(data, "Pairwise key expansion", 23); // With its terminator
+    bool apFirst = memcmp(ap, sta, 6) < 0;
+    memcpy(data + 23, apFirst ? ap : sta, 6);
+    memcpy(data + 29, apFirst ? sta : ap, 6);
+    bool anonceFirst = memcmp(anonce, snonce, 32) < 0;
+    memcpy(data + 35, anonceFirst ? anonce : snonce, 32);
+    memcpy(data + 67, anonceFirst ? snonce : anonce, 32);
+    data[99] = 0;
+    hmacSha1(pmk, 32, data, 100, out);
+    memcpy(kck, out, 16);
+}
+
+// Puts the real MIC into a frame from buildEapolFrame
+static void signEapolFrame(uint8_t* f, int len, bool qos, const uint8_t* kck) {
+    uint8_t* e = f + (qos ? 26 : 24) + 8;
+    uint8_t mic[20];
+    memset(e + 81, 0, 16);
+    hmacSha1(kck, 16, e, len - (e - f), mic);
+    memcpy(e + 81, mic, 16);
+}
+
+static int hexValue(char c) {
+    return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+}
+
+// Splits a 22000 line into its nine fields, hex fields decoded
+static bool parseHashLine(const String& line, std::vector<std::vector<uint8_t>>& fields) {
+    fields.assign(1, std::vector<uint8_t>());
+    int start = line.indexOf('*');
+    if (!line.startsWith("WPA*") || start < 0) return false;
+    for (unsigned int i = start + 1; i < line.length() && line[i] != '\n'; i++) {
+        if (line[i] == '*') {
+            fields.push_back(std::vector<uint8_t>());
+            continue;
+        }
+        int hi = hexValue(line[i]), lo = i + 1 < line.length() ? hexValue(line[i + 1]) : -1;
+        if (hi < 0 || lo < 0) return false;
+        fields.back().push_back(hi << 4 | lo);
+        i++;
+    }
+    return fields.size() == 8 && fields[0].size() == 1 && fields[1].size() == 16 && fields[2].size() == 6 &&
+           fields[3].size() == 6 && !fields[4].empty();
+}
+
+// True when passphrase cracks the line: PMKIDs are recomputed, handshakes
+// have M2's MIC recomputed from the ANonce and the EAPOL frame. Only
+// HMAC-SHA1 MICs (key descriptor version 2) are checked.
+static bool verifyHashLine(const String& line, const char* passphrase) {
+    std::vector<std::vector<uint8_t>> f;
+    if (!parseHashLine(line, f)) return false;
+    uint8_t pmk[32], out[16];
+    wpaPmk(passphrase, f[4].data(), f[4].size(), pmk);
+    if (f[0][0] == 1) {
+        wpaPmkid(pmk, f[2].data(), f[3].data(), out);
+        return f[5].empty() && f[6].empty() && memcmp(out, f[1].data(), 16) == 0;
+    }
+    if (f[0][0] != 2 || f[5].size() != 32 || f[6].size() < 99 || f[7].size() != 1) return false;
+    std::vector<uint8_t>& eapol = f[6];
+    if ((eapol[6] & 0x07) != 2) return false;
+    for (int i = 81; i < 97; i++) {
+        if (eapol[i]) return false; // MIC must be zeroed
+    }
+    uint8_t kck[16], mic[20];
+    wpaKck(pmk, f[2].data(), f[3].data(), f[5].data(), eapol.data() + 17, kck);
+    hmacSha1(kck, 16, eapol.data(), eapol.size(), mic);
+    return memcmp(mic, f[1].data(), 16) == 0;
+}
+
+// A beacon, then for each of aps APs: an M1 with the real PMKID, a
+// station completing M1/M2 and another M2/M3, all signed with the
+// passphrase. Every AP should give three lines that crack.
+static void writeReferencePcap(const char* path, uint32_t aps) {
+    File file = SD.open(path, FILE_WRITE);
+    if (!file) return;
+    const uint32_t header[6] = {0xa1b2c3d4, 0x00040002, 0, 0, 65535, 105};
+    file.write((const uint8_t*)header, sizeof(header));
+
+    uint8_t f[256], ap[6], sta[6], pmk[32], pmkid[16], kck[16], anonce[32], snonce[32];
+    wpaPmk(BENCH_PASSPHRASE, (const uint8_t*)BENCH_ESSID, strlen(BENCH_ESSID), pmk);
+    uint32_t ms = 0;
+    auto record = [&](int len) {
+        ms += 5;
+        const uint32_t rec[4] = {ms / 1000, (ms % 1000) * 1000, (uint32_t)len, (uint32_t)len};
+        file.write((const uint8_t*)rec, sizeof(rec));
+        file.write(f, len);
+    };
+    for (uint32_t i = 0; i < aps; i++) {
+        benchCaptureAddress(ap, 0x02, i);
+        memset(f, 0, sizeof(f));
+        f[0] = 0x80;                                            // Beacon
+        memset(&f[4], 0xFF, 6);
+        memcpy(&f[10], ap, 6);
+        memcpy(&f[16], ap, 6);
+        f[37] = strlen(BENCH_ESSID);
+        memcpy(&f[38], BENCH_ESSID, f[37]);
+        record(38 + f[37]);
+
+        benchNonce(anonce, ap);
+        benchCaptureAddress(sta, 0x3e, i * 3);
+        wpaPmkid(pmk, ap, sta, pmkid);
+        record(buildEapolFrame(f, ap, sta, EAPOL_M1, 1, false, pmkid));
+
+        for (uint32_t n = 1; n <= 2; n++) {
+            benchCaptureAddress(sta, 0x3e, i * 3 + n);
+            benchNonce(snonce, sta);
+            wpaKck(pmk, ap, sta, anonce, snonce, kck);
+            for (uint8_t m = n == 1 ? EAPOL_M1 : EAPOL_M2; m <= EAPOL_M3; m <<= 1) {
+                bool qos = n == 2;
+                int len = buildEapolFrame(f, ap, sta, m, 1 + (m == EAPOL_M3), qos);
+                if (m != EAPOL_M1) signEapolFrame(f, len, qos, kck);
+                record(len);
+            }
+        }
+    }
+    file.close();
+}
+
+// Handshakes spread over the targets' channels. A client answers M1 after
+// 20-1200ms (slow supplicants, retries); M3 and M4 follow within a few ms.
+struct BenchExchange {
+    uint32_t startMs;
+    uint16_t replyMs;
+    uint8_t ap;
+};
+
+static const uint8_t benchCaptureChannels[CAPTURE_MAX_TARGETS] = {1, 1, 1, 1, 1, 1, 6, 6, 6, 6, 6, 11, 11, 11, 3, 9};
+
+static std::vector<BenchExchange> buildExchanges(uint32_t durationMs) {
+    std::vector<BenchExchange> out;
+    uint32_t seed = 0x5eed;
+    for (uint32_t t = 0; t < durationMs;) {
+        seed = seed * 1103515245 + 12345;
+        t += 200 + (seed >> 8) % 1600;                       // ~60 attempts a minute over all targets
+        out.push_back({t, (uint16_t)(20 + (seed >> 4) % 1180), (uint8_t)((seed >> 16) % CAPTURE_MAX_TARGETS)});
+    }
+    return out;
+}
+
+// Runs a schedule over the exchanges in 10ms loop ticks. A message is heard
+// only while the schedule sits on its AP's channel.
+static uint32_t simulateSchedule(CaptureSchedule mode, const std::vector<BenchExchange>& exchanges, uint32_t durationMs) {
+    static EapolTracker tracker;
+    ChannelSchedule schedule;
+    tracker.clear();
+    schedule.begin(mode);
+    for (uint8_t i = 0; i < CAPTURE_MAX_TARGETS; i++) schedule.addTarget(benchCaptureChannels[i]);
+
+    struct Message { uint32_t ms; uint8_t ap; uint8_t message; uint32_t exchange; };
+    std::vector<Message> messages;
+    messages.reserve(exchanges.size() * 4);
+    for (uint32_t i = 0; i < exchanges.size(); i++) {
+        const BenchExchange& x = exchanges[i];
+        messages.push_back({x.startMs, x.ap, EAPOL_M1, i});
+        messages.push_back({x.startMs + x.replyMs, x.ap, EAPOL_M2, i});
+        messages.push_back({x.startMs + x.replyMs + 4, x.ap, EAPOL_M3, i});
+        messages.push_back({x.startMs + x.replyMs + 8, x.ap, EAPOL_M4, i});
+    }
+    std::sort(messages.begin(), messages.end(), [](const Message& a, const Message& b) { return a.ms < b.ms; });
+
+    uint8_t f[256], ap[6], sta[6];
+    size_t next = 0;
+    for (uint32_t now = 0; now < durationMs; now += 10) {
+        bool hopped;
+        uint8_t channel = schedule.update(now, hopped);
+        for (; next < messages.size() && messages[next].ms < now + 10; next++) {
+            const Message& m = messages[next];
+            if (benchCaptureChannels[m.ap] != channel) continue;
+            benchCaptureAddress(ap, 0xa4, m.ap);
+            benchCaptureAddress(sta, 0x3c, m.exchange); // A new client every time
+            uint64_t replay = 1 + (m.message >= EAPOL_M3);
+            EapolKey key;
+            if (!parseEapolKey(f, buildEapolFrame(f, ap, sta, m.message, replay, false), key)) continue;
+            if (tracker.observe(key, channel, m.ms) == EAPOL_PROGRESS) schedule.onProgress(channel, m.ms);
+        }
+    }
+    return tracker.getComplete();
+}
+
+static size_t benchFileSize(const char* path) {
+    File f = SD.open(path, FILE_READ);
+    if (!f) return 0;
+    size_t size = f.size();
+    f.close();
+    return size;
+}
+
+// The writer as the sniffer callback uses it: lines wait in the ring until
+// poll(), and a full ring drops instead of blocking
+static bool checkHashWriter(uint8_t frames[2][256], const int* lengths) {
+    static EapolTracker tracker;
+    static Hc22000Writer writer;
+    const uint8_t* essid = (const uint8_t*)BENCH_ESSID;
+    SD.remove(BENCH_HASHES);
+    tracker.clear();
+    if (!writer.begin(BENCH_HASHES)) return false;
+
+    EapolKey key;
+    for (int m = 0; m < 2; m++) {
+        if (!parseEapolKey(frames[m], lengths[m], key)) return false;
+        uint32_t pmkids = tracker.getPmkids();
+        EapolResult result = tracker.observe(key, 1, 0);
+        if (tracker.getPmkids() != pmkids) writer.writePmkid(*tracker.getLast(), essid, strlen(BENCH_ESSID));
+        if (result == EAPOL_COMPLETE) writer.writeHandshake(*tracker.getLast(), essid, strlen(BENCH_ESSID));
+    }
+    bool ok = writer.getPmkids() == 1 && writer.getHandshakes() == 1;
+    writer.poll();
+    size_t written = benchFileSize(BENCH_HASHES);
+    ok = ok && written > 0;
+
+    const EapolSession& session = *tracker.getLast();
+    for (int i = 0; i < HC22000_QUEUE_LINES; i++) writer.writeHandshake(session, essid, strlen(BENCH_ESSID));
+    ok = ok && writer.getDropped() == 1 && benchFileSize(BENCH_HASHES) == written;
+    writer.end();
+    ok = ok && benchFileSize(BENCH_HASHES) > written && writer.getErrors() == 0;
+    SD.remove(BENCH_HASHES);
+    return ok;
+}
+
+static void benchHandshakes() {
+    buildFrames();
+    if (bench.enabled("eapol")) bench.check(checkEapolSessions(), "eapol session tracking");
+
+    // Replays: the synthetic capture must give exactly its handshakes
+    if (sdManager.isMounted() && bench.enabled("eapol")) {
+        static EapolTracker tracker;
+        tracker.clear();
+        uint32_t expected = writeHandshakePcap(BENCH_HANDSHAKES, 24);
+        bool ok = replayPcap(BENCH_HANDSHAKES, tracker);
+        bench.check(ok && expected == 40 && tracker.getComplete() == expected && tracker.getInProgress(UINT32_MAX) == 0,
+                    "eapol pcap replay (" + String(tracker.getComplete()) + "/" + String(expected) + ")");
+        SD.remove(BENCH_HANDSHAKES);
+
+        // Same exchanges through the firmware's pcapng writer and back
+        tracker.clear();
+        expected = writeHandshakePcap(BENCH_PCAPNG, 24, true);
+        ok = replayPcap(BENCH_PCAPNG, tracker);
+        bench.check(ok && expected == 40 && tracker.getComplete() == expected,
+                    "eapol pcapng replay (" + String(tracker.getComplete()) + "/" + String(expected) + ")");
+        SD.remove(BENCH_PCAPNG);
+
+        // IEEE 802.11i test vector, so the checks below don't just agree with themselves
+        uint8_t pmk[32];
+        const uint8_t pmkExpected[8] = {0xf4, 0x2c, 0x6f, 0xc5, 0x2d, 0xf0, 0xeb, 0xef};
+        wpaPmk("password", (const uint8_t*)"IEEE", 4, pmk);
+        bench.check(memcmp(pmk, pmkExpected, 8) == 0 && pmk[31] == 0x2e, "wpa pmk test vector");
+
+        // Exported lines must crack with the right passphrase and only with it
+        std::vector<String> lines;
+        tracker.clear();
+        writeReferencePcap(BENCH_REFERENCE, 4);
+        ok = replayPcap(BENCH_REFERENCE, tracker, &lines) && lines.size() == 12;
+        uint32_t cracked = 0, pmkidLines = 0;
+        for (const String& line : lines) {
+            if (verifyHashLine(line, BENCH_PASSPHRASE)) cracked++;
+            if (line.startsWith("WPA*01*")) pmkidLines++;
+            ok = ok && line.endsWith("\n") && !verifyHashLine(line, "wrong-passphrase");
+        }
+        bench.check(ok && cracked == lines.size() && pmkidLines == 4,
+                    "hc22000 lines crack (" + String(cracked) + "/" + String(lines.size()) + ")");
+        bench.check(lines.size() > 2 && lines[1].endsWith("*00\n") && lines[2].endsWith("*02\n") &&
+                    lines[0].endsWith("***\n"), "hc22000 message pairs");
+        SD.remove(BENCH_REFERENCE);
+
+        // Real captures: a line per usable handshake, checked when the passphrase is known
+        std::vector<FileEntry> files = sdManager.listDir(BENCH_PCAPS_DIR);
+        for (const auto& file : files) {
+            if (file.isDirectory || !(file.name.endsWith(".pcap") || file.name.endsWith(".cap") || file.name.endsWith(".pcapng"))) continue;
+            String path = String(BENCH_PCAPS_DIR) + "/" + file.name;
+            lines.clear();
+            tracker.clear();
+            if (!replayPcap(path, tracker, &lines)) continue;
+            Serial.println("Replay " + file.name + ": " + String(tracker.getComplete()) + " handshakes, " +
+                           String(tracker.getPmkids()) + " PMKIDs, " + String(lines.size()) + " lines from " +
+                           String(tracker.getFrames()) + " EAPOL frames");
+
+            File psk = SD.open(path.substring(0, path.lastIndexOf('.')) + ".psk", FILE_READ);
+            if (!psk) continue;
+            String passphrase = psk.readStringUntil('\n');
+            psk.close();
+            passphrase.trim();
+            cracked = 0;
+            for (const String& line : lines) {
+                if (verifyHashLine(line, passphrase.c_str())) cracked++;
+            }
+            bench.check(cracked > 0 && cracked == lines.size(),
+                        "hc22000 " + file.name + " (" + String(cracked) + "/" + String(lines.size()) + " crack)");
+        }
+    }
+
+    bench.run("eapol_parse_observe", 5000, [](uint32_t ops) {
+        static EapolTracker tracker;
+        tracker.clear();
+        const uint8_t* f = eapolPkt + sizeof(wifi_promiscuous_pkt_t);
+        EapolKey key;
+        for (uint32_t i = 0; i < ops; i++) {
+            if (parseEapolKey(f, BENCH_EAPOL_LEN, key)) tracker.observe(key, 1, i);
+        }
+    });
+
+    // Capture path from frame to hashcat line: M1 with a PMKID, then M2
+    if (bench.enabled("hc22000_extract")) {
+        static uint8_t frames[2][256];
+        static int lengths[2];
+        uint8_t ap[6], sta[6], pmkid[16];
+        benchCaptureAddress(ap, 0x02, 1);
+        benchCaptureAddress(sta, 0x3e, 1);
+        for (int i = 0; i < 16; i++) pmkid[i] = 0xA0 + i;
+        lengths[0] = buildEapolFrame(frames[0], ap, sta, EAPOL_M1, 1, false, pmkid);
+        lengths[1] = buildEapolFrame(frames[1], ap, sta, EAPOL_M2, 1, true);
+        if (sdManager.isMounted()) bench.check(checkHashWriter(frames, lengths), "hc22000 lines queue until poll");
+        BenchResult* r = bench.run("hc22000_extract", 2000, [](uint32_t ops) {
+            static EapolTracker tracker;
+            static char line[HC22000_LINE_MAX];
+            const uint8_t* essid = (const uint8_t*)BENCH_ESSID;
+            tracker.clear();
+            for (uint32_t i = 0; i < ops; i++) {
+                // A new station every exchange so each one exports both lines
+                frames[0][9] = frames[1][15] = i;
+                frames[0][8] = frames[1][14] = i >> 8;
+                EapolKey key;
+                for (int m = 0; m < 2; m++) {
+                    if (!parseEapolKey(frames[m], lengths[m], key)) continue;
+                    uint32_t pmkids = tracker.getPmkids();
+                    EapolResult result = tracker.observe(key, 1, i);
+                    if (tracker.getPmkids() != pmkids) formatPmkidLine(*tracker.getLast(), essid, strlen(BENCH_ESSID), line, sizeof(line));
+                    if (result == EAPOL_COMPLETE) formatHandshakeLine(*tracker.getLast(), essid, strlen(BENCH_ESSID), line, sizeof(line));
+                }
+            }
+        });
+#ifdef SIMULATOR
+        if (r) bench.check(r->allocsPerOp == 0, "hc22000 extraction allocation-free");
+#endif
+        if (r) {
+            r->extraKey = "lines_per_op";
+            r->extraValue = 2;
+        }
+    }
+
+    // Same traffic, both schedules: yield per minute is what they're compared on
+    if (!bench.enabled("capture_schedule")) return;
+    uint32_t durationMs = BENCH_CAPTURE_MIN * 60000;
+    std::vector<BenchExchange> exchanges = buildExchanges(durationMs);
+    uint32_t yield[2];
+    const char* names[2] = {"capture_schedule_round_robin", "capture_schedule_adaptive"};
+    for (int mode = SCHEDULE_ROUND_ROBIN; mode <= SCHEDULE_ADAPTIVE; mode++) {
+        yield[mode] = simulateSchedule((CaptureSchedule)mode, exchanges, durationMs);
+        BenchResult* r = bench.run(names[mode], 1, [&](uint32_t ops) {
+            for (uint32_t i = 0; i < ops; i++) simulateSchedule((CaptureSchedule)mode, exchanges, durationMs);
+        });
+        if (r) {
+            r->extraKey = "yield_per_min";
+            r->extraValue = (float)yield[mode] / BENCH_CAPTURE_MIN;
+        }
+    }
+    bench.check(yield[SCHEDULE_ADAPTIVE] > yield[SCHEDULE_ROUND_ROBIN],
+                "adaptive schedule yield (" + String(yield[SCHEDULE_ADAPTIVE]) + " vs " +
+                String(yield[SCHEDULE_ROUND_ROBIN]) + " of " + String(exchanges.size()) + ")");
+}
+
+// --- SubGHz ---
+
+// EV1527 style remote: 5ms gap, sync, 24 bits, repeated, with +-20us jitter
+static std::vector<uint32_t> buildPulseTrain(size_t count) {
+    std::vector<uint32_t> pulses;
+    randomSeed(1527);
+    uint32_t code = 0xA5C3E1;
+    pulses.push_back(5000);
+    while (pulses.size() < count) {
+        pulses.push_back(350);
+        pulses.push_back(10850);
+        for (int bit = 23; bit >= 0; bit--) {
+            bool one = (code >> bit) & 1;
+            pulses.push_back(one ? 1050 : 350);
+            pulses.push_back(one ? 350 : 1050);
+        }
+    }
+    pulses.resize(count);
+    for (auto& p : pulses) p = p + random(41) - 20;
+    return pulses;
+}
+
+static void benchPulseCodec() {
+    std::vector<uint32_t> pulses = buildPulseTrain(4096);
+    std::vector<uint8_t> encoded(pulses.size() * PULSE_VARINT_MAX);
+    std::vector<uint32_t> decoded(pulses.size());
+
+    PulseEncoder encoder;
+    size_t len = 0;
+    for (uint32_t p : pulses) len += encoder.encode(p, &encoded[len]);
+
+    // Decode in odd sized chunks so varints straddle the boundaries, like SD reads
+    PulseDecoder decoder;
+    size_t count = 0;
+    for (size_t off = 0; off < len; off += 61) {
+        count += decoder.decode(&encoded[off], std::min<size_t>(61, len - off), &decoded[count], decoded.size() - count);
+    }
+    bench.check(count == pulses.size() && !decoder.isPartial() && decoded == pulses, "pulse codec round trip");
+
+    // Extremes: zero, max, and sign flips between consecutive same-level pulses
+    const uint32_t edge[] = {0, 0xFFFFFFFF, 1, 0x80000000, 0x7FFFFFFF, 0, 15, 0xFFFFFFFF};
+    uint8_t buf[sizeof(edge) / sizeof(edge[0]) * PULSE_VARINT_MAX];
+    encoder.reset();
+    len = 0;
+    for (uint32_t v : edge) len += encoder.encode(v, buf + len);
+    uint32_t out[sizeof(edge) / sizeof(edge[0])];
+    decoder.reset();
+    count = decoder.decode(buf, len, out, sizeof(edge) / sizeof(edge[0]));
+    bench.check(count == sizeof(edge) / sizeof(edge[0]) && memcmp(out, edge, sizeof(edge)) == 0, "pulse codec extremes");
+
+    BenchResult* r = bench.run("pulse_encode", 65536, [&](uint32_t ops) {
+        encoder.reset();
+        size_t n = 0;
+        for (uint32_t i = 0; i < ops; i++) {
+            if (n + PULSE_VARINT_MAX > encoded.size()) n = 0;
+            n += encoder.encode(pulses[i % pulses.size()], &encoded[n]);
+        }
+    });
+    if (r) {
+        encoder.reset();
+        len = 0;
+        for (uint32_t p : pulses) len += encoder.encode(p, &encoded[len]);
+        r->extraKey = "bytes_per_pulse";
+        r->extraValue = (float)len / pulses.size();
+    }
+
+    bench.run("pulse_decode", 65536, [&](uint32_t ops) {
+        uint32_t d;
+        uint32_t done = 0;
+        while (done < ops) {
+            decoder.reset();
+            for (size_t i = 0; i < len && done < ops; i++) {
+                if (decoder.feed(encoded[i], d)) done++;
+            }
+        }
+    });
+}
+
+struct BenchPulse {
+    uint32_t us;
+    bool level;
+};
+
+// Manchester frame (te = 500us) after a gap, as the demodulator would see it
+static void appendManchester(std::vector<BenchPulse>& out, uint32_t value, int bits) {
+    const uint32_t te = 500;
+    out.push_back({8000, false});
+    for (int i = bits - 1; i >= 0; i--) {
+        bool one = (value >> i) & 1;
+        bool halves[2] = {!one, one}; // Low to high is 1
+        for (bool level : halves) {
+            if (out.back().level == level) out.back().us += te;
+            else out.push_back({te, level});
+        }
+    }
+}
+
+// Recorded captures from the bench SD if there are any, otherwise the
+// synthetic EV1527 train plus Manchester frames
+static std::vector<BenchPulse> loadDecoderInput(String& source) {
+    std::vector<BenchPulse> out;
+    if (sdManager.isMounted()) {
+        std::vector<FileEntry> files = sdManager.listDir(BENCH_CAPTURES_DIR);
+        for (const auto& f : files) {
+            if (f.isDirectory || !f.name.endsWith(PULSE_FILE_EXT)) continue;
+            PulseFileReader reader;
+            if (!reader.open(String(BENCH_CAPTURES_DIR) + "/" + f.name)) continue;
+            BenchPulse p;
+            while (reader.next(p.us, p.level)) out.push_back(p);
+            reader.close();
+        }
+    }
+    if (!out.empty()) {
+        source = "recorded";
+        return out;
+    }
+
+    source = "synthetic";
+    std::vector<uint32_t> train = buildPulseTrain(20000);
+    for (size_t i = 0; i < train.size(); i++) out.push_back({train[i], i % 2 == 1});
+    for (int i = 0; i < 50; i++) appendManchester(out, 0xDEADBEEF, 32);
+    out.push_back({8000, false});
+    return out;
+}
+
+static void benchDecoder() {
+    if (!bench.enabled("ook_decode")) return;
+    ProtocolDecoder decoder;
+
+    // Known answers
+    std::vector<uint32_t> train = buildPulseTrain(2000);
+    for (size_t i = 0; i < train.size(); i++) decoder.feed(train[i], i % 2 == 1);
+    DecodedCode code;
+    bench.check(decoder.getResults(&code, 1) == 1 && code.code == 0xA5C3E1 && code.bits == 24 &&
+                String(code.protocol->name) == "PT2262/EV1527", "ook decode EV1527");
+
+    std::vector<BenchPulse> manchester;
+    manchester.push_back({8000, false});
+    appendManchester(manchester, 0xDEADBEEF, 32);
+    manchester.push_back({8000, false});
+    decoder.reset();
+    for (const auto& p : manchester) decoder.feed(p.us, p.level);
+    bench.check(decoder.getResults(&code, 1) == 1 && code.code == 0xDEADBEEF && code.bits == 32 &&
+                String(code.protocol->name) == "Manchester", "ook decode Manchester");
+
+    // Throughput: one op is one pulse, ops_per_sec is the sustainable edge rate
+    String source;
+    std::vector<BenchPulse> input = loadDecoderInput(source);
+    Serial.println("# Decoder input: " + String(input.size()) + " " + source + " pulses");
+    decoder.reset();
+    BenchResult* r = bench.run("ook_decode_pulse", input.size(), [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            const BenchPulse& p = input[i % input.size()];
+            decoder.feed(p.us, p.level);
+        }
+    });
+    if (r) {
+        decoder.reset();
+        for (const auto& p : input) decoder.feed(p.us, p.level);
+        r->extraKey = "frames_decoded";
+        r->extraValue = decoder.getDecoded();
+    }
+
+    // Latency: one op is a whole EV1527 frame, the gap pulse triggers the decode
+    std::vector<uint32_t> frame(train.begin() + 3, train.begin() + 3 + 50);
+    bench.run("ook_decode_frame", 1000, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            for (size_t j = 0; j < frame.size(); j++) decoder.feed(frame[j], j % 2 == 0);
+        }
+    });
+}
+
+#ifdef SIMULATOR
+// Whole capture path: GDO0 edges through the ISR, ring, glitch filter,
+// encoder and SD. Needs the simulated pin, a real radio is not involved.
+static void benchSignalCapture() {
+    if (!sdManager.isMounted() || !bench.enabled("subghz_capture_edge")) return;
+
+    std::vector<uint32_t> pulses = buildPulseTrain(20000);
+    SignalCapture capture;
+
+    auto record = [&](uint32_t count) {
+        simSetPinInput(BENCH_GDO0_PIN, LOW);
+        capture.start(BENCH_CAPTURE_FILE, BENCH_GDO0_PIN, 433920, 2);
+        int level = LOW;
+        for (uint32_t i = 0; i < count; i++) {
+            simAdvanceMicros(pulses[i % pulses.size()]);
+            level = !level;
+            simSetPinInput(BENCH_GDO0_PIN, level);
+            if ((i & 255) == 255) capture.poll(); // Module loop cadence, well inside the ring
+        }
+        capture.stop();
+    };
+
+    BenchResult* r = bench.run("subghz_capture_edge", 20000, [&](uint32_t ops) { record(ops); });
+
+    // Read the last pass back and compare
+    record(pulses.size());
+    CaptureStats stats = capture.getStats();
+    File f = SD.open(BENCH_CAPTURE_FILE, FILE_READ);
+    PulseFileHeader header;
+    bool ok = f && f.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == PULSE_FILE_MAGIC && header.firstLevel == LOW &&
+              header.pulseCount == pulses.size() && header.droppedEdges == 0;
+    std::vector<uint32_t> decoded(pulses.size() + 1);
+    PulseDecoder decoder;
+    size_t count = 0;
+    uint8_t buf[512];
+    size_t n;
+    while (ok && (n = f.read(buf, sizeof(buf))) > 0) {
+        count += decoder.decode(buf, n, &decoded[count], decoded.size() - count);
+    }
+    f.close();
+    decoded.resize(count);
+    bench.check(ok && decoded == pulses, "signal capture read back");
+    SD.remove(BENCH_CAPTURE_FILE);
+
+    if (r) {
+        r->extraKey = "bytes_per_pulse";
+        r->extraValue = (float)stats.bytesWritten / stats.pulses;
+    }
+}
+
+// Chunk scheduler and file reader against the simulated RMT sink. The
+// recorded waveform is compared with the file to check the error stats.
+static void benchSignalReplay() {
+    if (!sdManager.isMounted() || !bench.enabled("subghz_replay_file")) return;
+
+    // Some idle gaps longer than one RMT item can hold
+    std::vector<uint32_t> pulses = buildPulseTrain(20000);
+    for (size_t i = 0; i < pulses.size(); i += 2000) pulses[i] = 100000;
+
+    PulseFileHeader header = {};
+    header.magic = PULSE_FILE_MAGIC;
+    header.version = PULSE_FILE_VERSION;
+    header.headerSize = sizeof(header);
+    header.frequencyKhz = 433920;
+    header.modulation = 2;
+    header.firstLevel = LOW;
+    header.resolutionNs = 1000;
+    header.pulseCount = pulses.size();
+    File f = SD.open(BENCH_REPLAY_FILE, FILE_WRITE);
+    f.write((const uint8_t*)&header, sizeof(header));
+    PulseEncoder encoder;
+    uint8_t buf[PULSE_VARINT_MAX];
+    for (uint32_t p : pulses) f.write(buf, encoder.encode(p, buf));
+    f.close();
+
+    SimPulseSink sink;
+    SignalReplay replay;
+    BenchResult* r = bench.run("subghz_replay_file", 1, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) replay.start(BENCH_REPLAY_FILE, &sink);
+    });
+
+    replay.start(BENCH_REPLAY_FILE, &sink);
+    ReplayStats stats = replay.getStats();
+    const std::vector<SimPulse>& wave = sink.getWaveform();
+    bool ok = stats.pulses == pulses.size() && wave.size() == pulses.size() && stats.handOvers > 0;
+    int64_t drift = 0;
+    uint32_t maxError = 0;
+    for (size_t i = 0; ok && i < pulses.size(); i++) {
+        int32_t error = (int32_t)(wave[i].us - pulses[i]);
+        ok = wave[i].level == (i % 2 == 1) && (wave[i].level == LOW || error == 0);
+        drift += error;
+        maxError = std::max<uint32_t>(maxError, error < 0 ? -error : error);
+    }
+    bench.check(ok, "signal replay waveform");
+    bench.check(ok && drift == stats.driftUs && maxError == stats.maxErrorUs, "signal replay error stats");
+    SD.remove(BENCH_REPLAY_FILE);
+
+    if (r) {
+        r->extraKey = "max_error_us";
+        r->extraValue = stats.maxErrorUs;
+    }
+}
+#endif
+
+// --- Wardriving ---
+
+static void benchBssid(uint32_t i, uint8_t* out) {
+    // Two vendor OUIs, like a street of ISP routers
+    out[0] = i & 1 ? 0x3C : 0xA4;
+    out[1] = 0x37;
+    out[2] = 0x12;
+    out[3] = i >> 16;
+    out[4] = i >> 8;
+    out[5] = i;
+}
+
+static void appendUbx(std::vector<uint8_t>& out, uint8_t cls, uint8_t id, const uint8_t* payload, uint16_t len) {
+    size_t start = out.size();
+    out.push_back(0xB5);
+    out.push_back(0x62);
+    out.push_back(cls);
+    out.push_back(id);
+    out.push_back(len & 0xFF);
+    out.push_back(len >> 8);
+    out.insert(out.end(), payload, payload + len);
+    uint8_t a = 0, b = 0;
+    for (size_t i = start + 2; i < out.size(); i++) {
+        a += out[i];
+        b += a;
+    }
+    out.push_back(a);
+    out.push_back(b);
+}
+
+static void putU32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = v >> (8 * i);
+}
+
+static void benchWardrive() {
+    if (!bench.enabled("wardrive")) return;
+
+    // UBX NAV-PVT behind some NMEA, split so the frame straddles two reads
+    uint8_t pvt[92] = {};
+    pvt[4] = 2024 & 0xFF;
+    pvt[5] = 2024 >> 8;
+    pvt[6] = 2;
+    pvt[7] = 29;
+    pvt[8] = 12;
+    pvt[9] = 34;
+    pvt[10] = 56;
+    pvt[11] = 0x07;  // Date, time, fully resolved
+    pvt[20] = 3;     // 3D
+    pvt[21] = 0x01;  // gnssFixOK
+    pvt[23] = 11;
+    putU32(pvt + 24, (uint32_t)-41234567);
+    putU32(pvt + 28, 521234567);
+    putU32(pvt + 36, 12400);
+    putU32(pvt + 40, 3500);
+    const char* nmea = "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74\r\n";
+    std::vector<uint8_t> stream(nmea, nmea + strlen(nmea));
+    appendUbx(stream, 0x01, 0x07, pvt, sizeof(pvt));
+    stream.insert(stream.end(), nmea, nmea + strlen(nmea));
+    GpsReader gps;
+    gps.feed(stream.data(), 40);
+    gps.feed(stream.data() + 40, stream.size() - 40);
+    GeoFix fix;
+    bench.check(gps.getFix(fix) && fix.latE7 == 521234567 && fix.lonE7 == -41234567 && fix.altitudeM == 12 &&
+                fix.accuracyDm == 35 && fix.satellites == 11 && fix.unixTime == 1709210096 &&
+                gps.getUbxFrames() == 1, "gps ubx nav-pvt");
+
+    ApSighting ap = {};
+    benchBssid(0x0ABBCC, ap.bssid);
+    strcpy(ap.ssid, "Cafe, \"Free\"");
+    ap.ssidLen = strlen(ap.ssid);
+    ap.authMode = WIFI_AUTH_WPA2_PSK;
+    ap.channel = 6;
+    ap.rssi = -67;
+    ap.firstSeen = fix.unixTime;
+    ap.fix = fix;
+    char row[WIGLE_ROW_MAX];
+    size_t len = formatWigleRow(ap, row, sizeof(row));
+    bench.check(len == strlen(row) && String(row) == "a4:37:12:0a:bb:cc,\"Cafe, \"\"Free\"\"\",[WPA2-PSK-CCMP][ESS],"
+                "2024-02-29 12:34:56,6,-67,52.1234567,-4.1234567,12,3.5,WIFI\n", "wigle csv row");
+
+    // Dedupe: only new or stronger sightings are queued for the CSV
+    BssidTable table;
+    table.begin(1024);
+    uint8_t bssid[6];
+    benchBssid(1, bssid);
+    fix.timestampMs = 0;
+    bool dedupeOk = table.observe(bssid, "a", 1, 0, 1, -80, fix) == SIGHTING_NEW &&
+                    table.observe(bssid, "a", 1, 0, 1, -85, fix) == SIGHTING_SEEN &&
+                    table.observe(bssid, "a", 1, 0, 1, -70, fix) == SIGHTING_STRONGER &&
+                    table.getDirtyCount() == 1 && table.find(bssid)->rssi == -70;
+    table.drainDirty([](const ApSighting&) {});
+    dedupeOk = dedupeOk && table.observe(bssid, "a", 1, 0, 1, -75, fix) == SIGHTING_SEEN && table.getDirtyCount() == 0;
+
+    // Eviction: fill past the load limit, half of it stale, and check every fresh entry is still found
+    table.clear();
+    for (uint32_t i = 0; i < 800; i++) {
+        benchBssid(i, bssid);
+        fix.timestampMs = i < 400 ? 0 : WARDRIVE_EVICT_AGE_MS;
+        table.observe(bssid, "x", 1, 0, 1, -60, fix);
+    }
+    table.drainDirty([](const ApSighting&) {});
+    bool evictOk = table.evict(WARDRIVE_EVICT_AGE_MS + 1) == 400 && table.getCount() == 400;
+    for (uint32_t i = 0; i < 800 && evictOk; i++) {
+        benchBssid(i, bssid);
+        evictOk = (table.find(bssid) != nullptr) == (i >= 400);
+    }
+    bench.check(dedupeOk && evictOk, "wardrive bssid dedupe");
+    table.end();
+
+    // A drive past BENCH_WARDRIVE_APS APs, each seen ~10 times at varying strength.
+    // One op is one scan result; the table is drained and evicted like the module does.
+    std::vector<uint32_t> order;
+    randomSeed(2024);
+    for (uint32_t i = 0; i < BENCH_WARDRIVE_APS * 10; i++) order.push_back(i / 10 + random(-40, 40));
+    table.begin(WARDRIVE_TABLE_SLOTS);
+    uint32_t written = 0;
+    auto drive = [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            uint32_t id = order[i % order.size()];
+            benchBssid(id, bssid);
+            fix.timestampMs = i;
+            table.observe(bssid, "BenchNet", 8, WIFI_AUTH_WPA2_PSK, 1 + id % 13, -90 + random(60), fix);
+            if (table.getDirtyCount() >= 32) {
+                written += table.drainDirty([](const ApSighting&) {});
+                table.evict(i);
+            }
+        }
+    };
+    BenchResult* r = bench.run("wardrive_observe", order.size(), drive);
+    if (r) {
+        // Rows a single drive produces, out of its sightings
+        table.clear();
+        written = 0;
+        drive(order.size());
+        written += table.drainDirty([](const ApSighting&) {});
+        r->extraKey = "rows_per_sighting";
+        r->extraValue = (float)written / order.size();
+    }
+    table.end();
+
+    bench.run("wardrive_csv_row", 10000, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            ap.rssi = -30 - (i & 63);
+            formatWigleRow(ap, row, sizeof(row));
+        }
+    });
+
+    if (!sdManager.isMounted() || !bench.enabled("wardrive_csv_append")) return;
+    SD.remove(BENCH_WIGLE_FILE);
+
+    WigleCsvWriter writer;
+    uint32_t appended = 0;
+    writer.begin(BENCH_WIGLE_FILE);
+    r = bench.run("wardrive_csv_append", 2000, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            benchBssid(appended++, ap.bssid);
+            writer.append(ap);
+        }
+        writer.flush();
+    });
+    writer.end();
+
+    // Read back: two header lines, then one row per append
+    File f = SD.open(BENCH_WIGLE_FILE, FILE_READ);
+    bool ok = f && f.readStringUntil('\n') + "\n" == WIGLE_PRE_HEADER && f.readStringUntil('\n') + "\n" == WIGLE_HEADER;
+    uint32_t lines = 0;
+    while (ok && f.available()) {
+        String line = f.readStringUntil('\n');
+        benchBssid(lines++, ap.bssid);
+        formatWigleRow(ap, row, sizeof(row));
+        ok = line + "\n" == row;
+    }
+    if (f) f.close();
+    bench.check(ok && lines == appended, "wigle csv read back");
+    SD.remove(BENCH_WIGLE_FILE);
+
+    if (r) {
+        r->extraKey = "rows_per_write";
+        r->extraValue = writer.getWrites() ? (float)writer.getRows() / writer.getWrites() : 0;
+    }
+}
+
+// --- AP store ---
+
+static void benchApPosition(uint32_t id, int32_t& latE7, int32_t& lonE7) {
+    latE7 = 515000000 + (int32_t)(id / 400) * 3000;
+    lonE7 = -1500000 + (int32_t)(id % 400) * 5000;
+}
+
+static void benchApSighting(ApSighting& ap, uint32_t id, int8_t rssi, int32_t latE7, int32_t lonE7, uint32_t t) {
+    benchBssid(id, ap.bssid);
+    ap.ssidLen = sprintf(ap.ssid, "Net%lu", (unsigned long)id);
+    ap.authMode = WIFI_AUTH_WPA2_PSK;
+    ap.channel = 1 + id % 13;
+    ap.rssi = rssi;
+    ap.firstSeen = t;
+    ap.fix.latE7 = latE7;
+    ap.fix.lonE7 = lonE7;
+    ap.fix.unixTime = t;
+}
+
+static void benchApStore() {
+    if (!sdManager.isMounted() || !bench.enabled("apstore")) return;
+    SD.remove(BENCH_APSTORE_INDEX);
+    SD.remove(BENCH_APSTORE_DATA);
+
+    char hash[7];
+    geohashString(geohash32(515074000, -1278000), hash);
+    bench.check(String(hash) == "gcpvj0", "geohash32");
+    // Index pages are placed by this hash, stores on the card depend on it
+    bench.check(fnv1a((const uint8_t*)"a", 1) == 0xE40C292Cu && fnv1a((const uint8_t*)"foobar", 6) == 0xBF9CF968u,
+                "fnv1a");
+
+    // Small hashes so buckets spill: A and B next to each other, C 10km away
+    ApStore store;
+    ApSighting ap = {};
+    ApRecord found;
+    ApRecord near[4];
+    bool ok = store.begin(BENCH_APSTORE_INDEX, BENCH_APSTORE_DATA, 16, 4);
+    benchApSighting(ap, 1, -70, 515000000, -1500000, 1000);
+    ok = ok && store.observe(ap) == SIGHTING_NEW;
+    ap.rssi = -80;
+    ok = ok && store.observe(ap) == SIGHTING_SEEN;
+    ap.rssi = -60;
+    ok = ok && store.observe(ap) == SIGHTING_STRONGER;
+    benchApSighting(ap, 2, -65, 515009000, -1490000, 1001);
+    ok = ok && store.observe(ap) == SIGHTING_NEW;
+    benchApSighting(ap, 3, -40, 516000000, -1500000, 1002);
+    ok = ok && store.observe(ap) == SIGHTING_NEW;
+    uint8_t n = store.nearest(515000000, -1500000, near, 4);
+    ok = ok && n == 2 && near[0].bssid[5] == 1 && near[0].rssi == -60 && near[0].observations == 3 && near[1].bssid[5] == 2;
+    // B heard stronger next to C: it moves, and its old node must not bring it back
+    benchApSighting(ap, 2, -50, 516000000, -1500000, 1003);
+    ok = ok && store.observe(ap) == SIGHTING_STRONGER;
+    n = store.nearest(515000000, -1500000, near, 4);
+    ok = ok && n == 1 && near[0].bssid[5] == 1;
+    n = store.nearest(516000000, -1500000, near, 4);
+    ok = ok && n == 2 && near[0].bssid[5] == 3 && near[1].bssid[5] == 2 && near[1].rssi == -50;
+    bench.check(ok, "ap store nearest");
+
+    // 600 BSSIDs in 16 buckets of 51 spill over; all found again after a reopen
+    for (uint32_t i = 10; i < 610; i++) {
+        benchApSighting(ap, i, -70, 515000000, -1500000, 2000);
+        store.observe(ap);
+    }
+    store.end();
+    ok = store.begin(BENCH_APSTORE_INDEX, BENCH_APSTORE_DATA) && store.getRecords() == 603 && store.getDropped() == 0;
+    for (uint32_t i = 10; i < 610 && ok; i++) {
+        benchBssid(i, ap.bssid);
+        ok = store.find(ap.bssid, found) && found.bssid[5] == (uint8_t)i && found.ssidLen == String("Net" + String(i)).length();
+    }
+    benchBssid(9999, ap.bssid);
+    bench.check(ok && !store.find(ap.bssid, found), "ap store reopen");
+    store.end();
+    SD.remove(BENCH_APSTORE_INDEX);
+    SD.remove(BENCH_APSTORE_DATA);
+
+    // A long survey: the car moves along the AP ids, each AP heard ~10 times
+    // with some position jitter, flushed every 4096 like a 10s flush would
+    if (!store.begin(BENCH_APSTORE_INDEX, BENCH_APSTORE_DATA)) return;
+    randomSeed(36);
+    uint32_t observed = 0;
+    BenchResult* r = bench.run("apstore_observe", BENCH_APSTORE_OBS, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++, observed++) {
+            uint32_t id = (observed / 10 + random(-40, 40) + BENCH_APSTORE_APS) % BENCH_APSTORE_APS;
+            int32_t lat, lon;
+            benchApPosition(id, lat, lon);
+            benchApSighting(ap, id, -90 + random(60), lat + random(-2000, 2000), lon + random(-2000, 2000),
+                            1700000000 + observed);
+            store.observe(ap);
+            if ((observed & 4095) == 4095) store.flush();
+        }
+        store.flush();
+    });
+    if (r) {
+        r->extraKey = "page_ios_per_op";
+        r->extraValue = (float)(store.getPageReads() + store.getPageWrites()) / std::max<uint32_t>(observed, 1);
+    }
+
+    // Every sampled AP is found, near where it really is, and turns up around there
+    ok = store.getObservations() == observed && store.getDropped() == 0;
+    uint32_t apCount = std::min<uint32_t>(BENCH_APSTORE_APS, observed / 10);
+    for (uint32_t k = 0; k < 200 && ok; k++) {
+        uint32_t id = random(apCount);
+        int32_t lat, lon;
+        benchApPosition(id, lat, lon);
+        benchBssid(id, ap.bssid);
+        ok = store.find(ap.bssid, found) && abs(found.latE7 - lat) <= 2000 && abs(found.lonE7 - lon) <= 2000;
+        n = store.nearest(lat, lon, near, 4);
+        for (uint8_t j = 1; j < n && ok; j++) ok = near[j].rssi <= near[j - 1].rssi;
+        ok = ok && n == 4;
+    }
+    bench.check(ok, "ap store survey " + String(observed) + " observations");
+
+    uint32_t reads = store.getPageReads();
+    r = bench.run("apstore_find", 2000, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            benchBssid(random(apCount), ap.bssid);
+            store.find(ap.bssid, found);
+        }
+    });
+    if (r) {
+        r->extraKey = "page_reads_per_op";
+        r->extraValue = (float)(store.getPageReads() - reads) / (r->ops * (BENCH_RUNS + 1));
+    }
+
+    reads = store.getPageReads();
+    r = bench.run("apstore_nearest", 200, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            int32_t lat, lon;
+            benchApPosition(random(apCount), lat, lon);
+            store.nearest(lat, lon, near, 4);
+        }
+    });
+    if (r) {
+        r->extraKey = "page_reads_per_op";
+        r->extraValue = (float)(store.getPageReads() - reads) / (r->ops * (BENCH_RUNS + 1));
+    }
+
+    store.end();
+    SD.remove(BENCH_APSTORE_INDEX);
+    SD.remove(BENCH_APSTORE_DATA);
+}
+
+// --- LoRa ---
+
+static void fillLoRaPacket(LoRaPacket& p, uint32_t i) {
+    p.timestampMs = 1000 + i * 250;
+    p.frequencyHz = 868100000;
+    p.spreadingFactor = 7;
+    p.bandwidthHz = 125000;
+    p.rssi = -60 - (int16_t)(i % 60);
+    p.snr = 9.25f - (i % 40) * 0.5f;
+    p.length = 24 + i % 40;
+    for (uint8_t j = 0; j < p.length; j++) p.data[j] = (uint8_t)(i * 31 + j);
+}
+
+static void benchLoRa() {
+    if (!bench.enabled("lora")) return;
+
+    // Known answers from the SX127x datasheet formula. SF12/125k has 32ms
+    // symbols, so it also covers low data rate optimisation.
+    LoRaModemParams sf7;
+    LoRaModemParams sf12;
+    sf12.spreadingFactor = 12;
+    LoRaModemParams sf11;
+    sf11.spreadingFactor = 11;
+    bench.check(loraTimeOnAirUs(sf7, 10) == 41216 && loraTimeOnAirUs(sf12, 10) == 991232 &&
+                loraTimeOnAirUs(sf11, 20) == 741376, "lora time on air");
+    LoRaModemParams implicit;
+    implicit.spreadingFactor = 6;
+    implicit.explicitHeader = false;
+    implicit.crc = false;
+    bench.check(loraTimeOnAirUs(implicit, 0) == 10368 && loraTimeOnAirUs(sf7, 0) == 25856, "lora time on air, empty payload");
+
+    // 1% of an hour is 36s. 30s at t=0 leaves room for 6s until the first
+    // minute slice has been out of the window for a whole hour.
+    DutyCycleBudget budget;
+    budget.record(30000000, 0);
+    bool dutyOk = budget.getBudgetUs() == 36000000 && budget.canTransmit(6000000, 1000) &&
+                  !budget.canTransmit(7000000, 1000) && budget.getWaitMs(7000000, 1000) == 3659000 &&
+                  budget.getWaitMs(40000000, 1000) == UINT32_MAX;
+    bench.check(dutyOk && budget.getUsedUs(3659999) == 30000000 && budget.getUsedUs(3660000) == 0, "lora duty cycle budget");
+
+    LoRaPacket packet;
+    fillLoRaPacket(packet, 0);
+    packet.timestampMs = 123456;
+    packet.rssi = -87;
+    packet.snr = -4.75f;
+    packet.length = 4;
+    const uint8_t payload[] = {0xDE, 0xAD, 0x00, 0x7F};
+    memcpy(packet.data, payload, sizeof(payload));
+    char line[LORA_LOG_LINE_MAX];
+    size_t len = formatLoRaLogLine(packet, line, sizeof(line));
+    bench.check(len == strlen(line) && String(line) == "123456,868100000,7,125000,-87,-4.75,4,DEAD007F\n" &&
+                formatLoRaLogLine(packet, line, len) == 0, "lora log line");
+
+    uint32_t sink = 0;
+    bench.run("lora_airtime", 65536, [&](uint32_t ops) {
+        LoRaModemParams p;
+        for (uint32_t i = 0; i < ops; i++) {
+            p.spreadingFactor = 7 + i % 6;
+            sink += loraTimeOnAirUs(p, i & 0xFF);
+        }
+    });
+
+    bench.run("lora_log_format", 10000, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            fillLoRaPacket(packet, i);
+            sink += formatLoRaLogLine(packet, line, sizeof(line));
+        }
+    });
+    if (sink == 1) Serial.println(); // Keep the loops
+
+    if (!sdManager.isMounted() || !bench.enabled("lora_log_append")) return;
+    SD.remove(BENCH_LORA_LOG);
+
+    // One op is one received packet going to the card
+    LoRaLogWriter writer;
+    uint32_t appended = 0;
+    writer.begin(BENCH_LORA_LOG);
+    BenchResult* r = bench.run("lora_log_append", 2000, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            fillLoRaPacket(packet, appended++);
+            writer.append(packet);
+        }
+        writer.flush();
+    });
+    writer.end();
+
+    // Read back: header, then every packet in order
+    File f = SD.open(BENCH_LORA_LOG, FILE_READ);
+    bool ok = f && f.readStringUntil('\n') + "\n" == LORA_LOG_HEADER;
+    for (uint32_t i = 0; ok && i < appended; i++) {
+        fillLoRaPacket(packet, i);
+        formatLoRaLogLine(packet, line, sizeof(line));
+        ok = f.readStringUntil('\n') + "\n" == line;
+    }
+    ok = ok && f.available() == 0;
+    if (f) f.close();
+    bench.check(ok && writer.getErrors() == 0, "lora log read back");
+    SD.remove(BENCH_LORA_LOG);
+
+    if (r) {
+        r->extraKey = "lines_per_write";
+        r->extraValue = writer.getWrites() ? (float)writer.getLines() / writer.getWrites() : 0;
+    }
+}
+
+// --- I2C ---
+
+// One chip on the bus with a register file, what identifyI2CDevice() reads
+// on the device through Wire
+class BenchI2CBus : public I2CBus {
+public:
+    uint8_t address = 0;
+    uint8_t regs[256];
+    bool nack = false;      // The chip answers its address but not register reads
+    uint32_t reads = 0;
+
+    void chip(uint8_t a) {
+        address = a;
+        memset(regs, 0, sizeof(regs));
+        nack = false;
+        reads = 0;
+    }
+    uint8_t probe(uint8_t a) override { return a == address ? 0 : 2; }
+    bool readRegister(uint8_t a, uint8_t reg, uint8_t* out, size_t len) override {
+        reads++;
+        if (a != address || nack) return false;
+        for (size_t i = 0; i < len; i++) out[i] = regs[(uint8_t)(reg + i)];
+        return true;
+    }
+};
+
+// nullptr for a chip that must stay unidentified
+static bool identifiesAs(BenchI2CBus& bus, const char* name) {
+    const I2CFingerprint* fp = identifyI2CDevice(bus, bus.address);
+    if (!name) return fp == nullptr;
+    return fp && strcmp(fp->name, name) == 0;
+}
+
+// 23:59:<seconds>, Sunday 31/12/25, BCD as the DS3231 keeps it
+static void benchDs3231Time(BenchI2CBus& bus, uint8_t seconds) {
+    const uint8_t time[7] = {seconds, 0x59, 0x23, 0x07, 0x31, 0x12, 0x25};
+    memcpy(bus.regs, time, sizeof(time));
+}
+
+static bool checkI2CFingerprints() {
+    BenchI2CBus bus;
+    bool ok = true;
+
+    // 0x68 is shared: an IMU answers its WHO_AM_I, the DS3231 has none and is
+    // told apart by status bits 6..4 reading 0 and a valid time
+    bus.chip(0x68);
+    bus.regs[0x75] = 0x68;
+    ok = ok && identifiesAs(bus, "MPU6050 IMU") && bus.reads == 1;
+    bus.chip(0x68);
+    benchDs3231Time(bus, 0x37);
+    bus.regs[0x0F] = 0x88;  // OSF and EN32kHz set
+    ok = ok && identifiesAs(bus, "DS3231 RTC") && bus.reads == 3; // 0x75, 0x0F and the time
+    // At second :24 the seconds counter reads like a BMI270's chip ID
+    bus.chip(0x68);
+    benchDs3231Time(bus, 0x24);
+    ok = ok && identifiesAs(bus, "DS3231 RTC");
+    bus.chip(0x68);
+    bus.regs[0x00] = 0x24;  // A BMI270: its other registers are no time
+    ok = ok && identifiesAs(bus, "BMI270 IMU");
+    bus.chip(0x69);
+    bus.regs[0x75] = 0x71;
+    ok = ok && identifiesAs(bus, "MPU9250 IMU");
+    bus.chip(0x69);
+    bus.regs[0x00] = 0xD1;
+    bus.regs[0x0F] = 0x00;  // The DS3231 row is 0x68 only
+    ok = ok && identifiesAs(bus, "BMI160 IMU");
+
+    bus.chip(0x0D);
+    bus.regs[0x0D] = 0xFF;
+    ok = ok && identifiesAs(bus, "QMC5883L Compass");
+
+    // Address only, nothing is read
+    bus.chip(0x42);
+    ok = ok && identifiesAs(bus, "u-blox GNSS") && bus.reads == 0;
+
+    // An unknown chip at a known address, and an address not in the table
+    bus.chip(0x68);
+    bus.regs[0x75] = 0x12;
+    bus.regs[0x00] = 0x12;
+    bus.regs[0x0F] = 0x70;
+    ok = ok && identifiesAs(bus, nullptr);
+    bus.chip(0x20);
+    ok = ok && identifiesAs(bus, nullptr) && bus.reads == 0;
+
+    // A failed ID read never matches, not even the DS3231 row that wants zero bits
+    bus.chip(0x0D);
+    bus.regs[0x0D] = 0xFF;
+    bus.nack = true;
+    ok = ok && identifiesAs(bus, nullptr);
+    bus.chip(0x68);
+    bus.nack = true;
+    ok = ok && identifiesAs(bus, nullptr);
+    return ok;
+}
+
+static void benchI2C() {
+    if (bench.enabled("i2c_identify")) {
+        bench.check(checkI2CFingerprints(), "I2C chips are told apart by their ID registers");
+    }
+}
+
+// --- SD ---
+
+static void prepareListDir() {
+    if (!SD.exists(BENCH_LISTDIR)) SD.mkdir(BENCH_LISTDIR);
+    if (sdManager.listDir(BENCH_LISTDIR).size() >= BENCH_LISTDIR_FILES) return;
+
+    Serial.println("# Creating " + String(BENCH_LISTDIR_FILES) + " files in " BENCH_LISTDIR);
+    for (int i = 0; i < BENCH_LISTDIR_FILES; i++) {
+        File f = SD.open(String(BENCH_LISTDIR) + "/payload_" + String(i) + ".txt", FILE_WRITE);
+        if (!f) break;
+        f.print("STRING bench\n");
+        f.close();
+    }
+}
+
+static void benchSD() {
+    if (!sdManager.isMounted()) {
+        Serial.println("# SD not mounted, skipping SD cases");
+        return;
+    }
+
+    if (bench.enabled("sd_list_dir_256")) {
+        prepareListDir();
+        size_t entries = 0;
+        BenchResult* r = bench.run("sd_list_dir_256", 2, [&](uint32_t ops) {
+            for (uint32_t i = 0; i < ops; i++) entries = sdManager.listDir(BENCH_LISTDIR).size();
+        });
+        if (r) {
+            r->extraKey = "entries";
+            r->extraValue = entries;
+        }
+    }
+
+    if (bench.enabled("config_load")) {
+        if (!ConfigManager::getInstance().load()) ConfigManager::getInstance().save();
+        bench.run("config_load", 20, [](uint32_t ops) {
+            for (uint32_t i = 0; i < ops; i++) ConfigManager::getInstance().load();
+        });
+    }
+}
+
+// --- Assets ---
+
+static bool lz4Gives(const uint8_t* src, size_t len, const char* expected) {
+    uint8_t out[32];
+    int n = AssetPack::lz4Decode(src, len, out, sizeof(out));
+    if (!expected) return n == -1;
+    return n == (int)strlen(expected) && memcmp(out, expected, n) == 0;
+}
+
+static bool checkLz4() {
+    // Literals only, and a literal run long enough for an extra length byte
+    static const uint8_t literals[] = {0x50, 'h', 'e', 'l', 'l', 'o'};
+    static const uint8_t longLiterals[] = {0xF0, 0x05, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j',
+                                           'k',  'l',  'm', 'n', 'o', 'p', 'q', 'r', 's', 't'};
+    // Matches that overlap their own output: "ab" repeated, a run of one byte
+    static const uint8_t overlap[] = {0x24, 'a', 'b', 0x02, 0x00, 0x10, 'c'};
+    static const uint8_t run[] = {0x12, 'x', 0x01, 0x00};
+    // Malformed: cut inside the literals and inside the offset, offset before the start
+    static const uint8_t farOffset[] = {0x14, 'a', 0x05, 0x00};
+    bool ok = lz4Gives(literals, sizeof(literals), "hello") &&
+              lz4Gives(longLiterals, sizeof(longLiterals), "abcdefghijklmnopqrst") &&
+              lz4Gives(overlap, sizeof(overlap), "abababababc") && lz4Gives(run, sizeof(run), "xxxxxxx");
+    ok = ok && lz4Gives(literals, 3, nullptr) && lz4Gives(overlap, 4, nullptr) && lz4Gives(longLiterals, 1, nullptr) &&
+         lz4Gives(farOffset, sizeof(farOffset), nullptr);
+    // Output that would not fit
+    uint8_t small[4];
+    return ok && AssetPack::lz4Decode(literals, sizeof(literals), small, sizeof(small)) == -1;
+}
+
+// A pack of ASSET_CACHE_SLOTS + 1 compressed bitmaps, one more than the cache holds
+#define BENCH_PACK_ASSETS (ASSET_CACHE_SLOTS + 1)
+static uint8_t benchPack[sizeof(AssetPackHeader) + BENCH_PACK_ASSETS * (sizeof(AssetEntry) + 5)];
+
+static void buildBenchPack() {
+    AssetPackHeader header = {ASSET_PACK_MAGIC, ASSET_PACK_VERSION, BENCH_PACK_ASSETS, sizeof(benchPack), 0};
+    memcpy(benchPack, &header, sizeof(header));
+    uint32_t data = sizeof(header) + BENCH_PACK_ASSETS * sizeof(AssetEntry);
+    for (int i = 0; i < BENCH_PACK_ASSETS; i++) {
+        AssetEntry e = {};
+        snprintf(e.name, sizeof(e.name), "icon%d", i); // Sorted, as the packer writes them
+        e.width = 8;
+        e.height = 4;
+        e.type = ASSET_BITMAP;
+        e.codec = ASSET_LZ4;
+        e.offset = data + i * 5;
+        e.packedSize = 5;
+        e.rawSize = 4;
+        memcpy(benchPack + sizeof(header) + i * sizeof(AssetEntry), &e, sizeof(e));
+        const uint8_t block[5] = {0x40, (uint8_t)i, (uint8_t)i, (uint8_t)i, (uint8_t)i};
+        memcpy(benchPack + e.offset, block, sizeof(block));
+    }
+}
+
+// The least recently used slot goes first, a hit makes its slot the newest
+static bool checkAssetCache() {
+    AssetPack& assets = AssetPack::getInstance();
+    buildBenchPack();
+    if (!assets.begin(benchPack, sizeof(benchPack))) return false;
+    char name[ASSET_NAME_LEN];
+    auto fetch = [&](int i) {
+        snprintf(name, sizeof(name), "icon%d", i);
+        const uint8_t* data = assets.get(name);
+        return data && data[0] == i && data[3] == i;
+    };
+    bool ok = true;
+    for (int i = 0; i < ASSET_CACHE_SLOTS; i++) ok = ok && fetch(i);
+    uint32_t hits = assets.getHits(), misses = assets.getMisses();
+    ok = ok && fetch(0) && assets.getHits() == hits + 1;           // icon0 is now the newest
+    ok = ok && fetch(ASSET_CACHE_SLOTS) && assets.getMisses() == misses + 1; // Evicts icon1
+    ok = ok && fetch(0) && assets.getHits() == hits + 2;
+    ok = ok && fetch(1) && assets.getMisses() == misses + 2;       // Was evicted, evicts icon2
+    ok = ok && fetch(3) && assets.getHits() == hits + 3;
+    ok = ok && fetch(2) && assets.getMisses() == misses + 3;
+    return ok;
+}
+
+static void benchAssets() {
+    AssetPack& assets = AssetPack::getInstance();
+    if (bench.enabled("asset_icon")) {
+        bench.check(checkLz4(), "lz4 decodes literals and overlapping matches, rejects truncated blocks");
+        bench.check(checkAssetCache(), "asset cache evicts the least recently used");
+    }
+    // Back to the real pack. Every icon comes from it, without it the menus draw blank.
+    bool loaded = assets.begin();
+    bench.check(loaded, "asset pack loaded");
+    if (!loaded) return;
+
+    // Status bar battery icon: LZ4 packed, served from the cache after the first draw
+    bench.run("asset_icon_cached", 1000, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) assets.getBitmap("battery_50");
+    });
+
+    // Cold cache: lookup plus LZ4 decode of the largest icon
+    bench.run("asset_icon_decode", 1000, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            assets.clearCache();
+            assets.getBitmap("SDQuestion");
+        }
+    });
+    assets.clearCache();
+}
+
+// --- Bitmap blitter ---
+
+#ifdef SIMULATOR
+// The blitter's pixels against the library's opaque drawBitmap at the same place
+static bool sameAsDrawBitmap(BitmapBlitter& blit, const uint8_t* bits, int16_t w, int16_t h, uint16_t fg, uint16_t bg) {
+    TFT_eSPI* tft = displayManager.getTFT();
+    static uint16_t expected[64 * 64];
+    tft->drawBitmap(3, 30, bits, w, h, fg, bg);
+    for (int16_t j = 0; j < h; j++) {
+        for (int16_t i = 0; i < w; i++) expected[j * w + i] = tft->getPixel(3 + i, 30 + j);
+    }
+    tft->fillRect(3, 30, w, h, TFT_MAGENTA);
+    blit.draw(tft, 3, 30, bits, w, h, fg, bg);
+    bool ok = true;
+    for (int16_t j = 0; j < h && ok; j++) {
+        for (int16_t i = 0; i < w && ok; i++) ok = tft->getPixel(3 + i, 30 + j) == expected[j * w + i];
+    }
+    return ok;
+}
+
+static bool checkBlitter() {
+    static const uint8_t odd[] = {0x80, 0x00, 0x80, 0xA0, 0xE0, 0x40};
+    BitmapBlitter blit;
+    bool ok = sameAsDrawBitmap(blit, image_battery_50_bits, 24, 16, THEME_TEXT, THEME_SECONDARY) &&
+              sameAsDrawBitmap(blit, image_cloud_sync_bits, 17, 16, TFT_CYAN, THEME_SECONDARY) &&
+              sameAsDrawBitmap(blit, image_micro_sd_bits, 14, 16, TFT_RED, THEME_BG) &&
+              sameAsDrawBitmap(blit, image_SDQuestion_bits, 35, 43, TFT_YELLOW, THEME_PRIMARY) &&
+              sameAsDrawBitmap(blit, odd, 1, 3, TFT_WHITE, TFT_BLACK) && sameAsDrawBitmap(blit, odd, 3, 2, TFT_GREEN, TFT_BLUE);
+    // 35x43 needs two pushes, everything else one
+    return ok && blit.getPushes() == 7;
+}
+#endif
+
+static void benchBlitter() {
+#ifdef SIMULATOR
+    if (bench.enabled("icon_blit")) bench.check(checkBlitter(), "icon blitter matches drawBitmap");
+#endif
+
+    // Icons per second are ops per second: the status bar battery, old path against the
+    // blitter, both opaque so they cover the same pixels
+    TFT_eSPI* tft = displayManager.getTFT();
+    bench.run("icon_drawbitmap", 200, [tft](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) tft->drawBitmap(255, 2, image_battery_50_bits, 24, 16, THEME_TEXT, THEME_SECONDARY);
+    });
+    static BitmapBlitter blit;
+    bench.run("icon_blit", 200, [tft](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) blit.draw(tft, 255, 2, image_battery_50_bits, 24, 16, THEME_TEXT, THEME_SECONDARY);
+    });
+}
+
+// --- Themes ---
+
+static bool checkThemes() {
+    bool ok = themeIndex("no_such_theme") == -1;
+    for (uint8_t i = 0; i < THEME_COUNT && ok; i++) ok = themeIndex(THEMES[i].name) == i && themeReadable(THEMES[i]);
+    // The same checks as the static_assert, against known values
+    ok = ok && themeContrast(0x0000, 0xFFFF) > 20.9 && themeContrast(0xFFFF, 0x0000) > 20.9 &&
+         themeContrast(0x7BEF, 0x7BEF) == 1.0 &&
+         !themeReadable({"grey", {0x0000, 0x780F, 0x4010, 0x4208, 0x911F, 0xFFFF, 0x07E0, 0xFFE0, 0xF800}});
+    // The light palette with the dark themes' green, yellow and red
+    ok = ok && !themeReadable({"pale", {0xFFFF, 0xAEDF, 0xC618, 0x0000, 0x001F, 0x4208, 0x07E0, 0xFFE0, 0xF800}});
+
+    // Switching copies the palette and asks for one repaint, the same theme again is a no-op
+    ok = ok && displayManager.setTheme("light") && THEME_BG == 0xFFFF && THEME_TEXT == 0x0000 &&
+         displayManager.takeRepaint() && !displayManager.takeRepaint();
+    ok = ok && !displayManager.setTheme("light") && !displayManager.takeRepaint();
+#ifdef SIMULATOR
+    // The menu loop repaints everything once in the new colors, then goes back to the status bar clock
+    TFT_eSPI* tft = displayManager.getTFT();
+    displayManager.setTheme("green_matrix");
+    tft->resetPixelCounter();
+    menuSystem.update();
+    uint64_t repaint = tft->pixelsWritten();
+    tft->resetPixelCounter();
+    menuSystem.update();
+    ok = ok && repaint >= 320 * 170 && tft->pixelsWritten() < 320 * 20 && tft->getPixel(2, 160) == THEMES[1].colors[COLOR_BG] &&
+         tft->getPixel(2, 10) == THEMES[1].colors[COLOR_SECONDARY];
+#endif
+    // An unknown name falls back to the default
+    ok = ok && displayManager.setTheme("no_such_theme") && activeTheme.name == THEMES[0].name;
+    menuSystem.draw();
+    return ok;
+}
+
+static void benchThemes() {
+    if (bench.enabled("themes")) bench.check(checkThemes(), "theme palettes, contrast and repaint");
+}
+
+// --- List view ---
+
+#define BENCH_LIST_ITEMS 40
+#define BENCH_ROW_AREA   (290 * 22)
+#define BENCH_BAR_AREA   (6 * 125)
+
+static ListView benchList;
+static uint32_t benchListRows = 0; // Source calls
+
+static void benchListSource(int index, ListRow& row) {
+    benchListRows++;
+    row.text = "Item ";
+    row.text += index;
+}
+
+#ifdef SIMULATOR
+// The rows and the scroll bar on screen against a fresh draw() of the same state
+static bool sameAsFreshDraw(ListView& list) {
+    TFT_eSPI* tft = displayManager.getTFT();
+    static uint16_t shown[320 * 150];
+    for (int j = 0; j < 150; j++) {
+        for (int i = 0; i < 320; i++) shown[j * 320 + i] = tft->getPixel(i, 20 + j);
+    }
+    displayManager.clearContent();
+    list.draw();
+    bool ok = true;
+    for (int j = 0; j < 150 && ok; j++) {
+        for (int i = 0; i < 320 && ok; i++) ok = tft->getPixel(i, 20 + j) == shown[j * 320 + i];
+    }
+    return ok;
+}
+#endif
+
+static bool checkListView() {
+    benchList.begin(&displayManager, benchListSource);
+    benchList.reset(BENCH_LIST_ITEMS);
+    displayManager.clearContent();
+    benchList.draw();
+    bool ok = benchList.getLastPixels() == 5 * BENCH_ROW_AREA + BENCH_BAR_AREA;
+
+    // Inside the window a click is the two rows whose selection changed, and only they are asked for
+    benchListRows = 0;
+    benchList.next();
+    benchList.update();
+    ok = ok && benchList.getSelected() == 1 && benchList.getOffset() == 0 && benchListRows == 2 &&
+         benchList.getLastPixels() == 2 * BENCH_ROW_AREA;
+    // Nothing changed, nothing drawn
+    benchList.update();
+    ok = ok && benchList.getLastPixels() == 0;
+#ifdef SIMULATOR
+    ok = ok && sameAsFreshDraw(benchList);
+#endif
+
+    // Past the last row the window moves three rows on and ends where a fresh draw would,
+    // redrawn once in place unless it slides there
+    benchList.select(4);
+    benchList.update();
+    benchList.next();
+    benchList.update();
+    ok = ok && benchList.getSelected() == 5 && benchList.getOffset() == 3;
+#if LIST_SLIDE
+    ok = ok && benchList.getLastPixels() > 5 * BENCH_ROW_AREA;
+#else
+    ok = ok && benchList.getLastPixels() == 5 * BENCH_ROW_AREA + 2 * BENCH_BAR_AREA;
+#endif
+#ifdef SIMULATOR
+    ok = ok && sameAsFreshDraw(benchList);
+#endif
+
+    // A jump redraws the window once, wrapping goes back to the top
+    benchList.select(30);
+    benchList.update();
+    ok = ok && benchList.getOffset() == 28 && benchList.getLastPixels() == 5 * BENCH_ROW_AREA + 2 * BENCH_BAR_AREA;
+    benchList.select(BENCH_LIST_ITEMS - 1);
+    benchList.update();
+    benchList.next();
+    benchList.update();
+    ok = ok && benchList.getSelected() == 0 && benchList.getOffset() == 0;
+#ifdef SIMULATOR
+    ok = ok && sameAsFreshDraw(benchList);
+#endif
+
+    // Shrinking keeps the cursor on the last item and blanks the rows that went away
+    benchList.select(20);
+    benchList.update();
+    benchList.setCount(3);
+    benchList.update();
+    ok = ok && benchList.getSelected() == 2 && benchList.getOffset() == 0;
+#ifdef SIMULATOR
+    ok = ok && sameAsFreshDraw(benchList);
+#endif
+    benchList.setCount(0);
+    benchList.next();
+    benchList.update();
+    ok = ok && benchList.empty() && benchList.getSelected() == 0;
+    return ok;
+}
+
+static void benchListView() {
+    if (bench.enabled("list_click")) bench.check(checkListView(), "list view redraws only what changed");
+
+    // One click in a long list: clearing and drawing every row against the list's update.
+    // pixels_per_op is the area each repaints.
+    benchList.begin(&displayManager, benchListSource);
+    benchList.reset(BENCH_LIST_ITEMS);
+    BenchResult* r = bench.run("list_click_full", 20, [](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            benchList.next();
+            displayManager.clearContent();
+            benchList.draw();
+        }
+    });
+    if (r) {
+        r->extraKey = "pixels_per_op";
+        r->extraValue = 320 * 150 + benchList.getLastPixels();
+    }
+    uint32_t clicks = 0;
+    uint64_t pixels = 0;
+    benchList.reset(BENCH_LIST_ITEMS);
+    displayManager.clearContent();
+    benchList.draw();
+    r = bench.run("list_click", 20, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            benchList.next();
+            benchList.update();
+            pixels += benchList.getLastPixels();
+            clicks++;
+        }
+    });
+    if (r && clicks) {
+        r->extraKey = "pixels_per_op";
+        r->extraValue = pixels / clicks;
+    }
+}
+
+// --- Module registry ---
+
+#define BENCH_MODULE_BYTES 4096
+
+// Holds a buffer from init() on, and runs in the background while asked to
+class BenchLazyModule : public Module {
+public:
+    static bool keepRunning;
+    static int live;
+    BenchLazyModule() { live++; }
+    ~BenchLazyModule() override {
+        delete[] buffer;
+        live--;
+    }
+    void init() override {
+        if (!buffer) buffer = new uint8_t[BENCH_MODULE_BYTES];
+    }
+    void loop() override {}
+    String getName() override { return "Bench"; }
+    String getDescription() override { return ""; }
+    void drawMenu(DisplayManager* display) override {}
+    bool handleInput(uint8_t button) override { return true; }
+    bool isBackgroundRunning() override { return keepRunning; }
+
+private:
+    uint8_t* buffer = nullptr;
+};
+bool BenchLazyModule::keepRunning = false;
+int BenchLazyModule::live = 0;
+
+// Starts a "task" on entry that writes into the module through its own
+// pointer, the way the I2C sweep fills found[]. The bench steps it by hand,
+// the host has no second thread.
+class BenchTaskModule : public Module {
+public:
+    static BenchTaskModule* task;  // What the task holds
+    static int live;
+    volatile bool taskRunning = false;
+    uint32_t written = 0;
+    BenchTaskModule() { live++; }
+    ~BenchTaskModule() override { live--; }
+    void init() override {
+        taskRunning = true;
+        task = this;
+    }
+    void loop() override {}
+    String getName() override { return "Bench task"; }
+    String getDescription() override { return ""; }
+    void drawMenu(DisplayManager* display) override {}
+    bool handleInput(uint8_t button) override { return false; }
+    bool isBackgroundRunning() override { return taskRunning; }
+
+    static void step() { task->written++; }
+    static void finish() {
+        task->taskRunning = false; // Its last write
+        task = nullptr;
+    }
+};
+BenchTaskModule* BenchTaskModule::task = nullptr;
+int BenchTaskModule::live = 0;
+
+// Left while its task is still writing, the module must outlive the task
+static bool checkModuleTask() {
+    ModuleRegistry registry;
+    int i = registry.add(ModuleDescriptor{"Bench task", nullptr, 16, 16, 8, 0, makeModule<BenchTaskModule>});
+    Module* module = registry.acquire(i);
+    BenchTaskModule::step();
+    registry.release(i); // handleInput() returned false mid-task
+    registry.reap();
+    bool ok = module && registry.get(i) == module && BenchTaskModule::live == 1;
+    BenchTaskModule::step(); // Still a live object
+    ok = ok && static_cast<BenchTaskModule*>(module)->written == 2;
+    BenchTaskModule::finish();
+    registry.reap();
+    ok = ok && registry.get(i) == nullptr && BenchTaskModule::live == 0;
+    return ok;
+}
+
+static bool checkModuleRegistry() {
+    ModuleRegistry registry;
+    int resident = registry.add(&counterModule);
+    int lazy = registry.add(ModuleDescriptor{"Bench", nullptr, 16, 16, 8, 0, makeModule<BenchLazyModule>});
+
+    // Listed without being constructed, built on entry and gone on exit
+    bool ok = registry.count() == 2 && registry.get(lazy) == nullptr && BenchLazyModule::live == 0 &&
+              registry.getName(lazy) == "Bench" && registry.getName(resident) == counterModule.getName();
+    ok = ok && registry.acquire(lazy) != nullptr && BenchLazyModule::live == 1;
+    registry.reap(); // Open, so never reaped
+    ok = ok && BenchLazyModule::live == 1;
+    registry.release(lazy);
+    ok = ok && registry.get(lazy) == nullptr && BenchLazyModule::live == 0;
+#ifdef SIMULATOR
+    // Every byte is counted here, the object and its buffer both come back
+    const ModuleFootprint& f = registry.getFootprint(lazy);
+    ok = ok && f.atEntry >= (int32_t)(sizeof(BenchLazyModule) + BENCH_MODULE_BYTES) && f.peak >= f.atEntry &&
+         f.reclaimed == f.atEntry && f.loads == 1;
+#endif
+
+    // Left while busy it stays until its background work ends
+    BenchLazyModule::keepRunning = true;
+    Module* first = registry.acquire(lazy);
+    registry.release(lazy);
+    ok = ok && registry.get(lazy) == first && registry.anyBackground();
+    registry.reap();
+    ok = ok && BenchLazyModule::live == 1;
+    // Entering it again finds the same instance
+    ok = ok && registry.acquire(lazy) == first && registry.getFootprint(lazy).loads == 2;
+    registry.release(lazy);
+    BenchLazyModule::keepRunning = false;
+    registry.reap();
+    ok = ok && registry.get(lazy) == nullptr && BenchLazyModule::live == 0 && !registry.anyBackground();
+
+    // A resident module is never deleted
+    ok = ok && registry.acquire(resident) == &counterModule;
+    registry.release(resident);
+    registry.reap();
+    ok = ok && registry.get(resident) == &counterModule;
+    return ok;
+}
+
+static void benchModuleRegistry() {
+    if (bench.enabled("module_load")) {
+        bench.check(checkModuleRegistry(), "lazy modules are freed when left");
+        bench.check(checkModuleTask(), "a module left mid-task is freed after the task");
+    }
+
+    // Entering and leaving the WiFi tools: construction, init() and teardown.
+    // bytes_reclaimed is what leaving gives back.
+    ModuleRegistry registry;
+    int wifi = registry.add(ModuleDescriptor{"WiFi Tools", "wifi", 19, 16, 13, 0, makeModule<WiFiModule>});
+    BenchResult* r = bench.run("module_load_wifi", 20, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            registry.acquire(wifi);
+            registry.release(wifi);
+        }
+    });
+    if (r) {
+        r->extraKey = "bytes_reclaimed";
+        r->extraValue = registry.getFootprint(wifi).reclaimed;
+    }
+}
+
+// --- Battery ---
+
+// One trend point a minute, changing by mvPerMin
+static void benchBatteryRamp(BatteryTrend& trend, uint16_t startMv, int mvPerMin, int points) {
+    for (int i = 0; i < points; i++) trend.add(i * BATTERY_TREND_MS, startMv + mvPerMin * i);
+}
+
+static bool checkBatteryFilter() {
+    bool ok = batteryPercent(3200) == 0 && batteryPercent(4300) == 100 && fabsf(batteryPercent(3870) - 50) < 0.01f &&
+              batteryPercent(3895) > batteryPercent(3894);
+
+    // Seeded by the first reading, a single dip never shows
+    BatteryFilter filter;
+    filter.reset();
+    ok = ok && filter.add(3900) == 3900;
+    filter.add(3900);
+    ok = ok && filter.add(3500) == 3900 && filter.add(3900) == 3900;
+
+    // Alternating noise is squeezed, a step is followed
+    uint16_t lowest = 0xFFFF, highest = 0;
+    for (int i = 0; i < 60; i++) {
+        uint16_t mv = filter.add(i & 1 ? 3920 : 3880);
+        if (i >= 30) {
+            lowest = std::min(lowest, mv);
+            highest = std::max(highest, mv);
+        }
+    }
+    ok = ok && highest - lowest <= 10;
+    for (int i = 0; i < 60; i++) filter.add(3800);
+    ok = ok && abs((int)filter.get() - 3800) <= 2;
+    return ok;
+}
+
+static bool checkBatteryTrend() {
+    BatteryTrend trend;
+
+    // 1mV a minute between 3870 and 3920 is 0.2% a minute, 12% an hour
+    trend.reset();
+    benchBatteryRamp(trend, 3915, -1, BATTERY_TREND_MIN - 1);
+    bool ok = trend.getState() == BATTERY_UNKNOWN && trend.getMinutesLeft() < 0;
+    trend.reset();
+    benchBatteryRamp(trend, 3915, -1, BATTERY_TREND_POINTS + 4);
+    float expected = batteryPercent(3915 - (BATTERY_TREND_POINTS + 3)) / 12 * 60;
+    ok = ok && trend.getState() == BATTERY_DISCHARGING && fabsf(trend.getRate() + 12) < 0.2f &&
+         fabsf(trend.getMinutesLeft() - expected) <= expected * 0.02f + 1;
+
+    // A jump starts a new curve
+    trend.add((BATTERY_TREND_POINTS + 4) * BATTERY_TREND_MS, 3700);
+    ok = ok && trend.getCount() == 1 && trend.getState() == BATTERY_UNKNOWN;
+
+    // Rising is charging, USB voltage is charging at once, flat has no estimate
+    trend.reset();
+    benchBatteryRamp(trend, 3880, 2, 8);
+    ok = ok && trend.getState() == BATTERY_CHARGING && trend.getMinutesLeft() < 0;
+    trend.add(9 * BATTERY_TREND_MS, 4300);
+    ok = ok && trend.getState() == BATTERY_CHARGING && trend.getCount() == 0;
+    trend.reset();
+    benchBatteryRamp(trend, 3900, 0, 8);
+    ok = ok && trend.getState() == BATTERY_DISCHARGING && trend.getMinutesLeft() < 0;
+    return ok;
+}
+
+static void benchBattery() {
+    if (bench.enabled("battery_filter")) {
+        bench.check(checkBatteryFilter(), "battery filter drops dips and follows steps");
+        bench.check(checkBatteryTrend(), "battery trend gives charge state and time to empty");
+    }
+
+    // The status bar as every screen draws it; adc_reads_per_op is what a
+    // draw costs the ADC, the monitor's own readings happen in poll()
+    BatteryMonitor& battery = displayManager.getBattery();
+    uint32_t reads = battery.getReads();
+    uint32_t draws = 0;
+    BenchResult* r = bench.run("status_bar_draw", 20, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) {
+            displayManager.drawStatusBar("Bench", displayManager.getBatteryVoltage(), true, false, true, "", false);
+            draws++;
+        }
+    });
+    if (r && draws) {
+        r->extraKey = "adc_reads_per_op";
+        r->extraValue = (float)(battery.getReads() - reads) / draws;
+    }
+}
+
+// --- Drawing ---
+
+static void benchDraw(const char* name, Module* module) {
+    String caseName = String("draw_menu_") + name;
+    if (!bench.enabled(caseName.c_str())) return;
+
+    BenchResult* r = bench.run(caseName.c_str(), 10, [&](uint32_t ops) {
+        for (uint32_t i = 0; i < ops; i++) module->drawMenu(&displayManager);
+    });
+#ifdef SIMULATOR
+    if (r) {
+        TFT_eSPI* tft = displayManager.getTFT();
+        tft->resetPixelCounter();
+        module->drawMenu(&displayManager);
+        r->extraKey = "pixels_per_op";
+        r->extraValue = tft->pixelsWritten();
+    }
+#endif
+}
+
+static void benchScreens() {
+    if (bench.enabled("draw_main_menu")) {
+        bench.run("draw_main_menu", 10, [](uint32_t ops) {
+            for (uint32_t i = 0; i < ops; i++) menuSystem.draw();
+        });
+    }
+
+    // init() only where it is side-effect free; BadUSB's init starts USB HID
+    wifiModule.init();
+    counterModule.init();
+    fileExplorerModule.init();
+    settingsModule.init();
+    nrf24Module.init();
+
+    benchDraw("wifi", &wifiModule);
+    benchDraw("badusb", &badusbModule);
+    benchDraw("nrf24", &nrf24Module);
+    benchDraw("file_explorer", &fileExplorerModule);
+    benchDraw("settings", &settingsModule);
+    benchDraw("i2c_scanner", &i2cScannerModule);
+    benchDraw("counter", &counterModule);
+#ifndef SIMULATOR
+    benchDraw("usb_storage", &usbStorageModule);
+    benchDraw("wifi_storage", &wifiStorageModule);
+#endif
+}
+
+static void runAll() {
+    bench.clear();
+    benchDucky();
+    benchSniffer();
+    benchFrameFilter();
+    benchAirtime();
+    benchProbes();
+    benchBeacons();
+    benchScanResults();
+    benchScanHistory();
+    benchPcap();
+    benchPcapng();
+    benchHandshakes();
+    benchPulseCodec();
+    benchDecoder();
+    benchLoRa();
+    benchWardrive();
+    benchApStore();
+#ifdef SIMULATOR
+    benchSignalCapture();
+    benchSignalReplay();
+#endif
+    benchI2C();
+    benchSD();
+    benchAssets();
+    benchBlitter();
+    benchThemes();
+    benchListView();
+    benchModuleRegistry();
+    benchBattery();
+    benchScreens();
+    menuSystem.draw();
+    bench.printJson(BENCH_TARGET);
+}
+
+static void benchSetup() {
+    AssetPack::getInstance().begin();
+    displayManager.init();
+    sdManager.waitForCard(1000);
+    if (!SD.exists(BENCH_DIR)) SD.mkdir(BENCH_DIR); // Every case writing to the card works under it
+    inputManager.begin();
+
+    menuSystem.registerModule(&wifiModule);
+    menuSystem.registerModule(&badusbModule);
+    menuSystem.registerModule(&nrf24Module);
+    menuSystem.registerModule(&fileExplorerModule);
+    menuSystem.registerModule(&settingsModule);
+    menuSystem.registerModule(&i2cScannerModule);
+    menuSystem.registerModule(&counterModule);
+}
+
+#ifdef SIMULATOR
+
+#include <sys/stat.h>
+
+int main(int argc, char** argv) {
+    const char* sdDir = "bench_sd";
+    for (int i = 1; i < argc; i++) {
+        String arg = argv[i];
+        if (arg == "--sd" && i + 1 < argc) sdDir = argv[++i];
+        else if (arg == "--filter" && i + 1 < argc) bench.setFilter(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--sd DIR] [--filter NAME]\n", argv[0]);
+            return 1;
+        }
+    }
+    mkdir(sdDir, 0755);
+    simSetFsRoot(sdDir);
+
+    benchSetup();
+    runAll();
+    return bench.getFailures() ? 1 : 0;
+}
+
+#else
+
+void setup() {
+    Serial.begin(115200);
+    // Power the SD card (external power NPN, see main.cpp)
+    pinMode(17, OUTPUT);
+    gpio_hold_dis((gpio_num_t)17);
+    digitalWrite(17, HIGH);
+    delay(2000); // Time to attach the serial monitor
+
+    benchSetup();
+    runAll();
+}
+
+void loop() {
+    if (digitalRead(BTN_14) == LOW) {
+        while (digitalRead(BTN_14) == LOW) delay(10);
+        runAll();
+    }
+    delay(10);
+}
+
+#endif
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Compare two ESP-Chain benchmark runs and flag regressions.
+
+Inputs can be the raw JSON line or a whole serial log / program output; the
+last line that parses as a bench result is used.
+
+    python3 test/bench/compare.py baseline.json current.json [--threshold 10]
+
+Exits 1 when any case got slower (median us/op by default) or allocates
+more per op than the thresholds allow, so it can gate CI.
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    result = None
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith('{"bench"'):
+                continue
+            try:
+                result = json.loads(line)
+            except json.JSONDecodeError:
+                continue
+    if result is None:
+        sys.exit(f"{path}: no benchmark JSON found")
+    return result
+
+
+def pct(base, cur):
+    if base == 0:
+        return 0.0 if cur == 0 else float("inf")
+    return (cur - base) * 100.0 / base
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent (default 10)")
+    parser.add_argument("--metric", choices=["us_per_op", "min_us_per_op"], default="us_per_op",
+                        help="min_us_per_op is steadier on busy CI hosts")
+    parser.add_argument("--alloc-threshold", type=float, default=0.5,
+                        help="allowed increase in allocations per op (default 0.5)")
+    args = parser.parse_args()
+
+    base = load(args.baseline)
+    cur = load(args.current)
+    if base.get("target") != cur.get("target"):
+        print(f"warning: comparing target {base.get('target')} against {cur.get('target')}")
+
+    base_cases = {r["name"]: r for r in base["results"]}
+    cur_cases = {r["name"]: r for r in cur["results"]}
+
+    regressions = 0
+    print(f"{'case':32} {'base':>12} {'current':>12} {'delta':>9}  status ({args.metric})")
+    for name, c in cur_cases.items():
+        b = base_cases.get(name)
+        if b is None:
+            print(f"{name:32} {'-':>12} {c[args.metric]:12.3f} {'':>9}  new")
+            continue
+
+        delta = pct(b[args.metric], c[args.metric])
+        status = "ok"
+        if delta > args.threshold:
+            status = "REGRESSION"
+        elif delta < -args.threshold:
+            status = "improved"
+
+        if "allocs_per_op" in b and "allocs_per_op" in c:
+            extra = c["allocs_per_op"] - b["allocs_per_op"]
+            if extra > args.alloc_threshold:
+                status = f"REGRESSION (+{extra:.2f} allocs/op)"
+
+        if status.startswith("REGRESSION"):
+            regressions += 1
+        print(f"{name:32} {b[args.metric]:12.3f} {c[args.metric]:12.3f} {delta:+8.1f}%  {status}")
+
+    for name in base_cases:
+        if name not in cur_cases:
+            print(f"{name:32} {base_cases[name][args.metric]:12.3f} {'-':>12} {'':>9}  missing")
+
+    if regressions:
+        print(f"\n{regressions} regression(s) beyond {args.threshold:.0f}%")
+        return 1
+    print("\nNo regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())